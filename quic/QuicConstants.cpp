@@ -20,6 +20,8 @@ folly::StringPiece congestionControlTypeToString(CongestionControlType type) {
       return kCongestionControlCopaStr;
     case CongestionControlType::NewReno:
       return kCongestionControlNewRenoStr;
+    case CongestionControlType::Ledbat:
+      return kCongestionControlLedbatStr;
     case CongestionControlType::None:
       return kCongestionControlNoneStr;
     default:
@@ -37,6 +39,8 @@ folly::Optional<CongestionControlType> congestionControlStrToType(
     return quic::CongestionControlType::Copa;
   } else if (str == kCongestionControlNewRenoStr) {
     return quic::CongestionControlType::NewReno;
+  } else if (str == kCongestionControlLedbatStr) {
+    return quic::CongestionControlType::Ledbat;
   } else if (str == kCongestionControlNoneStr) {
     return quic::CongestionControlType::None;
   }
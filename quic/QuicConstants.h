@@ -58,6 +58,12 @@ constexpr uint16_t kCustomTransportParameterThreshold = 0xff00;
 constexpr uint64_t kDefaultBufferSpaceAvailable =
     std::numeric_limits<uint64_t>::max();
 
+// Once a stream with send buffer limits runs out of buffer space, the write
+// callback registered through notifyPendingWriteOnStream() is not called again
+// until at least 1/kSendBufferLowWatermarkDivisor of its unsent buffer limit
+// is available.
+constexpr uint64_t kSendBufferLowWatermarkDivisor = 4;
+
 // The default min rtt to use for a new connection
 constexpr std::chrono::microseconds kDefaultMinRtt =
     std::chrono::microseconds::max();
@@ -97,6 +103,7 @@ enum class FrameType : uint8_t {
   CONNECTION_CLOSE = 0x1C,
   // CONNECTION_CLOSE_APP_ERR frametype is use to indicate application errors
   CONNECTION_CLOSE_APP_ERR = 0x1D,
+  STREAM_REPAIR = 0xFD, // private extension, negotiated via kFecParameterId
   MIN_STREAM_DATA = 0xFE, // subject to change (https://fburl.com/qpr)
   EXPIRED_STREAM_DATA = 0xFF, // subject to change (https://fburl.com/qpr)
 };
@@ -197,6 +204,11 @@ using TransportPartialReliabilitySetting = bool;
 
 constexpr uint16_t kPartialReliabilityParameterId = 0xFF00; // subject to change
 
+// Value is the number of bytes of stream data the endpoint keeps around to
+// recover lost data from STREAM_REPAIR frames. Absent or 0 means the
+// endpoint does not accept repair frames.
+constexpr uint16_t kFecParameterId = 0xFF01; // subject to change
+
 constexpr uint32_t kDrainFactor = 3;
 
 // batching mode
@@ -243,6 +255,17 @@ constexpr uint64_t kDefaultMinBurstPackets = 5;
 // but the notifications can get delayed if the event loop is busy
 // this is subject to testing but I would suggest a value >= 200usec
 constexpr std::chrono::microseconds kDefaultPacingTimerTickInterval{1000};
+// Longest burst an application send rate cap allows after being idle. Kept
+// above the timer tick so that a capped sender is not starved between ticks.
+constexpr std::chrono::milliseconds kSendRateLimiterBurstInterval{10};
+// Loss rate, as retransmitted over sent bytes, above which streams with
+// forward error correction enabled start sending repair frames.
+constexpr double kDefaultFecMinLossRate = 0.01;
+// Repair windows are sized so that about this many packets are expected to
+// be lost in each; a single XOR repair can only recover one of them.
+constexpr double kFecLossesPerWindow = 0.25;
+constexpr uint64_t kMinFecWindowSymbols = 2;
+constexpr uint64_t kDefaultFecMaxWindowSymbols = 16;
 // Fraction of RTT that is used to limit how long a write function can loop
 constexpr DurationRep kDefaultWriteLimitRttFraction = 25;
 
@@ -251,10 +274,18 @@ constexpr folly::StringPiece kCongestionControlCubicStr = "cubic";
 constexpr folly::StringPiece kCongestionControlBbrStr = "bbr";
 constexpr folly::StringPiece kCongestionControlCopaStr = "copa";
 constexpr folly::StringPiece kCongestionControlNewRenoStr = "newreno";
+constexpr folly::StringPiece kCongestionControlLedbatStr = "ledbat";
 constexpr folly::StringPiece kCongestionControlNoneStr = "none";
 
 constexpr DurationRep kPersistentCongestionThreshold = 3;
-enum class CongestionControlType : uint8_t { Cubic, NewReno, Copa, BBR, None };
+enum class CongestionControlType : uint8_t {
+  Cubic,
+  NewReno,
+  Copa,
+  BBR,
+  Ledbat,
+  None
+};
 folly::StringPiece congestionControlTypeToString(CongestionControlType type);
 folly::Optional<CongestionControlType> congestionControlStrToType(
     folly::StringPiece str);
@@ -367,6 +398,61 @@ constexpr size_t kMaxReasonPhraseLength = 1024;
 // Minimum size of an initial packet
 constexpr size_t kMinInitialPacketSize = 1200;
 
+// Sources are grouped by these prefixes by the server's ingress policer.
+constexpr uint8_t kDefaultIngressPolicerIPv4PrefixLength = 24;
+constexpr uint8_t kDefaultIngressPolicerIPv6PrefixLength = 48;
+
+// Default per source limits of the server's ingress policer.
+constexpr uint64_t kDefaultIngressPolicerInitialsPerSecond = 100;
+constexpr uint64_t kDefaultIngressPolicerInitialBurst = 200;
+constexpr uint64_t kDefaultIngressPolicerUnroutablePerSecond = 100;
+constexpr uint64_t kDefaultIngressPolicerUnroutableBurst = 200;
+
+// Dimensions of the ingress policer's count-min sketches.
+constexpr size_t kIngressPolicerSketchDepth = 4;
+constexpr size_t kIngressPolicerSketchWidth = 1024;
+
+// How often the ingress policer drains the buckets in its sketches.
+constexpr std::chrono::milliseconds kIngressPolicerDrainInterval{10};
+
+// How often a server worker's overload controller assesses the load.
+constexpr std::chrono::milliseconds kDefaultOverloadSampleInterval{100};
+
+// Event loop lag at which a worker counts as fully loaded.
+constexpr std::chrono::milliseconds kDefaultOverloadMaxLoopLag{50};
+
+// Receive queue drops per sample interval at which a worker counts as fully
+// loaded. A burst of traffic can overflow the queue of an idle worker now
+// and then, so this is set well above the few drops such a burst causes.
+constexpr uint64_t kDefaultOverloadMaxKernelDrops = 100;
+
+// Weight of the newest interval in the overload controller's load average.
+constexpr double kOverloadLoadEwmaWeight = 0.5;
+
+// Smallest receive buffer the adaptive socket buffer sizing goes down to.
+constexpr uint32_t kDefaultMinSocketReceiveBuffer = 256 * 1024;
+
+// How often the kernel's receive drop count is read, and the socket receive
+// buffer resized, when a socket does not report drops with every packet.
+constexpr std::chrono::milliseconds kSocketReceiveStatsInterval{100};
+
+// The receive buffer is sized to hold this many of the largest read bursts.
+constexpr uint32_t kSocketReceiveBufferBursts = 4;
+
+// Clocks that packet send and receive times can be taken from.
+enum class PacketTimestampClock : uint8_t {
+  // std::chrono::steady_clock.
+  Steady,
+  // The CPU's time stamp counter, converted to steady clock time. Falls back
+  // to the steady clock where there is no invariant TSC.
+  Tsc,
+};
+
+// How long the TSC is measured against the steady clock to calibrate it, and
+// how often each thread re-anchors its TSC readings to the steady clock.
+constexpr std::chrono::microseconds kTscCalibrationDuration{2000};
+constexpr std::chrono::milliseconds kTscReanchorInterval{1000};
+
 // Default maximum PTOs that will happen before tearing down the connection
 constexpr uint16_t kDefaultMaxNumPTO = 7;
 
@@ -400,6 +486,11 @@ constexpr auto kExpectedNumOfParamsInTheTicket = 8;
 
 constexpr auto kStatelessResetTokenSecretLength = 32;
 
+constexpr auto kNewTokenSecretLength = 32;
+
+// How long an address validation token sent in NEW_TOKEN is accepted for.
+constexpr std::chrono::seconds kDefaultNewTokenValidity = 24h;
+
 constexpr uint64_t kDefaultActiveConnectionIdLimit = 7;
 
 // default capability of QUIC partial reliability
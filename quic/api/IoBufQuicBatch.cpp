@@ -72,7 +72,7 @@ bool IOBufQuicBatch::isRetriableError(int err) {
   if (continueOnNetworkUnreachable_ && isNetworkUnreachable(err)) {
     if (!conn_.continueOnNetworkUnreachableDeadline) {
       conn_.continueOnNetworkUnreachableDeadline =
-          now + conn_.transportSettings.continueOnNetworkUnreachableDuration;
+          now + conn_.transportSettings->continueOnNetworkUnreachableDuration;
     }
     return now <= *conn_.continueOnNetworkUnreachableDeadline;
   }
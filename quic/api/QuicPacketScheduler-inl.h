@@ -46,7 +46,7 @@ folly::Optional<PacketNum> AckScheduler::writeAcksImpl(
   uint8_t ackDelayExponentToUse =
       builder.getPacketHeader().getHeaderForm() == HeaderForm::Long
       ? kDefaultAckDelayExponent
-      : conn_.transportSettings.ackDelayExponent;
+      : conn_.transportSettings->ackDelayExponent;
   auto largestAckedPacketNum = *largestAckToSend(ackState_);
   auto ackingTime = ClockType::now();
   DCHECK(ackState_.largestRecvdPacketTime.hasValue())
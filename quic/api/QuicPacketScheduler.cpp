@@ -276,9 +276,15 @@ void StreamFrameScheduler::writeStreams(PacketBuilderInterface& builder) {
         conn_.schedulingState.nextScheduledControlStream,
         connWritableBytes);
   }
-  if (connWritableBytes == 0) {
+  if (isConnectionSendRateLimited(conn_)) {
+    return;
+  }
+  // Non-control streams may not use the credit reserved for control streams.
+  auto reservedBytes = getReservedConnFlowControlBytes(conn_);
+  if (connWritableBytes <= reservedBytes) {
     return;
   }
+  connWritableBytes -= reservedBytes;
   const auto& writableStreams = conn_.streamManager->writableStreams();
   if (!writableStreams.empty()) {
     conn_.schedulingState.nextScheduledStream = writeStreamsHelper(
@@ -290,8 +296,15 @@ void StreamFrameScheduler::writeStreams(PacketBuilderInterface& builder) {
 } // namespace quic
 
 bool StreamFrameScheduler::hasPendingData() const {
-  return conn_.streamManager->hasWritable() &&
-      getSendConnFlowControlBytesWire(conn_) > 0;
+  if (!conn_.streamManager->hasWritable()) {
+    return false;
+  }
+  auto connWritableBytes = getSendConnFlowControlBytesWire(conn_);
+  if (!conn_.streamManager->writableControlStreams().empty()) {
+    return connWritableBytes > 0;
+  }
+  return !isConnectionSendRateLimited(conn_) &&
+      connWritableBytes > getReservedConnFlowControlBytes(conn_);
 }
 
 bool StreamFrameScheduler::writeNextStreamFrame(
@@ -310,6 +323,21 @@ bool StreamFrameScheduler::writeNextStreamFrame(
 
   uint64_t flowControlLen =
       std::min(getSendStreamFlowControlBytesWire(*stream), connWritableBytes);
+  if (stream->fecEncoder) {
+    // A lost packet is only repairable if it carried at most a symbol.
+    flowControlLen =
+        std::min(flowControlLen, stream->fecEncoder->getSymbolSize());
+  }
+  if (stream->dataSource) {
+    // Only pull what this frame can carry, so nothing from the source sits
+    // in the write buffer waiting for the network.
+    auto frameLen = std::min<uint64_t>(
+        flowControlLen, builder.remainingSpaceInPkt());
+    auto bufferedLen = stream->writeBuffer.chainLength();
+    if (bufferedLen < frameLen) {
+      pullDataFromStreamDataSource(*stream, frameLen - bufferedLen);
+    }
+  }
   uint64_t bufferLen = stream->writeBuffer.chainLength();
   bool canWriteFin =
       stream->finalWriteOffset.hasValue() && bufferLen <= flowControlLen;
@@ -427,10 +455,16 @@ BlockedScheduler::BlockedScheduler(const QuicConnectionStateBase& conn)
     : conn_(conn) {}
 
 bool BlockedScheduler::hasPendingBlockedFrames() const {
-  return !conn_.streamManager->blockedStreams().empty();
+  return conn_.pendingEvents.dataBlocked.hasValue() ||
+      !conn_.streamManager->blockedStreams().empty();
 }
 
 void BlockedScheduler::writeBlockedFrames(PacketBuilderInterface& builder) {
+  if (conn_.pendingEvents.dataBlocked) {
+    if (!writeFrame(*conn_.pendingEvents.dataBlocked, builder)) {
+      return;
+    }
+  }
   for (const auto& blockedStream : conn_.streamManager->blockedStreams()) {
     auto bytesWritten = writeFrame(blockedStream.second, builder);
     if (!bytesWritten) {
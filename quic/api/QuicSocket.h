@@ -306,6 +306,11 @@ class QuicSocket {
    * The maximum total amount of buffer space is the sum of maxUnacked and
    * maxUnsent.  Bytes passed to writeChain count against unsent until the
    * transport flushes them to the wire, after which they count against unacked.
+   *
+   * The limits are reflected in the maxToSend passed to onStreamWriteReady,
+   * and writeChain returns the data that does not fit. Once the buffer is
+   * full, the write callback is only invoked again after a quarter of
+   * maxUnsent is available. A maxUnsent of 0 removes the limits.
    */
   virtual void
   setSendBuffer(StreamId id, size_t maxUnacked, size_t maxUnsent) = 0;
@@ -377,6 +382,34 @@ class QuicSocket {
   virtual folly::Expected<folly::Unit, LocalErrorCode>
   setStreamFlowControlWindow(StreamId id, uint64_t windowSize) = 0;
 
+  /**
+   * Caps the rate, in bytes per second, at which new data on the stream is
+   * sent. Retransmissions are not counted. A rate of 0 removes the cap.
+   * The stream's data is held back while it is over its cap, so other
+   * streams can use the connection in the meantime.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode> setStreamMaxSendRate(
+      StreamId id,
+      uint64_t bytesPerSecond) = 0;
+
+  /**
+   * Caps the rate, in bytes per second, at which new data on non-control
+   * streams is sent on the connection. A rate of 0 removes the cap. When
+   * pacing is enabled, the pacing rate is capped as well.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode>
+  setConnectionMaxSendRate(uint64_t bytesPerSecond) = 0;
+
+  /**
+   * Turns forward error correction on or off for new data on the stream.
+   * While on, and once the loss rate on the connection is high enough, the
+   * stream's data is followed by repair frames that let the peer rebuild a
+   * lost packet's worth of data without waiting for the retransmission.
+   * Has no effect if the peer does not accept repair frames.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode>
+  setStreamForwardErrorCorrection(StreamId id, bool enabled) = 0;
+
   /**
    * Settings for the transport. This takes effect only before the transport
    * is connected.
@@ -490,6 +523,31 @@ class QuicSocket {
       StreamId id,
       size_t maxLen) = 0;
 
+  /**
+   * Puts the stream in unordered read mode, for applications that frame their
+   * own messages and can handle them out of order. Data is then made
+   * available as soon as it arrives, rather than waiting for the bytes before
+   * it, and must be read with readUnordered(). Flow control credit is
+   * returned to the peer for every byte read, including those past a gap.
+   * Once set, the mode can not be turned off for the stream.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode> setStreamUnorderedRead(
+      StreamId id) = 0;
+
+  /**
+   * Reads from a stream in unordered read mode, up to maxLen bytes. If maxLen
+   * is 0, transport will return all available bytes.
+   *
+   * The value is a list of the chunks read, in no particular order, each with
+   * the stream offset of its first byte, and the EOF marker. EOF is only
+   * returned once every byte up to the end of the stream has been read. No
+   * byte is returned more than once.
+   */
+  virtual folly::Expected<
+      std::pair<std::vector<StreamBuffer>, bool>,
+      LocalErrorCode>
+  readUnordered(StreamId id, size_t maxLen) = 0;
+
   /**
    * ===== Peek/Consume API =====
    */
@@ -764,6 +822,12 @@ class QuicSocket {
   virtual folly::Expected<folly::Unit, LocalErrorCode>
   notifyPendingWriteOnStream(StreamId id, WriteCallback* wcb) = 0;
 
+  /**
+   * Withdraw the write callback registered for a stream through
+   * notifyPendingWriteOnStream. The callback is not invoked again.
+   */
+  virtual void unregisterStreamWriteCallback(StreamId id) = 0;
+
   /**
    * Callback class for receiving ack notifications
    */
@@ -811,6 +875,17 @@ class QuicSocket {
       bool cork,
       DeliveryCallback* cb = nullptr) = 0;
 
+  /**
+   * Sends the rest of the stream, followed by the FIN, from source. The
+   * transport reads from the source while building packets, so a large body
+   * is never buffered up front. No more data can be written to the stream
+   * afterwards. A delivery callback, if given, is registered for the FIN.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode> setStreamDataSource(
+      StreamId id,
+      std::unique_ptr<StreamDataSource> source,
+      DeliveryCallback* cb = nullptr) = 0;
+
   /**
    * Register a callback to be invoked when the peer has acknowledged the
    * given offset on the given stream
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/api/QuicStreamFutures.h>
+
+#include <algorithm>
+
+#include <quic/QuicException.h>
+
+namespace quic {
+
+namespace {
+
+folly::exception_wrapper makeLocalError(LocalErrorCode code) {
+  return folly::make_exception_wrapper<QuicInternalException>(
+      toString(code), code);
+}
+
+folly::exception_wrapper makeError(
+    const std::pair<QuicErrorCode, folly::Optional<folly::StringPiece>>&
+        error) {
+  std::string msg =
+      error.second ? error.second->str() : toString(error.first);
+  switch (error.first.type()) {
+    case QuicErrorCode::Type::ApplicationErrorCode_E:
+      return folly::make_exception_wrapper<QuicApplicationException>(
+          msg, *error.first.asApplicationErrorCode());
+    case QuicErrorCode::Type::LocalErrorCode_E:
+      return folly::make_exception_wrapper<QuicInternalException>(
+          msg, *error.first.asLocalErrorCode());
+    case QuicErrorCode::Type::TransportErrorCode_E:
+      return folly::make_exception_wrapper<QuicTransportException>(
+          msg, *error.first.asTransportErrorCode());
+  }
+  folly::assume_unreachable();
+}
+
+bool hasReadResult(const std::pair<Buf, bool>& result) {
+  return result.second || (result.first && !result.first->empty());
+}
+
+} // namespace
+
+QuicStreamFutures::QuicStreamFutures(std::shared_ptr<QuicSocket> sock)
+    : sock_(std::move(sock)) {
+  CHECK(sock_);
+}
+
+QuicStreamFutures::~QuicStreamFutures() {
+  auto streams = std::move(streams_);
+  streams_.clear();
+  for (auto& stream : streams) {
+    cancelStream(stream.first, std::move(stream.second));
+  }
+}
+
+folly::SemiFuture<std::pair<Buf, bool>> QuicStreamFutures::read(
+    StreamId id,
+    size_t maxLen) {
+  // Only track the stream once the adapter has a callback installed on it, so
+  // failed calls do not leave entries behind.
+  auto it = streams_.find(id);
+  if (it != streams_.end() && it->second.readPromise) {
+    return folly::makeSemiFuture<std::pair<Buf, bool>>(
+        makeLocalError(LocalErrorCode::INVALID_OPERATION));
+  }
+  auto result = sock_->read(id, maxLen);
+  if (result.hasError()) {
+    return folly::makeSemiFuture<std::pair<Buf, bool>>(
+        makeLocalError(result.error()));
+  }
+  if (hasReadResult(*result)) {
+    return folly::makeSemiFuture(std::move(*result));
+  }
+  if (it == streams_.end() || !it->second.readCallbackSet) {
+    auto setResult = sock_->setReadCallback(id, this);
+    if (setResult.hasError()) {
+      return folly::makeSemiFuture<std::pair<Buf, bool>>(
+          makeLocalError(setResult.error()));
+    }
+  } else {
+    sock_->resumeRead(id);
+  }
+  auto& state = streams_[id];
+  state.readCallbackSet = true;
+  state.readMaxLen = maxLen;
+  state.readPromise.emplace();
+  return state.readPromise->getSemiFuture();
+}
+
+void QuicStreamFutures::tryRead(StreamId id, StreamState& state) {
+  auto result = sock_->read(id, state.readMaxLen);
+  if (result.hasValue() && !hasReadResult(*result)) {
+    return;
+  }
+  auto promise = std::move(*state.readPromise);
+  state.readPromise.clear();
+  // Only read again once the application asks for more data, otherwise the
+  // transport would keep telling us the stream is readable.
+  sock_->pauseRead(id);
+  // The continuation may re-enter and modify streams_, so state must not be
+  // touched after this point.
+  if (result.hasError()) {
+    promise.setException(makeLocalError(result.error()));
+  } else {
+    promise.setValue(std::move(*result));
+  }
+}
+
+void QuicStreamFutures::readAvailable(StreamId id) noexcept {
+  auto it = streams_.find(id);
+  if (it == streams_.end() || !it->second.readPromise) {
+    sock_->pauseRead(id);
+    return;
+  }
+  tryRead(id, it->second);
+}
+
+void QuicStreamFutures::readError(
+    StreamId id,
+    std::pair<QuicErrorCode, folly::Optional<folly::StringPiece>>
+        error) noexcept {
+  auto it = streams_.find(id);
+  if (it == streams_.end() || !it->second.readPromise) {
+    return;
+  }
+  auto promise = std::move(*it->second.readPromise);
+  it->second.readPromise.clear();
+  promise.setException(makeError(error));
+}
+
+folly::SemiFuture<folly::Unit>
+QuicStreamFutures::write(StreamId id, Buf data, bool eof) {
+  auto it = streams_.find(id);
+  if (it != streams_.end() && it->second.writePromise) {
+    return folly::makeSemiFuture<folly::Unit>(
+        makeLocalError(LocalErrorCode::INVALID_OPERATION));
+  }
+  auto notifyResult = sock_->notifyPendingWriteOnStream(id, this);
+  if (notifyResult.hasError()) {
+    return folly::makeSemiFuture<folly::Unit>(
+        makeLocalError(notifyResult.error()));
+  }
+  auto& state = streams_[id];
+  state.pendingWrite.append(std::move(data));
+  state.pendingEof = eof;
+  state.writePromise.emplace();
+  return state.writePromise->getSemiFuture();
+}
+
+void QuicStreamFutures::onStreamWriteReady(
+    StreamId id,
+    uint64_t maxToSend) noexcept {
+  auto it = streams_.find(id);
+  if (it == streams_.end() || !it->second.writePromise) {
+    return;
+  }
+  auto& state = it->second;
+  auto data = state.pendingWrite.splitAtMost(maxToSend);
+  bool lastChunk = state.pendingWrite.empty();
+  auto writeResult = sock_->writeChain(
+      id, std::move(data), lastChunk && state.pendingEof, false /* cork */);
+  folly::Optional<LocalErrorCode> error;
+  if (writeResult.hasError()) {
+    error = writeResult.error();
+  } else if (*writeResult) {
+    // The transport did not take everything, put the rest back in front.
+    folly::IOBufQueue remaining{folly::IOBufQueue::cacheChainLength()};
+    remaining.append(std::move(*writeResult));
+    remaining.append(state.pendingWrite.move());
+    state.pendingWrite = std::move(remaining);
+    lastChunk = false;
+  }
+  if (!error && !lastChunk) {
+    auto notifyResult = sock_->notifyPendingWriteOnStream(id, this);
+    if (notifyResult.hasError()) {
+      error = notifyResult.error();
+    } else {
+      return;
+    }
+  }
+  auto promise = std::move(*state.writePromise);
+  state.writePromise.clear();
+  state.pendingWrite.move();
+  state.pendingEof = false;
+  if (error) {
+    promise.setException(makeLocalError(*error));
+  } else {
+    promise.setValue();
+  }
+}
+
+void QuicStreamFutures::onStreamWriteError(
+    StreamId id,
+    std::pair<QuicErrorCode, folly::Optional<folly::StringPiece>>
+        error) noexcept {
+  auto it = streams_.find(id);
+  if (it == streams_.end() || !it->second.writePromise) {
+    return;
+  }
+  auto promise = std::move(*it->second.writePromise);
+  it->second.writePromise.clear();
+  it->second.pendingWrite.move();
+  it->second.pendingEof = false;
+  promise.setException(makeError(error));
+}
+
+folly::SemiFuture<folly::Unit> QuicStreamFutures::awaitDelivery(
+    StreamId id,
+    uint64_t offset) {
+  // The transport never invokes delivery callbacks from within the
+  // registration, so the promise can be added once it succeeded.
+  auto registerResult = sock_->registerDeliveryCallback(id, offset, this);
+  if (registerResult.hasError()) {
+    return folly::makeSemiFuture<folly::Unit>(
+        makeLocalError(registerResult.error()));
+  }
+  auto& state = streams_[id];
+  state.deliveryPromises.emplace_back(offset, folly::Promise<folly::Unit>());
+  return state.deliveryPromises.back().second.getSemiFuture();
+}
+
+void QuicStreamFutures::onDeliveryAck(
+    StreamId id,
+    uint64_t offset,
+    std::chrono::microseconds /* rtt */) {
+  auto it = streams_.find(id);
+  if (it == streams_.end()) {
+    return;
+  }
+  auto& promises = it->second.deliveryPromises;
+  auto promiseIt = std::find_if(
+      promises.begin(), promises.end(), [offset](const auto& entry) {
+        return entry.first == offset;
+      });
+  if (promiseIt == promises.end()) {
+    return;
+  }
+  auto promise = std::move(promiseIt->second);
+  promises.erase(promiseIt);
+  promise.setValue();
+}
+
+void QuicStreamFutures::onCanceled(StreamId id, uint64_t offset) {
+  auto it = streams_.find(id);
+  if (it == streams_.end()) {
+    return;
+  }
+  auto& promises = it->second.deliveryPromises;
+  auto promiseIt = std::find_if(
+      promises.begin(), promises.end(), [offset](const auto& entry) {
+        return entry.first == offset;
+      });
+  if (promiseIt == promises.end()) {
+    return;
+  }
+  auto promise = std::move(promiseIt->second);
+  promises.erase(promiseIt);
+  promise.setException(makeLocalError(LocalErrorCode::STREAM_CLOSED));
+}
+
+void QuicStreamFutures::releaseStream(StreamId id) {
+  auto it = streams_.find(id);
+  if (it == streams_.end()) {
+    return;
+  }
+  auto state = std::move(it->second);
+  streams_.erase(it);
+  cancelStream(id, std::move(state));
+}
+
+void QuicStreamFutures::cancelStream(StreamId id, StreamState state) {
+  // The stream is no longer in streams_, so callbacks the socket invokes
+  // from here on are ignored.
+  if (state.readCallbackSet) {
+    sock_->setReadCallback(id, nullptr);
+  }
+  if (state.writePromise) {
+    sock_->unregisterStreamWriteCallback(id);
+  }
+  if (!state.deliveryPromises.empty()) {
+    sock_->cancelDeliveryCallbacksForStream(id);
+  }
+  auto error = makeLocalError(LocalErrorCode::STREAM_CLOSED);
+  if (state.readPromise) {
+    state.readPromise->setException(error);
+  }
+  if (state.writePromise) {
+    state.writePromise->setException(error);
+  }
+  for (auto& entry : state.deliveryPromises) {
+    entry.second.setException(error);
+  }
+}
+
+} // namespace quic
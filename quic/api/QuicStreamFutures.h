@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+
+#include <folly/container/F14Map.h>
+#include <folly/futures/Future.h>
+#include <folly/io/IOBufQueue.h>
+
+#include <quic/api/QuicSocket.h>
+
+namespace quic {
+
+/**
+ * Future based adapter on top of the callback based QuicSocket stream API.
+ *
+ * A single adapter serves every stream of a socket: it installs itself as the
+ * read, write and delivery callback, so awaiting an operation never allocates
+ * a callback object. The returned SemiFutures complete inline on the socket's
+ * EventBase, and can be co_await-ed directly from folly::coro tasks where
+ * coroutines are available.
+ *
+ * All methods must be called from the socket's EventBase thread. At most one
+ * read and one write may be outstanding per stream. Releasing a stream, or
+ * destroying the adapter, removes the adapter from the socket for that stream:
+ * it unsets the read callback, withdraws the pending write notification and
+ * cancels the delivery callbacks of the stream. The socket may therefore
+ * outlive the adapter.
+ */
+class QuicStreamFutures : private QuicSocket::ReadCallback,
+                          private QuicSocket::WriteCallback,
+                          private QuicSocket::DeliveryCallback {
+ public:
+  explicit QuicStreamFutures(std::shared_ptr<QuicSocket> sock);
+
+  ~QuicStreamFutures() override;
+
+  QuicStreamFutures(const QuicStreamFutures&) = delete;
+  QuicStreamFutures& operator=(const QuicStreamFutures&) = delete;
+
+  /**
+   * Read up to maxLen bytes from the stream, completing once there is data,
+   * EOF or an error. A maxLen of 0 reads everything available. The value has
+   * the same meaning as the one returned from QuicSocket::read.
+   */
+  folly::SemiFuture<std::pair<Buf, bool>> read(StreamId id, size_t maxLen);
+
+  /**
+   * Write data/eof to the stream. Data is handed to the transport only as
+   * fast as it is willing to send it, and the future completes once all of it
+   * has been handed over. This allows callers to apply backpressure by
+   * waiting on the future before issuing the next write.
+   */
+  folly::SemiFuture<folly::Unit> write(StreamId id, Buf data, bool eof);
+
+  /**
+   * Complete once the peer has acknowledged the given offset on the stream.
+   */
+  folly::SemiFuture<folly::Unit> awaitDelivery(StreamId id, uint64_t offset);
+
+  /**
+   * Fail any outstanding operations on the stream and remove the adapter's
+   * callbacks for it from the socket. Call this once the application is done
+   * with the stream.
+   */
+  void releaseStream(StreamId id);
+
+ private:
+  struct StreamState {
+    bool readCallbackSet{false};
+    size_t readMaxLen{0};
+    folly::Optional<folly::Promise<std::pair<Buf, bool>>> readPromise;
+
+    folly::IOBufQueue pendingWrite{folly::IOBufQueue::cacheChainLength()};
+    bool pendingEof{false};
+    folly::Optional<folly::Promise<folly::Unit>> writePromise;
+
+    std::deque<std::pair<uint64_t, folly::Promise<folly::Unit>>>
+        deliveryPromises;
+  };
+
+  // QuicSocket::ReadCallback
+  void readAvailable(StreamId id) noexcept override;
+  void readError(
+      StreamId id,
+      std::pair<QuicErrorCode, folly::Optional<folly::StringPiece>>
+          error) noexcept override;
+
+  // QuicSocket::WriteCallback
+  void onStreamWriteReady(StreamId id, uint64_t maxToSend) noexcept override;
+  void onStreamWriteError(
+      StreamId id,
+      std::pair<QuicErrorCode, folly::Optional<folly::StringPiece>>
+          error) noexcept override;
+
+  // QuicSocket::DeliveryCallback
+  void onDeliveryAck(
+      StreamId id,
+      uint64_t offset,
+      std::chrono::microseconds rtt) override;
+  void onCanceled(StreamId id, uint64_t offset) override;
+
+  // Try to satisfy the pending read on the stream. Does nothing if there is
+  // no data, EOF or error to deliver yet.
+  void tryRead(StreamId id, StreamState& state);
+
+  // Remove the callbacks of a stream that was removed from streams_ from the
+  // socket and fail all of its outstanding operations.
+  void cancelStream(StreamId id, StreamState state);
+
+  std::shared_ptr<QuicSocket> sock_;
+  folly::F14FastMap<StreamId, StreamState> streams_;
+};
+
+} // namespace quic
@@ -8,13 +8,17 @@
 
 #include <quic/api/QuicTransportBase.h>
 
+#include <folly/Chrono.h>
 #include <folly/ScopeGuard.h>
+#include <folly/io/IOBufQueue.h>
 #include <quic/api/LoopDetectorCallback.h>
 #include <quic/api/QuicTransportFunctions.h>
+#include <quic/common/ContainerUtils.h>
 #include <quic/common/TimeUtil.h>
 #include <quic/congestion_control/Pacer.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/loss/QuicLossFunctions.h>
+#include <quic/state/FecFunctions.h>
 #include <quic/state/QuicPacingFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
@@ -35,6 +39,7 @@ QuicTransportBase::QuicTransportBase(
       idleTimeout_(this),
       drainTimeout_(this),
       pingTimeout_(this),
+      sendRateLimitTimeout_(this),
       readLooper_(new FunctionLooper(
           evb,
           [this](bool /* ignored */) { invokeReadDataAndCallbacks(); },
@@ -49,7 +54,7 @@ QuicTransportBase::QuicTransportBase(
           LooperType::WriteLooper)) {
   writeLooper_->setPacingFunction([this]() -> auto {
     if (isConnectionPaced(*conn_)) {
-      conn_->pacer->onPacedWriteScheduled(Clock::now());
+      conn_->pacer->onPacedWriteScheduled(conn_->clock.coarseNow());
       return conn_->pacer->getTimeUntilNextWrite();
     }
     return 0us;
@@ -148,7 +153,6 @@ void QuicTransportBase::close(
   connCallback_ = nullptr;
 
   closeImpl(std::move(errorCode), true);
-  conn_->logger.reset();
 }
 
 void QuicTransportBase::closeNow(
@@ -165,8 +169,6 @@ void QuicTransportBase::closeNow(
     drainTimeout_.cancelTimeout();
     drainTimeoutExpired();
   }
-
-  conn_->logger.reset();
 }
 
 void QuicTransportBase::closeGracefully() {
@@ -209,7 +211,7 @@ void QuicTransportBase::closeImpl(
     return;
   }
 
-  drainConnection = drainConnection & conn_->transportSettings.shouldDrain;
+  drainConnection = drainConnection & conn_->transportSettings->shouldDrain;
 
   uint64_t totalCryptoDataWritten = 0;
   uint64_t totalCryptoDataRecvd = 0;
@@ -325,6 +327,9 @@ void QuicTransportBase::closeImpl(
   if (pingTimeout_.isScheduled()) {
     pingTimeout_.cancelTimeout();
   }
+  if (sendRateLimitTimeout_.isScheduled()) {
+    sendRateLimitTimeout_.cancelTimeout();
+  }
 
   VLOG(10) << "Stopping read looper due to immediate close " << *this;
   readLooper_->stop();
@@ -404,13 +409,12 @@ void QuicTransportBase::closeImpl(
     }
   }
   drainConnection = drainConnection && !isReset && !isAbandon;
-  if (drainConnection) {
+  auto drainPeriod = std::chrono::duration_cast<std::chrono::milliseconds>(
+      kDrainFactor * calculatePTO(*conn_));
+  if (drainConnection && !handOffDrain(drainPeriod)) {
     // We ever drain once, and the object ever gets created once.
     DCHECK(!drainTimeout_.isScheduled());
-    getEventBase()->timer().scheduleTimeout(
-        &drainTimeout_,
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            kDrainFactor * calculatePTO(*conn_)));
+    getEventBase()->timer().scheduleTimeout(&drainTimeout_, drainPeriod);
   } else {
     drainTimeoutExpired();
   }
@@ -540,9 +544,24 @@ void QuicTransportBase::setReceiveWindow(
     size_t /*recvWindowSize*/) {}
 
 void QuicTransportBase::setSendBuffer(
-    StreamId /*id*/,
-    size_t /*maxUnacked*/,
-    size_t /*maxUnsent*/) {}
+    StreamId id,
+    size_t maxUnacked,
+    size_t maxUnsent) {
+  if (isReceivingStream(conn_->nodeType, id) ||
+      closeState_ != CloseState::OPEN ||
+      !conn_->streamManager->streamExists(id)) {
+    return;
+  }
+  auto stream = CHECK_NOTNULL(conn_->streamManager->getStream(id));
+  if (maxUnsent == 0) {
+    // Nothing could ever be written with no unsent space, treat it as
+    // removing the limits.
+    stream->sendBufferLimits.clear();
+  } else {
+    stream->sendBufferLimits =
+        QuicStreamState::SendBufferLimits{maxUnacked, maxUnsent};
+  }
+}
 
 uint64_t QuicTransportBase::getConnectionBufferAvailable() const {
   return bufferSpaceAvailable();
@@ -551,7 +570,7 @@ uint64_t QuicTransportBase::getConnectionBufferAvailable() const {
 uint64_t QuicTransportBase::bufferSpaceAvailable() const {
   auto bytesBuffered = conn_->flowControlState.sumCurStreamBufferLen;
   auto totalBufferSpaceAvailable =
-      conn_->transportSettings.totalBufferSpaceAvailable;
+      conn_->transportSettings->totalBufferSpaceAvailable;
   return bytesBuffered > totalBufferSpaceAvailable
       ? 0
       : totalBufferSpaceAvailable - bytesBuffered;
@@ -589,7 +608,7 @@ QuicTransportBase::setConnectionFlowControlWindow(uint64_t windowSize) {
     return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
   }
   conn_->flowControlState.windowSize = windowSize;
-  maybeSendConnWindowUpdate(*conn_, Clock::now());
+  maybeSendConnWindowUpdate(*conn_, conn_->clock.coarseNow());
   updateWriteLooper(true);
   return folly::unit;
 }
@@ -609,11 +628,71 @@ QuicTransportBase::setStreamFlowControlWindow(
     return folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED);
   }
   stream->flowControlState.windowSize = windowSize;
-  maybeSendStreamWindowUpdate(*stream, Clock::now());
+  maybeSendStreamWindowUpdate(*stream, conn_->clock.coarseNow());
   updateWriteLooper(true);
   return folly::unit;
 }
 
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setStreamMaxSendRate(StreamId id, uint64_t bytesPerSecond) {
+  if (isReceivingStream(conn_->nodeType, id)) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  auto stream = CHECK_NOTNULL(conn_->streamManager->getStream(id));
+  if (bytesPerSecond == 0) {
+    stream->sendRateLimiter.reset();
+  } else {
+    stream->sendRateLimiter = std::make_unique<SendRateLimiter>(
+        bytesPerSecond, conn_->udpSendPacketLen);
+  }
+  conn_->streamManager->updateWritableStreams(*stream);
+  updateWriteLooper(true);
+  return folly::unit;
+}
+
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setConnectionMaxSendRate(uint64_t bytesPerSecond) {
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (bytesPerSecond == 0) {
+    conn_->sendRateLimiter.reset();
+  } else {
+    conn_->sendRateLimiter = std::make_unique<SendRateLimiter>(
+        bytesPerSecond, conn_->udpSendPacketLen);
+  }
+  // The pacer picks up the new cap the next time its rate is refreshed.
+  updateWriteLooper(true);
+  return folly::unit;
+}
+
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setStreamForwardErrorCorrection(StreamId id, bool enabled) {
+  if (isReceivingStream(conn_->nodeType, id)) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  auto stream = CHECK_NOTNULL(conn_->streamManager->getStream(id));
+  if (!enabled) {
+    stream->fecEncoder.reset();
+  } else if (!stream->fecEncoder) {
+    stream->fecEncoder =
+        std::make_unique<StreamFecEncoder>(id, getFecSymbolSize(*conn_));
+  }
+  return folly::unit;
+}
+
 folly::Expected<folly::Unit, LocalErrorCode> QuicTransportBase::setReadCallback(
     StreamId id,
     ReadCallback* cb) {
@@ -1251,6 +1330,9 @@ folly::Expected<std::pair<Buf, bool>, LocalErrorCode> QuicTransportBase::read(
       // by the stream existence check, but might as well check this.
       return folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED);
     }
+    if (stream->unorderedRead) {
+      return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+    }
     auto result = readDataFromQuicStream(*stream, maxLen);
     if (result.second) {
       VLOG(10) << "Delivered eof to app for stream=" << stream->id << " "
@@ -1283,6 +1365,80 @@ folly::Expected<std::pair<Buf, bool>, LocalErrorCode> QuicTransportBase::read(
   }
 }
 
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setStreamUnorderedRead(StreamId id) {
+  if (isSendingStream(conn_->nodeType, id)) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  auto stream = CHECK_NOTNULL(conn_->streamManager->getStream(id));
+  stream->unorderedRead = true;
+  // Data already past a gap may now be readable.
+  conn_->streamManager->updateReadableStreams(*stream);
+  updateReadLooper();
+  return folly::unit;
+}
+
+folly::Expected<std::pair<std::vector<StreamBuffer>, bool>, LocalErrorCode>
+QuicTransportBase::readUnordered(StreamId id, size_t maxLen) {
+  if (isSendingStream(conn_->nodeType, id)) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  FOLLY_MAYBE_UNUSED auto self = sharedGuard();
+  SCOPE_EXIT {
+    checkForClosedStream();
+    updateReadLooper();
+    updatePeekLooper();
+    updateWriteLooper(true);
+  };
+  try {
+    if (!conn_->streamManager->streamExists(id)) {
+      return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+    }
+    auto stream = conn_->streamManager->getStream(id);
+    if (!stream) {
+      return folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED);
+    }
+    if (!stream->unorderedRead) {
+      return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+    }
+    auto result = readDataUnorderedFromQuicStream(*stream, maxLen);
+    if (result.second) {
+      VLOG(10) << "Delivered eof to app for stream=" << stream->id << " "
+               << *this;
+      auto it = readCallbacks_.find(id);
+      if (it != readCallbacks_.end()) {
+        it->second.deliveredEOM = true;
+      }
+    }
+    return folly::makeExpected<LocalErrorCode>(std::move(result));
+  } catch (const QuicTransportException& ex) {
+    VLOG(4) << "readUnordered() error " << ex.what() << " " << *this;
+    closeImpl(std::make_pair(
+        QuicErrorCode(ex.errorCode()), std::string("readUnordered() error")));
+    return folly::makeUnexpected(LocalErrorCode::TRANSPORT_ERROR);
+  } catch (const QuicInternalException& ex) {
+    VLOG(4) << __func__ << " " << ex.what() << " " << *this;
+    closeImpl(std::make_pair(
+        QuicErrorCode(ex.errorCode()), std::string("readUnordered() error")));
+    return folly::makeUnexpected(ex.errorCode());
+  } catch (const std::exception& ex) {
+    VLOG(4) << "readUnordered() error " << ex.what() << " " << *this;
+    closeImpl(std::make_pair(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        std::string("readUnordered() error")));
+    return folly::makeUnexpected(LocalErrorCode::INTERNAL_ERROR);
+  }
+}
+
 folly::Expected<folly::Unit, LocalErrorCode> QuicTransportBase::peek(
     StreamId id,
     const folly::Function<void(StreamId id, const folly::Range<PeekIterator>&)
@@ -1371,6 +1527,10 @@ folly::
       return folly::makeUnexpected(
           ConsumeError{LocalErrorCode::STREAM_CLOSED, readOffset});
     }
+    if (stream->unorderedRead) {
+      return folly::makeUnexpected(
+          ConsumeError{LocalErrorCode::INVALID_OPERATION, readOffset});
+    }
     readOffset = stream->currentReadOffset;
     if (stream->currentReadOffset != offset) {
       return folly::makeUnexpected(
@@ -1584,6 +1744,7 @@ void QuicTransportBase::onNetworkData(
     updateWriteLooper(true);
   };
   try {
+    rehydrate();
     conn_->lossState.totalBytesRecvd += networkData.totalData;
     auto originalAckVersion = currentAckStateVersion(*conn_);
     for (auto& packet : networkData.packets) {
@@ -1638,10 +1799,10 @@ void QuicTransportBase::setIdleTimer() {
   if (idleTimeout_.isScheduled()) {
     idleTimeout_.cancelTimeout();
   }
-  if (conn_->transportSettings.idleTimeout >
+  if (conn_->transportSettings->idleTimeout >
       std::chrono::milliseconds::zero()) {
     getEventBase()->timer().scheduleTimeout(
-        &idleTimeout_, conn_->transportSettings.idleTimeout);
+        &idleTimeout_, conn_->transportSettings->idleTimeout);
   }
 }
 
@@ -1658,6 +1819,7 @@ QuicTransportBase::createStreamInternal(bool bidirectional) {
   if (closeState_ != CloseState::OPEN) {
     return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
   }
+  rehydrate();
   folly::Expected<QuicStreamState*, LocalErrorCode> streamResult;
   if (bidirectional) {
     streamResult = conn_->streamManager->createNextBidirectionalStream();
@@ -1705,6 +1867,7 @@ QuicTransportBase::notifyPendingWriteOnConnection(WriteCallback* wcb) {
   if (connWriteCallback_ != nullptr) {
     return folly::makeUnexpected(LocalErrorCode::INVALID_WRITE_CALLBACK);
   }
+  rehydrate();
   // Assign the write callback before going into the loop so that if we close
   // the connection while we are still scheduled, the write callback will get
   // an error synchronously.
@@ -1743,6 +1906,7 @@ QuicTransportBase::notifyPendingWriteOnStream(StreamId id, WriteCallback* wcb) {
   if (wcb == nullptr) {
     return folly::makeUnexpected(LocalErrorCode::INVALID_WRITE_CALLBACK);
   }
+  rehydrate();
   // Add the callback to the pending write callbacks so that if we are closed
   // while we are scheduled in the loop, the close will error out the callbacks.
   auto wcbEmplaceResult = pendingWriteCallbacks_.emplace(id, wcb);
@@ -1782,20 +1946,81 @@ QuicTransportBase::notifyPendingWriteOnStream(StreamId id, WriteCallback* wcb) {
   return folly::unit;
 }
 
+void QuicTransportBase::unregisterStreamWriteCallback(StreamId id) {
+  pendingWriteCallbacks_.erase(id);
+}
+
 uint64_t QuicTransportBase::maxWritableOnStream(const QuicStreamState& stream) {
-  auto connWritableBytes = maxWritableOnConn();
+  auto connWritableBytes = maxWritableOnConn(stream.isControl);
   auto streamFlowControlBytes = getSendStreamFlowControlBytesAPI(stream);
   auto flowControlAllowedBytes =
       std::min(streamFlowControlBytes, connWritableBytes);
-  return flowControlAllowedBytes;
+  return std::min(flowControlAllowedBytes, getSendBufferWritable(stream));
 }
 
-uint64_t QuicTransportBase::maxWritableOnConn() {
+uint64_t QuicTransportBase::maxWritableOnConn(bool includeReserved) {
   auto connWritableBytes = getSendConnFlowControlBytesAPI(*conn_);
+  if (!includeReserved) {
+    auto reservedBytes = getReservedConnFlowControlBytes(*conn_);
+    connWritableBytes = connWritableBytes > reservedBytes
+        ? connWritableBytes - reservedBytes
+        : 0;
+  }
   auto availableBufferSpace = bufferSpaceAvailable();
   return std::min(connWritableBytes, availableBufferSpace);
 }
 
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setStreamDataSource(
+    StreamId id,
+    std::unique_ptr<StreamDataSource> source,
+    DeliveryCallback* cb) {
+  if (isReceivingStream(conn_->nodeType, id)) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!source) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  FOLLY_MAYBE_UNUSED auto self = sharedGuard();
+  rehydrate();
+  try {
+    if (!conn_->streamManager->streamExists(id)) {
+      return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+    }
+    auto stream = conn_->streamManager->getStream(id);
+    if (!stream || !stream->writable()) {
+      return folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED);
+    }
+    stream->dataSource = std::move(source);
+    stream->dataSourceOffset = 0;
+    if (cb) {
+      registerDeliveryCallback(id, getLargestWriteOffsetSeen(*stream), cb);
+    }
+    // An empty source only has the FIN to send.
+    pullDataFromStreamDataSource(*stream, 0);
+    conn_->streamManager->updateWritableStreams(*stream);
+    updateWriteLooper(true);
+  } catch (const QuicTransportException& ex) {
+    VLOG(4) << __func__ << " streamId=" << id << " " << ex.what() << " "
+            << *this;
+    closeImpl(std::make_pair(
+        QuicErrorCode(ex.errorCode()),
+        std::string("setStreamDataSource() error")));
+    return folly::makeUnexpected(LocalErrorCode::TRANSPORT_ERROR);
+  } catch (const std::exception& ex) {
+    VLOG(4) << __func__ << " streamId=" << id << " " << ex.what() << " "
+            << *this;
+    closeImpl(std::make_pair(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        std::string("setStreamDataSource() error")));
+    return folly::makeUnexpected(LocalErrorCode::INTERNAL_ERROR);
+  }
+  return folly::unit;
+}
+
 QuicSocket::WriteResult QuicTransportBase::writeChain(
     StreamId id,
     Buf data,
@@ -1809,6 +2034,7 @@ QuicSocket::WriteResult QuicTransportBase::writeChain(
     return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
   }
   FOLLY_MAYBE_UNUSED auto self = sharedGuard();
+  rehydrate();
   try {
     // Check whether stream exists before calling getStream to avoid
     // creating a peer stream if it does not exist yet.
@@ -1819,6 +2045,22 @@ QuicSocket::WriteResult QuicTransportBase::writeChain(
     if (!stream || !stream->writable()) {
       return folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED);
     }
+    // Data past the send buffer limits is handed back to the app, which
+    // passes it again along with the EOF and delivery callback.
+    Buf unwritten;
+    auto writeLength = data ? data->computeChainDataLength() : 0;
+    auto sendBufferSpace = getSendBufferSpace(*stream);
+    if (writeLength > sendBufferSpace) {
+      folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
+      queue.append(std::move(data));
+      data = queue.splitAtMost(sendBufferSpace);
+      unwritten = queue.move();
+      eof = false;
+      cb = nullptr;
+      if (!data) {
+        return std::move(unwritten);
+      }
+    }
     // Register DeliveryCallback for the data + eof offset.
     if (cb) {
       auto dataLength =
@@ -1831,6 +2073,9 @@ QuicSocket::WriteResult QuicTransportBase::writeChain(
     }
     writeDataToQuicStream(*stream, std::move(data), eof);
     updateWriteLooper(true);
+    if (unwritten) {
+      return std::move(unwritten);
+    }
   } catch (const QuicTransportException& ex) {
     VLOG(4) << __func__ << " streamId=" << id << " " << ex.what() << " "
             << *this;
@@ -1934,6 +2179,7 @@ folly::Expected<folly::Unit, LocalErrorCode> QuicTransportBase::resetStream(
     updatePeekLooper();
     updateWriteLooper(true);
   };
+  rehydrate();
   try {
     // Check whether stream exists before calling getStream to avoid
     // creating a peer stream if it does not exist yet.
@@ -2045,6 +2291,7 @@ void QuicTransportBase::sendPing(
   if (closeState_ == CloseState::CLOSED) {
     return;
   }
+  rehydrate();
 
   // Step 1: Send a simple ping frame
   quic::sendSimpleFrame(*conn_, PingFrame());
@@ -2131,6 +2378,43 @@ void QuicTransportBase::idleTimeoutExpired(bool drain) noexcept {
       !drain /* sendCloseImmediately */);
 }
 
+void QuicTransportBase::rehydrate() {
+  quiescentSinceHibernationCheck_ = false;
+  if (conn_->hibernated) {
+    conn_->hibernated = false;
+    QUIC_STATS(conn_->infoCallback, onConnectionRehydrated);
+  }
+}
+
+bool QuicTransportBase::maybeHibernate() {
+  if (closeState_ != CloseState::OPEN || conn_->hibernated ||
+      conn_->transportSettings->hibernationIdleTimeout ==
+          std::chrono::milliseconds::zero()) {
+    return false;
+  }
+  if (!isConnectionQuiescent(*conn_) || !pendingWriteCallbacks_.empty() ||
+      connWriteCallback_) {
+    // Something is still in flight or waiting to be written.
+    quiescentSinceHibernationCheck_ = false;
+    return false;
+  }
+  if (!quiescentSinceHibernationCheck_) {
+    // Reads and application calls clear this, so the connection hibernates
+    // only once it stayed quiescent for a whole interval between two calls.
+    quiescentSinceHibernationCheck_ = true;
+    return false;
+  }
+  VLOG(10) << __func__ << " " << *this;
+  compactConnectionState(*conn_);
+  releaseIfEmpty(readCallbacks_);
+  releaseIfEmpty(peekCallbacks_);
+  releaseIfEmpty(deliveryCallbacks_);
+  releaseIfEmpty(dataExpiredCallbacks_);
+  releaseIfEmpty(dataRejectedCallbacks_);
+  QUIC_STATS(conn_->infoCallback, onConnectionHibernated);
+  return true;
+}
+
 void QuicTransportBase::scheduleLossTimeout(std::chrono::milliseconds timeout) {
   if (closeState_ == CloseState::CLOSED) {
     return;
@@ -2198,7 +2482,7 @@ void QuicTransportBase::schedulePathValidationTimeout() {
         conn_->lossState.maxAckDelay;
 
     auto validationTimeout =
-        std::max(3 * pto, 6 * conn_->transportSettings.initialRtt);
+        std::max(3 * pto, 6 * conn_->transportSettings->initialRtt);
     auto timeoutMs = std::chrono::duration_cast<std::chrono::milliseconds>(
         validationTimeout);
     VLOG(10) << __func__ << " timeout=" << timeoutMs.count() << "ms " << *this;
@@ -2206,6 +2490,53 @@ void QuicTransportBase::schedulePathValidationTimeout() {
   }
 }
 
+void QuicTransportBase::scheduleSendRateLimitTimeout() {
+  if (closeState_ == CloseState::CLOSED ||
+      sendRateLimitTimeout_.isScheduled()) {
+    return;
+  }
+  folly::Optional<std::chrono::microseconds> timeout;
+  if (isConnectionSendRateLimited(*conn_)) {
+    timeout = conn_->sendRateLimiter->timeUntilCredit();
+  }
+  for (auto id : conn_->streamManager->rateLimitedStreams()) {
+    auto stream = conn_->streamManager->findStream(id);
+    if (stream && stream->sendRateLimiter) {
+      auto untilCredit = stream->sendRateLimiter->timeUntilCredit();
+      timeout = timeout ? std::min(*timeout, untilCredit) : untilCredit;
+    }
+  }
+  if (!timeout) {
+    return;
+  }
+  auto timeoutMs = folly::chrono::ceil<std::chrono::milliseconds>(*timeout);
+  VLOG(10) << __func__ << " timeout=" << timeoutMs.count() << "ms " << *this;
+  getEventBase()->timer().scheduleTimeout(&sendRateLimitTimeout_, timeoutMs);
+}
+
+void QuicTransportBase::sendRateLimitTimeoutExpired() noexcept {
+  auto now = Clock::now();
+  if (conn_->sendRateLimiter) {
+    conn_->sendRateLimiter->refill(now);
+  }
+  // updateWritableStreams() modifies the set being walked.
+  std::vector<StreamId> rateLimitedStreams(
+      conn_->streamManager->rateLimitedStreams().begin(),
+      conn_->streamManager->rateLimitedStreams().end());
+  for (auto id : rateLimitedStreams) {
+    auto stream = conn_->streamManager->findStream(id);
+    if (!stream) {
+      continue;
+    }
+    if (stream->sendRateLimiter) {
+      stream->sendRateLimiter->refill(now);
+    }
+    conn_->streamManager->updateWritableStreams(*stream);
+  }
+  scheduleSendRateLimitTimeout();
+  updateWriteLooper(true);
+}
+
 void QuicTransportBase::cancelLossTimeout() {
   if (lossTimeout_.isScheduled()) {
     lossTimeout_.cancelTimeout();
@@ -2320,9 +2651,12 @@ void QuicTransportBase::writeSocketData() {
           conn_->cryptoState->initialStream.lossBuffer.empty() &&
           conn_->cryptoState->handshakeStream.lossBuffer.empty() &&
           conn_->cryptoState->oneRttStream.lossBuffer.empty();
+      // Data held back by a send rate cap leaves the window unused too.
+      auto rateLimited = conn_->streamManager->hasRateLimited() ||
+          isConnectionSendRateLimited(*conn_);
       if (conn_->congestionController &&
-          currentSendBufLen < conn_->udpSendPacketLen && lossBufferEmpty &&
-          conn_->congestionController->getWritableBytes()) {
+          (currentSendBufLen < conn_->udpSendPacketLen || rateLimited) &&
+          lossBufferEmpty && conn_->congestionController->getWritableBytes()) {
         conn_->congestionController->setAppLimited();
       }
     }
@@ -2332,6 +2666,7 @@ void QuicTransportBase::writeSocketData() {
   // effect.
   scheduleAckTimeout();
   schedulePathValidationTimeout();
+  scheduleSendRateLimitTimeout();
   updateWriteLooper(false);
 }
 
@@ -2382,6 +2717,16 @@ void QuicTransportBase::cancelDeliveryCallbacks(
 
 void QuicTransportBase::setTransportSettings(
     TransportSettings transportSettings) {
+  setTransportSettingsInternal(std::move(transportSettings));
+}
+
+void QuicTransportBase::setSharedTransportSettings(
+    std::shared_ptr<const TransportSettings> transportSettings) {
+  setTransportSettingsInternal(std::move(transportSettings));
+}
+
+void QuicTransportBase::setTransportSettingsInternal(
+    SharedTransportSettings transportSettings) {
   // If we've already encoded the transport parameters, silently return as
   // setting the transport settings again would be buggy.
   // TODO should we throw or return Expected here?
@@ -2389,20 +2734,26 @@ void QuicTransportBase::setTransportSettings(
     return;
   }
   conn_->transportSettings = std::move(transportSettings);
-  conn_->streamManager->refreshTransportSettings(conn_->transportSettings);
-  setCongestionControl(transportSettings.defaultCongestionController);
-  if (conn_->transportSettings.pacingEnabled) {
+  const auto& settings = *conn_->transportSettings;
+  conn_->streamManager->refreshTransportSettings(settings);
+  conn_->clock.setUseLoopCache(settings.useLoopCachedClock);
+  conn_->clock.setPacketTimestampClock(settings.packetTimestampClock);
+  auto congestionControlType = settings.defaultCongestionController;
+  auto minCwndInMss = settings.minCwndInMss;
+  // setCongestionControl() may copy the settings to turn on pacing, so read
+  // what is needed from them first.
+  setCongestionControl(congestionControlType);
+  if (conn_->transportSettings->pacingEnabled) {
     conn_->pacer = std::make_unique<DefaultPacer>(
         *conn_,
-        transportSettings.defaultCongestionController ==
-                CongestionControlType::BBR
+        congestionControlType == CongestionControlType::BBR
             ? kMinCwndInMssForBbr
-            : conn_->transportSettings.minCwndInMss);
+            : minCwndInMss);
   }
 }
 
 const TransportSettings& QuicTransportBase::getTransportSettings() const {
-  return conn_->transportSettings;
+  return *conn_->transportSettings;
 }
 
 bool QuicTransportBase::isPartiallyReliableTransport() const {
@@ -2417,7 +2768,9 @@ void QuicTransportBase::setCongestionControl(CongestionControlType type) {
 
     // We need to enable pacing if we're switching to BBR.
     if (type == CongestionControlType::BBR) {
-      conn_->transportSettings.pacingEnabled = true;
+      if (!conn_->transportSettings->pacingEnabled) {
+        conn_->transportSettings.mutate().pacingEnabled = true;
+      }
       conn_->pacer =
           std::make_unique<DefaultPacer>(*conn_, kMinCwndInMssForBbr);
     }
@@ -2440,9 +2793,11 @@ void QuicTransportBase::attachEventBase(folly::EventBase* evb) {
   if (socket_) {
     socket_->attachEventBase(evb);
   }
+  conn_->clock.attachEventBase(evb);
 
   scheduleAckTimeout();
   schedulePathValidationTimeout();
+  scheduleSendRateLimitTimeout();
   setIdleTimer();
 
   readLooper_->attachEventBase(evb);
@@ -2466,9 +2821,11 @@ void QuicTransportBase::detachEventBase() {
   pathValidationTimeout_.cancelTimeout();
   idleTimeout_.cancelTimeout();
   drainTimeout_.cancelTimeout();
+  sendRateLimitTimeout_.cancelTimeout();
   readLooper_->detachEventBase();
   peekLooper_->detachEventBase();
   writeLooper_->detachEventBase();
+  conn_->clock.detachEventBase();
   evb_ = nullptr;
 }
 
@@ -112,6 +112,17 @@ class QuicTransportBase : public QuicSocket {
       StreamId id,
       uint64_t windowSize) override;
 
+  folly::Expected<folly::Unit, LocalErrorCode> setStreamMaxSendRate(
+      StreamId id,
+      uint64_t bytesPerSecond) override;
+
+  folly::Expected<folly::Unit, LocalErrorCode> setConnectionMaxSendRate(
+      uint64_t bytesPerSecond) override;
+
+  folly::Expected<folly::Unit, LocalErrorCode> setStreamForwardErrorCorrection(
+      StreamId id,
+      bool enabled) override;
+
   folly::Expected<folly::Unit, LocalErrorCode> setReadCallback(
       StreamId id,
       ReadCallback* cb) override;
@@ -128,6 +139,12 @@ class QuicTransportBase : public QuicSocket {
       StreamId id,
       size_t maxLen) override;
 
+  folly::Expected<folly::Unit, LocalErrorCode> setStreamUnorderedRead(
+      StreamId id) override;
+
+  folly::Expected<std::pair<std::vector<StreamBuffer>, bool>, LocalErrorCode>
+  readUnordered(StreamId id, size_t maxLen) override;
+
   folly::Expected<folly::Unit, LocalErrorCode> setPeekCallback(
       StreamId id,
       PeekCallback* cb) override;
@@ -180,6 +197,8 @@ class QuicTransportBase : public QuicSocket {
       StreamId id,
       WriteCallback* wcb) override;
 
+  void unregisterStreamWriteCallback(StreamId id) override;
+
   folly::Expected<folly::Unit, LocalErrorCode> notifyPendingWriteOnConnection(
       WriteCallback* wcb) override;
 
@@ -190,6 +209,11 @@ class QuicTransportBase : public QuicSocket {
       bool cork,
       DeliveryCallback* cb = nullptr) override;
 
+  folly::Expected<folly::Unit, LocalErrorCode> setStreamDataSource(
+      StreamId id,
+      std::unique_ptr<StreamDataSource> source,
+      DeliveryCallback* cb = nullptr) override;
+
   folly::Expected<folly::Unit, LocalErrorCode> registerDeliveryCallback(
       StreamId id,
       uint64_t offset,
@@ -261,6 +285,13 @@ class QuicTransportBase : public QuicSocket {
    */
   void setTransportSettings(TransportSettings transportSettings) override;
 
+  /**
+   * Makes the connection share an immutable settings profile, which it only
+   * copies if it has to change one of the settings.
+   */
+  virtual void setSharedTransportSettings(
+      std::shared_ptr<const TransportSettings> transportSettings);
+
   /**
    * Set factory to create specific congestion controller instances
    * for a given connection
@@ -273,6 +304,15 @@ class QuicTransportBase : public QuicSocket {
    */
   const TransportSettings& getTransportSettings() const override;
 
+  /**
+   * Releases the spare capacity of the connection's containers if
+   * hibernation is enabled in its settings and the connection stayed
+   * quiescent since the previous call. Whoever owns many connections calls
+   * this every hibernationIdleTimeout, so connections do not need a timer of
+   * their own. Returns true if the connection hibernated.
+   */
+  bool maybeHibernate();
+
   // Subclass API.
 
   /**
@@ -306,6 +346,15 @@ class QuicTransportBase : public QuicSocket {
    */
   virtual void unbindConnection() = 0;
 
+  /**
+   * Invoked instead of scheduling the drain timeout. Returns true if the
+   * subclass arranged for the peer to be answered during the drain period,
+   * in which case the connection is unbound right away.
+   */
+  virtual bool handOffDrain(std::chrono::milliseconds /* drainPeriod */) {
+    return false;
+  }
+
   /**
    * Returns whether or not the connection has a write cipher. This will be used
    * to decide to return the onTransportReady() callbacks.
@@ -436,6 +485,26 @@ class QuicTransportBase : public QuicSocket {
     QuicTransportBase* transport_;
   };
 
+  class SendRateLimitTimeout : public folly::HHWheelTimer::Callback {
+   public:
+    ~SendRateLimitTimeout() override = default;
+
+    explicit SendRateLimitTimeout(QuicTransportBase* transport)
+        : transport_(transport) {}
+
+    void timeoutExpired() noexcept override {
+      transport_->sendRateLimitTimeoutExpired();
+    }
+
+    void callbackCanceled() noexcept override {
+      // ignore, as this happens only when event base dies
+      return;
+    }
+
+   private:
+    QuicTransportBase* transport_;
+  };
+
   // DrainTimeout is a bit different from other timeouts. It needs to hold a
   // shared_ptr to the transport, since if a DrainTimeout is scheduled,
   // transport cannot die.
@@ -463,10 +532,6 @@ class QuicTransportBase : public QuicSocket {
 
   void describe(std::ostream& os) const;
 
-  void setLogger(std::shared_ptr<Logger> logger) {
-    conn_->logger = std::move(logger);
-  }
-
   virtual void setQLogger(std::shared_ptr<QLogger> qLogger) {
     conn_->qLogger = std::move(qLogger);
   }
@@ -542,18 +607,25 @@ class QuicTransportBase : public QuicSocket {
   void pacedWriteDataToSocket(bool fromTimer);
 
   uint64_t maxWritableOnStream(const QuicStreamState&);
-  uint64_t maxWritableOnConn();
+  // Only control streams may write into the flow control reserved for them.
+  uint64_t maxWritableOnConn(bool includeReserved = false);
 
   void lossTimeoutExpired() noexcept;
   void ackTimeoutExpired() noexcept;
-  void pathValidationTimeoutExpired() noexcept;
+  virtual void pathValidationTimeoutExpired() noexcept;
   void idleTimeoutExpired(bool drain) noexcept;
   void drainTimeoutExpired() noexcept;
   void pingTimeoutExpired() noexcept;
+  void sendRateLimitTimeoutExpired() noexcept;
 
   void setIdleTimer();
+  void setTransportSettingsInternal(SharedTransportSettings transportSettings);
+  // Clears the hibernated state when the network or the application makes
+  // use of the connection again.
+  void rehydrate();
   void scheduleAckTimeout();
   void schedulePathValidationTimeout();
+  void scheduleSendRateLimitTimeout();
   void schedulePingTimeout(
       PingCallback* callback,
       std::chrono::milliseconds pingTimeout);
@@ -608,6 +680,8 @@ class QuicTransportBase : public QuicSocket {
   std::map<StreamId, WriteCallback*> pendingWriteCallbacks_;
   CloseState closeState_{CloseState::OPEN};
   bool transportReadyNotified_{false};
+  // Whether the connection stayed quiescent since the last maybeHibernate().
+  bool quiescentSinceHibernationCheck_{false};
 
   LossTimeout lossTimeout_;
   AckTimeout ackTimeout_;
@@ -615,6 +689,7 @@ class QuicTransportBase : public QuicSocket {
   IdleTimeout idleTimeout_;
   DrainTimeout drainTimeout_;
   PingTimeout pingTimeout_;
+  SendRateLimitTimeout sendRateLimitTimeout_;
   FunctionLooper::Ptr readLooper_;
   FunctionLooper::Ptr peekLooper_;
   FunctionLooper::Ptr writeLooper_;
@@ -19,6 +19,7 @@
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
 #include <quic/logging/QuicLogger.h>
+#include <quic/state/FecFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <quic/state/SimpleFrameFunctions.h>
@@ -99,6 +100,7 @@ void handleNewStreamDataWritten(
   auto bufWritten = stream.writeBuffer.splitAtMost(folly::to<size_t>(frameLen));
   DCHECK_EQ(bufWritten->computeChainDataLength(), frameLen);
   stream.currentWriteOffset += frameFin ? 1 : 0;
+  stream.unackedBytes += frameLen;
   CHECK(stream.retransmissionBuffer
             .emplace(
                 std::piecewise_construct,
@@ -217,6 +219,25 @@ void updateConnection(
             packetNum,
             packetNumberSpace);
         if (newStreamDataWritten) {
+          if (stream->sendRateLimiter) {
+            stream->sendRateLimiter->onBytesSent(
+                writeStreamFrame.len, sentTime);
+          }
+          if (conn.sendRateLimiter && !stream->isControl) {
+            conn.sendRateLimiter->onBytesSent(writeStreamFrame.len, sentTime);
+          }
+          if (stream->fecEncoder) {
+            auto& written =
+                stream->retransmissionBuffer.at(writeStreamFrame.offset);
+            // A frame with only the FIN still ends the last window.
+            folly::IOBuf noData;
+            const auto* data = written.data.front();
+            onFecStreamDataWritten(
+                *stream,
+                writeStreamFrame.offset,
+                data ? *data : noData,
+                writeStreamFrame.fin);
+          }
           updateFlowControlOnWriteToSocket(*stream, writeStreamFrame.len);
           maybeWriteBlockAfterSocketWrite(*stream);
           conn.streamManager->updateWritableStreams(*stream);
@@ -315,6 +336,19 @@ void updateConnection(
         conn.streamManager->removeBlocked(streamBlockedFrame.streamId);
         break;
       }
+      case QuicWriteFrame::Type::DataBlockedFrame_E: {
+        const DataBlockedFrame& blockedFrame = *frame.asDataBlockedFrame();
+        VLOG(10) << nodeToString(conn.nodeType)
+                 << " sent conn data blocked frame packetNum=" << packetNum
+                 << " " << conn;
+        retransmittable = true;
+        if (conn.pendingEvents.dataBlocked &&
+            conn.pendingEvents.dataBlocked->dataLimit ==
+                blockedFrame.dataLimit) {
+          conn.pendingEvents.dataBlocked.clear();
+        }
+        break;
+      }
       case QuicWriteFrame::Type::QuicSimpleFrame_E: {
         const QuicSimpleFrame& simpleFrame = *frame.asQuicSimpleFrame();
         retransmittable = true;
@@ -714,7 +748,7 @@ uint64_t writeZeroRttDataToSocket(
   return written;
 }
 
-void writeCloseCommon(
+Buf writeCloseCommon(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     PacketHeader&& header,
@@ -769,7 +803,7 @@ void writeCloseCommon(
   }
   if (written == 0) {
     LOG(ERROR) << "Close frame too large " << connection;
-    return;
+    return nullptr;
   }
   auto packet = std::move(packetBuilder).buildPacket();
   packet.header->coalesce();
@@ -812,9 +846,10 @@ void writeCloseCommon(
   } else {
     QUIC_STATS(connection.infoCallback, onWrite, ret);
   }
+  return packetBuf;
 }
 
-void writeLongClose(
+Buf writeLongClose(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& srcConnId,
@@ -827,7 +862,7 @@ void writeLongClose(
   if (!connection.serverConnectionId) {
     // It's possible that servers encountered an error before binding to a
     // connection id.
-    return;
+    return nullptr;
   }
   LongHeader header(
       headerType,
@@ -836,7 +871,7 @@ void writeLongClose(
       getNextPacketNum(
           connection, LongHeader::typeToPacketNumberSpace(headerType)),
       version);
-  writeCloseCommon(
+  return writeCloseCommon(
       sock,
       connection,
       std::move(header),
@@ -845,7 +880,7 @@ void writeLongClose(
       headerCipher);
 }
 
-void writeShortClose(
+Buf writeShortClose(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& connId,
@@ -856,7 +891,7 @@ void writeShortClose(
       ProtectionType::KeyPhaseZero,
       connId,
       getNextPacketNum(connection, PacketNumberSpace::AppData));
-  writeCloseCommon(
+  return writeCloseCommon(
       sock,
       connection,
       std::move(header),
@@ -914,8 +949,8 @@ uint64_t writeConnectionDataToSocket(
 
   auto batchWriter = BatchWriterFactory::makeBatchWriter(
       sock,
-      connection.transportSettings.batchingMode,
-      connection.transportSettings.maxBatchSize);
+      connection.transportSettings->batchingMode,
+      connection.transportSettings->maxBatchSize);
 
   IOBufQuicBatch ioBufBatch(
       std::move(batchWriter),
@@ -924,7 +959,7 @@ uint64_t writeConnectionDataToSocket(
       connection,
       connection.happyEyeballsState);
   ioBufBatch.setContinueOnNetworkUnreachable(
-      connection.transportSettings.continueOnNetworkUnreachable);
+      connection.transportSettings->continueOnNetworkUnreachable);
 
   if (connection.loopDetectorCallback) {
     connection.debugState.schedulerName = scheduler.name();
@@ -933,19 +968,20 @@ uint64_t writeConnectionDataToSocket(
       connection.debugState.noWriteReason = NoWriteReason::EMPTY_SCHEDULER;
     }
   }
-  auto writeLoopBeginTime = Clock::now();
+  auto writeLoopBeginTime = connection.clock.packetNow();
   // helper functor to check if we have been write in a loop for longer than the
   // RTT fraction that we are allowed to write. Only kicks in if we have write
   // one batch in batching write mode.
   auto timeLimitHelper = [&]() -> bool {
-    auto batchSize = connection.transportSettings.batchingMode ==
+    auto batchSize = connection.transportSettings->batchingMode ==
             quic::QuicBatchingMode::BATCHING_MODE_NONE
-        ? connection.transportSettings.writeConnectionDataPacketsLimit
-        : connection.transportSettings.maxBatchSize;
+        ? connection.transportSettings->writeConnectionDataPacketsLimit
+        : connection.transportSettings->maxBatchSize;
     return ioBufBatch.getPktSent() < batchSize ||
         connection.lossState.srtt == 0us ||
-        Clock::now() - writeLoopBeginTime < connection.lossState.srtt /
-            connection.transportSettings.writeLimitRttFraction;
+        connection.clock.packetNow() - writeLoopBeginTime <
+            connection.lossState.srtt /
+                connection.transportSettings->writeLimitRttFraction;
   };
   while (scheduler.hasData() && ioBufBatch.getPktSent() < packetLimit &&
          timeLimitHelper()) {
@@ -1021,7 +1057,7 @@ uint64_t writeConnectionDataToSocket(
         connection,
         std::move(result.first),
         std::move(result.second->packet),
-        Clock::now(),
+        connection.clock.packetNow(),
         folly::to<uint32_t>(encodedSize));
 
     // if ioBufBatch.write returns false
@@ -1140,7 +1176,9 @@ WriteDataReason hasNonAckDataToWrite(const QuicConnectionStateBase& conn) {
     return WriteDataReason::LOSS;
   }
   if (getSendConnFlowControlBytesWire(conn) != 0 &&
-      conn.streamManager->hasWritable()) {
+      (!conn.streamManager->writableControlStreams().empty() ||
+       (!conn.streamManager->writableStreams().empty() &&
+        !isConnectionSendRateLimited(conn)))) {
     return WriteDataReason::STREAM;
   }
   if (!conn.pendingEvents.frames.empty()) {
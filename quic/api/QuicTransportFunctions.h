@@ -154,7 +154,11 @@ uint64_t congestionControlWritableBytes(const QuicConnectionStateBase& conn);
 
 uint64_t unlimitedWritableBytes(const QuicConnectionStateBase&);
 
-void writeCloseCommon(
+/**
+ * Writes a packet with a close frame. Returns the encrypted packet that was
+ * written, or nullptr if the close frame did not fit.
+ */
+Buf writeCloseCommon(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     PacketHeader&& header,
@@ -165,8 +169,9 @@ void writeCloseCommon(
 /**
  * Writes a LongHeader packet with a close frame.
  * The close frame type written depends on the type of error in closeDetails.
+ * Returns the written packet, if any.
  */
-void writeLongClose(
+Buf writeLongClose(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& srcConnId,
@@ -180,8 +185,9 @@ void writeLongClose(
 /**
  * Write a short header packet with a close frame.
  * The close frame type written depends on the type of error in closeDetails.
+ * Returns the written packet, if any.
  */
-void writeShortClose(
+Buf writeShortClose(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& connId,
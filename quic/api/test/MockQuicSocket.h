@@ -82,6 +82,15 @@ class MockQuicSocket : public QuicSocket {
   MOCK_METHOD2(
       setStreamFlowControlWindow,
       folly::Expected<folly::Unit, LocalErrorCode>(StreamId, uint64_t));
+  MOCK_METHOD2(
+      setStreamMaxSendRate,
+      folly::Expected<folly::Unit, LocalErrorCode>(StreamId, uint64_t));
+  MOCK_METHOD1(
+      setConnectionMaxSendRate,
+      folly::Expected<folly::Unit, LocalErrorCode>(uint64_t));
+  MOCK_METHOD2(
+      setStreamForwardErrorCorrection,
+      folly::Expected<folly::Unit, LocalErrorCode>(StreamId, bool));
   MOCK_METHOD1(setTransportSettings, void(TransportSettings));
   MOCK_CONST_METHOD0(isPartiallyReliableTransport, bool());
   MOCK_METHOD2(
@@ -119,6 +128,12 @@ class MockQuicSocket : public QuicSocket {
   using ReadResult =
       folly::Expected<std::pair<folly::IOBuf*, bool>, LocalErrorCode>;
   MOCK_METHOD2(readNaked, ReadResult(StreamId, size_t));
+  MOCK_METHOD1(
+      setStreamUnorderedRead,
+      folly::Expected<folly::Unit, LocalErrorCode>(StreamId));
+  using ReadUnorderedResult = folly::
+      Expected<std::pair<std::vector<StreamBuffer>, bool>, LocalErrorCode>;
+  MOCK_METHOD2(readUnordered, ReadUnorderedResult(StreamId, size_t));
   MOCK_METHOD1(
       createBidirectionalStream,
       folly::Expected<StreamId, LocalErrorCode>(bool));
@@ -137,6 +152,7 @@ class MockQuicSocket : public QuicSocket {
   MOCK_METHOD2(
       notifyPendingWriteOnStream,
       folly::Expected<folly::Unit, LocalErrorCode>(StreamId, WriteCallback*));
+  MOCK_METHOD1(unregisterStreamWriteCallback, void(StreamId));
   folly::Expected<Buf, LocalErrorCode> writeChain(
       StreamId id,
       Buf data,
@@ -155,6 +171,18 @@ class MockQuicSocket : public QuicSocket {
   MOCK_METHOD5(
       writeChain,
       WriteResult(StreamId, SharedBuf, bool, bool, DeliveryCallback*));
+  folly::Expected<folly::Unit, LocalErrorCode> setStreamDataSource(
+      StreamId id,
+      std::unique_ptr<StreamDataSource> source,
+      DeliveryCallback* cb) override {
+    return setStreamDataSourceNaked(id, source.get(), cb);
+  }
+  MOCK_METHOD3(
+      setStreamDataSourceNaked,
+      folly::Expected<folly::Unit, LocalErrorCode>(
+          StreamId,
+          StreamDataSource*,
+          DeliveryCallback*));
   MOCK_METHOD3(
       registerDeliveryCallback,
       folly::Expected<folly::Unit, LocalErrorCode>(
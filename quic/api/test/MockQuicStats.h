@@ -29,6 +29,8 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD0(onForwardedPacketProcessed, void());
   MOCK_METHOD0(onNewConnection, void());
   MOCK_METHOD1(onConnectionClose, void(folly::Optional<ConnectionCloseReason>));
+  MOCK_METHOD0(onConnectionHibernated, void());
+  MOCK_METHOD0(onConnectionRehydrated, void());
   MOCK_METHOD0(onNewQuicStream, void());
   MOCK_METHOD0(onQuicStreamClosed, void());
   MOCK_METHOD0(onQuicStreamReset, void());
@@ -42,6 +44,7 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD1(onRead, void(size_t));
   MOCK_METHOD1(onWrite, void(size_t));
   MOCK_METHOD1(onUDPSocketWriteError, void(SocketErrorType));
+  MOCK_METHOD1(onKernelReceiveDrops, void(uint64_t));
 };
 
 class MockQuicStatsFactory : public QuicTransportStatsCallbackFactory {
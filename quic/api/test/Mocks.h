@@ -197,6 +197,13 @@ class MockQuicTransport : public QuicServerTransport {
 
   GMOCK_METHOD1_(, , , setTransportSettings, void(TransportSettings));
 
+  GMOCK_METHOD1_(
+      ,
+      ,
+      ,
+      setSharedTransportSettings,
+      void(std::shared_ptr<const TransportSettings>));
+
   GMOCK_METHOD1_(, noexcept, , setPacingTimer, void(TimerHighRes::SharedPtr));
 
   void onNetworkData(
@@ -843,6 +843,60 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobinControl) {
   EXPECT_EQ(conn.schedulingState.nextScheduledControlStream, stream2);
 }
 
+TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerControlStreamReserve) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.streamManager->setMaxLocalBidirectionalStreams(10);
+  conn.flowControlState.peerAdvertisedMaxOffset = 100;
+  conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote = 100000;
+  conn.transportSettings.mutate().controlStreamFlowControlReserve = 40;
+  StreamFrameScheduler scheduler(conn);
+  auto stream1 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  auto stream2 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  conn.streamManager->setStreamAsControl(
+      *conn.streamManager->findStream(stream2));
+  writeDataToQuicStream(
+      *conn.streamManager->findStream(stream1),
+      folly::IOBuf::copyBuffer(std::string(100, 'a')),
+      false);
+
+  MockQuicPacketBuilder builder1;
+  EXPECT_CALL(builder1, remainingSpaceInPkt()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(builder1, appendFrame(_)).WillRepeatedly(Invoke([&](auto f) {
+    builder1.frames_.push_back(f);
+  }));
+  scheduler.writeStreams(builder1);
+  ASSERT_EQ(builder1.frames_.size(), 1);
+  ASSERT_TRUE(builder1.frames_[0].asWriteStreamFrame());
+  EXPECT_EQ(
+      *builder1.frames_[0].asWriteStreamFrame(),
+      WriteStreamFrame(stream1, 0, 60, false));
+
+  // Once that is sent only the reservation is left, which only the control
+  // stream may use.
+  conn.flowControlState.sumCurWriteOffset = 60;
+  EXPECT_TRUE(conn.streamManager->hasWritable());
+  EXPECT_FALSE(scheduler.hasPendingData());
+  writeDataToQuicStream(
+      *conn.streamManager->findStream(stream2),
+      folly::IOBuf::copyBuffer("some data"),
+      false);
+  EXPECT_TRUE(scheduler.hasPendingData());
+  MockQuicPacketBuilder builder2;
+  EXPECT_CALL(builder2, remainingSpaceInPkt()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(builder2, appendFrame(_)).WillRepeatedly(Invoke([&](auto f) {
+    builder2.frames_.push_back(f);
+  }));
+  scheduler.writeStreams(builder2);
+  ASSERT_EQ(builder2.frames_.size(), 1);
+  ASSERT_TRUE(builder2.frames_[0].asWriteStreamFrame());
+  EXPECT_EQ(
+      *builder2.frames_[0].asWriteStreamFrame(),
+      WriteStreamFrame(stream2, 0, 9, false));
+}
+
 TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerOneStream) {
   QuicClientConnectionState conn(
       FizzClientQuicHandshakeContext::Builder().build());
@@ -865,6 +919,86 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerOneStream) {
   EXPECT_EQ(conn.schedulingState.nextScheduledStream, 0);
 }
 
+TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerPullsFromDataSource) {
+  class StringDataSource : public StreamDataSource {
+   public:
+    explicit StringDataSource(std::string data) : data_(std::move(data)) {}
+
+    uint64_t length() const override {
+      return data_.size();
+    }
+
+    Buf read(uint64_t offset, uint64_t len) override {
+      return folly::IOBuf::copyBuffer(data_.data() + offset, len);
+    }
+
+   private:
+    std::string data_;
+  };
+
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.streamManager->setMaxLocalBidirectionalStreams(10);
+  conn.flowControlState.peerAdvertisedMaxOffset = 100000;
+  conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote = 100000;
+  auto connId = getTestConnectionId();
+  StreamFrameScheduler scheduler(conn);
+  ShortHeader shortHeader(
+      ProtectionType::KeyPhaseZero,
+      connId,
+      getNextPacketNum(conn, PacketNumberSpace::AppData));
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen,
+      std::move(shortHeader),
+      conn.ackStates.appDataAckState.largestAckedByPeer);
+  auto stream1 = conn.streamManager->createNextBidirectionalStream().value();
+  stream1->dataSource =
+      std::make_unique<StringDataSource>(std::string(5000, 'a'));
+  conn.streamManager->updateWritableStreams(*stream1);
+  scheduler.writeStreams(builder);
+
+  auto packet = std::move(builder).buildPacket().packet;
+  ASSERT_EQ(packet.frames.size(), 1);
+  auto frame = packet.frames[0].asWriteStreamFrame();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_FALSE(frame->fin);
+  // No more than a packet's worth of the source is read.
+  EXPECT_LE(stream1->dataSourceOffset, conn.udpSendPacketLen);
+  EXPECT_GE(stream1->dataSourceOffset, frame->len);
+  EXPECT_EQ(stream1->writeBuffer.chainLength(), stream1->dataSourceOffset);
+  EXPECT_TRUE(stream1->hasDataSourceData());
+}
+
+TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerFecStreamFrameLen) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.streamManager->setMaxLocalBidirectionalStreams(10);
+  conn.flowControlState.peerAdvertisedMaxOffset = 100000;
+  conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote = 100000;
+  auto connId = getTestConnectionId();
+  StreamFrameScheduler scheduler(conn);
+  ShortHeader shortHeader(
+      ProtectionType::KeyPhaseZero,
+      connId,
+      getNextPacketNum(conn, PacketNumberSpace::AppData));
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen,
+      std::move(shortHeader),
+      conn.ackStates.appDataAckState.largestAckedByPeer);
+  auto stream1 = conn.streamManager->createNextBidirectionalStream().value();
+  stream1->fecEncoder = std::make_unique<StreamFecEncoder>(stream1->id, 100);
+  writeDataToQuicStream(
+      *stream1, folly::IOBuf::copyBuffer(std::string(5000, 'a')), false);
+  scheduler.writeStreams(builder);
+
+  // Only a symbol's worth goes in a packet, so losing it is repairable.
+  auto packet = std::move(builder).buildPacket().packet;
+  ASSERT_EQ(packet.frames.size(), 1);
+  auto frame = packet.frames[0].asWriteStreamFrame();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->len, 100);
+}
+
 TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRemoveOne) {
   QuicClientConnectionState conn(
       FizzClientQuicHandshakeContext::Builder().build());
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/api/QuicStreamFutures.h>
+
+#include <folly/io/async/EventBase.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <quic/api/test/MockQuicSocket.h>
+#include <quic/api/test/Mocks.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+std::pair<folly::IOBuf*, bool> readResult(const std::string& str, bool eof) {
+  if (str.empty()) {
+    return std::pair<folly::IOBuf*, bool>(nullptr, eof);
+  }
+  return std::pair<folly::IOBuf*, bool>(
+      folly::IOBuf::copyBuffer(str).release(), eof);
+}
+
+class QuicStreamFuturesTest : public Test {
+ public:
+  void SetUp() override {
+    sock_ = std::make_shared<MockQuicSocket>(&evb_, connCb_);
+    futures_ = std::make_unique<QuicStreamFutures>(sock_);
+  }
+
+ protected:
+  folly::EventBase evb_;
+  MockConnectionCallback connCb_;
+  std::shared_ptr<MockQuicSocket> sock_;
+  std::unique_ptr<QuicStreamFutures> futures_;
+  StreamId id_{4};
+};
+
+TEST_F(QuicStreamFuturesTest, ReadImmediate) {
+  EXPECT_CALL(*sock_, readNaked(id_, 10))
+      .WillOnce(Return(readResult("hello", true)));
+  EXPECT_CALL(*sock_, setReadCallback(_, _)).Times(0);
+  auto future = futures_->read(id_, 10);
+  ASSERT_TRUE(future.isReady());
+  auto result = std::move(future).get();
+  EXPECT_EQ(result.first->moveToFbString().toStdString(), "hello");
+  EXPECT_TRUE(result.second);
+}
+
+TEST_F(QuicStreamFuturesTest, ReadWaitsForData) {
+  QuicSocket::ReadCallback* readCb = nullptr;
+  EXPECT_CALL(*sock_, readNaked(id_, 0))
+      .WillOnce(Return(readResult("", false)));
+  EXPECT_CALL(*sock_, setReadCallback(id_, _))
+      .WillOnce(DoAll(SaveArg<1>(&readCb), Return(folly::unit)));
+  auto future = futures_->read(id_, 0);
+  EXPECT_FALSE(future.isReady());
+  ASSERT_NE(readCb, nullptr);
+
+  EXPECT_CALL(*sock_, readNaked(id_, 0))
+      .WillOnce(Return(readResult("hello", false)));
+  EXPECT_CALL(*sock_, pauseRead(id_)).WillOnce(Return(folly::unit));
+  readCb->readAvailable(id_);
+  ASSERT_TRUE(future.isReady());
+  auto result = std::move(future).get();
+  EXPECT_EQ(result.first->moveToFbString().toStdString(), "hello");
+  EXPECT_FALSE(result.second);
+
+  // Reading again resumes the paused stream instead of reinstalling the
+  // callback.
+  EXPECT_CALL(*sock_, readNaked(id_, 0))
+      .WillOnce(Return(readResult("", false)));
+  EXPECT_CALL(*sock_, resumeRead(id_)).WillOnce(Return(folly::unit));
+  auto future2 = futures_->read(id_, 0);
+  EXPECT_FALSE(future2.isReady());
+
+  readCb->readError(
+      id_, std::make_pair(LocalErrorCode::CONNECTION_RESET, folly::none));
+  ASSERT_TRUE(future2.isReady());
+  EXPECT_THROW(std::move(future2).get(), QuicInternalException);
+
+  EXPECT_CALL(*sock_, setReadCallback(id_, nullptr))
+      .WillOnce(Return(folly::unit));
+  futures_->releaseStream(id_);
+}
+
+TEST_F(QuicStreamFuturesTest, OnlyOneReadPerStream) {
+  EXPECT_CALL(*sock_, readNaked(id_, 0))
+      .WillOnce(Return(readResult("", false)));
+  EXPECT_CALL(*sock_, setReadCallback(id_, _)).WillOnce(Return(folly::unit));
+  auto future = futures_->read(id_, 0);
+  auto future2 = futures_->read(id_, 0);
+  ASSERT_TRUE(future2.isReady());
+  EXPECT_THROW(std::move(future2).get(), QuicInternalException);
+
+  EXPECT_CALL(*sock_, setReadCallback(id_, nullptr))
+      .WillOnce(Return(folly::unit));
+  futures_.reset();
+  ASSERT_TRUE(future.isReady());
+  EXPECT_THROW(std::move(future).get(), QuicInternalException);
+}
+
+TEST_F(QuicStreamFuturesTest, WriteFollowsFlowControl) {
+  QuicSocket::WriteCallback* writeCb = nullptr;
+  EXPECT_CALL(*sock_, notifyPendingWriteOnStream(id_, _))
+      .WillOnce(DoAll(SaveArg<1>(&writeCb), Return(folly::unit)));
+  auto future = futures_->write(id_, folly::IOBuf::copyBuffer("hello"), true);
+  EXPECT_FALSE(future.isReady());
+  ASSERT_NE(writeCb, nullptr);
+
+  EXPECT_CALL(*sock_, writeChain(id_, _, false, false, nullptr))
+      .WillOnce(Invoke([](StreamId,
+                          MockQuicSocket::SharedBuf buf,
+                          bool,
+                          bool,
+                          MockQuicSocket::DeliveryCallback*) {
+        EXPECT_EQ(buf->computeChainDataLength(), 3);
+        return MockQuicSocket::WriteResult(nullptr);
+      }));
+  EXPECT_CALL(*sock_, notifyPendingWriteOnStream(id_, writeCb))
+      .WillOnce(Return(folly::unit));
+  writeCb->onStreamWriteReady(id_, 3);
+  EXPECT_FALSE(future.isReady());
+
+  EXPECT_CALL(*sock_, writeChain(id_, _, true, false, nullptr))
+      .WillOnce(Invoke([](StreamId,
+                          MockQuicSocket::SharedBuf buf,
+                          bool,
+                          bool,
+                          MockQuicSocket::DeliveryCallback*) {
+        EXPECT_EQ(buf->computeChainDataLength(), 2);
+        return MockQuicSocket::WriteResult(nullptr);
+      }));
+  writeCb->onStreamWriteReady(id_, 100);
+  ASSERT_TRUE(future.isReady());
+  EXPECT_NO_THROW(std::move(future).get());
+}
+
+TEST_F(QuicStreamFuturesTest, WriteError) {
+  QuicSocket::WriteCallback* writeCb = nullptr;
+  EXPECT_CALL(*sock_, notifyPendingWriteOnStream(id_, _))
+      .WillOnce(DoAll(SaveArg<1>(&writeCb), Return(folly::unit)));
+  auto future = futures_->write(id_, folly::IOBuf::copyBuffer("hello"), false);
+  ASSERT_NE(writeCb, nullptr);
+  writeCb->onStreamWriteError(
+      id_,
+      std::make_pair(TransportErrorCode::FLOW_CONTROL_ERROR, folly::none));
+  ASSERT_TRUE(future.isReady());
+  EXPECT_THROW(std::move(future).get(), QuicTransportException);
+}
+
+TEST_F(QuicStreamFuturesTest, AwaitDelivery) {
+  QuicSocket::DeliveryCallback* deliveryCb = nullptr;
+  EXPECT_CALL(*sock_, registerDeliveryCallback(id_, _, _))
+      .Times(2)
+      .WillRepeatedly(DoAll(SaveArg<2>(&deliveryCb), Return(folly::unit)));
+  auto future = futures_->awaitDelivery(id_, 10);
+  auto future2 = futures_->awaitDelivery(id_, 20);
+  ASSERT_NE(deliveryCb, nullptr);
+
+  deliveryCb->onDeliveryAck(id_, 10, std::chrono::microseconds(100));
+  ASSERT_TRUE(future.isReady());
+  EXPECT_NO_THROW(std::move(future).get());
+  EXPECT_FALSE(future2.isReady());
+
+  deliveryCb->onCanceled(id_, 20);
+  ASSERT_TRUE(future2.isReady());
+  EXPECT_THROW(std::move(future2).get(), QuicInternalException);
+
+  EXPECT_CALL(*sock_, registerDeliveryCallback(id_, 30, _))
+      .WillOnce(Return(folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED)));
+  auto future3 = futures_->awaitDelivery(id_, 30);
+  ASSERT_TRUE(future3.isReady());
+  EXPECT_THROW(std::move(future3).get(), QuicInternalException);
+}
+
+TEST_F(QuicStreamFuturesTest, ReleaseRemovesSocketCallbacks) {
+  EXPECT_CALL(*sock_, notifyPendingWriteOnStream(id_, _))
+      .WillOnce(Return(folly::unit));
+  auto writeFuture =
+      futures_->write(id_, folly::IOBuf::copyBuffer("hello"), false);
+  EXPECT_CALL(*sock_, registerDeliveryCallback(id_, 5, _))
+      .WillOnce(Return(folly::unit));
+  auto deliveryFuture = futures_->awaitDelivery(id_, 5);
+
+  EXPECT_CALL(*sock_, setReadCallback(_, _)).Times(0);
+  EXPECT_CALL(*sock_, unregisterStreamWriteCallback(id_));
+  EXPECT_CALL(*sock_, cancelDeliveryCallbacksForStream(id_));
+  futures_->releaseStream(id_);
+  ASSERT_TRUE(writeFuture.isReady());
+  EXPECT_THROW(std::move(writeFuture).get(), QuicInternalException);
+  ASSERT_TRUE(deliveryFuture.isReady());
+  EXPECT_THROW(std::move(deliveryFuture).get(), QuicInternalException);
+}
+
+TEST_F(QuicStreamFuturesTest, DestructionRemovesSocketCallbacks) {
+  EXPECT_CALL(*sock_, readNaked(id_, 0))
+      .WillOnce(Return(readResult("", false)));
+  EXPECT_CALL(*sock_, setReadCallback(id_, _)).WillOnce(Return(folly::unit));
+  auto readFuture = futures_->read(id_, 0);
+  EXPECT_CALL(*sock_, notifyPendingWriteOnStream(id_, _))
+      .WillOnce(Return(folly::unit));
+  auto writeFuture =
+      futures_->write(id_, folly::IOBuf::copyBuffer("hello"), false);
+
+  EXPECT_CALL(*sock_, setReadCallback(id_, nullptr))
+      .WillOnce(Return(folly::unit));
+  EXPECT_CALL(*sock_, unregisterStreamWriteCallback(id_));
+  EXPECT_CALL(*sock_, cancelDeliveryCallbacksForStream(_)).Times(0);
+  futures_.reset();
+  ASSERT_TRUE(readFuture.isReady());
+  EXPECT_THROW(std::move(readFuture).get(), QuicInternalException);
+  ASSERT_TRUE(writeFuture.isReady());
+  EXPECT_THROW(std::move(writeFuture).get(), QuicInternalException);
+}
+
+TEST_F(QuicStreamFuturesTest, FailedCallsDoNotTrackStream) {
+  EXPECT_CALL(*sock_, readNaked(id_, 0))
+      .WillOnce(Return(readResult("", false)));
+  EXPECT_CALL(*sock_, setReadCallback(id_, _))
+      .WillOnce(Return(folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED)));
+  auto readFuture = futures_->read(id_, 0);
+  ASSERT_TRUE(readFuture.isReady());
+  EXPECT_THROW(std::move(readFuture).get(), QuicInternalException);
+
+  EXPECT_CALL(*sock_, notifyPendingWriteOnStream(id_, _))
+      .WillOnce(Return(folly::makeUnexpected(LocalErrorCode::STREAM_CLOSED)));
+  auto writeFuture =
+      futures_->write(id_, folly::IOBuf::copyBuffer("hello"), false);
+  ASSERT_TRUE(writeFuture.isReady());
+  EXPECT_THROW(std::move(writeFuture).get(), QuicInternalException);
+
+  // Nothing was installed on the socket, so there is nothing to remove.
+  EXPECT_CALL(*sock_, setReadCallback(_, _)).Times(0);
+  EXPECT_CALL(*sock_, unregisterStreamWriteCallback(_)).Times(0);
+  EXPECT_CALL(*sock_, cancelDeliveryCallbacksForStream(_)).Times(0);
+  futures_.reset();
+}
+
+} // namespace test
+} // namespace quic
@@ -210,7 +210,7 @@ class TestQuicTransport
         *aead,
         *headerCipher,
         *conn_->version,
-        conn_->transportSettings.writeConnectionDataPacketsLimit);
+        conn_->transportSettings->writeConnectionDataPacketsLimit);
   }
 
   bool hasWriteCipher() const {
@@ -419,6 +419,71 @@ TEST_F(QuicTransportImplTest, IdleTimeoutExpiredDestroysTransport) {
   transport->invokeIdleTimeout();
 }
 
+TEST_F(QuicTransportImplTest, HibernateCompactsQuiescentConnection) {
+  transport->transportConn->transportSettings.mutate().hibernationIdleTimeout =
+      1s;
+  // The connection has to stay quiescent from one check to the next.
+  EXPECT_FALSE(transport->maybeHibernate());
+  EXPECT_FALSE(transport->transportConn->hibernated);
+  EXPECT_TRUE(transport->maybeHibernate());
+  EXPECT_TRUE(transport->transportConn->hibernated);
+  EXPECT_FALSE(transport->maybeHibernate());
+
+  // The next packet wakes the connection back up.
+  auto stream = transport->createBidirectionalStream().value();
+  transport->addDataToStream(
+      stream, StreamBuffer(folly::IOBuf::copyBuffer("hello"), 0));
+  EXPECT_FALSE(transport->transportConn->hibernated);
+  transport->close(folly::none);
+}
+
+TEST_F(QuicTransportImplTest, HibernationEndsOnApplicationWrite) {
+  transport->transportConn->transportSettings.mutate().hibernationIdleTimeout =
+      1s;
+  auto stream = transport->createBidirectionalStream().value();
+  transport->maybeHibernate();
+  EXPECT_TRUE(transport->maybeHibernate());
+  EXPECT_TRUE(transport->transportConn->hibernated);
+
+  transport->writeChain(
+      stream, folly::IOBuf::copyBuffer("hello"), false, false);
+  EXPECT_FALSE(transport->transportConn->hibernated);
+  transport->close(folly::none);
+}
+
+TEST_F(QuicTransportImplTest, HibernationWaitsForOutstandingData) {
+  transport->transportConn->transportSettings.mutate().hibernationIdleTimeout =
+      1s;
+  auto stream = transport->createBidirectionalStream().value();
+  transport->transportConn->streamManager->addLoss(stream);
+
+  EXPECT_FALSE(transport->maybeHibernate());
+  EXPECT_FALSE(transport->maybeHibernate());
+  EXPECT_FALSE(transport->transportConn->hibernated);
+  transport->close(folly::none);
+}
+
+TEST_F(QuicTransportImplTest, HibernationWaitsForQuietInterval) {
+  transport->transportConn->transportSettings.mutate().hibernationIdleTimeout =
+      1s;
+  auto stream = transport->createBidirectionalStream().value();
+  EXPECT_FALSE(transport->maybeHibernate());
+
+  // A packet between the checks starts the interval over.
+  transport->addDataToStream(
+      stream, StreamBuffer(folly::IOBuf::copyBuffer("hello"), 0));
+  EXPECT_FALSE(transport->maybeHibernate());
+  EXPECT_TRUE(transport->maybeHibernate());
+  transport->close(folly::none);
+}
+
+TEST_F(QuicTransportImplTest, HibernationDisabledByDefault) {
+  EXPECT_FALSE(transport->maybeHibernate());
+  EXPECT_FALSE(transport->maybeHibernate());
+  EXPECT_FALSE(transport->transportConn->hibernated);
+  transport->close(folly::none);
+}
+
 TEST_F(QuicTransportImplTest, WriteAckPacketUnsetsLooper) {
   // start looper in running state first
   transport->writeLooper()->run(true);
@@ -649,6 +714,41 @@ TEST_F(QuicTransportImplTest, ReadData) {
   transport.reset();
 }
 
+TEST_F(QuicTransportImplTest, ReadDataUnordered) {
+  auto stream1 = transport->createBidirectionalStream().value();
+
+  MockReadCallback readCb1;
+  transport->setReadCallback(stream1, &readCb1);
+  EXPECT_EQ(
+      transport->readUnordered(stream1, 0).error(),
+      LocalErrorCode::INVALID_OPERATION);
+
+  // Data past a gap is not readable until the stream is unordered.
+  transport->addDataToStream(
+      stream1, StreamBuffer(folly::IOBuf::copyBuffer("stream data"), 7));
+  EXPECT_CALL(readCb1, readAvailable(stream1)).Times(0);
+  transport->driveReadCallbacks();
+
+  EXPECT_TRUE(transport->setStreamUnorderedRead(stream1).hasValue());
+  EXPECT_EQ(
+      transport->read(stream1, 0).error(), LocalErrorCode::INVALID_OPERATION);
+  EXPECT_CALL(readCb1, readAvailable(stream1));
+  transport->driveReadCallbacks();
+
+  auto result = transport->readUnordered(stream1, 0);
+  ASSERT_TRUE(result.hasValue());
+  ASSERT_EQ(result->first.size(), 1);
+  EXPECT_EQ(result->first[0].offset, 7);
+  IOBufEqualTo eq;
+  EXPECT_TRUE(eq(
+      *result->first[0].data.move(), *folly::IOBuf::copyBuffer("stream data")));
+  EXPECT_FALSE(result->second);
+
+  EXPECT_CALL(readCb1, readAvailable(stream1)).Times(0);
+  transport->driveReadCallbacks();
+  transport.reset();
+}
+
 // TODO The finest copypasta around. We need a better story for parameterizing
 // unidirectional vs. bidirectional.
 TEST_F(QuicTransportImplTest, UnidirectionalReadData) {
@@ -1274,6 +1374,82 @@ TEST_F(QuicTransportImplTest, TestNotifyPendingWriteWithActiveCallback) {
   evb->loopOnce();
 }
 
+TEST_F(QuicTransportImplTest, TestNotifyPendingWriteReservedFlowControl) {
+  auto& conn = *transport->transportConn;
+  conn.transportSettings.mutate().controlStreamFlowControlReserve = 100;
+  conn.flowControlState.peerAdvertisedMaxOffset = 1000;
+  auto stream = transport->createBidirectionalStream().value();
+  auto ctrlStream = transport->createBidirectionalStream().value();
+  transport->setControlStream(ctrlStream);
+
+  // Only the control stream may write into the reservation.
+  MockWriteCallback wcb;
+  MockWriteCallback ctrlWcb;
+  MockWriteCallback connWcb;
+  EXPECT_CALL(wcb, onStreamWriteReady(stream, 900));
+  EXPECT_CALL(ctrlWcb, onStreamWriteReady(ctrlStream, 1000));
+  EXPECT_CALL(connWcb, onConnectionWriteReady(900));
+  transport->notifyPendingWriteOnStream(stream, &wcb);
+  transport->notifyPendingWriteOnStream(ctrlStream, &ctrlWcb);
+  transport->notifyPendingWriteOnConnection(&connWcb);
+  evb->loopOnce();
+  transport->close(folly::none);
+}
+
+TEST_F(QuicTransportImplTest, TestNotifyPendingWriteSendBufferLimits) {
+  auto stream = transport->createBidirectionalStream().value();
+  auto streamState = transport->transportConn->streamManager->getStream(stream);
+  transport->setSendBuffer(stream, 100, 100);
+  // Less than the low watermark is available, so the writer is not woken up.
+  streamState->writeBuffer.append(IOBuf::copyBuffer(std::string(90, 'a')));
+  MockWriteCallback wcb;
+  EXPECT_CALL(wcb, onStreamWriteReady(_, _)).Times(0);
+  transport->notifyPendingWriteOnStream(stream, &wcb);
+  evb->loopOnce();
+  Mock::VerifyAndClearExpectations(&wcb);
+
+  auto stream2 = transport->createBidirectionalStream().value();
+  auto streamState2 =
+      transport->transportConn->streamManager->getStream(stream2);
+  transport->setSendBuffer(stream2, 100, 100);
+  streamState2->writeBuffer.append(IOBuf::copyBuffer(std::string(70, 'a')));
+  MockWriteCallback wcb2;
+  EXPECT_CALL(wcb2, onStreamWriteReady(stream2, 30));
+  transport->notifyPendingWriteOnStream(stream2, &wcb2);
+  evb->loopOnce();
+  Mock::VerifyAndClearExpectations(&wcb2);
+
+  EXPECT_CALL(wcb, onStreamWriteError(stream, _));
+  transport->close(folly::none);
+  evb->loopOnce();
+}
+
+TEST_F(QuicTransportImplTest, WriteChainReturnsDataPastSendBuffer) {
+  auto stream = transport->createBidirectionalStream().value();
+  auto streamState = transport->transportConn->streamManager->getStream(stream);
+  transport->setSendBuffer(stream, 100, 100);
+  MockDeliveryCallback dcb;
+  auto result = transport->writeChain(
+      stream, IOBuf::copyBuffer(std::string(150, 'a')), true, false, &dcb);
+  ASSERT_TRUE(result.hasValue());
+  ASSERT_NE(nullptr, result.value());
+  EXPECT_EQ(50, result.value()->computeChainDataLength());
+  EXPECT_EQ(100, streamState->writeBuffer.chainLength());
+  // The EOF and the callback come with the rest of the data, so closing
+  // cancels no callback.
+  EXPECT_FALSE(streamState->finalWriteOffset.hasValue());
+
+  result = transport->writeChain(
+      stream, IOBuf::copyBuffer("a"), true, false, &dcb);
+  ASSERT_TRUE(result.hasValue());
+  ASSERT_NE(nullptr, result.value());
+  EXPECT_EQ(1, result.value()->computeChainDataLength());
+  EXPECT_EQ(100, streamState->writeBuffer.chainLength());
+
+  EXPECT_CALL(dcb, onCanceled(_, _)).Times(0);
+  transport->close(folly::none);
+}
+
 TEST_F(QuicTransportImplTest, TestNotifyPendingWriteOnCloseWithoutError) {
   auto stream = transport->createBidirectionalStream().value();
   MockWriteCallback wcb;
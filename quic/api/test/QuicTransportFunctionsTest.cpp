@@ -1002,7 +1002,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketWithCC) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
 }
 
 TEST_F(QuicTransportFunctionsTest, WriteQuicdataToSocketWithPacer) {
@@ -1030,7 +1030,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicdataToSocketWithPacer) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
 }
 
 TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketLimitTest) {
@@ -1054,7 +1054,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketLimitTest) {
           InvokeWithoutArgs([&writableBytes]() { return writableBytes; }));
 
   // Limit to zero
-  conn->transportSettings.writeConnectionDataPacketsLimit = 0;
+  conn->transportSettings.mutate().writeConnectionDataPacketsLimit = 0;
   EXPECT_CALL(*rawSocket, write(_, _)).Times(0);
   EXPECT_CALL(*rawCongestionController, onPacketSent(_)).Times(0);
   EXPECT_CALL(*transportInfoCb_, onWrite(_)).Times(0);
@@ -1068,11 +1068,11 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketLimitTest) {
           *aead,
           *headerCipher,
           getVersion(*conn),
-          conn->transportSettings.writeConnectionDataPacketsLimit));
+          conn->transportSettings->writeConnectionDataPacketsLimit));
 
   // Normal limit
   conn->pendingEvents.numProbePackets = 0;
-  conn->transportSettings.writeConnectionDataPacketsLimit =
+  conn->transportSettings.mutate().writeConnectionDataPacketsLimit =
       kDefaultWriteConnectionDataPacketLimit;
   EXPECT_CALL(*rawSocket, write(_, _))
       .Times(1)
@@ -1093,7 +1093,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketLimitTest) {
           *aead,
           *headerCipher,
           getVersion(*conn),
-          conn->transportSettings.writeConnectionDataPacketsLimit));
+          conn->transportSettings->writeConnectionDataPacketsLimit));
 
   // Probing can be limited by packet limit too
   conn->pendingEvents.numProbePackets =
@@ -1123,7 +1123,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketLimitTest) {
           *aead,
           *headerCipher,
           getVersion(*conn),
-          conn->transportSettings.writeConnectionDataPacketsLimit));
+          conn->transportSettings->writeConnectionDataPacketsLimit));
 }
 
 TEST_F(
@@ -1168,7 +1168,7 @@ TEST_F(
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
 }
 
@@ -1197,7 +1197,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketWithNoBytesForHeader) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   // No header space left. Should send nothing.
   EXPECT_TRUE(conn->outstandingPackets.empty());
 }
@@ -1217,7 +1217,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketRetxBufferSorted) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, stream->retransmissionBuffer.size());
 
   auto buf2 = IOBuf::copyBuffer("Google Buzz");
@@ -1230,7 +1230,7 @@ TEST_F(QuicTransportFunctionsTest, WriteQuicDataToSocketRetxBufferSorted) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(2, stream->retransmissionBuffer.size());
 }
 
@@ -1263,7 +1263,7 @@ TEST_F(QuicTransportFunctionsTest, NothingWritten) {
           *aead,
           *headerCipher,
           getVersion(*conn),
-          conn->transportSettings.writeConnectionDataPacketsLimit),
+          conn->transportSettings->writeConnectionDataPacketsLimit),
       0);
 }
 
@@ -1311,7 +1311,7 @@ TEST_F(QuicTransportFunctionsTest, WriteBlockedFrameWhenBlocked) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_LT(sentBytes, 200);
 
   EXPECT_GT(conn->ackStates.appDataAckState.nextPacketNum, originalNextSeq);
@@ -1333,7 +1333,7 @@ TEST_F(QuicTransportFunctionsTest, WriteBlockedFrameWhenBlocked) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(previousPackets, conn->outstandingPackets.size());
 }
 
@@ -1562,7 +1562,7 @@ TEST_F(QuicTransportFunctionsTest, TestCryptoWritingIsHandshakeInOutstanding) {
           *conn->initialWriteCipher,
           *conn->initialHeaderCipher,
           getVersion(*conn),
-          conn->transportSettings.writeConnectionDataPacketsLimit));
+          conn->transportSettings->writeConnectionDataPacketsLimit));
   ASSERT_EQ(1, conn->outstandingPackets.size());
   EXPECT_TRUE(getFirstOutstandingPacket(*conn, PacketNumberSpace::Initial)
                   ->isHandshake);
@@ -1605,7 +1605,7 @@ TEST_F(QuicTransportFunctionsTest, WritePureAckWhenNoWritableBytes) {
           *aead,
           *headerCipher,
           getVersion(*conn),
-          conn->transportSettings.writeConnectionDataPacketsLimit),
+          conn->transportSettings->writeConnectionDataPacketsLimit),
       0);
   EXPECT_EQ(0, conn->outstandingPackets.size());
 }
@@ -1646,7 +1646,7 @@ TEST_F(QuicTransportFunctionsTest, ShouldWriteDataTest) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
 
   // Congestion control
@@ -1665,7 +1665,7 @@ TEST_F(QuicTransportFunctionsTest, ShouldWriteDataTest) {
       *aead,
       *headerCipher,
       getVersion(*conn),
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
 }
 
@@ -95,7 +95,7 @@ class TestQuicTransport
         getVersion(),
         (isConnectionPaced(*conn_)
              ? conn_->pacer->updateAndGetWriteBatchSize(Clock::now())
-             : conn_->transportSettings.writeConnectionDataPacketsLimit));
+             : conn_->transportSettings->writeConnectionDataPacketsLimit));
   }
 
   void closeTransport() override {
@@ -456,6 +456,57 @@ TEST_F(QuicTransportTest, AppLimited) {
   transport_->close(folly::none);
 }
 
+TEST_F(QuicTransportTest, StreamMaxSendRate) {
+  auto& conn = transport_->getConnectionState();
+  EXPECT_CALL(*socket_, write(_, _)).WillRepeatedly(Invoke(bufLength));
+  EXPECT_EQ(
+      transport_->setStreamMaxSendRate(101, 1000).error(),
+      LocalErrorCode::STREAM_NOT_EXISTS);
+  auto cappedStream = transport_->createBidirectionalStream().value();
+  auto stream = transport_->createBidirectionalStream().value();
+  ASSERT_FALSE(transport_->setStreamMaxSendRate(cappedStream, 1000).hasError());
+  auto buf = buildRandomInputData(20 * 1000);
+  transport_->writeChain(cappedStream, buf->clone(), false, false);
+  transport_->writeChain(stream, buf->clone(), false, false);
+  loopForWrites();
+
+  // The capped stream sends a burst, then waits for its credit to refill
+  // without holding back the other stream.
+  auto capped = conn.streamManager->findStream(cappedStream);
+  EXPECT_GT(capped->currentWriteOffset, 0);
+  EXPECT_LT(capped->currentWriteOffset, 2 * kDefaultUDPSendPacketLen);
+  EXPECT_EQ(conn.streamManager->rateLimitedStreams().count(cappedStream), 1);
+  EXPECT_FALSE(conn.streamManager->writableContains(cappedStream));
+  EXPECT_GT(
+      conn.streamManager->findStream(stream)->currentWriteOffset,
+      capped->currentWriteOffset);
+
+  ASSERT_FALSE(transport_->setStreamMaxSendRate(cappedStream, 0).hasError());
+  EXPECT_FALSE(conn.streamManager->hasRateLimited());
+  EXPECT_TRUE(conn.streamManager->writableContains(cappedStream));
+  transport_->close(folly::none);
+}
+
+TEST_F(QuicTransportTest, ConnectionMaxSendRate) {
+  auto& conn = transport_->getConnectionState();
+  EXPECT_CALL(*socket_, write(_, _)).WillRepeatedly(Invoke(bufLength));
+  ASSERT_FALSE(transport_->setConnectionMaxSendRate(1000).hasError());
+  auto stream = transport_->createBidirectionalStream().value();
+  auto buf = buildRandomInputData(20 * 1000);
+  transport_->writeChain(stream, buf->clone(), false, false);
+  loopForWrites();
+
+  auto streamState = conn.streamManager->findStream(stream);
+  EXPECT_GT(streamState->currentWriteOffset, 0);
+  EXPECT_LT(streamState->currentWriteOffset, 2 * kDefaultUDPSendPacketLen);
+  EXPECT_TRUE(conn.streamManager->writableContains(stream));
+  EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(conn));
+
+  ASSERT_FALSE(transport_->setConnectionMaxSendRate(0).hasError());
+  EXPECT_EQ(WriteDataReason::STREAM, shouldWriteData(conn));
+  transport_->close(folly::none);
+}
+
 TEST_F(QuicTransportTest, WriteSmall) {
   // Testing writing a small buffer that could be fit in a single packet
   auto stream = transport_->createBidirectionalStream().value();
@@ -478,7 +529,7 @@ TEST_F(QuicTransportTest, WriteSmall) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
 
   verifyCorrectness(conn, 0, stream, *buf);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(conn));
@@ -513,7 +564,7 @@ TEST_F(QuicTransportTest, WriteLarge) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(NumFullPackets + 1, conn.outstandingPackets.size());
   verifyCorrectness(conn, 0, stream, *buf);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(conn));
@@ -569,7 +620,7 @@ TEST_F(QuicTransportTest, WriteMultipleStreams) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   verifyCorrectness(conn, 0, s1, *buf);
   verifyCorrectness(conn, 0, s2, *buf2);
 }
@@ -625,7 +676,7 @@ TEST_F(QuicTransportTest, WriteFlowControl) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   verifyCorrectness(conn, 100, streamId, *buf1, false, false);
 
   // Connection flow controled
@@ -640,7 +691,7 @@ TEST_F(QuicTransportTest, WriteFlowControl) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   auto buf2 = buf->clone();
   buf2->trimEnd(30);
   verifyCorrectness(conn, 100, streamId, *buf2, false, false);
@@ -656,7 +707,7 @@ TEST_F(QuicTransportTest, WriteFlowControl) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   verifyCorrectness(conn, 100, streamId, *buf, false, false);
 }
 
@@ -708,7 +759,7 @@ TEST_F(QuicTransportTest, WriteFin) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   verifyCorrectness(conn, 0, stream, *buf, true);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(conn));
 }
@@ -736,7 +787,7 @@ TEST_F(QuicTransportTest, WriteOnlyFin) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   verifyCorrectness(conn, 0, stream, *buf, true);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(conn));
 }
@@ -777,7 +828,7 @@ TEST_F(QuicTransportTest, WriteImmediateAcks) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_TRUE(conn.outstandingPackets.empty());
   EXPECT_EQ(conn.ackStates.appDataAckState.largestAckScheduled, end);
   EXPECT_FALSE(conn.ackStates.appDataAckState.needsToSendAckImmediately);
@@ -802,7 +853,7 @@ TEST_F(QuicTransportTest, NotWriteAcksIfNoData) {
           *aead_,
           *headerCipher_,
           transport_->getVersion(),
-          conn.transportSettings.writeConnectionDataPacketsLimit));
+          conn.transportSettings->writeConnectionDataPacketsLimit));
 }
 
 TEST_F(QuicTransportTest, WritePendingAckIfHavingData) {
@@ -1312,7 +1363,7 @@ TEST_F(QuicTransportTest, CloneNewConnectionIdFrame) {
 
 TEST_F(QuicTransportTest, BusyWriteLoopDetection) {
   auto& conn = transport_->getConnectionState();
-  conn.transportSettings.writeConnectionDataPacketsLimit = 1;
+  conn.transportSettings.mutate().writeConnectionDataPacketsLimit = 1;
   auto mockLoopDetectorCallback = std::make_unique<MockLoopDetectorCallback>();
   auto rawLoopDetectorCallback = mockLoopDetectorCallback.get();
   conn.loopDetectorCallback = std::move(mockLoopDetectorCallback);
@@ -1682,7 +1733,7 @@ TEST_F(QuicTransportTest, WriteAckNotSetLossAlarm) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, res); // Write one packet out
   EXPECT_FALSE(transport_->isLossTimeoutScheduled()); // no alarm scheduled
 }
@@ -1701,7 +1752,7 @@ TEST_F(QuicTransportTest, WriteWindowUpdate) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, res); // Write one packet out
   EXPECT_EQ(1, conn.outstandingPackets.size());
   auto packet =
@@ -1737,7 +1788,7 @@ TEST_F(QuicTransportTest, WriteWindowUpdate) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, res); // Write one packet out
   EXPECT_EQ(1, conn.outstandingPackets.size());
   auto packet1 =
@@ -2320,7 +2371,7 @@ TEST_F(QuicTransportTest, WriteStreamFromMiddleOfMap) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, conn.outstandingPackets.size());
   auto& packet = *getFirstOutstandingPacket(conn, PacketNumberSpace::AppData);
   EXPECT_EQ(1, packet.packet.frames.size());
@@ -2343,7 +2394,7 @@ TEST_F(QuicTransportTest, WriteStreamFromMiddleOfMap) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, conn.outstandingPackets.size());
   auto& packet2 = *getFirstOutstandingPacket(conn, PacketNumberSpace::AppData);
   EXPECT_EQ(1, packet2.packet.frames.size());
@@ -2365,7 +2416,7 @@ TEST_F(QuicTransportTest, WriteStreamFromMiddleOfMap) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, conn.outstandingPackets.size());
   auto& packet3 = *getFirstOutstandingPacket(conn, PacketNumberSpace::AppData);
   EXPECT_EQ(2, packet3.packet.frames.size());
@@ -2391,7 +2442,7 @@ TEST_F(QuicTransportTest, NoStream) {
       *aead_,
       *headerCipher_,
       transport_->getVersion(),
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_TRUE(conn.outstandingPackets.empty());
 }
 
@@ -2474,7 +2525,7 @@ TEST_F(QuicTransportTest, PacingWillBurstFirst) {
   auto mockCongestionController = std::make_unique<MockCongestionController>();
   auto rawCongestionController = mockCongestionController.get();
   conn.congestionController = std::move(mockCongestionController);
-  conn.transportSettings.pacingEnabled = true;
+  conn.transportSettings.mutate().pacingEnabled = true;
   conn.canBePaced = true;
   auto mockPacer = std::make_unique<MockPacer>();
   auto rawPacer = mockPacer.get();
@@ -2497,7 +2548,7 @@ TEST_F(QuicTransportTest, AlreadyScheduledPacingNoWrite) {
   auto mockCongestionController = std::make_unique<MockCongestionController>();
   auto rawCongestionController = mockCongestionController.get();
   conn.congestionController = std::move(mockCongestionController);
-  conn.transportSettings.pacingEnabled = true;
+  conn.transportSettings.mutate().pacingEnabled = true;
   conn.canBePaced = true;
   auto mockPacer = std::make_unique<MockPacer>();
   auto rawPacer = mockPacer.get();
@@ -2529,7 +2580,7 @@ TEST_F(QuicTransportTest, NoScheduleIfNoNewData) {
   auto mockCongestionController = std::make_unique<MockCongestionController>();
   auto rawCongestionController = mockCongestionController.get();
   conn.congestionController = std::move(mockCongestionController);
-  conn.transportSettings.pacingEnabled = true;
+  conn.transportSettings.mutate().pacingEnabled = true;
   conn.canBePaced = true;
   auto mockPacer = std::make_unique<MockPacer>();
   auto rawPacer = mockPacer.get();
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/client/QuicClientSocketMultiplexer.h>
+
+#include <folly/io/Cursor.h>
+#include <quic/codec/Decode.h>
+
+#ifndef MSG_WAITFORONE
+#define RECVMMSG_FLAGS 0
+#else
+#define RECVMMSG_FLAGS MSG_WAITFORONE
+#endif
+
+namespace quic {
+
+QuicClientSocketMultiplexer::QuicClientSocketMultiplexer(
+    folly::EventBase* evb,
+    std::unique_ptr<folly::AsyncUDPSocket> socket,
+    size_t connectionIdSize,
+    size_t maxRecvBatchSize)
+    : evb_(evb),
+      socket_(std::move(socket)),
+      connectionIdSize_(connectionIdSize),
+      maxRecvBatchSize_(maxRecvBatchSize) {
+  CHECK(socket_);
+  CHECK_GE(connectionIdSize_, kMinInitialDestinationConnIdLength)
+      << "Packets can only be demultiplexed by client connection id";
+  CHECK_LE(connectionIdSize_, kMaxConnectionIdSize);
+  CHECK_GT(maxRecvBatchSize_, 0);
+}
+
+QuicClientSocketMultiplexer::~QuicClientSocketMultiplexer() {
+  if (socket_->getNetworkSocket() != folly::NetworkSocket()) {
+    socket_->pauseRead();
+    socket_->close();
+  }
+}
+
+void QuicClientSocketMultiplexer::start(
+    const folly::SocketAddress& localAddress) {
+  socket_->setReuseAddr(false);
+  socket_->bind(localAddress);
+  socket_->setDFAndTurnOffPMTU();
+  socket_->resumeRead(this);
+}
+
+std::unique_ptr<folly::AsyncUDPSocket> QuicClientSocketMultiplexer::makeSocket()
+    const {
+  auto sock = std::make_unique<folly::AsyncUDPSocket>(evb_);
+  sock->setFD(
+      socket_->getNetworkSocket(), folly::AsyncUDPSocket::FDOwnership::SHARED);
+  return sock;
+}
+
+void QuicClientSocketMultiplexer::addTransport(
+    std::shared_ptr<QuicClientTransport> transport) {
+  auto connId = transport->getClientConnectionId();
+  CHECK(connId && connId->size() == connectionIdSize_)
+      << "Client connection id does not match the multiplexer's size";
+  transport->setSocketMultiplexer(shared_from_this());
+  transports_[*connId] = transport;
+}
+
+void QuicClientSocketMultiplexer::removeTransport(const ConnectionId& connId) {
+  transports_.erase(connId);
+}
+
+std::shared_ptr<QuicClientTransport> QuicClientSocketMultiplexer::findTransport(
+    const folly::IOBuf& packet) {
+  folly::io::Cursor cursor(&packet);
+  if (!cursor.canAdvance(sizeof(uint8_t))) {
+    return nullptr;
+  }
+  uint8_t initialByte = cursor.readBE<uint8_t>();
+  folly::Optional<ConnectionId> dstConnId;
+  if (getHeaderForm(initialByte) == HeaderForm::Long) {
+    auto parsedHeader = parseLongHeaderInvariant(initialByte, cursor);
+    if (parsedHeader) {
+      dstConnId = std::move(parsedHeader->invariant.dstConnId);
+    }
+  } else {
+    auto parsedHeader =
+        parseShortHeaderInvariants(initialByte, cursor, connectionIdSize_);
+    if (parsedHeader) {
+      dstConnId = std::move(parsedHeader->destinationConnId);
+    }
+  }
+  if (!dstConnId) {
+    return nullptr;
+  }
+  auto it = transports_.find(*dstConnId);
+  if (it == transports_.end()) {
+    return nullptr;
+  }
+  auto transport = it->second.lock();
+  if (!transport) {
+    transports_.erase(it);
+  }
+  return transport;
+}
+
+void QuicClientSocketMultiplexer::getReadBuffer(
+    void** buf,
+    size_t* len) noexcept {
+  readBuffer_ = folly::IOBuf::create(kDefaultUDPReadBufferSize);
+  *buf = readBuffer_->writableData();
+  *len = kDefaultUDPReadBufferSize;
+}
+
+void QuicClientSocketMultiplexer::onDataAvailable(
+    const folly::SocketAddress& peer,
+    size_t len,
+    bool truncated) noexcept {
+  Buf data = std::move(readBuffer_);
+  if (truncated) {
+    return;
+  }
+  data->append(len);
+  auto transport = findTransport(*data);
+  if (!transport) {
+    VLOG(4) << "Dropping packet with unknown connection id from " << peer;
+    return;
+  }
+  transport->onNetworkData(peer, NetworkData(std::move(data), Clock::now()));
+}
+
+void QuicClientSocketMultiplexer::onNotifyDataAvailable(
+    folly::AsyncUDPSocket& sock) noexcept {
+  const size_t addrLen = sizeof(struct sockaddr_storage);
+  recvmmsgStorage_.resize(maxRecvBatchSize_);
+  auto& msgs = recvmmsgStorage_.msgs;
+  auto& addrs = recvmmsgStorage_.addrs;
+  auto& readBuffers = recvmmsgStorage_.readBuffers;
+  auto& iovecs = recvmmsgStorage_.iovecs;
+
+  for (size_t i = 0; i < maxRecvBatchSize_; ++i) {
+    // One buffer per packet so that each transport can decrypt in place.
+    readBuffers[i] = folly::IOBuf::create(kDefaultUDPReadBufferSize);
+    iovecs[i].iov_base = readBuffers[i]->writableData();
+    iovecs[i].iov_len = kDefaultUDPReadBufferSize;
+
+    auto* rawAddr = reinterpret_cast<sockaddr*>(&addrs[i]);
+    rawAddr->sa_family = socket_->address().getFamily();
+
+    struct msghdr* msg = &msgs[i].msg_hdr;
+    msg->msg_name = rawAddr;
+    msg->msg_namelen = addrLen;
+    msg->msg_iov = &iovecs[i];
+    msg->msg_iovlen = 1;
+  }
+
+  int numMsgsRecvd =
+      sock.recvmmsg(msgs.data(), maxRecvBatchSize_, RECVMMSG_FLAGS, nullptr);
+  if (numMsgsRecvd < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      onReadError(folly::AsyncSocketException(
+          folly::AsyncSocketException::INTERNAL_ERROR,
+          "::recvmmsg() failed",
+          errno));
+    }
+    return;
+  }
+
+  // Consecutive packets for the same transport from the same peer are
+  // delivered together so that the transport processes them as one batch.
+  auto receiveTime = Clock::now();
+  std::shared_ptr<QuicClientTransport> batchTransport;
+  folly::SocketAddress batchPeer;
+  NetworkData batch;
+  auto flushBatch = [&]() {
+    if (batchTransport && !batch.packets.empty()) {
+      batch.receiveTimePoint = receiveTime;
+      batchTransport->onNetworkData(batchPeer, std::move(batch));
+    }
+    batch = NetworkData();
+    batchTransport = nullptr;
+  };
+  for (int i = 0; i < numMsgsRecvd; ++i) {
+    size_t bytesRead = msgs[i].msg_len;
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      continue;
+    }
+    auto& packet = readBuffers[i];
+    packet->append(bytesRead);
+    auto transport = findTransport(*packet);
+    if (!transport) {
+      VLOG(4) << "Dropping packet with unknown connection id";
+      continue;
+    }
+    folly::SocketAddress peer;
+    peer.setFromSockaddr(
+        reinterpret_cast<sockaddr*>(&addrs[i]), msgs[i].msg_hdr.msg_namelen);
+    if (transport != batchTransport || peer != batchPeer) {
+      flushBatch();
+      batchTransport = std::move(transport);
+      batchPeer = std::move(peer);
+    }
+    batch.totalData += bytesRead;
+    batch.packets.emplace_back(std::move(packet));
+  }
+  flushBatch();
+}
+
+void QuicClientSocketMultiplexer::onReadError(
+    const folly::AsyncSocketException& ex) noexcept {
+  LOG(ERROR) << "Shared client socket read error: " << ex.what();
+}
+
+} // namespace quic
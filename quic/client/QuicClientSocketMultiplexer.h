@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/container/F14Map.h>
+#include <folly/io/async/AsyncUDPSocket.h>
+#include <quic/client/QuicClientTransport.h>
+#include <quic/codec/QuicConnectionId.h>
+
+namespace quic {
+
+/**
+ * Lets many client transports share one UDP socket, and so one file
+ * descriptor. The multiplexer binds the socket, reads from it in batches
+ * with recvmmsg, and hands each packet to the transport whose client
+ * connection id matches the packet's destination connection id.
+ *
+ * Every transport writes through its own AsyncUDPSocket wrapping the shared
+ * fd, so its GSO / sendmmsg write batching is unchanged.
+ *
+ * Transports must use client connection ids of the size given to the
+ * multiplexer. Happy eyeballs and connected UDP are not supported, since
+ * they need a socket per connection.
+ */
+class QuicClientSocketMultiplexer
+    : public folly::AsyncUDPSocket::ReadCallback,
+      public std::enable_shared_from_this<QuicClientSocketMultiplexer> {
+ public:
+  QuicClientSocketMultiplexer(
+      folly::EventBase* evb,
+      std::unique_ptr<folly::AsyncUDPSocket> socket,
+      size_t connectionIdSize = kDefaultConnectionIdSize,
+      size_t maxRecvBatchSize = kDefaultQuicMaxBatchSize);
+
+  ~QuicClientSocketMultiplexer() override;
+
+  /**
+   * Binds the shared socket and starts reading from it. Must be called
+   * before any of the transports are started.
+   */
+  void start(const folly::SocketAddress& localAddress);
+
+  /**
+   * Returns a self-owning client transport that sends and receives through
+   * the shared socket.
+   */
+  template <class TransportType = QuicClientTransport>
+  std::shared_ptr<TransportType> newClient(
+      std::shared_ptr<ClientHandshakeFactory> handshakeFactory) {
+    auto client = QuicClientTransport::newClient<TransportType>(
+        evb_, makeSocket(), std::move(handshakeFactory), connectionIdSize_);
+    addTransport(client);
+    return client;
+  }
+
+  /**
+   * Creates a socket for a transport, sharing the multiplexed fd.
+   */
+  std::unique_ptr<folly::AsyncUDPSocket> makeSocket() const;
+
+  /**
+   * Routes packets for the transport's client connection id to it. The
+   * transport must have been created with a socket from makeSocket().
+   */
+  void addTransport(std::shared_ptr<QuicClientTransport> transport);
+
+  /**
+   * Called by the transport once it no longer expects packets.
+   */
+  void removeTransport(const ConnectionId& connId);
+
+  size_t numTransports() const {
+    return transports_.size();
+  }
+
+  const folly::SocketAddress& getLocalAddress() const {
+    return socket_->address();
+  }
+
+  // folly::AsyncUDPSocket::ReadCallback
+  void getReadBuffer(void** buf, size_t* len) noexcept override;
+  void onDataAvailable(
+      const folly::SocketAddress& peer,
+      size_t len,
+      bool truncated) noexcept override;
+  bool shouldOnlyNotify() override {
+    return true;
+  }
+  void onNotifyDataAvailable(folly::AsyncUDPSocket& sock) noexcept override;
+  void onReadError(const folly::AsyncSocketException& ex) noexcept override;
+  void onReadClosed() noexcept override {}
+
+ private:
+  /**
+   * Returns the transport the packet is for, or nullptr.
+   */
+  std::shared_ptr<QuicClientTransport> findTransport(
+      const folly::IOBuf& packet);
+
+  folly::EventBase* evb_;
+  std::unique_ptr<folly::AsyncUDPSocket> socket_;
+  size_t connectionIdSize_;
+  size_t maxRecvBatchSize_;
+  Buf readBuffer_;
+  RecvmmsgStorage recvmmsgStorage_;
+  folly::F14FastMap<
+      ConnectionId,
+      std::weak_ptr<QuicClientTransport>,
+      ConnectionIdHash>
+      transports_;
+};
+
+} // namespace quic
@@ -11,6 +11,7 @@
 #include <folly/portability/Sockets.h>
 
 #include <quic/api/QuicTransportFunctions.h>
+#include <quic/client/QuicClientSocketMultiplexer.h>
 #include <quic/client/handshake/ClientHandshakeFactory.h>
 #include <quic/client/handshake/ClientTransportParametersExtension.h>
 #include <quic/client/state/ClientStateMachine.h>
@@ -55,6 +56,7 @@ QuicClientTransport::QuicClientTransport(
       std::make_unique<QuicClientConnectionState>(std::move(handshakeFactory));
   clientConn_ = tempConn.get();
   conn_.reset(tempConn.release());
+  conn_->clock.attachEventBase(evb);
   std::vector<uint8_t> connIdData(
       std::max(kMinInitialDestinationConnIdLength, connectionIdSize));
   folly::Random::secureRandom(connIdData.data(), connIdData.size());
@@ -496,6 +498,15 @@ void QuicClientTransport::processPacketData(
       case QuicFrame::Type::PaddingFrame_E: {
         break;
       }
+      case QuicFrame::Type::ReadNewTokenFrame_E: {
+        ReadNewTokenFrame& newTokenFrame = *quicFrame.asReadNewTokenFrame();
+        VLOG(10) << "Client received new token " << *this;
+        pktHasRetransmittableData = true;
+        if (newTokenFrame.token) {
+          onNewToken(newTokenFrame.token->moveToFbString().toStdString());
+        }
+        break;
+      }
       case QuicFrame::Type::QuicSimpleFrame_E: {
         QuicSimpleFrame& simpleFrame = *quicFrame.asQuicSimpleFrame();
         pktHasRetransmittableData = true;
@@ -672,6 +683,7 @@ void QuicClientTransport::onReadData(
   }
   bool waitingForFirstPacket = !hasReceivedPackets(*conn_);
   processUDPData(peer, std::move(networkData));
+  maybeMigrateToPreferredAddress();
   if (connCallback_ && waitingForFirstPacket && hasReceivedPackets(*conn_)) {
     connCallback_->onFirstPeerPacketProcessed();
   }
@@ -692,6 +704,57 @@ void QuicClientTransport::onReadData(
   }
 }
 
+void QuicClientTransport::maybeMigrateToPreferredAddress() {
+  if (closeState_ != CloseState::OPEN || !conn_->oneRttWriteCipher ||
+      clientConn_->clientHandshakeLayer->getPhase() !=
+          ClientHandshake::Phase::Established) {
+    return;
+  }
+  if (maybeFinishPreferredAddressMigration(*clientConn_)) {
+    VLOG(4) << "Migrated to preferred address " << conn_->peerAddress << " "
+            << *this;
+    return;
+  }
+  if (startPreferredAddressMigration(*clientConn_)) {
+    VLOG(4) << "Validating preferred address " << conn_->peerAddress << " "
+            << *this;
+    if (conn_->transportSettings->connectUDP) {
+      try {
+        socket_->connect(conn_->peerAddress);
+      } catch (const std::exception& ex) {
+        // The socket is still connected to the original address, so carry on
+        // there.
+        VLOG(4) << "Failed to connect to preferred address "
+                << conn_->peerAddress << " " << ex.what() << " " << *this;
+        abandonPreferredAddressMigration(*clientConn_);
+      }
+    }
+  }
+}
+
+void QuicClientTransport::pathValidationTimeoutExpired() noexcept {
+  if (!clientConn_->preMigrationPath) {
+    QuicTransportBase::pathValidationTimeoutExpired();
+    return;
+  }
+  VLOG(4) << "Preferred address " << conn_->peerAddress
+          << " failed validation " << *this;
+  if (conn_->qLogger) {
+    conn_->qLogger->addPathValidationEvent(false);
+  }
+  abandonPreferredAddressMigration(*clientConn_);
+  if (conn_->transportSettings->connectUDP) {
+    FOLLY_MAYBE_UNUSED auto self = sharedGuard();
+    try {
+      socket_->connect(conn_->peerAddress);
+    } catch (const std::exception& ex) {
+      closeImpl(std::make_pair(
+          QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+          std::string(ex.what())));
+    }
+  }
+}
+
 void QuicClientTransport::writeData() {
   // TODO: replace with write in state machine.
   // TODO: change to draining when we move the client to have a draining state
@@ -734,8 +797,9 @@ void QuicClientTransport::writeData() {
 
   uint64_t packetLimit =
       (isConnectionPaced(*conn_)
-           ? conn_->pacer->updateAndGetWriteBatchSize(Clock::now())
-           : conn_->transportSettings.writeConnectionDataPacketsLimit);
+           ? conn_->pacer->updateAndGetWriteBatchSize(
+                 conn_->clock.coarseNow())
+           : conn_->transportSettings->writeConnectionDataPacketsLimit);
   CryptoStreamScheduler initialScheduler(
       *conn_, *getCryptoStream(*conn_->cryptoState, EncryptionLevel::Initial));
   CryptoStreamScheduler handshakeScheduler(
@@ -756,7 +820,8 @@ void QuicClientTransport::writeData() {
         *conn_->initialHeaderCipher,
         version,
         packetLimit,
-        clientConn_->retryToken);
+        clientConn_->retryToken.empty() ? clientConn_->cachedNewToken
+                                        : clientConn_->retryToken);
   }
   if (!packetLimit) {
     return;
@@ -820,7 +885,7 @@ folly::Optional<QuicCachedPsk> QuicClientTransport::getPsk() {
   }
 
   // TODO T32658838 better API to disable early data for current connection
-  if (!conn_->transportSettings.attemptEarlyData) {
+  if (!conn_->transportSettings->attemptEarlyData) {
     quicCachedPsk->cachedPsk.maxEarlyDataSize = 0;
   } else if (
       quicCachedPsk->transportParams.negotiatedVersion !=
@@ -850,13 +915,14 @@ void QuicClientTransport::startCryptoHandshake() {
   // handshake. This is so that we can reset the flow control settings when
   // we go through version negotiation as well.
   updateFlowControlStateWithSettings(
-      conn_->flowControlState, conn_->transportSettings);
+      conn_->flowControlState, *conn_->transportSettings);
 
   // Look up psk and supply to handshake layer
   folly::Optional<QuicCachedPsk> quicCachedPsk = getPsk();
   folly::Optional<fizz::client::CachedPsk> cachedPsk;
   if (quicCachedPsk) {
     cachedPsk = std::move(quicCachedPsk->cachedPsk);
+    clientConn_->cachedNewToken = quicCachedPsk->newToken;
   }
 
   auto handshakeLayer = clientConn_->clientHandshakeLayer;
@@ -873,21 +939,22 @@ void QuicClientTransport::startCryptoHandshake() {
   conn_->initialHeaderCipher = cryptoFactory.makeClientInitialHeaderCipher(
       *clientConn_->initialDestinationConnectionId, version);
 
-  // Add partial reliability parameter to customTransportParameters_.
+  // Add partial reliability and FEC parameters to customTransportParameters_.
   setPartialReliabilityTransportParameter();
+  setFecTransportParameter();
 
   auto paramsExtension = std::make_shared<ClientTransportParametersExtension>(
       folly::none,
-      conn_->transportSettings.advertisedInitialConnectionWindowSize,
-      conn_->transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn_->transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn_->transportSettings.advertisedInitialUniStreamWindowSize,
-      conn_->transportSettings.advertisedInitialMaxStreamsBidi,
-      conn_->transportSettings.advertisedInitialMaxStreamsUni,
-      conn_->transportSettings.idleTimeout,
-      conn_->transportSettings.ackDelayExponent,
-      conn_->transportSettings.maxRecvPacketSize,
-      conn_->transportSettings.selfActiveConnectionIdLimit,
+      conn_->transportSettings->advertisedInitialConnectionWindowSize,
+      conn_->transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn_->transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn_->transportSettings->advertisedInitialUniStreamWindowSize,
+      conn_->transportSettings->advertisedInitialMaxStreamsBidi,
+      conn_->transportSettings->advertisedInitialMaxStreamsUni,
+      conn_->transportSettings->idleTimeout,
+      conn_->transportSettings->ackDelayExponent,
+      conn_->transportSettings->maxRecvPacketSize,
+      conn_->transportSettings->selfActiveConnectionIdLimit,
       customTransportParameters_);
   conn_->transportParametersEncoded = true;
   handshakeLayer->connect(
@@ -988,10 +1055,26 @@ void QuicClientTransport::onNewCachedPsk(
       quicCachedPsk.appParams = appParams->moveToFbString().toStdString();
     }
   }
+  quicCachedPsk.newToken = clientConn_->receivedNewToken;
 
   pskCache_->putPsk(*hostname_, std::move(quicCachedPsk));
 }
 
+void QuicClientTransport::onNewToken(std::string token) {
+  clientConn_->receivedNewToken = std::move(token);
+  if (!pskCache_ || !hostname_) {
+    return;
+  }
+  // The token may arrive after the session ticket, in which case it has to
+  // be added to the psk that is already cached. Otherwise onNewCachedPsk
+  // picks it up.
+  auto quicCachedPsk = pskCache_->getPsk(*hostname_);
+  if (quicCachedPsk) {
+    quicCachedPsk->newToken = clientConn_->receivedNewToken;
+    pskCache_->putPsk(*hostname_, std::move(*quicCachedPsk));
+  }
+}
+
 bool QuicClientTransport::hasWriteCipher() const {
   return clientConn_->oneRttWriteCipher || clientConn_->zeroRttWriteCipher;
 }
@@ -1030,7 +1113,7 @@ void QuicClientTransport::errMessage(
 
 void QuicClientTransport::getReadBuffer(void** buf, size_t* len) noexcept {
   DCHECK(conn_) << "trying to receive packets without a connection";
-  auto readBufferSize = conn_->transportSettings.maxRecvPacketSize;
+  auto readBufferSize = conn_->transportSettings->maxRecvPacketSize;
   readBuffer_ = folly::IOBuf::create(readBufferSize);
   *buf = readBuffer_->writableData();
   *len = readBufferSize;
@@ -1041,7 +1124,7 @@ void QuicClientTransport::onDataAvailable(
     size_t len,
     bool truncated) noexcept {
   VLOG(10) << "Got data from socket peer=" << server << " len=" << len;
-  auto packetReceiveTime = Clock::now();
+  auto packetReceiveTime = conn_->clock.packetNow();
   Buf data = std::move(readBuffer_);
   if (truncated) {
     // This is an error, drop the packet.
@@ -1055,12 +1138,20 @@ void QuicClientTransport::onDataAvailable(
   if (conn_->qLogger) {
     conn_->qLogger->addDatagramReceived(len);
   }
+  if (shouldTrackKernelReceiveDrops()) {
+    // The socket may read several datagrams in this loop iteration, so they
+    // are accounted for as one burst once it ends.
+    if (receiveBurstBytes_ == 0) {
+      evb_->runInLoop(&receiveBurstCallback_);
+    }
+    receiveBurstBytes_ += len;
+  }
   NetworkData networkData(std::move(data), packetReceiveTime);
   onNetworkData(server, std::move(networkData));
 }
 
 bool QuicClientTransport::shouldOnlyNotify() {
-  return conn_->transportSettings.shouldRecvBatch;
+  return conn_->transportSettings->shouldRecvBatch;
 }
 
 void QuicClientTransport::recvMsg(
@@ -1092,6 +1183,11 @@ void QuicClientTransport::recvMsg(
     msg.msg_namelen = size_t(addrLen);
     msg.msg_iov = &vec;
     msg.msg_iovlen = 1;
+    ReceiveControlBuffer control;
+    if (shouldTrackKernelReceiveDrops()) {
+      msg.msg_control = control.data;
+      msg.msg_controllen = sizeof(control.data);
+    }
 
     ssize_t ret = sock.recvmsg(&msg, 0);
     if (ret < 0) {
@@ -1111,6 +1207,10 @@ void QuicClientTransport::recvMsg(
     }
     size_t bytesRead = size_t(ret);
     totalData += bytesRead;
+    if (auto drops = getReceiveDropCount(msg)) {
+      onKernelReceiveDropCount(
+          sock, *drops, KernelDropCounter::Source::ControlMessage);
+    }
     if (!server) {
       server = folly::SocketAddress();
       server->setFromSockaddr(rawAddr, addrLen);
@@ -1138,6 +1238,8 @@ void QuicClientTransport::recvMmsg(
   auto& addrs = networkData.recvmmsgStorage.addrs;
   auto& readBuffers = networkData.recvmmsgStorage.readBuffers;
   auto& iovecs = networkData.recvmmsgStorage.iovecs;
+  auto& controls = networkData.recvmmsgStorage.controls;
+  bool trackDrops = shouldTrackKernelReceiveDrops();
 
   int i = 0;
   for (; i < numPackets; ++i) {
@@ -1157,6 +1259,10 @@ void QuicClientTransport::recvMmsg(
     msg->msg_namelen = addrLen;
     msg->msg_iov = &iovecs[i];
     msg->msg_iovlen = 1;
+    if (trackDrops) {
+      msg->msg_control = controls[i].data;
+      msg->msg_controllen = sizeof(controls[i].data);
+    }
   }
 
   int numMsgsRecvd =
@@ -1179,6 +1285,10 @@ void QuicClientTransport::recvMmsg(
   for (i = 0; i < numMsgsRecvd; ++i) {
     size_t bytesRead = msgs[i].msg_len;
     totalData += bytesRead;
+    if (auto drops = getReceiveDropCount(msgs[i].msg_hdr)) {
+      onKernelReceiveDropCount(
+          sock, *drops, KernelDropCounter::Source::ControlMessage);
+    }
 
     if (!server) {
       server = folly::SocketAddress();
@@ -1199,15 +1309,15 @@ void QuicClientTransport::recvMmsg(
 void QuicClientTransport::onNotifyDataAvailable(
     folly::AsyncUDPSocket& sock) noexcept {
   DCHECK(conn_) << "trying to receive packets without a connection";
-  auto readBufferSize = conn_->transportSettings.maxRecvPacketSize;
-  const int numPackets = conn_->transportSettings.maxRecvBatchSize;
+  auto readBufferSize = conn_->transportSettings->maxRecvPacketSize;
+  const int numPackets = conn_->transportSettings->maxRecvBatchSize;
 
   NetworkData networkData;
   networkData.packets.reserve(numPackets);
   size_t totalData = 0;
   folly::Optional<folly::SocketAddress> server;
 
-  if (conn_->transportSettings.shouldUseRecvmmsgForBatchRecv) {
+  if (conn_->transportSettings->shouldUseRecvmmsgForBatchRecv) {
     recvMmsg(sock, readBufferSize, numPackets, networkData, server, totalData);
   } else {
     recvMsg(sock, readBufferSize, numPackets, networkData, server, totalData);
@@ -1219,12 +1329,85 @@ void QuicClientTransport::onNotifyDataAvailable(
   DCHECK(server.hasValue());
   // TODO: we can get better receive time accuracy than this, with
   // SO_TIMESTAMP or SIOCGSTAMP.
-  auto packetReceiveTime = Clock::now();
+  auto packetReceiveTime = conn_->clock.packetNow();
   networkData.receiveTimePoint = packetReceiveTime;
   networkData.totalData = totalData;
+  updateReceiveStats(sock, totalData, packetReceiveTime);
   onNetworkData(*server, std::move(networkData));
 }
 
+bool QuicClientTransport::shouldTrackKernelReceiveDrops() const {
+  // A multiplexed socket's drops belong to all of its connections.
+  return !socketMultiplexer_ &&
+      (conn_->transportSettings->trackKernelReceiveDrops ||
+       conn_->transportSettings->maxSocketReceiveBuffer > 0);
+}
+
+void QuicClientTransport::onKernelReceiveDropCount(
+    const folly::AsyncUDPSocket& sock,
+    uint32_t total,
+    KernelDropCounter::Source source) {
+  if (&sock != kernelDropSocket_ || source != kernelDropCounter_.getSource()) {
+    kernelDropSocket_ = &sock;
+    kernelDropCounter_.reset(source);
+  }
+  auto drops = kernelDropCounter_.update(total);
+  if (drops == 0) {
+    return;
+  }
+  VLOG(4) << "Kernel dropped " << drops << " datagrams " << *this;
+  QUIC_STATS(conn_->infoCallback, onKernelReceiveDrops, drops);
+  if (receiveBufferSizer_) {
+    receiveBufferSizer_->onDrops(drops);
+  }
+}
+
+void QuicClientTransport::updateReceiveStats(
+    folly::AsyncUDPSocket& sock,
+    uint64_t burstBytes,
+    TimePoint now) {
+  if (!shouldTrackKernelReceiveDrops()) {
+    return;
+  }
+  const auto& settings = *conn_->transportSettings;
+  auto fd = sock.getNetworkSocket().toFd();
+  if (settings.maxSocketReceiveBuffer > 0 && !receiveBufferSizer_) {
+    receiveBufferSizer_.emplace(
+        settings.minSocketReceiveBuffer,
+        settings.maxSocketReceiveBuffer,
+        getSocketReceiveBuffer(fd).value_or(settings.minSocketReceiveBuffer));
+  }
+  if (receiveBufferSizer_) {
+    receiveBufferSizer_->onReadBurst(burstBytes);
+  }
+  if (now < nextReceiveStatsTime_) {
+    return;
+  }
+  nextReceiveStatsTime_ = now + kSocketReceiveStatsInterval;
+  if (!settings.shouldRecvBatch) {
+    // Datagrams read by the socket itself come without control messages.
+    if (auto drops = readSocketDropCount(fd)) {
+      onKernelReceiveDropCount(
+          sock, *drops, KernelDropCounter::Source::SocketPoll);
+    }
+  }
+  if (receiveBufferSizer_) {
+    auto size = receiveBufferSizer_->nextSize();
+    if (size && !setSocketReceiveBuffer(fd, *size)) {
+      VLOG(4) << "Failed to resize receive buffer to " << *size << " "
+              << *this;
+    }
+  }
+}
+
+void QuicClientTransport::onReceiveBurstEnd() {
+  auto burstBytes = receiveBurstBytes_;
+  receiveBurstBytes_ = 0;
+  if (socket_) {
+    updateReceiveStats(*socket_, burstBytes, conn_->clock.packetNow());
+  }
+}
+
 void QuicClientTransport::
     happyEyeballsConnAttemptDelayTimeoutExpired() noexcept {
   QUIC_TRACE(happy_eyeballs, *conn_, "delay timer expired");
@@ -1235,7 +1418,11 @@ void QuicClientTransport::
 }
 
 void QuicClientTransport::start(ConnectionCallback* cb) {
-  if (happyEyeballsEnabled_) {
+  // Multiplexed sockets are shared by all connections, so they can neither be
+  // raced per address family nor connected to a single peer.
+  bool unsupportedMultiplexing = socketMultiplexer_ &&
+      (happyEyeballsEnabled_ || conn_->transportSettings->connectUDP);
+  if (happyEyeballsEnabled_ && !unsupportedMultiplexing) {
     // TODO Supply v4 delay amount from somewhere when we want to tune this
     startHappyEyeballs(
         *conn_,
@@ -1257,13 +1444,20 @@ void QuicClientTransport::start(ConnectionCallback* cb) {
   QUIC_TRACE(fst_trace, *conn_, "start");
   setConnectionCallback(cb);
   try {
-    happyEyeballsSetUpSocket(
-        *socket_,
-        conn_->localAddress,
-        conn_->peerAddress,
-        conn_->transportSettings,
-        this,
-        this);
+    if (unsupportedMultiplexing) {
+      throw QuicInternalException(
+          "Multiplexed sockets do not support happy eyeballs or connectUDP",
+          LocalErrorCode::INVALID_OPERATION);
+    }
+    if (!socketMultiplexer_) {
+      happyEyeballsSetUpSocket(
+          *socket_,
+          conn_->localAddress,
+          conn_->peerAddress,
+          *conn_->transportSettings,
+          this,
+          this);
+    }
     startCryptoHandshake();
   } catch (const QuicTransportException& ex) {
     runOnEvbAsync([ex](auto self) {
@@ -1334,6 +1528,11 @@ void QuicClientTransport::setPskCache(std::shared_ptr<QuicPskCache> pskCache) {
   pskCache_ = std::move(pskCache);
 }
 
+void QuicClientTransport::setSocketMultiplexer(
+    std::shared_ptr<QuicClientSocketMultiplexer> multiplexer) {
+  socketMultiplexer_ = std::move(multiplexer);
+}
+
 void QuicClientTransport::setSelfOwning() {
   selfOwning_ = shared_from_this();
 }
@@ -1367,7 +1566,7 @@ bool QuicClientTransport::setCustomTransportParameter(
 
 void QuicClientTransport::setPartialReliabilityTransportParameter() {
   uint64_t partialReliabilitySetting = 0;
-  if (conn_->transportSettings.partialReliabilityEnabled) {
+  if (conn_->transportSettings->partialReliabilityEnabled) {
     partialReliabilitySetting = 1;
   }
   auto partialReliabilityCustomParam =
@@ -1379,11 +1578,27 @@ void QuicClientTransport::setPartialReliabilityTransportParameter() {
   }
 }
 
+void QuicClientTransport::setFecTransportParameter() {
+  if (conn_->transportSettings->fecRetentionBytes == 0) {
+    return;
+  }
+  auto fecCustomParam = std::make_unique<CustomIntegralTransportParameter>(
+      kFecParameterId, conn_->transportSettings->fecRetentionBytes);
+  if (!setCustomTransportParameter(std::move(fecCustomParam))) {
+    LOG(ERROR) << "failed to set forward error correction transport setting";
+  }
+}
+
 void QuicClientTransport::closeTransport() {
   happyEyeballsConnAttemptDelayTimeout_.cancelTimeout();
+  receiveBurstCallback_.cancelLoopCallback();
+  receiveBurstBytes_ = 0;
 }
 
 void QuicClientTransport::unbindConnection() {
+  if (socketMultiplexer_ && conn_->clientConnectionId) {
+    socketMultiplexer_->removeTransport(*conn_->clientConnectionId);
+  }
   selfOwning_ = nullptr;
 }
 
@@ -1418,11 +1633,12 @@ void QuicClientTransport::onNetworkSwitch(
     sock->close();
 
     socket_ = std::move(newSock);
+    kernelDropSocket_ = nullptr;
     happyEyeballsSetUpSocket(
         *socket_,
         conn_->localAddress,
         conn_->peerAddress,
-        conn_->transportSettings,
+        *conn_->transportSettings,
         this,
         this);
     if (conn_->qLogger) {
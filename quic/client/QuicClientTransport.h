@@ -16,10 +16,12 @@
 #include <quic/client/handshake/QuicPskCache.h>
 #include <quic/client/state/ClientStateMachine.h>
 #include <quic/common/BufUtil.h>
+#include <quic/common/SocketTuning.h>
 
 namespace quic {
 
 class ClientHandshakeFactory;
+class QuicClientSocketMultiplexer;
 
 class QuicClientTransport
     : public QuicTransportBase,
@@ -84,6 +86,16 @@ class QuicClientTransport
    */
   void setPskCache(std::shared_ptr<QuicPskCache> pskCache);
 
+  /**
+   * Marks the socket as shared with other transports. The multiplexer binds
+   * and reads from the shared socket, so the transport does neither.
+   * Happy eyeballs and connectUDP cannot be used with a shared socket, and
+   * start() fails the connection with INVALID_OPERATION if either is set.
+   * Called by QuicClientSocketMultiplexer::addTransport().
+   */
+  void setSocketMultiplexer(
+      std::shared_ptr<QuicClientSocketMultiplexer> multiplexer);
+
   /**
    * Starts the connection.
    */
@@ -185,6 +197,10 @@ class QuicClientTransport
 
   void happyEyeballsConnAttemptDelayTimeoutExpired() noexcept;
 
+  // Falls back to the original server address when the preferred address
+  // could not be validated, instead of closing the connection.
+  void pathValidationTimeoutExpired() noexcept override;
+
   void handleAckFrame(
       const OutstandingPacket& outstandingPacket,
       const QuicWriteFrame& packetFrame,
@@ -213,13 +229,55 @@ class QuicClientTransport
       uint64_t peerAdvertisedInitialMaxStreamUni);
   folly::Optional<QuicCachedPsk> getPsk();
   void removePsk();
+  void onNewToken(std::string token);
+  void maybeMigrateToPreferredAddress();
+  bool shouldTrackKernelReceiveDrops() const;
+  void onKernelReceiveDropCount(
+      const folly::AsyncUDPSocket& sock,
+      uint32_t total,
+      KernelDropCounter::Source source);
+  // Accounts for a burst of reads from sock, then, at most once per
+  // kSocketReceiveStatsInterval, polls the kernel drops and resizes the
+  // receive buffer.
+  void updateReceiveStats(
+      folly::AsyncUDPSocket& sock,
+      uint64_t burstBytes,
+      TimePoint now);
+  // Accounts for the datagrams the socket delivered through onDataAvailable
+  // in the loop iteration that just ended.
+  void onReceiveBurstEnd();
   void setPartialReliabilityTransportParameter();
+  void setFecTransportParameter();
 
  private:
+  class ReceiveBurstCallback : public folly::EventBase::LoopCallback {
+   public:
+    explicit ReceiveBurstCallback(QuicClientTransport* transport)
+        : transport_(transport) {}
+
+    void runLoopCallback() noexcept override {
+      transport_->onReceiveBurstEnd();
+    }
+
+   private:
+    QuicClientTransport* transport_;
+  };
+
   bool replaySafeNotified_{false};
   // Set it QuicClientTransport is in a self owning mode. This will be cleaned
   // up when the caller invokes a terminal call to the transport.
   std::shared_ptr<QuicClientTransport> selfOwning_;
+  // Keeps the shared fd open for as long as this transport uses it.
+  std::shared_ptr<QuicClientSocketMultiplexer> socketMultiplexer_;
+  KernelDropCounter kernelDropCounter_{
+      KernelDropCounter::Source::ControlMessage};
+  // Socket the drop counter follows; only compared, never dereferenced.
+  const folly::AsyncUDPSocket* kernelDropSocket_{nullptr};
+  folly::Optional<ReceiveBufferSizer> receiveBufferSizer_;
+  TimePoint nextReceiveStatsTime_;
+  // Bytes delivered through onDataAvailable in the current loop iteration.
+  uint64_t receiveBurstBytes_{0};
+  ReceiveBurstCallback receiveBurstCallback_{this};
   bool happyEyeballsEnabled_{false};
   sa_family_t happyEyeballsCachedFamily_{AF_UNSPEC};
   std::shared_ptr<QuicPskCache> pskCache_;
@@ -38,6 +38,10 @@ void FizzClientHandshake::connect(
   context->setCompatibilityMode(false);
   // Since Draft-17, EOED should not be sent
   context->setOmitEarlyRecordLayer(true);
+  if (fizzContext_->getCertDecompressionManager()) {
+    context->setCertDecompressionManager(
+        fizzContext_->getCertDecompressionManager());
+  }
   processActions(machine_.processConnect(
       state_,
       std::move(context),
@@ -14,8 +14,11 @@ namespace quic {
 
 FizzClientQuicHandshakeContext::FizzClientQuicHandshakeContext(
     std::shared_ptr<const fizz::client::FizzClientContext> context,
-    std::shared_ptr<const fizz::CertificateVerifier> verifier)
-    : context_(std::move(context)), verifier_(std::move(verifier)) {}
+    std::shared_ptr<const fizz::CertificateVerifier> verifier,
+    std::shared_ptr<fizz::CertDecompressionManager> certDecompressionManager)
+    : context_(std::move(context)),
+      verifier_(std::move(verifier)),
+      certDecompressionManager_(std::move(certDecompressionManager)) {}
 
 std::unique_ptr<ClientHandshake>
 FizzClientQuicHandshakeContext::makeClientHandshake(
@@ -35,7 +38,9 @@ FizzClientQuicHandshakeContext::Builder::build() {
 
   return std::shared_ptr<FizzClientQuicHandshakeContext>(
       new FizzClientQuicHandshakeContext(
-          std::move(context_), std::move(verifier_)));
+          std::move(context_),
+          std::move(verifier_),
+          std::move(certDecompressionManager_)));
 }
 
 } // namespace quic
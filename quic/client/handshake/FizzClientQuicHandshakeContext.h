@@ -11,6 +11,7 @@
 #include <quic/client/handshake/ClientHandshakeFactory.h>
 
 #include <fizz/client/FizzClientContext.h>
+#include <fizz/compression/CertDecompressionManager.h>
 #include <fizz/protocol/DefaultCertificateVerifier.h>
 
 namespace quic {
@@ -34,6 +35,11 @@ class FizzClientQuicHandshakeContext
     return verifier_;
   }
 
+  const std::shared_ptr<fizz::CertDecompressionManager>&
+  getCertDecompressionManager() const {
+    return certDecompressionManager_;
+  }
+
  private:
   /**
    * We make the constructor private so that users have to use the Builder
@@ -45,10 +51,12 @@ class FizzClientQuicHandshakeContext
    */
   FizzClientQuicHandshakeContext(
       std::shared_ptr<const fizz::client::FizzClientContext> context,
-      std::shared_ptr<const fizz::CertificateVerifier> verifier);
+      std::shared_ptr<const fizz::CertificateVerifier> verifier,
+      std::shared_ptr<fizz::CertDecompressionManager> certDecompressionManager);
 
   std::shared_ptr<const fizz::client::FizzClientContext> context_;
   std::shared_ptr<const fizz::CertificateVerifier> verifier_;
+  std::shared_ptr<fizz::CertDecompressionManager> certDecompressionManager_;
 
  public:
   class Builder {
@@ -65,11 +73,23 @@ class FizzClientQuicHandshakeContext
       return *this;
     }
 
+    /**
+     * Advertises RFC 8879 certificate compression for every algorithm the
+     * manager can decompress. Overrides any manager set on the
+     * FizzClientContext.
+     */
+    Builder& setCertDecompressionManager(
+        std::shared_ptr<fizz::CertDecompressionManager> manager) {
+      certDecompressionManager_ = std::move(manager);
+      return *this;
+    }
+
     std::shared_ptr<FizzClientQuicHandshakeContext> build();
 
    private:
     std::shared_ptr<const fizz::client::FizzClientContext> context_;
     std::shared_ptr<const fizz::CertificateVerifier> verifier_;
+    std::shared_ptr<fizz::CertDecompressionManager> certDecompressionManager_;
   };
 };
 
@@ -21,6 +21,8 @@ struct QuicCachedPsk {
   fizz::client::CachedPsk cachedPsk;
   CachedServerTransportParameters transportParams;
   std::string appParams;
+  // Address validation token the server sent in a NEW_TOKEN frame.
+  std::string newToken;
 };
 
 class QuicPskCache {
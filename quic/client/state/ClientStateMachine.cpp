@@ -8,12 +8,14 @@
 
 #include <quic/client/state/ClientStateMachine.h>
 
+#include <folly/Random.h>
 #include <folly/io/async/AsyncSocketException.h>
 #include <quic/congestion_control/QuicCubic.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/TransportParameters.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamUtilities.h>
+#include <quic/state/SimpleFrameFunctions.h>
 #include <quic/state/StateData.h>
 
 namespace quic {
@@ -86,9 +88,13 @@ void processServerInitialParams(
   auto partialReliability = getIntegerParameter(
       static_cast<TransportParameterId>(kPartialReliabilityParameterId),
       serverParams.parameters);
+  auto fecRetentionBytes = getIntegerParameter(
+      static_cast<TransportParameterId>(kFecParameterId),
+      serverParams.parameters);
   auto activeConnectionIdLimit = getIntegerParameter(
       TransportParameterId::active_connection_id_limit,
       serverParams.parameters);
+  auto preferredAddress = getPreferredAddressParameter(serverParams.parameters);
 
   if (!packetSize || *packetSize == 0) {
     packetSize = kDefaultMaxUDPPayload;
@@ -132,7 +138,7 @@ void processServerInitialParams(
   conn.peerAckDelayExponent =
       ackDelayExponent.value_or(kDefaultAckDelayExponent);
   // TODO: udpSendPacketLen should also be limited by PMTU
-  if (conn.transportSettings.canIgnorePathMTU) {
+  if (conn.transportSettings->canIgnorePathMTU) {
     conn.udpSendPacketLen =
         std::min<uint64_t>(*packetSize, kDefaultMaxUDPPayload);
   }
@@ -143,32 +149,103 @@ void processServerInitialParams(
       activeConnectionIdLimit.value_or(kDefaultConnectionIdLimit);
 
   if (partialReliability && *partialReliability != 0 &&
-      conn.transportSettings.partialReliabilityEnabled) {
+      conn.transportSettings->partialReliabilityEnabled) {
     conn.partialReliabilityEnabled = true;
   }
   VLOG(10) << "conn.partialReliabilityEnabled="
            << conn.partialReliabilityEnabled;
+  conn.peerFecRetentionBytes = fecRetentionBytes.value_or(0);
 
   conn.statelessResetToken = std::move(statelessResetToken);
+  if (preferredAddress) {
+    // The preferred address connection id always has sequence number 1.
+    conn.peerConnectionIds.emplace_back(
+        preferredAddress->connectionId, 1, preferredAddress->token);
+    conn.serverPreferredAddress = std::move(preferredAddress);
+  }
   // Update the existing streams, because we allow streams to be created before
   // the connection is established.
   conn.streamManager->streamStateForEach([&conn,
                                           &packetNum](QuicStreamState& s) {
     auto windowSize = isUnidirectionalStream(s.id)
-        ? conn.transportSettings.advertisedInitialUniStreamWindowSize
+        ? conn.transportSettings->advertisedInitialUniStreamWindowSize
         : isLocalStream(conn.nodeType, s.id)
-            ? conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize
+            ? conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize
             : conn.transportSettings
-                  .advertisedInitialBidiRemoteStreamWindowSize;
+                  ->advertisedInitialBidiRemoteStreamWindowSize;
     handleStreamWindowUpdate(s, windowSize, packetNum);
   });
 }
 
+bool startPreferredAddressMigration(QuicClientConnectionState& conn) {
+  if (!conn.transportSettings->migrateToPreferredAddress ||
+      !conn.serverPreferredAddress || conn.preferredAddressMigrationAttempted) {
+    return false;
+  }
+  // Stay within the current address family, the socket is bound to it.
+  const auto& newPeerAddress = conn.peerAddress.getFamily() == AF_INET6
+      ? conn.serverPreferredAddress->ipv6Address
+      : conn.serverPreferredAddress->ipv4Address;
+  if (!newPeerAddress || *newPeerAddress == conn.peerAddress) {
+    return false;
+  }
+  conn.preferredAddressMigrationAttempted = true;
+  conn.preMigrationPath = QuicClientConnectionState::PreMigrationPath{
+      conn.peerAddress, conn.serverConnectionId, conn.statelessResetToken};
+  conn.peerAddress = *newPeerAddress;
+  conn.serverConnectionId = conn.serverPreferredAddress->connectionId;
+  conn.statelessResetToken = conn.serverPreferredAddress->token;
+
+  uint64_t pathData;
+  folly::Random::secureRandom(&pathData, sizeof(pathData));
+  conn.pendingEvents.pathChallenge = PathChallengeFrame(pathData);
+  conn.pathValidationLimiter =
+      std::make_unique<PendingPathRateLimiter>(conn.udpSendPacketLen);
+  if (conn.qLogger) {
+    conn.qLogger->addConnectionMigrationUpdate(true);
+  }
+  return true;
+}
+
+bool maybeFinishPreferredAddressMigration(QuicClientConnectionState& conn) {
+  if (!conn.preMigrationPath || conn.pendingEvents.pathChallenge ||
+      conn.outstandingPathValidation) {
+    return false;
+  }
+  auto& peerIds = conn.peerConnectionIds;
+  const auto& oldConnId = conn.preMigrationPath->serverConnectionId;
+  auto oldId = std::find_if(
+      peerIds.begin(),
+      peerIds.end(),
+      [&oldConnId](const ConnectionIdData& data) {
+        return data.connId == oldConnId;
+      });
+  if (oldId != peerIds.end()) {
+    sendSimpleFrame(conn, RetireConnectionIdFrame(oldId->sequenceNumber));
+    peerIds.erase(oldId);
+  }
+  conn.preMigrationPath = folly::none;
+  conn.pathValidationLimiter.reset();
+  return true;
+}
+
+void abandonPreferredAddressMigration(QuicClientConnectionState& conn) {
+  CHECK(conn.preMigrationPath);
+  conn.peerAddress = conn.preMigrationPath->peerAddress;
+  conn.serverConnectionId = conn.preMigrationPath->serverConnectionId;
+  conn.statelessResetToken = conn.preMigrationPath->statelessResetToken;
+  conn.preMigrationPath = folly::none;
+  conn.pendingEvents.pathChallenge = folly::none;
+  conn.outstandingPathValidation = folly::none;
+  conn.pendingEvents.schedulePathValidationTimeout = false;
+  conn.pathValidationLimiter.reset();
+}
+
 void updateTransportParamsFromCachedEarlyParams(
     QuicClientConnectionState& conn,
     const CachedServerTransportParameters& transportParams) {
   conn.peerIdleTimeout = std::chrono::milliseconds(transportParams.idleTimeout);
-  if (conn.transportSettings.canIgnorePathMTU) {
+  if (conn.transportSettings->canIgnorePathMTU) {
     conn.udpSendPacketLen = transportParams.maxRecvPacketSize;
   }
   conn.flowControlState.peerAdvertisedMaxOffset =
@@ -29,9 +29,30 @@ struct QuicClientConnectionState : public QuicConnectionStateBase {
   // The retry token sent by the server.
   std::string retryToken;
 
+  // Token from a NEW_TOKEN frame of a previous connection to the server. It is
+  // sent in Initial packets when there is no retry token.
+  std::string cachedNewToken;
+
+  // Latest token the server sent in a NEW_TOKEN frame on this connection.
+  std::string receivedNewToken;
+
   // Initial destination connection id.
   folly::Optional<ConnectionId> initialDestinationConnectionId;
 
+  // Preferred address the server offered in its transport parameters.
+  folly::Optional<PreferredAddress> serverPreferredAddress;
+
+  // Path in use before moving to the preferred address. Only set while the
+  // new path is being validated, so that the client can fall back to it if
+  // validation fails.
+  struct PreMigrationPath {
+    folly::SocketAddress peerAddress;
+    folly::Optional<ConnectionId> serverConnectionId;
+    folly::Optional<StatelessResetToken> statelessResetToken;
+  };
+  folly::Optional<PreMigrationPath> preMigrationPath;
+  bool preferredAddressMigrationAttempted{false};
+
   std::shared_ptr<ClientHandshakeFactory> handshakeFactory;
   ClientHandshake* clientHandshakeLayer;
 
@@ -63,10 +84,10 @@ struct QuicClientConnectionState : public QuicConnectionStateBase {
     handshakeLayer = std::move(tmpClientHandshake);
     // We shouldn't normally need to set this until we're starting the
     // transport, however writing unit tests is much easier if we set this here.
-    updateFlowControlStateWithSettings(flowControlState, transportSettings);
+    updateFlowControlStateWithSettings(flowControlState, *transportSettings);
     streamManager = std::make_unique<QuicStreamManager>(
-        *this, this->nodeType, transportSettings);
-    transportSettings.selfActiveConnectionIdLimit =
+        *this, this->nodeType, *transportSettings);
+    transportSettings.mutate().selfActiveConnectionIdLimit =
         kDefaultActiveConnectionIdLimit;
   }
 };
@@ -85,6 +106,25 @@ void processServerInitialParams(
     ServerTransportParameters serverParams,
     PacketNum packetNum);
 
+/**
+ * Switches the connection to the server's preferred address and schedules
+ * a PATH_CHALLENGE on the new path. Returns false when migration is disabled,
+ * was already attempted, or no address of the current family is offered.
+ */
+bool startPreferredAddressMigration(QuicClientConnectionState& conn);
+
+/**
+ * Finishes the migration once the new path is validated, retiring the
+ * connection id used on the original path. Returns true if it did so.
+ */
+bool maybeFinishPreferredAddressMigration(QuicClientConnectionState& conn);
+
+/**
+ * Moves the connection back to the original server address after the
+ * preferred address failed validation.
+ */
+void abandonPreferredAddressMigration(QuicClientConnectionState& conn);
+
 void updateTransportParamsFromCachedEarlyParams(
     QuicClientConnectionState& conn,
     const CachedServerTransportParameters& transportParams);
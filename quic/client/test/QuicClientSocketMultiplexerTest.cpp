@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/client/QuicClientSocketMultiplexer.h>
+
+#include <folly/portability/GTest.h>
+#include <thread>
+
+#include <quic/api/test/Mocks.h>
+#include <quic/client/handshake/FizzClientQuicHandshakeContext.h>
+#include <quic/codec/QuicPacketBuilder.h>
+#include <quic/common/test/TestUtils.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class RecordingQuicClientTransport : public QuicClientTransport {
+ public:
+  using QuicClientTransport::QuicClientTransport;
+
+  void onNetworkData(
+      const folly::SocketAddress& peer,
+      NetworkData&& data) noexcept override {
+    lastPeer = peer;
+    packetsReceived += data.packets.size();
+  }
+
+  folly::SocketAddress lastPeer;
+  size_t packetsReceived{0};
+};
+
+class QuicClientSocketMultiplexerTest : public Test {
+ public:
+  void SetUp() override {
+    multiplexer = std::make_shared<QuicClientSocketMultiplexer>(
+        &evb, std::make_unique<folly::AsyncUDPSocket>(&evb));
+    multiplexer->start(folly::SocketAddress("127.0.0.1", 0));
+    sender = std::make_unique<folly::AsyncUDPSocket>(&evb);
+    sender->bind(folly::SocketAddress("127.0.0.1", 0));
+  }
+
+  void TearDown() override {
+    for (auto& client : clients) {
+      client->closeNow(folly::none);
+    }
+  }
+
+  std::shared_ptr<RecordingQuicClientTransport> makeClient() {
+    auto client = multiplexer->newClient<RecordingQuicClientTransport>(
+        FizzClientQuicHandshakeContext::Builder().build());
+    clients.push_back(client);
+    return client;
+  }
+
+  void sendShortHeaderPacket(const ConnectionId& dstConnId) {
+    ShortHeader header(ProtectionType::KeyPhaseZero, dstConnId, 1);
+    RegularQuicPacketBuilder builder(
+        kDefaultUDPSendPacketLen, std::move(header), 0 /* largestAcked */);
+    writeFrame(PaddingFrame(), builder);
+    auto packet = packetToBuf(std::move(builder).buildPacket());
+    sender->write(multiplexer->getLocalAddress(), packet);
+  }
+
+  void loopUntil(std::function<bool()> done) {
+    for (int i = 0; i < 100 && !done(); ++i) {
+      evb.loopOnce(EVLOOP_NONBLOCK);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  folly::EventBase evb;
+  std::shared_ptr<QuicClientSocketMultiplexer> multiplexer;
+  std::unique_ptr<folly::AsyncUDPSocket> sender;
+  std::vector<std::shared_ptr<RecordingQuicClientTransport>> clients;
+};
+
+TEST_F(QuicClientSocketMultiplexerTest, DemuxByConnectionId) {
+  auto client1 = makeClient();
+  auto client2 = makeClient();
+  EXPECT_EQ(multiplexer->numTransports(), 2);
+
+  sendShortHeaderPacket(*client1->getClientConnectionId());
+  sendShortHeaderPacket(*client2->getClientConnectionId());
+  sendShortHeaderPacket(*client2->getClientConnectionId());
+  sendShortHeaderPacket(getTestConnectionId(99));
+  loopUntil([&] {
+    return client1->packetsReceived == 1 && client2->packetsReceived == 2;
+  });
+  EXPECT_EQ(client1->packetsReceived, 1);
+  EXPECT_EQ(client2->packetsReceived, 2);
+  EXPECT_EQ(client1->lastPeer, sender->address());
+}
+
+TEST_F(QuicClientSocketMultiplexerTest, RemovedOnClose) {
+  auto client = makeClient();
+  auto connId = *client->getClientConnectionId();
+  EXPECT_EQ(multiplexer->numTransports(), 1);
+  client->closeNow(folly::none);
+  clients.clear();
+  EXPECT_EQ(multiplexer->numTransports(), 0);
+
+  sendShortHeaderPacket(connId);
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(client->packetsReceived, 0);
+}
+
+TEST_F(QuicClientSocketMultiplexerTest, ConnectUDPReportsError) {
+  auto client = makeClient();
+  TransportSettings settings;
+  settings.connectUDP = true;
+  client->setTransportSettings(settings);
+  client->addNewPeerAddress(sender->address());
+
+  MockConnectionCallback connCallback;
+  EXPECT_CALL(connCallback, onConnectionError(_))
+      .WillOnce(Invoke([](auto error) {
+        EXPECT_EQ(
+            *error.first.asLocalErrorCode(),
+            LocalErrorCode::INVALID_OPERATION);
+      }));
+  client->start(&connCallback);
+  evb.loopOnce(EVLOOP_NONBLOCK);
+}
+
+} // namespace test
+} // namespace quic
@@ -730,7 +730,7 @@ TEST_P(QuicClientTransportIntegrationTest, TestZeroRttNotAttempted) {
   pskCache_->putPsk(hostname, cachedPsk);
   // Change the ctx
   server_->setFizzContext(serverCtx);
-  client->getNonConstConn().transportSettings.attemptEarlyData = false;
+  client->getNonConstConn().transportSettings.mutate().attemptEarlyData = false;
   client->setEarlyDataAppParamsFunctions(
       [&](const folly::Optional<std::string>&, const Buf&) {
         EXPECT_TRUE(false);
@@ -1356,7 +1356,8 @@ class QuicClientTransportTest : public Test {
     client->getNonConstConn().handshakeLayer.reset(mockClientHandshake);
     setFakeHandshakeCiphers();
     // Allow ignoring path mtu for testing negotiation.
-    client->getNonConstConn().transportSettings.canIgnorePathMTU = true;
+    client->getNonConstConn().transportSettings.mutate().canIgnorePathMTU =
+        true;
   }
 
   virtual void setFakeHandshakeCiphers() {
@@ -2949,7 +2950,7 @@ TEST_F(
 
 TEST_F(QuicClientTransportAfterStartTest, RecvNewConnectionIdValid) {
   auto& conn = client->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 1;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 1;
 
   ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
   RegularQuicPacketBuilder builder(
@@ -2975,7 +2976,7 @@ TEST_F(
     QuicClientTransportAfterStartTest,
     RecvNewConnectionIdTooManyReceivedIds) {
   auto& conn = client->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 0;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 0;
 
   ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
   RegularQuicPacketBuilder builder(
@@ -2995,7 +2996,7 @@ TEST_F(
 
 TEST_F(QuicClientTransportAfterStartTest, RecvNewConnectionIdInvalidRetire) {
   auto& conn = client->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 1;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 1;
 
   ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
   RegularQuicPacketBuilder builder(
@@ -3014,7 +3015,7 @@ TEST_F(QuicClientTransportAfterStartTest, RecvNewConnectionIdInvalidRetire) {
 
 TEST_F(QuicClientTransportAfterStartTest, RecvNewConnectionIdUsing0LenCid) {
   auto& conn = client->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 2;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 2;
 
   conn.serverConnectionId = ConnectionId(std::vector<uint8_t>{});
   conn.peerConnectionIds.pop_back();
@@ -3045,7 +3046,7 @@ TEST_F(
     QuicClientTransportAfterStartTest,
     RecvNewConnectionIdNoopValidDuplicate) {
   auto& conn = client->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 1;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 1;
 
   ConnectionId connId2({5, 5, 5, 5});
   conn.peerConnectionIds.emplace_back(connId2, 1);
@@ -3069,7 +3070,7 @@ TEST_F(
     QuicClientTransportAfterStartTest,
     RecvNewConnectionIdExceptionInvalidDuplicate) {
   auto& conn = client->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 1;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 1;
 
   ConnectionId connId2({5, 5, 5, 5});
   conn.peerConnectionIds.emplace_back(connId2, 1);
@@ -3251,6 +3252,72 @@ TEST_F(QuicClientTransportAfterStartTest, RecvPathChallengeAvailablePeerId) {
   EXPECT_EQ(pathResponse.pathData, pathChallenge.pathData);
 }
 
+TEST_F(QuicClientTransportAfterStartTest, MigrateToPreferredAddress) {
+  auto& conn = client->getNonConstConn();
+  auto originalPeer = conn.peerAddress;
+  auto originalCid = *conn.serverConnectionId;
+  ConnectionId preferredCid(std::vector<uint8_t>{5, 6, 7, 8});
+  PreferredAddress preferredAddress(
+      preferredCid, generateStatelessResetToken());
+  folly::SocketAddress newPeer("127.0.0.2", originalPeer.getPort());
+  preferredAddress.ipv4Address = newPeer;
+  conn.serverPreferredAddress = preferredAddress;
+  conn.peerConnectionIds.emplace_back(preferredCid, 1, preferredAddress.token);
+
+  EXPECT_FALSE(startPreferredAddressMigration(conn));
+  conn.transportSettings.mutate().migrateToPreferredAddress = true;
+  EXPECT_TRUE(startPreferredAddressMigration(conn));
+  EXPECT_EQ(conn.peerAddress, newPeer);
+  EXPECT_EQ(*conn.serverConnectionId, preferredCid);
+  EXPECT_EQ(*conn.statelessResetToken, preferredAddress.token);
+  EXPECT_TRUE(conn.pendingEvents.pathChallenge);
+  EXPECT_TRUE(conn.pathValidationLimiter);
+  // Only one attempt is made per connection.
+  EXPECT_FALSE(startPreferredAddressMigration(conn));
+
+  // Not finished while the challenge is unanswered.
+  EXPECT_FALSE(maybeFinishPreferredAddressMigration(conn));
+  conn.pendingEvents.pathChallenge = folly::none;
+  EXPECT_TRUE(maybeFinishPreferredAddressMigration(conn));
+  EXPECT_FALSE(conn.preMigrationPath);
+  EXPECT_FALSE(conn.pathValidationLimiter);
+  ASSERT_EQ(conn.pendingEvents.frames.size(), 1);
+  auto retireFrame = conn.pendingEvents.frames[0].asRetireConnectionIdFrame();
+  ASSERT_NE(retireFrame, nullptr);
+  EXPECT_EQ(retireFrame->sequenceNumber, 0);
+  for (const auto& peerId : conn.peerConnectionIds) {
+    EXPECT_NE(peerId.connId, originalCid);
+  }
+}
+
+TEST_F(QuicClientTransportAfterStartTest, AbandonPreferredAddressMigration) {
+  auto& conn = client->getNonConstConn();
+  auto originalPeer = conn.peerAddress;
+  auto originalCid = *conn.serverConnectionId;
+  auto originalToken = conn.statelessResetToken;
+  ConnectionId preferredCid(std::vector<uint8_t>{5, 6, 7, 8});
+  PreferredAddress preferredAddress(
+      preferredCid, generateStatelessResetToken());
+  preferredAddress.ipv4Address =
+      folly::SocketAddress("127.0.0.2", originalPeer.getPort());
+  conn.serverPreferredAddress = preferredAddress;
+  conn.transportSettings.mutate().migrateToPreferredAddress = true;
+
+  ASSERT_TRUE(startPreferredAddressMigration(conn));
+  conn.outstandingPathValidation = *conn.pendingEvents.pathChallenge;
+  conn.pendingEvents.pathChallenge = folly::none;
+  EXPECT_FALSE(maybeFinishPreferredAddressMigration(conn));
+
+  abandonPreferredAddressMigration(conn);
+  EXPECT_EQ(conn.peerAddress, originalPeer);
+  EXPECT_EQ(*conn.serverConnectionId, originalCid);
+  EXPECT_EQ(conn.statelessResetToken, originalToken);
+  EXPECT_FALSE(conn.preMigrationPath);
+  EXPECT_FALSE(conn.outstandingPathValidation);
+  EXPECT_FALSE(conn.pathValidationLimiter);
+  EXPECT_FALSE(startPreferredAddressMigration(conn));
+}
+
 bool verifyFramePresent(
     std::vector<std::unique_ptr<folly::IOBuf>>& socketWrites,
     QuicReadCodec& readCodec,
@@ -5020,6 +5087,34 @@ TEST_F(QuicClientTransportPskCacheTest, TestTwoOnNewCachedPsk) {
   mockClientHandshake->triggerOnNewCachedPsk();
 }
 
+TEST_F(QuicClientTransportPskCacheTest, TestNewTokenCached) {
+  EXPECT_CALL(*mockPskCache_, getPsk(hostname_))
+      .WillOnce(Return(QuicCachedPsk()));
+  EXPECT_CALL(*mockPskCache_, putPsk(hostname_, _))
+      .WillOnce(Invoke([=](const std::string&, QuicCachedPsk psk) {
+        EXPECT_EQ(psk.newToken, "token");
+      }));
+  ShortHeader header(
+      ProtectionType::KeyPhaseZero, *originalConnId, appDataPacketNum++);
+  RegularQuicPacketBuilder builder(
+      client->getConn().udpSendPacketLen,
+      std::move(header),
+      0 /* largestAcked */);
+  writeFrame(
+      QuicSimpleFrame(NewTokenFrame(folly::IOBuf::copyBuffer("token"))),
+      builder);
+  auto packet = packetToBuf(std::move(builder).buildPacket());
+  deliverData(packet->coalesce());
+  EXPECT_EQ(client->getConn().receivedNewToken, "token");
+
+  // A session ticket that arrives later keeps the token.
+  EXPECT_CALL(*mockPskCache_, putPsk(hostname_, _))
+      .WillOnce(Invoke([=](const std::string&, QuicCachedPsk psk) {
+        EXPECT_EQ(psk.newToken, "token");
+      }));
+  mockClientHandshake->triggerOnNewCachedPsk();
+}
+
 class QuicZeroRttClientTest : public QuicClientTransportAfterStartTestBase {
  public:
   ~QuicZeroRttClientTest() override = default;
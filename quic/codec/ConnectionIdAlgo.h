@@ -9,6 +9,7 @@
 #pragma once
 
 #include <folly/Optional.h>
+#include <quic/QuicConstants.h>
 #include <quic/codec/QuicConnectionId.h>
 
 namespace quic {
@@ -41,6 +42,14 @@ class ConnectionIdAlgo {
    */
   virtual ConnectionId encodeConnectionId(
       const ServerConnectionIdParams& params) = 0;
+
+  /**
+   * Length of the connection ids returned by encodeConnectionId. Short header
+   * packets are parsed with this length.
+   */
+  virtual size_t getConnectionIdSize() const {
+    return kDefaultConnectionIdSize;
+  }
 };
 
 /**
@@ -678,6 +678,52 @@ ExpiredStreamDataFrame decodeExpiredStreamDataFrame(folly::io::Cursor& cursor) {
       folly::to<StreamId>(streamId->first), minimumStreamOffset->first);
 }
 
+StreamRepairFrame decodeStreamRepairFrame(folly::io::Cursor& cursor) {
+  auto streamId = decodeQuicInteger(cursor);
+  if (!streamId) {
+    throw QuicTransportException(
+        "Invalid streamId",
+        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
+        quic::FrameType::STREAM_REPAIR);
+  }
+  auto offset = decodeQuicInteger(cursor);
+  if (!offset) {
+    throw QuicTransportException(
+        "Invalid offset",
+        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
+        quic::FrameType::STREAM_REPAIR);
+  }
+  auto length = decodeQuicInteger(cursor);
+  if (!length || length->first == 0) {
+    throw QuicTransportException(
+        "Invalid length",
+        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
+        quic::FrameType::STREAM_REPAIR);
+  }
+  auto symbolSize = decodeQuicInteger(cursor);
+  if (!symbolSize || symbolSize->first == 0) {
+    throw QuicTransportException(
+        "Invalid symbol size",
+        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
+        quic::FrameType::STREAM_REPAIR);
+  }
+  auto repairLength = std::min(length->first, symbolSize->first);
+  if (cursor.totalLength() < repairLength) {
+    throw QuicTransportException(
+        "Length mismatch",
+        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
+        quic::FrameType::STREAM_REPAIR);
+  }
+  Buf repairData;
+  cursor.clone(repairData, repairLength);
+  return StreamRepairFrame(
+      folly::to<StreamId>(streamId->first),
+      offset->first,
+      length->first,
+      symbolSize->first,
+      std::move(repairData));
+}
+
 QuicFrame parseFrame(
     BufQueue& queue,
     const PacketHeader& header,
@@ -766,6 +812,8 @@ QuicFrame parseFrame(
         return QuicFrame(decodeMinStreamDataFrame(cursor));
       case FrameType::EXPIRED_STREAM_DATA:
         return QuicFrame(decodeExpiredStreamDataFrame(cursor));
+      case FrameType::STREAM_REPAIR:
+        return QuicFrame(decodeStreamRepairFrame(cursor));
     }
   } catch (const std::exception&) {
     error = true;
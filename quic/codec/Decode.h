@@ -94,6 +94,8 @@ ExpiredStreamDataFrame decodeExpiredStreamDataFrame(folly::io::Cursor& cursor);
 
 MinStreamDataFrame decodeMinStreamDataFrame(folly::io::Cursor& cursor);
 
+StreamRepairFrame decodeStreamRepairFrame(folly::io::Cursor& cursor);
+
 MaxStreamsFrame decodeBiDiMaxStreamsFrame(folly::io::Cursor& cursor);
 
 MaxStreamsFrame decodeUniMaxStreamsFrame(folly::io::Cursor& cursor);
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/codec/QuicLbConnectionIdAlgo.h>
+
+#include <folly/Random.h>
+#include <folly/lang/Assume.h>
+#include <quic/QuicException.h>
+
+#include <openssl/evp.h>
+
+#include <cstring>
+
+namespace {
+// first 2 bits of the connection id carry the config rotation codepoint
+constexpr uint8_t kConfigIdBitsMask = 0xc0;
+// remaining 6 bits carry the length of the connection id minus one
+constexpr uint8_t kLengthBitsMask = 0x3f;
+// bit of the second server use byte holding the process id
+constexpr uint8_t kProcessIdBitMask = 0x80;
+
+size_t routingBytesLength(const quic::QuicLbConfig& config) {
+  return config.serverIdLen + quic::kQuicLbServerUseLength;
+}
+
+void throwInvalidConfig(const char* reason) {
+  throw quic::QuicInternalException(
+      std::string("Invalid QUIC-LB config: ") + reason,
+      quic::LocalErrorCode::INTERNAL_ERROR);
+}
+
+folly::ssl::EvpCipherCtxUniquePtr makeCipherContext(
+    const quic::QuicLbConfig& config,
+    bool encrypt) {
+  folly::ssl::EvpCipherCtxUniquePtr context(EVP_CIPHER_CTX_new());
+  if (context == nullptr) {
+    throw std::runtime_error("Unable to allocate an EVP_CIPHER_CTX object");
+  }
+  if (EVP_CipherInit_ex(
+          context.get(),
+          EVP_aes_128_ecb(),
+          nullptr,
+          config.key.data(),
+          nullptr,
+          encrypt ? 1 : 0) != 1) {
+    throw std::runtime_error("Init error");
+  }
+  EVP_CIPHER_CTX_set_padding(context.get(), 0);
+  return context;
+}
+
+void cipherBlock(
+    const folly::ssl::EvpCipherCtxUniquePtr& context,
+    const uint8_t* in,
+    uint8_t* out) {
+  int outLen = 0;
+  if (EVP_CipherUpdate(
+          context.get(), out, &outLen, in, quic::kQuicLbBlockLength) != 1 ||
+      static_cast<size_t>(outLen) != quic::kQuicLbBlockLength) {
+    throw std::runtime_error("Encryption error");
+  }
+}
+} // namespace
+
+namespace quic {
+
+size_t QuicLbConfig::connectionIdLength() const {
+  switch (mode) {
+    case QuicLbMode::Plaintext:
+      return plaintextConnectionIdLen;
+    case QuicLbMode::StreamCipher:
+      return 1 + nonceLen + serverIdLen + kQuicLbServerUseLength;
+    case QuicLbMode::BlockCipher:
+      return 1 + kQuicLbBlockLength;
+  }
+  folly::assume_unreachable();
+}
+
+void QuicLbConfig::validate() const {
+  if (configId >= kQuicLbUnroutableConfigId) {
+    throwInvalidConfig("config id is reserved");
+  }
+  if (serverIdLen == 0) {
+    throwInvalidConfig("server id length is zero");
+  }
+  if (serverIdLen + kQuicLbServerUseLength > kQuicLbBlockLength) {
+    throwInvalidConfig("server id does not fit in a block");
+  }
+  switch (mode) {
+    case QuicLbMode::Plaintext:
+      if (plaintextConnectionIdLen < 1 + serverIdLen + kQuicLbServerUseLength) {
+        throwInvalidConfig("connection id too short for server id");
+      }
+      break;
+    case QuicLbMode::StreamCipher:
+      if (nonceLen < kQuicLbMinNonceLength || nonceLen > kQuicLbBlockLength) {
+        throwInvalidConfig("nonce length out of range");
+      }
+      break;
+    case QuicLbMode::BlockCipher:
+      break;
+  }
+  auto length = connectionIdLength();
+  if (length < kMinSelfConnectionIdSize || length > kMaxConnectionIdSize) {
+    throwInvalidConfig("connection id length out of range");
+  }
+}
+
+QuicLbServerIdDecoder::QuicLbServerIdDecoder(QuicLbConfig config)
+    : config_(std::move(config)) {
+  config_.validate();
+  if (config_.mode != QuicLbMode::Plaintext) {
+    encryptCtx_ = makeCipherContext(config_, true);
+  }
+  if (config_.mode == QuicLbMode::BlockCipher) {
+    decryptCtx_ = makeCipherContext(config_, false);
+  }
+}
+
+bool QuicLbServerIdDecoder::canParse(const ConnectionId& id) const {
+  if (id.size() != config_.connectionIdLength()) {
+    return false;
+  }
+  uint8_t firstByte = id.data()[0];
+  return ((firstByte & kConfigIdBitsMask) >> 6) == config_.configId &&
+      (firstByte & kLengthBitsMask) == id.size() - 1;
+}
+
+folly::Optional<std::vector<uint8_t>> QuicLbServerIdDecoder::getServerId(
+    const ConnectionId& id) const {
+  std::vector<uint8_t> routingBytes(routingBytesLength(config_));
+  if (!decodeRoutingBytes(id, routingBytes.data())) {
+    return folly::none;
+  }
+  routingBytes.resize(config_.serverIdLen);
+  return routingBytes;
+}
+
+bool QuicLbServerIdDecoder::decodeRoutingBytes(
+    const ConnectionId& id,
+    uint8_t* out) const {
+  if (!canParse(id)) {
+    return false;
+  }
+  const uint8_t* payload = id.data() + 1;
+  size_t routingLen = routingBytesLength(config_);
+  switch (config_.mode) {
+    case QuicLbMode::Plaintext:
+      memcpy(out, payload, routingLen);
+      return true;
+    case QuicLbMode::StreamCipher: {
+      std::array<uint8_t, kQuicLbBlockLength> paddedNonce{};
+      memcpy(paddedNonce.data(), payload, config_.nonceLen);
+      std::array<uint8_t, kQuicLbBlockLength> keyStream;
+      encryptBlock(paddedNonce.data(), keyStream.data());
+      const uint8_t* encrypted = payload + config_.nonceLen;
+      for (size_t i = 0; i < routingLen; ++i) {
+        out[i] = encrypted[i] ^ keyStream[i];
+      }
+      return true;
+    }
+    case QuicLbMode::BlockCipher: {
+      std::array<uint8_t, kQuicLbBlockLength> plaintext;
+      cipherBlock(decryptCtx_, payload, plaintext.data());
+      memcpy(out, plaintext.data(), routingLen);
+      return true;
+    }
+  }
+  folly::assume_unreachable();
+}
+
+void QuicLbServerIdDecoder::encryptBlock(const uint8_t* in, uint8_t* out)
+    const {
+  cipherBlock(encryptCtx_, in, out);
+}
+
+QuicLbConnectionIdAlgo::QuicLbConnectionIdAlgo(QuicLbConfig config)
+    : QuicLbServerIdDecoder(std::move(config)) {}
+
+bool QuicLbConnectionIdAlgo::canParse(const ConnectionId& id) const {
+  return QuicLbServerIdDecoder::canParse(id);
+}
+
+ServerConnectionIdParams QuicLbConnectionIdAlgo::parseConnectionId(
+    const ConnectionId& id) {
+  std::array<uint8_t, kQuicLbBlockLength> routingBytes;
+  if (!decodeRoutingBytes(id, routingBytes.data())) {
+    throw QuicInternalException(
+        "ConnectionId does not match the QUIC-LB config",
+        LocalErrorCode::INTERNAL_ERROR);
+  }
+  // Only the low 16 bits of the server id can be a host id.
+  uint16_t hostId = 0;
+  for (size_t i = 0; i < config_.serverIdLen; ++i) {
+    hostId = (hostId << 8) | routingBytes[i];
+  }
+  const uint8_t* serverUse = routingBytes.data() + config_.serverIdLen;
+  return ServerConnectionIdParams(
+      config_.configId,
+      hostId,
+      (serverUse[1] & kProcessIdBitMask) ? 1 : 0,
+      serverUse[0]);
+}
+
+ConnectionId QuicLbConnectionIdAlgo::encodeConnectionId(
+    const ServerConnectionIdParams& params) {
+  if (config_.serverIdLen < sizeof(params.hostId) &&
+      (params.hostId >> (8 * config_.serverIdLen)) != 0) {
+    throw QuicInternalException(
+        "hostId does not fit in the QUIC-LB server id",
+        LocalErrorCode::INTERNAL_ERROR);
+  }
+  size_t routingLen = routingBytesLength(config_);
+  // Start from random bytes so that anything not written below, including
+  // the low bits of the second server use byte, is unpredictable.
+  std::array<uint8_t, kQuicLbBlockLength> routingBytes;
+  folly::Random::secureRandom(routingBytes.data(), routingBytes.size());
+  for (size_t i = 0; i < config_.serverIdLen; ++i) {
+    size_t shift = 8 * (config_.serverIdLen - 1 - i);
+    routingBytes[i] = shift < 16 ? (params.hostId >> shift) & 0xff : 0;
+  }
+  uint8_t* serverUse = routingBytes.data() + config_.serverIdLen;
+  serverUse[0] = params.workerId;
+  serverUse[1] &= ~kProcessIdBitMask;
+  serverUse[1] |= params.processId ? kProcessIdBitMask : 0;
+
+  std::vector<uint8_t> connIdData(config_.connectionIdLength());
+  folly::Random::secureRandom(connIdData.data(), connIdData.size());
+  connIdData[0] = (config_.configId << 6) |
+      ((connIdData.size() - 1) & kLengthBitsMask);
+  uint8_t* payload = connIdData.data() + 1;
+  switch (config_.mode) {
+    case QuicLbMode::Plaintext:
+      memcpy(payload, routingBytes.data(), routingLen);
+      break;
+    case QuicLbMode::StreamCipher: {
+      // The nonce is already random.
+      std::array<uint8_t, kQuicLbBlockLength> paddedNonce{};
+      memcpy(paddedNonce.data(), payload, config_.nonceLen);
+      std::array<uint8_t, kQuicLbBlockLength> keyStream;
+      encryptBlock(paddedNonce.data(), keyStream.data());
+      uint8_t* encrypted = payload + config_.nonceLen;
+      for (size_t i = 0; i < routingLen; ++i) {
+        encrypted[i] = routingBytes[i] ^ keyStream[i];
+      }
+      break;
+    }
+    case QuicLbMode::BlockCipher:
+      encryptBlock(routingBytes.data(), payload);
+      break;
+  }
+  return ConnectionId(std::move(connIdData));
+}
+
+size_t QuicLbConnectionIdAlgo::getConnectionIdSize() const {
+  return config_.connectionIdLength();
+}
+
+} // namespace quic
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+#include <quic/codec/ConnectionIdAlgo.h>
+#include <quic/codec/QuicConnectionId.h>
+
+#include <array>
+#include <vector>
+
+namespace quic {
+
+constexpr size_t kQuicLbKeyLength = 16;
+constexpr size_t kQuicLbBlockLength = 16;
+constexpr size_t kQuicLbMinNonceLength = 8;
+// Config rotation codepoint reserved for connection ids that the load
+// balancer cannot route.
+constexpr uint8_t kQuicLbUnroutableConfigId = 0x3;
+// Bytes following the server id that carry the worker id and process id.
+constexpr size_t kQuicLbServerUseLength = 2;
+
+enum class QuicLbMode : uint8_t {
+  // Server id in the clear, routable without any key.
+  Plaintext,
+  // Server id XORed with AES-ECB(key, nonce), random nonce per connection id.
+  StreamCipher,
+  // Server id and server use bytes encrypted as a single AES-128 block.
+  BlockCipher,
+};
+
+struct QuicLbConfig {
+  // Two bit config rotation codepoint carried in the first octet.
+  uint8_t configId{0};
+  QuicLbMode mode{QuicLbMode::Plaintext};
+  // Length in bytes of the server id that the load balancer routes on.
+  uint8_t serverIdLen{2};
+  // Length of the random nonce in stream cipher mode.
+  uint8_t nonceLen{kQuicLbMinNonceLength};
+  // Total connection id length in plaintext mode. The cipher modes derive
+  // their length from the other parameters.
+  uint8_t plaintextConnectionIdLen{kDefaultConnectionIdSize};
+  // AES-128 key, shared with the load balancer. Unused in plaintext mode.
+  std::array<uint8_t, kQuicLbKeyLength> key{};
+
+  /**
+   * Length of the connection ids this config produces.
+   */
+  size_t connectionIdLength() const;
+
+  /**
+   * Throws QuicInternalException if the config can't produce valid
+   * connection ids.
+   */
+  void validate() const;
+};
+
+/**
+ * Extracts the server id from connection ids produced by
+ * QuicLbConnectionIdAlgo. This is all a stateless load balancer needs to
+ * route a packet, and it only depends on folly and OpenSSL so it can be
+ * linked into a userspace load balancer.
+ *
+ * Not thread safe, each thread should use its own instance.
+ */
+class QuicLbServerIdDecoder {
+ public:
+  explicit QuicLbServerIdDecoder(QuicLbConfig config);
+
+  /**
+   * Returns true if the connection id was produced with this config.
+   */
+  bool canParse(const ConnectionId& id) const;
+
+  /**
+   * Returns the server id, or folly::none if the connection id doesn't
+   * belong to this config.
+   */
+  folly::Optional<std::vector<uint8_t>> getServerId(
+      const ConnectionId& id) const;
+
+  const QuicLbConfig& getConfig() const {
+    return config_;
+  }
+
+ protected:
+  /**
+   * Recovers the server id followed by the server use bytes. The output has
+   * to hold serverIdLen + kQuicLbServerUseLength bytes.
+   */
+  bool decodeRoutingBytes(const ConnectionId& id, uint8_t* out) const;
+
+  void encryptBlock(const uint8_t* in, uint8_t* out) const;
+
+  QuicLbConfig config_;
+  folly::ssl::EvpCipherCtxUniquePtr encryptCtx_;
+  folly::ssl::EvpCipherCtxUniquePtr decryptCtx_;
+};
+
+/**
+ * ConnectionIdAlgo that lays out connection ids following the QUIC-LB draft
+ * (draft-ietf-quic-load-balancers-02), so that load balancers can route
+ * without per-flow state while observers only see the server id in
+ * plaintext mode.
+ *
+ * The hostId is the server id, written big endian in serverIdLen bytes. The
+ * worker id and process id are carried in two server use bytes right after
+ * the server id, and are protected the same way as the server id:
+ *
+ *   Plaintext:     |CR|LEN| server id | worker | process | random ... |
+ *   Stream cipher: |CR|LEN| nonce | E(server id | worker | process) |
+ *   Block cipher:  |CR|LEN| AES(server id | worker | process | random) |
+ *
+ * CR is the two bit config id and LEN the connection id length minus one.
+ * The version of parsed ServerConnectionIdParams is the config id.
+ */
+class QuicLbConnectionIdAlgo : public ConnectionIdAlgo,
+                               private QuicLbServerIdDecoder {
+ public:
+  explicit QuicLbConnectionIdAlgo(QuicLbConfig config);
+  ~QuicLbConnectionIdAlgo() override = default;
+
+  bool canParse(const ConnectionId& id) const override;
+
+  ServerConnectionIdParams parseConnectionId(const ConnectionId& id) override;
+
+  ConnectionId encodeConnectionId(
+      const ServerConnectionIdParams& params) override;
+
+  size_t getConnectionIdSize() const override;
+};
+
+class QuicLbConnectionIdAlgoFactory : public ConnectionIdAlgoFactory {
+ public:
+  explicit QuicLbConnectionIdAlgoFactory(QuicLbConfig config)
+      : config_(std::move(config)) {
+    config_.validate();
+  }
+  ~QuicLbConnectionIdAlgoFactory() override = default;
+
+  std::unique_ptr<ConnectionIdAlgo> make() override {
+    return std::make_unique<QuicLbConnectionIdAlgo>(config_);
+  }
+
+ private:
+  QuicLbConfig config_;
+};
+
+} // namespace quic
@@ -60,7 +60,7 @@ folly::Optional<PacketEvent> PacketRebuilder::rebuildFromPacket(
         uint64_t ackDelayExponent =
             (packetHeader.getHeaderForm() == HeaderForm::Long)
             ? kDefaultAckDelayExponent
-            : conn_.transportSettings.ackDelayExponent;
+            : conn_.transportSettings->ackDelayExponent;
         AckBlocks ackBlocks;
         for (auto& block : ackFrame.ackBlocks) {
           ackBlocks.insert(block.start, block.end);
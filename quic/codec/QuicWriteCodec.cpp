@@ -494,6 +494,58 @@ size_t writeSimpleFrame(
       // no space left in packet
       return size_t(0);
     }
+    case QuicSimpleFrame::Type::NewTokenFrame_E: {
+      NewTokenFrame& newTokenFrame = *frame.asNewTokenFrame();
+      QuicInteger frameType(static_cast<uint8_t>(FrameType::NEW_TOKEN));
+      auto tokenLength =
+          newTokenFrame.token ? newTokenFrame.token->computeChainDataLength()
+                              : 0;
+      QuicInteger tokenLengthInt(tokenLength);
+      auto newTokenFrameSize =
+          frameType.getSize() + tokenLengthInt.getSize() + tokenLength;
+      if (packetSpaceCheck(spaceLeft, newTokenFrameSize)) {
+        builder.write(frameType);
+        builder.write(tokenLengthInt);
+        if (newTokenFrame.token) {
+          builder.insert(newTokenFrame.token->clone());
+        }
+        builder.appendFrame(QuicSimpleFrame(std::move(newTokenFrame)));
+        return newTokenFrameSize;
+      }
+      // no space left in packet
+      return size_t(0);
+    }
+    case QuicSimpleFrame::Type::StreamRepairFrame_E: {
+      StreamRepairFrame& repairFrame = *frame.asStreamRepairFrame();
+      QuicInteger frameType(static_cast<uint8_t>(FrameType::STREAM_REPAIR));
+      QuicInteger streamId(repairFrame.streamId);
+      QuicInteger offset(repairFrame.offset);
+      QuicInteger length(repairFrame.length);
+      QuicInteger symbolSize(repairFrame.symbolSize);
+      auto repairLength = repairFrame.repairData
+          ? repairFrame.repairData->computeChainDataLength()
+          : 0;
+      DCHECK_EQ(
+          repairLength,
+          std::min(repairFrame.length, repairFrame.symbolSize));
+      auto repairFrameSize = frameType.getSize() + streamId.getSize() +
+          offset.getSize() + length.getSize() + symbolSize.getSize() +
+          repairLength;
+      if (packetSpaceCheck(spaceLeft, repairFrameSize)) {
+        builder.write(frameType);
+        builder.write(streamId);
+        builder.write(offset);
+        builder.write(length);
+        builder.write(symbolSize);
+        if (repairFrame.repairData) {
+          builder.insert(repairFrame.repairData->clone());
+        }
+        builder.appendFrame(QuicSimpleFrame(std::move(repairFrame)));
+        return repairFrameSize;
+      }
+      // no space left in packet
+      return size_t(0);
+    }
   }
   folly::assume_unreachable();
 }
@@ -684,7 +736,6 @@ size_t writeFrame(QuicWriteFrame&& frame, PacketBuilderInterface& builder) {
       return writeSimpleFrame(std::move(*frame.asQuicSimpleFrame()), builder);
     }
     default: {
-      // TODO add support for: RETIRE_CONNECTION_ID and NEW_TOKEN frames
       auto errorStr = folly::to<std::string>(
           "Unknown / unsupported frame type received at ", __func__);
       VLOG(2) << errorStr;
@@ -392,6 +392,8 @@ std::string toString(FrameType frame) {
       return "CONNECTION_CLOSE";
     case FrameType::CONNECTION_CLOSE_APP_ERR:
       return "APPLICATION_CLOSE";
+    case FrameType::STREAM_REPAIR:
+      return "STREAM_REPAIR";
     case FrameType::MIN_STREAM_DATA:
       return "MIN_STREAM_DATA";
     case FrameType::EXPIRED_STREAM_DATA:
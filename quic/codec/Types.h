@@ -240,6 +240,34 @@ struct ReadNewTokenFrame {
   }
 };
 
+struct NewTokenFrame {
+  Buf token;
+
+  explicit NewTokenFrame(Buf tokenIn) : token(std::move(tokenIn)) {}
+
+  NewTokenFrame(NewTokenFrame&& other) = default;
+  NewTokenFrame& operator=(NewTokenFrame&& other) = default;
+
+  // Stuff stored in a variant type needs to be copyable.
+  NewTokenFrame(const NewTokenFrame& other) {
+    if (other.token) {
+      token = other.token->clone();
+    }
+  }
+
+  NewTokenFrame& operator=(const NewTokenFrame& other) {
+    if (other.token) {
+      token = other.token->clone();
+    }
+    return *this;
+  }
+
+  bool operator==(const NewTokenFrame& other) const {
+    folly::IOBufEqualTo eq;
+    return eq(token, other.token);
+  }
+};
+
 /**
  The structure of the stream frame used for writes.
  0                   1                   2                   3
@@ -547,6 +575,65 @@ struct ConnectionCloseFrame {
   }
 };
 
+/**
+ * Repair data for a range of a stream, used to recover from the loss of a
+ * packet without waiting for the retransmission. The range is cut into
+ * symbolSize byte symbols, the last one possibly shorter, and repairData is
+ * the XOR of all of them. Any bytes missing from the range can be rebuilt as
+ * long as no two of them fall at the same position within their symbols,
+ * which holds for a single lost frame no larger than a symbol.
+ */
+struct StreamRepairFrame {
+  StreamId streamId;
+  uint64_t offset;
+  uint64_t length;
+  uint64_t symbolSize;
+  // min(symbolSize, length) bytes.
+  Buf repairData;
+
+  StreamRepairFrame(
+      StreamId streamIdIn,
+      uint64_t offsetIn,
+      uint64_t lengthIn,
+      uint64_t symbolSizeIn,
+      Buf repairDataIn)
+      : streamId(streamIdIn),
+        offset(offsetIn),
+        length(lengthIn),
+        symbolSize(symbolSizeIn),
+        repairData(std::move(repairDataIn)) {}
+
+  StreamRepairFrame(StreamRepairFrame&& other) = default;
+  StreamRepairFrame& operator=(StreamRepairFrame&& other) = default;
+
+  // Stuff stored in a variant type needs to be copyable.
+  StreamRepairFrame(const StreamRepairFrame& other)
+      : streamId(other.streamId),
+        offset(other.offset),
+        length(other.length),
+        symbolSize(other.symbolSize) {
+    if (other.repairData) {
+      repairData = other.repairData->clone();
+    }
+  }
+
+  StreamRepairFrame& operator=(const StreamRepairFrame& other) {
+    streamId = other.streamId;
+    offset = other.offset;
+    length = other.length;
+    symbolSize = other.symbolSize;
+    repairData = other.repairData ? other.repairData->clone() : nullptr;
+    return *this;
+  }
+
+  bool operator==(const StreamRepairFrame& rhs) const {
+    folly::IOBufEqualTo eq;
+    return streamId == rhs.streamId && offset == rhs.offset &&
+        length == rhs.length && symbolSize == rhs.symbolSize &&
+        eq(repairData, rhs.repairData);
+  }
+};
+
 // Frame to represent ones we skip
 struct NoopFrame {
   bool operator==(const NoopFrame&) const {
@@ -570,7 +657,9 @@ struct StatelessReset {
   F(NewConnectionIdFrame, __VA_ARGS__)    \
   F(MaxStreamsFrame, __VA_ARGS__)         \
   F(RetireConnectionIdFrame, __VA_ARGS__) \
-  F(PingFrame, __VA_ARGS__)
+  F(PingFrame, __VA_ARGS__)               \
+  F(NewTokenFrame, __VA_ARGS__)           \
+  F(StreamRepairFrame, __VA_ARGS__)
 
 DECLARE_VARIANT_TYPE(QuicSimpleFrame, QUIC_SIMPLE_FRAME)
 
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/codec/QuicLbConnectionIdAlgo.h>
+
+#include <folly/portability/GTest.h>
+#include <quic/QuicException.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+QuicLbConfig makeConfig(QuicLbMode mode) {
+  QuicLbConfig config;
+  config.configId = 1;
+  config.mode = mode;
+  config.serverIdLen = 2;
+  for (size_t i = 0; i < config.key.size(); ++i) {
+    config.key[i] = i;
+  }
+  return config;
+}
+
+class QuicLbConnectionIdAlgoTest : public TestWithParam<QuicLbMode> {};
+
+TEST_P(QuicLbConnectionIdAlgoTest, EncodeParse) {
+  auto config = makeConfig(GetParam());
+  QuicLbConnectionIdAlgo algo(config);
+  QuicLbServerIdDecoder decoder(config);
+  for (uint8_t processId : {0, 1}) {
+    ServerConnectionIdParams params(0xabcd, processId, 0x42);
+    auto connId = algo.encodeConnectionId(params);
+    EXPECT_EQ(connId.size(), config.connectionIdLength());
+    EXPECT_EQ(connId.size(), algo.getConnectionIdSize());
+    EXPECT_EQ(connId.data()[0] >> 6, config.configId);
+    EXPECT_TRUE(algo.canParse(connId));
+
+    auto parsed = algo.parseConnectionId(connId);
+    EXPECT_EQ(parsed.version, config.configId);
+    EXPECT_EQ(parsed.hostId, params.hostId);
+    EXPECT_EQ(parsed.processId, params.processId);
+    EXPECT_EQ(parsed.workerId, params.workerId);
+
+    auto serverId = decoder.getServerId(connId);
+    ASSERT_TRUE(serverId.hasValue());
+    EXPECT_EQ(*serverId, std::vector<uint8_t>({0xab, 0xcd}));
+  }
+}
+
+TEST_P(QuicLbConnectionIdAlgoTest, RejectOtherConfig) {
+  auto config = makeConfig(GetParam());
+  QuicLbConnectionIdAlgo algo(config);
+  auto otherConfig = config;
+  otherConfig.configId = 2;
+  QuicLbConnectionIdAlgo otherAlgo(otherConfig);
+
+  auto connId = otherAlgo.encodeConnectionId(ServerConnectionIdParams(1, 0, 1));
+  EXPECT_FALSE(algo.canParse(connId));
+  EXPECT_FALSE(QuicLbServerIdDecoder(config).getServerId(connId).hasValue());
+  EXPECT_THROW(algo.parseConnectionId(connId), QuicInternalException);
+
+  ConnectionId shortConnId(std::vector<uint8_t>{0x43, 0, 0, 1});
+  EXPECT_FALSE(algo.canParse(shortConnId));
+}
+
+INSTANTIATE_TEST_CASE_P(
+    QuicLbConnectionIdAlgoTests,
+    QuicLbConnectionIdAlgoTest,
+    Values(
+        QuicLbMode::Plaintext,
+        QuicLbMode::StreamCipher,
+        QuicLbMode::BlockCipher));
+
+TEST(QuicLbConnectionIdAlgoTest, PlaintextServerIdVisible) {
+  auto config = makeConfig(QuicLbMode::Plaintext);
+  QuicLbConnectionIdAlgo algo(config);
+  auto connId = algo.encodeConnectionId(ServerConnectionIdParams(0x1234, 0, 7));
+  EXPECT_EQ(connId.data()[1], 0x12);
+  EXPECT_EQ(connId.data()[2], 0x34);
+  EXPECT_EQ(connId.data()[3], 7);
+}
+
+TEST(QuicLbConnectionIdAlgoTest, EncryptedServerIdHidden) {
+  for (auto mode : {QuicLbMode::StreamCipher, QuicLbMode::BlockCipher}) {
+    auto config = makeConfig(mode);
+    QuicLbConnectionIdAlgo algo(config);
+    ServerConnectionIdParams params(0x1234, 0, 7);
+    auto connId1 = algo.encodeConnectionId(params);
+    auto connId2 = algo.encodeConnectionId(params);
+    EXPECT_NE(connId1, connId2);
+
+    auto wrongKey = config;
+    wrongKey.key[0] ^= 0xff;
+    auto serverId = QuicLbServerIdDecoder(wrongKey).getServerId(connId1);
+    ASSERT_TRUE(serverId.hasValue());
+    EXPECT_NE(*serverId, std::vector<uint8_t>({0x12, 0x34}));
+  }
+}
+
+TEST(QuicLbConnectionIdAlgoTest, ServerIdLength) {
+  auto config = makeConfig(QuicLbMode::StreamCipher);
+  config.serverIdLen = 1;
+  QuicLbConnectionIdAlgo algo(config);
+  auto connId = algo.encodeConnectionId(ServerConnectionIdParams(0x12, 1, 3));
+  EXPECT_EQ(connId.size(), 1 + config.nonceLen + 1 + kQuicLbServerUseLength);
+  EXPECT_EQ(algo.parseConnectionId(connId).hostId, 0x12);
+  EXPECT_THROW(
+      algo.encodeConnectionId(ServerConnectionIdParams(0x1234, 0, 0)),
+      QuicInternalException);
+
+  config.serverIdLen = 4;
+  QuicLbConnectionIdAlgo wideAlgo(config);
+  auto wideConnId =
+      wideAlgo.encodeConnectionId(ServerConnectionIdParams(0x1234, 0, 3));
+  auto serverId = QuicLbServerIdDecoder(config).getServerId(wideConnId);
+  ASSERT_TRUE(serverId.hasValue());
+  EXPECT_EQ(*serverId, std::vector<uint8_t>({0, 0, 0x12, 0x34}));
+}
+
+TEST(QuicLbConnectionIdAlgoTest, InvalidConfig) {
+  auto config = makeConfig(QuicLbMode::Plaintext);
+  config.configId = kQuicLbUnroutableConfigId;
+  EXPECT_THROW(config.validate(), QuicInternalException);
+
+  config = makeConfig(QuicLbMode::Plaintext);
+  config.plaintextConnectionIdLen = 4;
+  EXPECT_THROW(config.validate(), QuicInternalException);
+
+  config = makeConfig(QuicLbMode::StreamCipher);
+  config.nonceLen = 4;
+  EXPECT_THROW(config.validate(), QuicInternalException);
+
+  // 1 + 16 + 2 + 2 bytes exceeds the maximum connection id length.
+  config.nonceLen = 16;
+  EXPECT_THROW(config.validate(), QuicInternalException);
+
+  config = makeConfig(QuicLbMode::BlockCipher);
+  config.serverIdLen = 15;
+  EXPECT_THROW(config.validate(), QuicInternalException);
+  EXPECT_THROW(QuicLbConnectionIdAlgoFactory{config}, QuicInternalException);
+}
+} // namespace test
+} // namespace quic
@@ -1388,6 +1388,77 @@ TEST_F(QuicWriteCodecTest, WriteRetireConnId) {
   EXPECT_EQ(queue.chainLength(), 0);
 }
 
+TEST_F(QuicWriteCodecTest, WriteNewToken) {
+  MockQuicPacketBuilder pktBuilder;
+  setupCommonExpects(pktBuilder);
+  NewTokenFrame newToken(folly::IOBuf::copyBuffer("address token"));
+  auto bytesWritten = writeFrame(QuicSimpleFrame(newToken), pktBuilder);
+
+  auto builtOut = std::move(pktBuilder).buildPacket();
+  auto regularPacket = builtOut.first;
+  // 1 byte for the type, 1 for the length and 13 for the token.
+  EXPECT_EQ(bytesWritten, 15);
+  NewTokenFrame resultNewTokenFrame =
+      *regularPacket.frames[0].asQuicSimpleFrame()->asNewTokenFrame();
+  EXPECT_EQ(resultNewTokenFrame, newToken);
+
+  auto wireBuf = std::move(builtOut.second);
+  BufQueue queue;
+  queue.append(wireBuf->clone());
+  QuicFrame decodedFrame = parseQuicFrame(queue);
+  ReadNewTokenFrame& wireNewTokenFrame = *decodedFrame.asReadNewTokenFrame();
+  EXPECT_EQ(
+      wireNewTokenFrame.token->moveToFbString().toStdString(), "address token");
+  EXPECT_EQ(queue.chainLength(), 0);
+}
+
+TEST_F(QuicWriteCodecTest, NoSpaceForNewToken) {
+  MockQuicPacketBuilder pktBuilder;
+  pktBuilder.remaining_ = 14;
+  setupCommonExpects(pktBuilder);
+  NewTokenFrame newToken(folly::IOBuf::copyBuffer("address token"));
+  EXPECT_EQ(0, writeFrame(QuicSimpleFrame(newToken), pktBuilder));
+}
+
+TEST_F(QuicWriteCodecTest, WriteStreamRepair) {
+  MockQuicPacketBuilder pktBuilder;
+  setupCommonExpects(pktBuilder);
+  StreamRepairFrame repair(
+      4 /* streamId */,
+      100 /* offset */,
+      30 /* length */,
+      10 /* symbolSize */,
+      folly::IOBuf::copyBuffer("0123456789"));
+  auto bytesWritten = writeFrame(QuicSimpleFrame(repair), pktBuilder);
+
+  auto builtOut = std::move(pktBuilder).buildPacket();
+  auto regularPacket = builtOut.first;
+  // 1 byte for the type, 1 each for the stream id, length and symbol size,
+  // 2 for the offset and 10 for the repair data.
+  EXPECT_EQ(bytesWritten, 16);
+  StreamRepairFrame resultRepairFrame =
+      *regularPacket.frames[0].asQuicSimpleFrame()->asStreamRepairFrame();
+  EXPECT_EQ(resultRepairFrame, repair);
+
+  auto wireBuf = std::move(builtOut.second);
+  BufQueue queue;
+  queue.append(wireBuf->clone());
+  QuicFrame decodedFrame = parseQuicFrame(queue);
+  StreamRepairFrame& wireRepairFrame =
+      *decodedFrame.asQuicSimpleFrame()->asStreamRepairFrame();
+  EXPECT_EQ(wireRepairFrame, repair);
+  EXPECT_EQ(queue.chainLength(), 0);
+}
+
+TEST_F(QuicWriteCodecTest, NoSpaceForStreamRepair) {
+  MockQuicPacketBuilder pktBuilder;
+  pktBuilder.remaining_ = 15;
+  setupCommonExpects(pktBuilder);
+  StreamRepairFrame repair(
+      4, 100, 30, 10, folly::IOBuf::copyBuffer("0123456789"));
+  EXPECT_EQ(0, writeFrame(QuicSimpleFrame(repair), pktBuilder));
+}
+
 TEST_F(QuicWriteCodecTest, WriteStopSending) {
   MockQuicPacketBuilder pktBuilder;
   setupCommonExpects(pktBuilder);
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+namespace quic {
+
+/**
+ * Frees the memory an empty container still holds on to, such as the bucket
+ * array of a hash map or the blocks of a deque, which clear() and
+ * shrink_to_fit() leave in place.
+ */
+template <typename Container>
+void releaseIfEmpty(Container& container) {
+  if (container.empty()) {
+    Container().swap(container);
+  }
+}
+
+} // namespace quic
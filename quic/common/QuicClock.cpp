@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/common/QuicClock.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QUIC_HAS_TSC
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace quic {
+
+#ifdef QUIC_HAS_TSC
+namespace {
+
+struct TscCalibration {
+  bool invariant{false};
+  // Nanoseconds per tick, in 32.32 fixed point.
+  uint64_t nanosPerTick{0};
+  // Ticks after which a thread re-anchors to the steady clock.
+  uint64_t reanchorTicks{0};
+};
+
+struct TscAnchor {
+  bool set{false};
+  uint64_t ticks{0};
+  TimePoint time;
+  TimePoint lastTime;
+};
+
+bool hasInvariantTsc() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return edx & (1u << 8);
+}
+
+TscCalibration calibrate() {
+  TscCalibration calibration;
+  if (!hasInvariantTsc()) {
+    return calibration;
+  }
+  auto startTime = Clock::now();
+  auto startTicks = __rdtsc();
+  auto endTime = startTime;
+  while (endTime - startTime < kTscCalibrationDuration) {
+    endTime = Clock::now();
+  }
+  auto ticks = __rdtsc() - startTicks;
+  auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   endTime - startTime)
+                   .count();
+  if (ticks == 0) {
+    return calibration;
+  }
+  auto nanosPerTick = (static_cast<unsigned __int128>(nanos) << 32) / ticks;
+  if (nanosPerTick == 0) {
+    return calibration;
+  }
+  calibration.invariant = true;
+  calibration.nanosPerTick = static_cast<uint64_t>(nanosPerTick);
+  auto reanchorNanos =
+      std::chrono::nanoseconds(kTscReanchorInterval).count();
+  calibration.reanchorTicks = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(reanchorNanos) << 32) / nanosPerTick);
+  return calibration;
+}
+
+const TscCalibration& getCalibration() {
+  static const TscCalibration calibration = calibrate();
+  return calibration;
+}
+
+} // namespace
+#endif
+
+bool TscClock::available() {
+#ifdef QUIC_HAS_TSC
+  return getCalibration().invariant;
+#else
+  return false;
+#endif
+}
+
+TimePoint TscClock::now() {
+#ifdef QUIC_HAS_TSC
+  const auto& calibration = getCalibration();
+  if (!calibration.invariant) {
+    return Clock::now();
+  }
+  static thread_local TscAnchor anchor;
+  auto ticks = __rdtsc();
+  // A thread moved to a core whose counter is behind also re-anchors, as the
+  // difference wraps around.
+  if (!anchor.set || ticks - anchor.ticks >= calibration.reanchorTicks) {
+    anchor.set = true;
+    anchor.time = Clock::now();
+    anchor.ticks = ticks = __rdtsc();
+  }
+  auto nanos = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(ticks - anchor.ticks) *
+       calibration.nanosPerTick) >>
+      32);
+  auto time = anchor.time +
+      std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::nanoseconds(nanos));
+  // Re-anchoring can move time back by the error of the measured rate.
+  if (time < anchor.lastTime) {
+    time = anchor.lastTime;
+  }
+  anchor.lastTime = time;
+  return time;
+#else
+  return Clock::now();
+#endif
+}
+
+TimePoint LoopCachedClock::now() {
+  if (!evb_) {
+    return Clock::now();
+  }
+  if (!cachedTime_) {
+    cachedTime_ = Clock::now();
+    evb_->runInLoop(this, true /* thisIteration */);
+  }
+  return *cachedTime_;
+}
+
+void LoopCachedClock::attachEventBase(folly::EventBase* evb) {
+  DCHECK(!evb_);
+  DCHECK(evb);
+  evb_ = evb;
+}
+
+void LoopCachedClock::detachEventBase() {
+  cancelLoopCallback();
+  cachedTime_.clear();
+  evb_ = nullptr;
+}
+
+void LoopCachedClock::runLoopCallback() noexcept {
+  cachedTime_.clear();
+}
+
+} // namespace quic
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/io/async/EventBase.h>
+
+#include <quic/QuicConstants.h>
+
+namespace quic {
+
+/**
+ * Steady clock time taken from the CPU's time stamp counter, which is much
+ * cheaper to read than the steady clock.
+ *
+ * The counter rate is measured against the steady clock once per process.
+ * Each thread anchors its readings to the steady clock every
+ * kTscReanchorInterval, so the error from the measured rate stays small, and
+ * times returned on a thread never go backwards.
+ */
+class TscClock {
+ public:
+  /**
+   * Whether the CPU has a constant rate TSC. When it does not, now() reads
+   * the steady clock.
+   */
+  static bool available();
+
+  static TimePoint now();
+};
+
+/**
+ * Caches the steady clock time for the rest of an event loop iteration.
+ *
+ * The first now() in an iteration reads the clock and schedules a loop
+ * callback that drops the cached time at the end of the iteration. Without
+ * an event base every now() reads the clock.
+ */
+class LoopCachedClock : private folly::EventBase::LoopCallback {
+ public:
+  LoopCachedClock() = default;
+
+  TimePoint now();
+
+  /**
+   * The clock must then only be used on the event base's thread.
+   */
+  void attachEventBase(folly::EventBase* evb);
+
+  void detachEventBase();
+
+ private:
+  void runLoopCallback() noexcept override;
+
+  folly::EventBase* evb_{nullptr};
+  folly::Optional<TimePoint> cachedTime_;
+};
+
+/**
+ * Time source of a connection. Both kinds of time default to the steady
+ * clock, and are switched by the transport settings.
+ */
+class TransportClock {
+ public:
+  /**
+   * For uses that tolerate time as old as the start of the current event
+   * loop iteration, such as flow control updates, pacing and idle
+   * bookkeeping.
+   */
+  TimePoint coarseNow() {
+    return useLoopCache_ ? loopClock_.now() : Clock::now();
+  }
+
+  /**
+   * For packet send and receive times, and the measurements derived from
+   * them.
+   */
+  TimePoint packetNow() const {
+    return packetClock_ == PacketTimestampClock::Tsc ? TscClock::now()
+                                                     : Clock::now();
+  }
+
+  void setUseLoopCache(bool useLoopCache) {
+    useLoopCache_ = useLoopCache;
+  }
+
+  void setPacketTimestampClock(PacketTimestampClock packetClock) {
+    packetClock_ = packetClock;
+  }
+
+  void attachEventBase(folly::EventBase* evb) {
+    loopClock_.attachEventBase(evb);
+  }
+
+  void detachEventBase() {
+    loopClock_.detachEventBase();
+  }
+
+ private:
+  LoopCachedClock loopClock_;
+  bool useLoopCache_{false};
+  PacketTimestampClock packetClock_{PacketTimestampClock::Steady};
+};
+
+} // namespace quic
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/common/SocketTuning.h>
+
+#ifdef __linux__
+#include <linux/sock_diag.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace quic {
+
+bool enableReceiveDropReporting(int fd) {
+#ifdef SO_RXQ_OVFL
+  int enable = 1;
+  return ::setsockopt(
+             fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) == 0;
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+folly::Optional<uint32_t> getReceiveDropCount(const struct msghdr& msg) {
+#ifdef SO_RXQ_OVFL
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+       cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&msg), cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL &&
+        cmsg->cmsg_len >= CMSG_LEN(sizeof(uint32_t))) {
+      uint32_t drops;
+      memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+      return drops;
+    }
+  }
+#else
+  (void)msg;
+#endif
+  return folly::none;
+}
+
+folly::Optional<uint32_t> readSocketDropCount(int fd) {
+#if defined(SO_MEMINFO) && defined(SK_MEMINFO_DROPS)
+  uint32_t meminfo[SK_MEMINFO_VARS] = {};
+  socklen_t len = sizeof(meminfo);
+  if (::getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo, &len) != 0 ||
+      len <= SK_MEMINFO_DROPS * sizeof(uint32_t)) {
+    return folly::none;
+  }
+  return meminfo[SK_MEMINFO_DROPS];
+#else
+  (void)fd;
+  return folly::none;
+#endif
+}
+
+bool setSocketReceiveBuffer(int fd, uint32_t size) {
+  int value = size;
+  return ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, sizeof(value)) == 0;
+}
+
+folly::Optional<uint32_t> getSocketReceiveBuffer(int fd) {
+  int value = 0;
+  socklen_t len = sizeof(value);
+  if (::getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, &len) != 0) {
+    return folly::none;
+  }
+#ifdef __linux__
+  // Linux reports twice the requested size, to account for its overhead.
+  value /= 2;
+#endif
+  return value;
+}
+
+ReceiveBufferSizer::ReceiveBufferSizer(
+    uint32_t minSize,
+    uint32_t maxSize,
+    uint32_t current)
+    : minSize_(minSize),
+      maxSize_(std::max(minSize, maxSize)),
+      size_(std::min(std::max(current, minSize_), maxSize_)) {}
+
+void ReceiveBufferSizer::onReadBurst(uint64_t bytes) {
+  largestBurst_ = std::max(largestBurst_, bytes);
+}
+
+void ReceiveBufferSizer::onDrops(uint64_t drops) {
+  drops_ += drops;
+}
+
+folly::Optional<uint32_t> ReceiveBufferSizer::nextSize() {
+  uint64_t fit = largestBurst_ * kSocketReceiveBufferBursts;
+  uint64_t target = size_;
+  if (drops_ > 0) {
+    target = std::max<uint64_t>(fit, uint64_t(size_) * 2);
+  } else if (fit > size_) {
+    target = fit;
+  } else if (fit * 2 < size_) {
+    target = size_ / 2;
+  }
+  target = std::min<uint64_t>(std::max<uint64_t>(target, minSize_), maxSize_);
+  largestBurst_ = 0;
+  drops_ = 0;
+  if (target == size_) {
+    return folly::none;
+  }
+  size_ = target;
+  return size_;
+}
+
+} // namespace quic
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/portability/Sockets.h>
+
+#include <quic/QuicConstants.h>
+
+#include <cstddef>
+
+namespace quic {
+
+/**
+ * Control message space for a received datagram, big enough for the counters
+ * enabled by enableReceiveDropReporting.
+ */
+struct ReceiveControlBuffer {
+  alignas(alignof(struct cmsghdr)) char data[64];
+};
+
+/**
+ * Asks the kernel to attach its count of dropped datagrams (SO_RXQ_OVFL) to
+ * every datagram read from fd. Returns false where that is not supported.
+ */
+bool enableReceiveDropReporting(int fd);
+
+/**
+ * Finds the drop count attached by SO_RXQ_OVFL in a received message.
+ */
+folly::Optional<uint32_t> getReceiveDropCount(const struct msghdr& msg);
+
+/**
+ * Reads the number of datagrams the kernel dropped for fd so far, from
+ * SO_MEMINFO. Works on sockets read without control messages.
+ */
+folly::Optional<uint32_t> readSocketDropCount(int fd);
+
+bool setSocketReceiveBuffer(int fd, uint32_t size);
+
+folly::Optional<uint32_t> getSocketReceiveBuffer(int fd);
+
+/**
+ * Turns the cumulative, wrapping drop counts reported by the kernel into
+ * the number of new drops.
+ */
+class KernelDropCounter {
+ public:
+  enum class Source {
+    // Counts attached to datagrams through SO_RXQ_OVFL. The kernel only
+    // attaches one once it dropped something, so counting starts from zero.
+    ControlMessage,
+    // Counts polled through SO_MEMINFO. The first count read is taken as the
+    // baseline, since it holds every drop since the socket was created.
+    SocketPoll,
+  };
+
+  explicit KernelDropCounter(Source source) : source_(source) {
+    reset();
+  }
+
+  uint64_t update(uint32_t total) {
+    uint32_t drops = last_ ? total - *last_ : 0;
+    last_ = total;
+    return drops;
+  }
+
+  /**
+   * Starts counting again, for a new socket or a different source.
+   */
+  void reset(Source source) {
+    source_ = source;
+    reset();
+  }
+
+  void reset() {
+    if (source_ == Source::ControlMessage) {
+      last_ = 0;
+    } else {
+      last_ = folly::none;
+    }
+  }
+
+  Source getSource() const {
+    return source_;
+  }
+
+ private:
+  Source source_;
+  folly::Optional<uint32_t> last_;
+};
+
+/**
+ * Sizes a socket's receive buffer to fit the largest bursts read from it,
+ * and doubles it when the kernel drops datagrams. Once the bursts fit in
+ * less than half of the buffer, it is halved in each period without drops.
+ */
+class ReceiveBufferSizer {
+ public:
+  ReceiveBufferSizer(uint32_t minSize, uint32_t maxSize, uint32_t current);
+
+  void onReadBurst(uint64_t bytes);
+
+  void onDrops(uint64_t drops);
+
+  /**
+   * Returns the size the buffer should have from now on, if it should
+   * change. Closes the current observation period.
+   */
+  folly::Optional<uint32_t> nextSize();
+
+  uint32_t getSize() const {
+    return size_;
+  }
+
+ private:
+  uint32_t minSize_;
+  uint32_t maxSize_;
+  uint32_t size_;
+  uint64_t largestBurst_{0};
+  uint64_t drops_{0};
+};
+
+} // namespace quic
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/common/QuicClock.h>
+
+#include <folly/portability/GTest.h>
+
+#include <thread>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+TEST(QuicClockTest, TscFollowsSteadyClock) {
+  auto before = Clock::now();
+  auto tscTime = TscClock::now();
+  auto after = Clock::now();
+  // Allow for the error of the measured counter rate.
+  EXPECT_GE(tscTime, before - 1ms);
+  EXPECT_LE(tscTime, after + 1ms);
+
+  auto last = tscTime;
+  for (int i = 0; i < 1000; ++i) {
+    auto now = TscClock::now();
+    EXPECT_GE(now, last);
+    last = now;
+  }
+}
+
+TEST(QuicClockTest, LoopCachedClockWithoutEventBase) {
+  LoopCachedClock clock;
+  auto first = clock.now();
+  std::this_thread::sleep_for(1ms);
+  EXPECT_GT(clock.now(), first);
+}
+
+TEST(QuicClockTest, LoopCachedClockRefreshesEachIteration) {
+  folly::EventBase evb;
+  LoopCachedClock clock;
+  clock.attachEventBase(&evb);
+  auto first = clock.now();
+  std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(clock.now(), first);
+
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  auto second = clock.now();
+  EXPECT_GT(second, first);
+
+  clock.detachEventBase();
+  std::this_thread::sleep_for(1ms);
+  EXPECT_GT(clock.now(), second);
+}
+
+TEST(QuicClockTest, TransportClockDefaultsToSteadyClock) {
+  folly::EventBase evb;
+  TransportClock clock;
+  clock.attachEventBase(&evb);
+  auto first = clock.coarseNow();
+  std::this_thread::sleep_for(1ms);
+  EXPECT_GT(clock.coarseNow(), first);
+
+  clock.setUseLoopCache(true);
+  auto cached = clock.coarseNow();
+  std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(clock.coarseNow(), cached);
+  EXPECT_GT(clock.packetNow(), cached);
+
+  clock.setPacketTimestampClock(PacketTimestampClock::Tsc);
+  EXPECT_GT(clock.packetNow(), cached);
+}
+
+} // namespace test
+} // namespace quic
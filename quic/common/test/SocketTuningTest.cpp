@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/common/SocketTuning.h>
+
+using namespace quic;
+
+TEST(KernelDropCounter, Deltas) {
+  KernelDropCounter counter(KernelDropCounter::Source::SocketPoll);
+  EXPECT_EQ(counter.update(0), 0);
+  EXPECT_EQ(counter.update(5), 5);
+  EXPECT_EQ(counter.update(5), 0);
+  EXPECT_EQ(counter.update(12), 7);
+
+  counter.update(std::numeric_limits<uint32_t>::max() - 1);
+  EXPECT_EQ(counter.update(2), 4);
+
+  // Drops from before the first reading are not counted.
+  counter.reset();
+  EXPECT_EQ(counter.update(3), 0);
+  EXPECT_EQ(counter.update(5), 2);
+}
+
+TEST(KernelDropCounter, FirstReadingIsBaseline) {
+  KernelDropCounter counter(KernelDropCounter::Source::SocketPoll);
+  EXPECT_EQ(counter.update(1000), 0);
+  EXPECT_EQ(counter.update(1004), 4);
+}
+
+TEST(KernelDropCounter, ControlMessagesCountFromZero) {
+  // The first control message only arrives once there were drops, and those
+  // drops are counted.
+  KernelDropCounter counter(KernelDropCounter::Source::ControlMessage);
+  EXPECT_EQ(counter.update(3), 3);
+  EXPECT_EQ(counter.update(5), 2);
+
+  counter.reset();
+  EXPECT_EQ(counter.update(4), 4);
+
+  counter.reset(KernelDropCounter::Source::SocketPoll);
+  EXPECT_EQ(counter.update(10), 0);
+  EXPECT_EQ(counter.update(11), 1);
+}
+
+TEST(ReceiveBufferSizer, GrowsWithBursts) {
+  ReceiveBufferSizer sizer(1000, 16000, 4000);
+  sizer.onReadBurst(500);
+  EXPECT_FALSE(sizer.nextSize().hasValue());
+
+  sizer.onReadBurst(2000);
+  sizer.onReadBurst(100);
+  EXPECT_EQ(sizer.nextSize(), 8000u);
+  EXPECT_EQ(sizer.getSize(), 8000);
+
+  sizer.onReadBurst(100000);
+  EXPECT_EQ(sizer.nextSize(), 16000u);
+}
+
+TEST(ReceiveBufferSizer, GrowsOnDrops) {
+  ReceiveBufferSizer sizer(1000, 16000, 4000);
+  sizer.onReadBurst(100);
+  sizer.onDrops(3);
+  EXPECT_EQ(sizer.nextSize(), 8000u);
+
+  // Drops are counted per period.
+  sizer.onReadBurst(1500);
+  EXPECT_FALSE(sizer.nextSize().hasValue());
+
+  sizer.onDrops(1);
+  EXPECT_EQ(sizer.nextSize(), 16000u);
+  sizer.onDrops(1);
+  EXPECT_FALSE(sizer.nextSize().hasValue());
+}
+
+TEST(ReceiveBufferSizer, ShrinksByHalves) {
+  ReceiveBufferSizer sizer(1000, 16000, 100000);
+  EXPECT_EQ(sizer.getSize(), 16000);
+  EXPECT_EQ(sizer.nextSize(), 8000u);
+  EXPECT_EQ(sizer.nextSize(), 4000u);
+
+  // Bursts using half the buffer keep it.
+  sizer.onReadBurst(500);
+  EXPECT_FALSE(sizer.nextSize().hasValue());
+
+  EXPECT_EQ(sizer.nextSize(), 2000u);
+  EXPECT_EQ(sizer.nextSize(), 1000u);
+  EXPECT_FALSE(sizer.nextSize().hasValue());
+}
+
+#ifdef SO_RXQ_OVFL
+TEST(SocketTuning, ReceiveDropCountFromControlMessage) {
+  ReceiveControlBuffer control;
+  struct msghdr msg {};
+  EXPECT_FALSE(getReceiveDropCount(msg).hasValue());
+
+  msg.msg_control = control.data;
+  msg.msg_controllen = CMSG_SPACE(sizeof(uint32_t));
+  auto cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SO_RXQ_OVFL;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint32_t));
+  uint32_t drops = 42;
+  memcpy(CMSG_DATA(cmsg), &drops, sizeof(drops));
+  EXPECT_EQ(getReceiveDropCount(msg), 42u);
+}
+#endif
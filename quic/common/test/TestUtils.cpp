@@ -13,6 +13,7 @@
 #include <fizz/protocol/test/Mocks.h>
 #include <quic/api/QuicTransportFunctions.h>
 #include <quic/codec/DefaultConnectionIdAlgo.h>
+#include <quic/fizz/handshake/FizzCertCompression.h>
 #include <quic/fizz/handshake/QuicFizzFactory.h>
 #include <quic/handshake/test/Mocks.h>
 #include <quic/server/handshake/StatelessResetGenerator.h>
@@ -43,7 +44,7 @@ const RegularQuicWritePacket& writeQuicPacket(
       *aead,
       *headerCipher,
       version,
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
   CHECK(
       conn.outstandingPackets.rend() !=
       getLastOutstandingPacket(conn, PacketNumberSpace::AppData));
@@ -67,7 +68,7 @@ PacketNum rstStreamAndSendPacket(
       *aead,
       *headerCipher,
       version,
-      conn.transportSettings.writeConnectionDataPacketsLimit);
+      conn.transportSettings->writeConnectionDataPacketsLimit);
 
   for (const auto& packet : conn.outstandingPackets) {
     for (const auto& frame : packet.packet.frames) {
@@ -125,27 +126,36 @@ RegularQuicPacketBuilder::Packet createAckPacket(
   }
   DCHECK(builder.canBuildPacket());
   AckFrameMetaData ackData(
-      acks, 0us, dstConn.transportSettings.ackDelayExponent);
+      acks, 0us, dstConn.transportSettings->ackDelayExponent);
   writeAckFrame(ackData, builder);
   return std::move(builder).buildPacket();
 }
 
-std::shared_ptr<fizz::SelfCert> readCert() {
+std::shared_ptr<fizz::SelfCert> readCert(
+    const std::vector<fizz::CertificateCompressionAlgorithm>&
+        certCompressionAlgos = {}) {
   auto certificate = fizz::test::getCert(fizz::test::kP256Certificate);
   auto privKey = fizz::test::getPrivateKey(fizz::test::kP256Key);
   std::vector<folly::ssl::X509UniquePtr> certs;
   certs.emplace_back(std::move(certificate));
+  if (!certCompressionAlgos.empty()) {
+    return createCompressibleSelfCert(
+        std::move(privKey), std::move(certs), certCompressionAlgos);
+  }
   return std::make_shared<fizz::SelfCertImpl<fizz::KeyType::P256>>(
       std::move(privKey), std::move(certs));
 }
 
-std::shared_ptr<fizz::server::FizzServerContext> createServerCtx() {
-  auto cert = readCert();
+std::shared_ptr<fizz::server::FizzServerContext> createServerCtx(
+    const std::vector<fizz::CertificateCompressionAlgorithm>&
+        certCompressionAlgos) {
+  auto cert = readCert(certCompressionAlgos);
   auto certManager = std::make_unique<fizz::server::CertManager>();
   certManager->addCert(std::move(cert), true);
   auto serverCtx = std::make_shared<fizz::server::FizzServerContext>();
   serverCtx->setFactory(std::make_shared<QuicFizzFactory>());
   serverCtx->setCertManager(std::move(certManager));
+  serverCtx->setSupportedCompressionAlgorithms(certCompressionAlgos);
   serverCtx->setOmitEarlyRecordLayer(true);
   serverCtx->setClock(std::make_shared<fizz::test::MockClock>());
   return serverCtx;
@@ -351,9 +361,15 @@ RegularQuicPacketBuilder::Packet createInitialCryptoPacket(
     folly::IOBuf& data,
     const Aead& aead,
     PacketNum largestAcked,
-    uint64_t offset) {
+    uint64_t offset,
+    const std::string& token) {
   LongHeader header(
-      LongHeader::Types::Initial, srcConnId, dstConnId, packetNum, version);
+      LongHeader::Types::Initial,
+      srcConnId,
+      dstConnId,
+      packetNum,
+      version,
+      token);
   RegularQuicPacketBuilder builder(
       kDefaultUDPSendPacketLen, std::move(header), largestAcked);
   builder.setCipherOverhead(aead.getCipherOverhead());
@@ -91,7 +91,8 @@ RegularQuicPacketBuilder::Packet createInitialCryptoPacket(
     folly::IOBuf& data,
     const Aead& aead,
     PacketNum largestAcked,
-    uint64_t offset = 0);
+    uint64_t offset = 0,
+    const std::string& token = std::string());
 
 RegularQuicPacketBuilder::Packet createCryptoPacket(
     ConnectionId srcConnId,
@@ -121,7 +122,10 @@ bool isState(const S& s) {
       [](const auto&) { return false; });
 }
 
-std::shared_ptr<fizz::server::FizzServerContext> createServerCtx();
+// certCompressionAlgos enables RFC 8879 compression of the test cert.
+std::shared_ptr<fizz::server::FizzServerContext> createServerCtx(
+    const std::vector<fizz::CertificateCompressionAlgorithm>&
+        certCompressionAlgos = {});
 
 void setupCtxWithTestCert(fizz::server::FizzServerContext& ctx);
 
@@ -30,13 +30,13 @@ namespace quic {
 
 BbrCongestionController::BbrCongestionController(QuicConnectionStateBase& conn)
     : conn_(conn),
-      cwnd_(conn.udpSendPacketLen * conn.transportSettings.initCwndInMss),
+      cwnd_(conn.udpSendPacketLen * conn.transportSettings->initCwndInMss),
       initialCwnd_(
-          conn.udpSendPacketLen * conn.transportSettings.initCwndInMss),
+          conn.udpSendPacketLen * conn.transportSettings->initCwndInMss),
       recoveryWindow_(
-          conn.udpSendPacketLen * conn.transportSettings.maxCwndInMss),
+          conn.udpSendPacketLen * conn.transportSettings->maxCwndInMss),
       pacingWindow_(
-          conn.udpSendPacketLen * conn.transportSettings.initCwndInMss),
+          conn.udpSendPacketLen * conn.transportSettings->initCwndInMss),
       // TODO: experiment with longer window len for ack aggregation filter
       maxAckHeightFilter_(kBandwidthWindowLength, 0, 0) {
   QUIC_TRACE(initcwnd, conn_, initialCwnd_);
@@ -77,7 +77,7 @@ void BbrCongestionController::onPacketLoss(
     recoveryWindow_ = boundedCwnd(
         recoveryWindow_,
         conn_.udpSendPacketLen,
-        conn_.transportSettings.maxCwndInMss,
+        conn_.transportSettings->maxCwndInMss,
         kMinCwndInMssForBbr);
 
     // We need to make sure CONSERVATIVE can last for a round trip, so update
@@ -313,7 +313,7 @@ void BbrCongestionController::handleAckInProbeBw(
   if (shouldAdvancePacingGainCycle) {
     pacingCycleIndex_ = (pacingCycleIndex_ + 1) % kNumOfCycles;
     cycleStart_ = ackTime;
-    if (conn_.transportSettings.bbrConfig.drainToTarget && pacingGain_ < 1.0 &&
+    if (conn_.transportSettings->bbrConfig.drainToTarget && pacingGain_ < 1.0 &&
         kPacingGainCycles[pacingCycleIndex_] == 1.0) {
       auto drainTarget =
           targetCwndCache ? *targetCwndCache : calculateTargetCwnd(1.0);
@@ -338,7 +338,7 @@ bool BbrCongestionController::shouldExitDrain() noexcept {
 }
 
 bool BbrCongestionController::shouldProbeRtt(TimePoint ackTime) noexcept {
-  if (conn_.transportSettings.bbrConfig.probeRttDisabledIfAppLimited &&
+  if (conn_.transportSettings->bbrConfig.probeRttDisabledIfAppLimited &&
       appLimitedSinceProbeRtt_) {
     minRttSampler_->timestampMinRtt(ackTime);
     return false;
@@ -433,7 +433,7 @@ void BbrCongestionController::updateRecoveryWindowWithAck(
   }
 
   uint64_t recoveryIncrease =
-      conn_.transportSettings.bbrConfig.conservativeRecovery
+      conn_.transportSettings->bbrConfig.conservativeRecovery
       ? conn_.udpSendPacketLen
       : bytesAcked;
   recoveryWindow_ =
@@ -441,7 +441,7 @@ void BbrCongestionController::updateRecoveryWindowWithAck(
   recoveryWindow_ = boundedCwnd(
       recoveryWindow_,
       conn_.udpSendPacketLen,
-      conn_.transportSettings.maxCwndInMss,
+      conn_.transportSettings->maxCwndInMss,
       kMinCwndInMssForBbr);
 }
 
@@ -497,7 +497,7 @@ void BbrCongestionController::updateCwnd(
   auto targetCwnd = calculateTargetCwnd(cwndGain_);
   if (btlbwFound_) {
     targetCwnd += maxAckHeightFilter_.GetBest();
-  } else if (conn_.transportSettings.bbrConfig.enableAckAggregationInStartup) {
+  } else if (conn_.transportSettings->bbrConfig.enableAckAggregationInStartup) {
     targetCwnd += excessiveBytes;
   }
 
@@ -513,7 +513,7 @@ void BbrCongestionController::updateCwnd(
   cwnd_ = boundedCwnd(
       cwnd_,
       conn_.udpSendPacketLen,
-      conn_.transportSettings.maxCwndInMss,
+      conn_.transportSettings->maxCwndInMss,
       kMinCwndInMssForBbr);
 }
 
@@ -550,11 +550,11 @@ bool BbrCongestionController::isAppLimited() const noexcept {
 
 uint64_t BbrCongestionController::getCongestionWindow() const noexcept {
   if (state_ == BbrCongestionController::BbrState::ProbeRtt) {
-    if (conn_.transportSettings.bbrConfig.largeProbeRttCwnd) {
+    if (conn_.transportSettings->bbrConfig.largeProbeRttCwnd) {
       return boundedCwnd(
           calculateTargetCwnd(kLargeProbeRttCwndGain),
           conn_.udpSendPacketLen,
-          conn_.transportSettings.maxCwndInMss,
+          conn_.transportSettings->maxCwndInMss,
           kMinCwndInMssForBbr);
     }
     return conn_.udpSendPacketLen * kMinCwndInMssForBbr;
@@ -12,6 +12,7 @@
 #include <quic/congestion_control/BbrBandwidthSampler.h>
 #include <quic/congestion_control/BbrRttSampler.h>
 #include <quic/congestion_control/Copa.h>
+#include <quic/congestion_control/Ledbat.h>
 #include <quic/congestion_control/NewReno.h>
 #include <quic/congestion_control/QuicCubic.h>
 
@@ -33,6 +34,9 @@ DefaultCongestionControllerFactory::makeCongestionController(
     case CongestionControlType::Copa:
       congestionController = std::make_unique<Copa>(conn);
       break;
+    case CongestionControlType::Ledbat:
+      congestionController = std::make_unique<Ledbat>(conn);
+      break;
     case CongestionControlType::BBR: {
       auto bbr = std::make_unique<BbrCongestionController>(conn);
       bbr->setRttSampler(std::make_unique<BbrRttSampler>(
@@ -18,7 +18,7 @@ using namespace std::chrono;
 
 Copa::Copa(QuicConnectionStateBase& conn)
     : conn_(conn),
-      cwndBytes_(conn.transportSettings.initCwndInMss * conn.udpSendPacketLen),
+      cwndBytes_(conn.transportSettings->initCwndInMss * conn.udpSendPacketLen),
       isSlowStart_(true),
       minRTTFilter_(kMinRTTWindowLength.count(), 0us, 0),
       standingRTTFilter_(
@@ -28,8 +28,8 @@ Copa::Copa(QuicConnectionStateBase& conn)
   VLOG(10) << __func__ << " writable=" << getWritableBytes()
            << " cwnd=" << cwndBytes_ << " inflight=" << bytesInFlight_ << " "
            << conn_;
-  if (conn_.transportSettings.latencyFactor.hasValue()) {
-    latencyFactor_ = conn_.transportSettings.latencyFactor.value();
+  if (conn_.transportSettings->latencyFactor.hasValue()) {
+    latencyFactor_ = conn_.transportSettings->latencyFactor.value();
   }
   QUIC_TRACE(initcwnd, conn_, cwndBytes_);
 }
@@ -123,6 +123,13 @@ void Copa::changeDirection(
   velocityState_.lastRecordedCwndBytes = cwndBytes_;
 }
 
+void Copa::resetVelocity() {
+  velocityState_.direction = VelocityState::Direction::None;
+  velocityState_.velocity = 1;
+  velocityState_.numTimesDirectionSame = 0;
+  velocityState_.lastCwndRecordTime = folly::none;
+}
+
 void Copa::onPacketAckOrLoss(
     folly::Optional<AckEvent> ack,
     folly::Optional<LossEvent> loss) {
@@ -142,6 +149,13 @@ void Copa::onPacketAckOrLoss(
 void Copa::onPacketAcked(const AckEvent& ack) {
   DCHECK(ack.largestAckedPacket.hasValue());
   subtractAndCheckUnderflow(bytesInFlight_, ack.ackedBytes);
+  if (appLimited_ && appLimitedExitTarget_ < ack.largestAckedPacketSentTime) {
+    VLOG(10) << __func__ << " exiting app-limited " << conn_;
+    appLimited_ = false;
+    if (conn_.pacer) {
+      conn_.pacer->setAppLimited(false);
+    }
+  }
   minRTTFilter_.Update(
       conn_.lossState.lrtt,
       std::chrono::duration_cast<microseconds>(ack.ackTime.time_since_epoch())
@@ -206,13 +220,16 @@ void Copa::onPacketAcked(const AckEvent& ack) {
     increaseCwnd = targetRate >= currentRate;
   }
 
-  if (!(increaseCwnd && isSlowStart_)) {
+  if (!appLimited_ && !(increaseCwnd && isSlowStart_)) {
     // Update direction except for the case where we are in slow start mode,
     checkAndUpdateDirection(ack.ackTime);
   }
 
   if (increaseCwnd) {
-    if (isSlowStart_) {
+    if (appLimited_) {
+      VLOG(10) << __func__ << " not increasing cwnd=" << cwndBytes_
+               << " while app-limited " << conn_;
+    } else if (isSlowStart_) {
       // When a flow starts, Copa performs slow-start where
       // cwnd doubles once per RTT until current rate exceeds target rate".
       if (!lastCwndDoubleTime_.hasValue()) {
@@ -242,7 +259,8 @@ void Copa::onPacketAcked(const AckEvent& ack) {
       addAndCheckOverflow(cwndBytes_, addition);
     }
   } else {
-    if (velocityState_.direction != VelocityState::Direction::Down &&
+    if (!appLimited_ &&
+        velocityState_.direction != VelocityState::Direction::Down &&
         velocityState_.velocity > 1.0) {
       // if our current rate is much different than target, we double v every
       // RTT. That could result in a high v at some point in time. If we detect
@@ -261,7 +279,8 @@ void Copa::onPacketAcked(const AckEvent& ack) {
         std::min<uint64_t>(
             reduction,
             cwndBytes_ -
-                conn_.transportSettings.minCwndInMss * conn_.udpSendPacketLen));
+                conn_.transportSettings->minCwndInMss *
+                    conn_.udpSendPacketLen));
   }
   if (conn_.pacer) {
     conn_.pacer->refreshPacingRate(cwndBytes_ * 2, conn_.lossState.srtt);
@@ -287,7 +306,7 @@ void Copa::onPacketLoss(const LossEvent& loss) {
       conn_.qLogger->addCongestionMetricUpdate(
           bytesInFlight_, getCongestionWindow(), kPersistentCongestion);
     }
-    cwndBytes_ = conn_.transportSettings.minCwndInMss * conn_.udpSendPacketLen;
+    cwndBytes_ = conn_.transportSettings->minCwndInMss * conn_.udpSendPacketLen;
     if (conn_.pacer) {
       conn_.pacer->refreshPacingRate(cwndBytes_ * 2, conn_.lossState.srtt);
     }
@@ -318,14 +337,50 @@ uint64_t Copa::getBytesInFlight() const noexcept {
   return bytesInFlight_;
 }
 
-void Copa::setAppIdle(bool, TimePoint) noexcept { /* unsupported */
+void Copa::setAppIdle(bool idle, TimePoint eventTime) noexcept {
+  if (conn_.qLogger) {
+    conn_.qLogger->addAppIdleUpdate(kAppIdle, idle);
+  }
+  if (conn_.pacer) {
+    conn_.pacer->setAppLimited(idle || appLimited_);
+  }
+  if (idle) {
+    if (!idleStart_) {
+      idleStart_ = eventTime;
+    }
+    return;
+  }
+  if (idleStart_ && eventTime - *idleStart_ > conn_.lossState.srtt) {
+    // The direction and slow start doubling were measured against a queue
+    // that has since drained, so start over rather than resuming them.
+    VLOG(10) << __func__ << " restarting after idle " << conn_;
+    resetVelocity();
+    lastCwndDoubleTime_ = folly::none;
+  }
+  idleStart_ = folly::none;
 }
 
-void Copa::setAppLimited() { /* unsupported */
+void Copa::setAppLimited() {
+  if (bytesInFlight_ > cwndBytes_) {
+    return;
+  }
+  if (!appLimited_) {
+    // A velocity built up before this would otherwise keep doubling against
+    // a direction that no longer reflects the sender.
+    resetVelocity();
+  }
+  appLimited_ = true;
+  appLimitedExitTarget_ = Clock::now();
+  if (conn_.qLogger) {
+    conn_.qLogger->addAppLimitedUpdate();
+  }
+  if (conn_.pacer) {
+    conn_.pacer->setAppLimited(true);
+  }
 }
 
 bool Copa::isAppLimited() const noexcept {
-  return false; // not supported
+  return appLimited_;
 }
 
 } // namespace quic
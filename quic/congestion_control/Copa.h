@@ -68,6 +68,7 @@ class Copa : public CongestionController {
   void changeDirection(
       VelocityState::Direction newDirection,
       const TimePoint ackTime);
+  void resetVelocity();
   QuicConnectionStateBase& conn_;
   uint64_t bytesInFlight_{0};
   uint64_t cwndBytes_;
@@ -91,6 +92,15 @@ class Copa : public CongestionController {
       standingRTTFilter_; // To get min RTT over srtt/2
 
   VelocityState velocityState_;
+
+  // While app-limited the cwnd is not the bottleneck, so acks say nothing
+  // about whether it could grow: neither the cwnd nor the velocity increase.
+  bool appLimited_{false};
+  // When a packet sent after this time is acked, the connection is no longer
+  // app-limited.
+  TimePoint appLimitedExitTarget_;
+  // Set while the app is idle.
+  folly::Optional<TimePoint> idleStart_;
   /**
    * latencyFactor_ determines how latency sensitive the algorithm is. Lower
    * means it will maximime throughput at expense of delay. Higher value means
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/congestion_control/Ledbat.h>
+#include <quic/congestion_control/CongestionControlFunctions.h>
+#include <quic/logging/QLoggerConstants.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace quic {
+
+using namespace std::chrono;
+
+Ledbat::Ledbat(QuicConnectionStateBase& conn)
+    : conn_(conn),
+      cwndBytes_(conn.transportSettings->initCwndInMss * conn.udpSendPacketLen),
+      ssthresh_(std::numeric_limits<uint64_t>::max()),
+      baseDelayFilter_(kLedbatBaseDelayWindow.count(), 0us, 0) {
+  cwndBytes_ = boundedCwnd(
+      cwndBytes_,
+      conn_.udpSendPacketLen,
+      conn_.transportSettings->maxCwndInMss,
+      conn_.transportSettings->minCwndInMss);
+}
+
+void Ledbat::onRemoveBytesFromInflight(uint64_t bytes) {
+  subtractAndCheckUnderflow(bytesInFlight_, bytes);
+  VLOG(10) << __func__ << " writable=" << getWritableBytes()
+           << " cwnd=" << cwndBytes_ << " inflight=" << bytesInFlight_ << " "
+           << conn_;
+  if (conn_.qLogger) {
+    conn_.qLogger->addCongestionMetricUpdate(
+        bytesInFlight_, getCongestionWindow(), kRemoveInflight);
+  }
+}
+
+void Ledbat::onPacketSent(const OutstandingPacket& packet) {
+  addAndCheckOverflow(bytesInFlight_, packet.encodedSize);
+  VLOG(10) << __func__ << " writable=" << getWritableBytes()
+           << " cwnd=" << cwndBytes_ << " inflight=" << bytesInFlight_
+           << " packetNum=" << packet.packet.header.getPacketSequenceNum()
+           << " " << conn_;
+  if (conn_.qLogger) {
+    conn_.qLogger->addCongestionMetricUpdate(
+        bytesInFlight_, getCongestionWindow(), kCongestionPacketSent);
+  }
+}
+
+void Ledbat::onPacketAckOrLoss(
+    folly::Optional<AckEvent> ack,
+    folly::Optional<LossEvent> loss) {
+  if (loss) {
+    onPacketLoss(*loss);
+    if (conn_.pacer) {
+      conn_.pacer->onPacketsLoss();
+    }
+  }
+  if (ack && ack->largestAckedPacket.hasValue()) {
+    onPacketAcked(*ack);
+  }
+}
+
+void Ledbat::updateDelays(TimePoint ackTime) {
+  auto rtt = conn_.lossState.lrtt;
+  baseDelayFilter_.Update(
+      rtt, duration_cast<microseconds>(ackTime.time_since_epoch()).count());
+  currentDelaySamples_.push_back(rtt);
+  if (currentDelaySamples_.size() > kLedbatCurrentDelaySamples) {
+    currentDelaySamples_.pop_front();
+  }
+  auto baseDelay = baseDelayFilter_.GetBest();
+  auto currentDelay = *std::min_element(
+      currentDelaySamples_.begin(), currentDelaySamples_.end());
+  queuingDelay_ = currentDelay > baseDelay ? currentDelay - baseDelay : 0us;
+}
+
+double Ledbat::getGain() const noexcept {
+  // Short paths grow more slowly, so that LEDBAT stays less aggressive than
+  // Reno style flows sharing the bottleneck.
+  auto baseDelay = baseDelayFilter_.GetBest();
+  uint64_t gainInverse = kLedbatMaxGainInverse;
+  if (baseDelay > 0us) {
+    gainInverse = std::min<uint64_t>(
+        kLedbatMaxGainInverse,
+        std::ceil(2.0 * kLedbatTargetDelay.count() / baseDelay.count()));
+  }
+  return 1.0 / std::max<uint64_t>(gainInverse, 1);
+}
+
+void Ledbat::onPacketAcked(const AckEvent& ack) {
+  DCHECK(ack.largestAckedPacket.hasValue());
+  subtractAndCheckUnderflow(bytesInFlight_, ack.ackedBytes);
+  updateDelays(ack.ackTime);
+  VLOG(10) << __func__ << " ackedBytes=" << ack.ackedBytes
+           << " queuingDelay=" << queuingDelay_.count()
+           << " baseDelay=" << baseDelayFilter_.GetBest().count()
+           << " cwnd=" << cwndBytes_ << " inflight=" << bytesInFlight_ << " "
+           << conn_;
+  if (conn_.qLogger) {
+    conn_.qLogger->addCongestionMetricUpdate(
+        bytesInFlight_, getCongestionWindow(), kCongestionPacketAck);
+  }
+  if (endOfRecovery_ && ack.largestAckedPacketSentTime <= *endOfRecovery_) {
+    return;
+  }
+  if (nextSlowdownTime_ && ack.ackTime >= *nextSlowdownTime_) {
+    startSlowdown(ack.ackTime);
+    return;
+  }
+  if (slowdownFrozenUntil_) {
+    if (ack.ackTime < *slowdownFrozenUntil_) {
+      return;
+    }
+    slowdownFrozenUntil_ = folly::none;
+  }
+
+  auto gain = getGain();
+  if (inSlowStart()) {
+    if (queuingDelay_ > kLedbatTargetDelay * 3 / 4) {
+      ssthresh_ = cwndBytes_;
+      onSlowStartExit(ack.ackTime);
+    } else {
+      updateCwnd(cwndBytes_ + static_cast<uint64_t>(ack.ackedBytes * gain));
+      if (!inSlowStart()) {
+        onSlowStartExit(ack.ackTime);
+      }
+    }
+  } else {
+    // Grows by gain packets per RTT while under target. Over target it
+    // shrinks by the cwnd times the fraction the delay is over target, by at
+    // most half the cwnd per RTT.
+    double delayRatio = static_cast<double>(queuingDelay_.count()) /
+        kLedbatTargetDelay.count();
+    double cwndPackets =
+        static_cast<double>(cwndBytes_) / conn_.udpSendPacketLen;
+    double packetsPerRtt = std::max(
+        gain - cwndPackets * std::max(0.0, delayRatio - 1.0),
+        -cwndPackets / 2);
+    double ackedFraction =
+        static_cast<double>(ack.ackedBytes) / std::max<uint64_t>(cwndBytes_, 1);
+    double change = packetsPerRtt * conn_.udpSendPacketLen * ackedFraction;
+    if (change >= 0) {
+      updateCwnd(cwndBytes_ + static_cast<uint64_t>(change));
+    } else {
+      auto decrease = static_cast<uint64_t>(-change);
+      updateCwnd(cwndBytes_ - std::min(decrease, cwndBytes_));
+      // Backing off does not make room for another slow start.
+      ssthresh_ = std::min(ssthresh_, cwndBytes_);
+    }
+  }
+  if (conn_.pacer) {
+    conn_.pacer->refreshPacingRate(cwndBytes_, conn_.lossState.srtt);
+  }
+}
+
+void Ledbat::startSlowdown(TimePoint now) {
+  VLOG(10) << __func__ << " cwnd=" << cwndBytes_ << " " << conn_;
+  nextSlowdownTime_ = folly::none;
+  slowdownStartTime_ = now;
+  slowdownFrozenUntil_ = now + 2 * conn_.lossState.srtt;
+  ssthresh_ = cwndBytes_;
+  updateCwnd(conn_.transportSettings->minCwndInMss * conn_.udpSendPacketLen);
+  if (conn_.pacer) {
+    conn_.pacer->refreshPacingRate(cwndBytes_, conn_.lossState.srtt);
+  }
+}
+
+void Ledbat::onSlowStartExit(TimePoint now) {
+  if (slowdownStartTime_) {
+    auto slowdownDuration = now - *slowdownStartTime_;
+    nextSlowdownTime_ = now + kLedbatSlowdownInterval * slowdownDuration;
+    slowdownStartTime_ = folly::none;
+  } else if (!nextSlowdownTime_) {
+    // The first slowdown comes shortly after the initial slow start, so that
+    // the base delay is measured before the queue has had time to build up
+    // in earnest.
+    nextSlowdownTime_ = now + 2 * conn_.lossState.srtt;
+  }
+}
+
+void Ledbat::updateCwnd(uint64_t cwndBytes) {
+  cwndBytes_ = boundedCwnd(
+      cwndBytes,
+      conn_.udpSendPacketLen,
+      conn_.transportSettings->maxCwndInMss,
+      conn_.transportSettings->minCwndInMss);
+}
+
+void Ledbat::onPacketLoss(const LossEvent& loss) {
+  DCHECK(
+      loss.largestLostPacketNum.hasValue() &&
+      loss.largestLostSentTime.hasValue());
+  subtractAndCheckUnderflow(bytesInFlight_, loss.lostBytes);
+  if (!endOfRecovery_ || *endOfRecovery_ < *loss.largestLostSentTime) {
+    auto now = Clock::now();
+    endOfRecovery_ = now;
+    bool wasInSlowStart = inSlowStart();
+    updateCwnd(cwndBytes_ / 2);
+    ssthresh_ = cwndBytes_;
+    slowdownFrozenUntil_ = folly::none;
+    if (wasInSlowStart) {
+      onSlowStartExit(now);
+    }
+    VLOG(10) << __func__ << " packetNum=" << *loss.largestLostPacketNum
+             << " cwnd=" << cwndBytes_ << " inflight=" << bytesInFlight_
+             << " " << conn_;
+  }
+  if (conn_.qLogger) {
+    conn_.qLogger->addCongestionMetricUpdate(
+        bytesInFlight_, getCongestionWindow(), kCongestionPacketLoss);
+  }
+  if (loss.persistentCongestion) {
+    if (conn_.qLogger) {
+      conn_.qLogger->addCongestionMetricUpdate(
+          bytesInFlight_, getCongestionWindow(), kPersistentCongestion);
+    }
+    updateCwnd(conn_.transportSettings->minCwndInMss * conn_.udpSendPacketLen);
+  }
+  if (conn_.pacer) {
+    conn_.pacer->refreshPacingRate(cwndBytes_, conn_.lossState.srtt);
+  }
+}
+
+uint64_t Ledbat::getWritableBytes() const noexcept {
+  if (bytesInFlight_ > cwndBytes_) {
+    return 0;
+  } else {
+    return cwndBytes_ - bytesInFlight_;
+  }
+}
+
+uint64_t Ledbat::getCongestionWindow() const noexcept {
+  return cwndBytes_;
+}
+
+bool Ledbat::inSlowStart() const noexcept {
+  return cwndBytes_ < ssthresh_;
+}
+
+bool Ledbat::inSlowdown() const noexcept {
+  return slowdownStartTime_.hasValue();
+}
+
+CongestionControlType Ledbat::type() const noexcept {
+  return CongestionControlType::Ledbat;
+}
+
+uint64_t Ledbat::getBytesInFlight() const noexcept {
+  return bytesInFlight_;
+}
+
+std::chrono::microseconds Ledbat::getQueuingDelay() const noexcept {
+  return queuingDelay_;
+}
+
+void Ledbat::setAppIdle(bool, TimePoint) noexcept { /* unsupported */
+}
+
+void Ledbat::setAppLimited() { /* unsupported */
+}
+
+bool Ledbat::isAppLimited() const noexcept {
+  return false; // unsupported
+}
+
+} // namespace quic
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <quic/QuicException.h>
+#include <quic/congestion_control/third_party/windowed_filter.h>
+#include <quic/state/StateData.h>
+
+#include <deque>
+
+namespace quic {
+
+using namespace std::chrono_literals;
+// Queuing delay the controller tries to stay under.
+constexpr std::chrono::microseconds kLedbatTargetDelay{60ms};
+// Base delay is the minimum RTT seen over this window.
+constexpr std::chrono::microseconds kLedbatBaseDelayWindow{10min};
+// Current delay is the minimum of this many of the latest RTT samples.
+constexpr size_t kLedbatCurrentDelaySamples = 4;
+// The gain is never below 1 / kLedbatMaxGainInverse.
+constexpr uint64_t kLedbatMaxGainInverse = 16;
+// A slowdown is followed by this many times its duration of normal sending.
+constexpr uint64_t kLedbatSlowdownInterval = 9;
+
+/**
+ * Less-than-best-effort delay based congestion controller, following
+ * LEDBAT++ (draft-irtf-iccrg-ledbat-plus-plus). It backs off as soon as
+ * queuing delay, the current RTT over the base RTT, rises above
+ * kLedbatTargetDelay, so it yields to competing traffic. Intended for
+ * background transfers.
+ *
+ * Queuing delay is measured with RTT rather than one-way delay. The cwnd
+ * grows by at most gain per RTT, where the gain shrinks on short paths, and
+ * slow start grows by gain per acked byte. To keep the base delay estimate
+ * fresh, the cwnd periodically drops to its minimum for two RTTs.
+ */
+class Ledbat : public CongestionController {
+ public:
+  explicit Ledbat(QuicConnectionStateBase& conn);
+  void onRemoveBytesFromInflight(uint64_t) override;
+  void onPacketSent(const OutstandingPacket& packet) override;
+  void onPacketAckOrLoss(folly::Optional<AckEvent>, folly::Optional<LossEvent>)
+      override;
+
+  uint64_t getWritableBytes() const noexcept override;
+  uint64_t getCongestionWindow() const noexcept override;
+  CongestionControlType type() const noexcept override;
+
+  bool inSlowStart() const noexcept;
+
+  bool inSlowdown() const noexcept;
+
+  uint64_t getBytesInFlight() const noexcept;
+
+  std::chrono::microseconds getQueuingDelay() const noexcept;
+
+  void setAppIdle(bool, TimePoint) noexcept override;
+  void setAppLimited() override;
+  bool isAppLimited() const noexcept override;
+
+ private:
+  void onPacketAcked(const AckEvent&);
+  void onPacketLoss(const LossEvent&);
+  void updateDelays(TimePoint ackTime);
+  double getGain() const noexcept;
+  void startSlowdown(TimePoint now);
+  void onSlowStartExit(TimePoint now);
+  void updateCwnd(uint64_t cwndBytes);
+
+  QuicConnectionStateBase& conn_;
+  uint64_t bytesInFlight_{0};
+  uint64_t cwndBytes_;
+  uint64_t ssthresh_;
+  folly::Optional<TimePoint> endOfRecovery_;
+
+  WindowedFilter<
+      std::chrono::microseconds,
+      MinFilter<std::chrono::microseconds>,
+      uint64_t,
+      uint64_t>
+      baseDelayFilter_;
+  std::deque<std::chrono::microseconds> currentDelaySamples_;
+  std::chrono::microseconds queuingDelay_{0us};
+
+  // Set once the first slow start ends, for the time the next slowdown
+  // starts.
+  folly::Optional<TimePoint> nextSlowdownTime_;
+  // Set while in a slowdown, including the slow start out of it.
+  folly::Optional<TimePoint> slowdownStartTime_;
+  // Set while the cwnd is held at its minimum during a slowdown.
+  folly::Optional<TimePoint> slowdownFrozenUntil_;
+};
+} // namespace quic
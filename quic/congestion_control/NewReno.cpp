@@ -17,12 +17,13 @@ constexpr int kRenoLossReductionFactorShift = 1;
 NewReno::NewReno(QuicConnectionStateBase& conn)
     : conn_(conn),
       ssthresh_(std::numeric_limits<uint32_t>::max()),
-      cwndBytes_(conn.transportSettings.initCwndInMss * conn.udpSendPacketLen) {
+      cwndBytes_(
+          conn.transportSettings->initCwndInMss * conn.udpSendPacketLen) {
   cwndBytes_ = boundedCwnd(
       cwndBytes_,
       conn_.udpSendPacketLen,
-      conn_.transportSettings.maxCwndInMss,
-      conn_.transportSettings.minCwndInMss);
+      conn_.transportSettings->maxCwndInMss,
+      conn_.transportSettings->minCwndInMss);
 }
 
 void NewReno::onRemoveBytesFromInflight(uint64_t bytes) {
@@ -64,8 +65,8 @@ void NewReno::onAckEvent(const AckEvent& ack) {
   cwndBytes_ = boundedCwnd(
       cwndBytes_,
       conn_.udpSendPacketLen,
-      conn_.transportSettings.maxCwndInMss,
-      conn_.transportSettings.minCwndInMss);
+      conn_.transportSettings->maxCwndInMss,
+      conn_.transportSettings->minCwndInMss);
 }
 
 void NewReno::onPacketAcked(
@@ -110,8 +111,8 @@ void NewReno::onPacketLoss(const LossEvent& loss) {
     cwndBytes_ = boundedCwnd(
         cwndBytes_,
         conn_.udpSendPacketLen,
-        conn_.transportSettings.maxCwndInMss,
-        conn_.transportSettings.minCwndInMss);
+        conn_.transportSettings->maxCwndInMss,
+        conn_.transportSettings->minCwndInMss);
     // This causes us to exit slow start.
     ssthresh_ = cwndBytes_;
     VLOG(10) << __func__ << " exit slow start, ssthresh=" << ssthresh_
@@ -136,7 +137,7 @@ void NewReno::onPacketLoss(const LossEvent& loss) {
       conn_.qLogger->addCongestionMetricUpdate(
           bytesInFlight_, getCongestionWindow(), kPersistentCongestion);
     }
-    cwndBytes_ = conn_.transportSettings.minCwndInMss * conn_.udpSendPacketLen;
+    cwndBytes_ = conn_.transportSettings->minCwndInMss * conn_.udpSendPacketLen;
   }
 }
 
@@ -18,10 +18,10 @@ DefaultPacer::DefaultPacer(
     uint64_t minCwndInMss)
     : conn_(conn),
       minCwndInMss_(minCwndInMss),
-      batchSize_(conn.transportSettings.writeConnectionDataPacketsLimit),
+      batchSize_(conn.transportSettings->writeConnectionDataPacketsLimit),
       pacingRateCalculator_(calculatePacingRate),
-      cachedBatchSize_(conn.transportSettings.writeConnectionDataPacketsLimit),
-      tokens_(conn.transportSettings.writeConnectionDataPacketsLimit) {}
+      cachedBatchSize_(conn.transportSettings->writeConnectionDataPacketsLimit),
+      tokens_(conn.transportSettings->writeConnectionDataPacketsLimit) {}
 
 // TODO: we choose to keep refershing pacing rate even when we are app-limited,
 // so that when we exit app-limited, we have an updated pacing rate. But I don't
@@ -29,12 +29,21 @@ DefaultPacer::DefaultPacer(
 void DefaultPacer::refreshPacingRate(
     uint64_t cwndBytes,
     std::chrono::microseconds rtt) {
-  if (rtt < conn_.transportSettings.pacingTimerTickInterval) {
+  if (rtt < conn_.transportSettings->pacingTimerTickInterval) {
     writeInterval_ = 0us;
-    batchSize_ = conn_.transportSettings.writeConnectionDataPacketsLimit;
+    batchSize_ = conn_.transportSettings->writeConnectionDataPacketsLimit;
   } else {
+    uint64_t pacedBytes = cwndBytes;
+    if (conn_.sendRateLimiter) {
+      // Pace a rate capped connection at its cap, so that it sends smoothly
+      // instead of bursting a window and then idling until the cap refills.
+      pacedBytes = std::min<uint64_t>(
+          cwndBytes,
+          conn_.sendRateLimiter->getRate() * rtt.count() /
+              std::chrono::microseconds::period::den);
+    }
     const PacingRate pacingRate =
-        pacingRateCalculator_(conn_, cwndBytes, minCwndInMss_, rtt);
+        pacingRateCalculator_(conn_, pacedBytes, minCwndInMss_, rtt);
     writeInterval_ = pacingRate.interval;
     batchSize_ = pacingRate.burstSize;
     tokens_ += batchSize_;
@@ -70,7 +79,7 @@ uint64_t DefaultPacer::updateAndGetWriteBatchSize(TimePoint currentTime) {
     scheduledWriteTime_.clear();
   };
   if (appLimited_) {
-    cachedBatchSize_ = conn_.transportSettings.writeConnectionDataPacketsLimit;
+    cachedBatchSize_ = conn_.transportSettings->writeConnectionDataPacketsLimit;
     return cachedBatchSize_;
   }
   if (writeInterval_ == 0us) {
@@ -24,8 +24,8 @@ Cubic::Cubic(
       ssthresh_(initSsthresh),
       spreadAcrossRtt_(spreadAcrossRtt) {
   cwndBytes_ = std::min(
-      conn.transportSettings.maxCwndInMss * conn.udpSendPacketLen,
-      conn.transportSettings.initCwndInMss * conn.udpSendPacketLen);
+      conn.transportSettings->maxCwndInMss * conn.udpSendPacketLen,
+      conn.transportSettings->initCwndInMss * conn.udpSendPacketLen);
   steadyState_.tcpFriendly = tcpFriendly;
   steadyState_.estRenoCwnd = cwndBytes_;
   hystartState_.ackTrain = ackTrain;
@@ -52,7 +52,7 @@ uint64_t Cubic::getCongestionWindow() const noexcept {
  * we decide to just ignore app limited state right now.
  */
 void Cubic::onPersistentCongestion() {
-  auto minCwnd = conn_.transportSettings.minCwndInMss * conn_.udpSendPacketLen;
+  auto minCwnd = conn_.transportSettings->minCwndInMss * conn_.udpSendPacketLen;
   ssthresh_ = std::max(cwndBytes_ / 2, minCwnd);
   cwndBytes_ = minCwnd;
   if (steadyState_.tcpFriendly) {
@@ -305,18 +305,18 @@ uint64_t Cubic::calculateCubicCwnd(int64_t delta) noexcept {
       (std::numeric_limits<uint64_t>::max() - *steadyState_.lastMaxCwndBytes <
        folly::to<uint64_t>(delta))) {
     LOG(WARNING) << "Quic Cubic: overflow cwnd cut at uint64_t max";
-    return conn_.transportSettings.maxCwndInMss * conn_.udpSendPacketLen;
+    return conn_.transportSettings->maxCwndInMss * conn_.udpSendPacketLen;
   } else if (
       delta < 0 &&
       (folly::to<uint64_t>(std::abs(delta)) > *steadyState_.lastMaxCwndBytes)) {
     LOG(WARNING) << "Quic Cubic: underflow cwnd cut at minCwndBytes_ " << conn_;
-    return conn_.transportSettings.minCwndInMss * conn_.udpSendPacketLen;
+    return conn_.transportSettings->minCwndInMss * conn_.udpSendPacketLen;
   } else {
     return boundedCwnd(
         delta + *steadyState_.lastMaxCwndBytes,
         conn_.udpSendPacketLen,
-        conn_.transportSettings.maxCwndInMss,
-        conn_.transportSettings.minCwndInMss);
+        conn_.transportSettings->maxCwndInMss,
+        conn_.transportSettings->minCwndInMss);
   }
 }
 
@@ -335,8 +335,8 @@ void Cubic::cubicReduction(TimePoint lossTime) noexcept {
   cwndBytes_ = boundedCwnd(
       cwndBytes_ * steadyState_.reductionFactor,
       conn_.udpSendPacketLen,
-      conn_.transportSettings.maxCwndInMss,
-      conn_.transportSettings.minCwndInMss);
+      conn_.transportSettings->maxCwndInMss,
+      conn_.transportSettings->minCwndInMss);
   if (steadyState_.tcpFriendly) {
     steadyState_.estRenoCwnd = cwndBytes_;
   }
@@ -493,8 +493,8 @@ void Cubic::onPacketAckedInHystart(const AckEvent& ack) {
   cwndBytes_ = boundedCwnd(
       cwndBytes_ + ack.ackedBytes,
       conn_.udpSendPacketLen,
-      conn_.transportSettings.maxCwndInMss,
-      conn_.transportSettings.minCwndInMss);
+      conn_.transportSettings->maxCwndInMss,
+      conn_.transportSettings->minCwndInMss);
 
   folly::Optional<Cubic::ExitReason> exitReason;
   SCOPE_EXIT {
@@ -686,8 +686,8 @@ void Cubic::onPacketAckedInSteady(const AckEvent& ack) {
     steadyState_.estRenoCwnd = boundedCwnd(
         steadyState_.estRenoCwnd,
         conn_.udpSendPacketLen,
-        conn_.transportSettings.maxCwndInMss,
-        conn_.transportSettings.minCwndInMss);
+        conn_.transportSettings->maxCwndInMss,
+        conn_.transportSettings->minCwndInMss);
     cwndBytes_ = std::max(cwndBytes_, steadyState_.estRenoCwnd);
     if (conn_.qLogger) {
       conn_.qLogger->addCongestionMetricUpdate(
@@ -31,7 +31,7 @@ TEST_F(BbrTest, InitStates) {
   EXPECT_FALSE(bbr.inRecovery());
   EXPECT_EQ("Startup", bbrStateToString(bbr.state()));
   EXPECT_EQ(
-      1000 * conn.transportSettings.initCwndInMss, bbr.getCongestionWindow());
+      1000 * conn.transportSettings->initCwndInMss, bbr.getCongestionWindow());
   EXPECT_EQ(bbr.getWritableBytes(), bbr.getCongestionWindow());
 }
 
@@ -40,14 +40,15 @@ TEST_F(BbrTest, Recovery) {
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Client);
   conn.qLogger = qLogger;
   conn.udpSendPacketLen = 1000;
-  conn.transportSettings.initCwndInMss = 500; // Make a really large initCwnd
+  // Make a really large initCwnd
+  conn.transportSettings.mutate().initCwndInMss = 500;
   BbrCongestionController bbr(conn);
   // Make a huge inflight so we don't underflow anything
   auto inflightBytes = 100 * 1000;
   bbr.onPacketSent(makeTestingWritePacket(9, inflightBytes, inflightBytes));
 
   // This also makes sure recoveryWindow_ is larger than inflightBytes
-  uint64_t ackedBytes = 1000 * conn.transportSettings.minCwndInMss * 2;
+  uint64_t ackedBytes = 1000 * conn.transportSettings->minCwndInMss * 2;
   CongestionController::LossEvent loss;
   loss.lostBytes = 100;
   inflightBytes -= (loss.lostBytes + ackedBytes);
@@ -515,7 +516,7 @@ TEST_F(BbrTest, AppLimitedIgnored) {
 
 TEST_F(BbrTest, ExtendMinRttExpiration) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
-  conn.transportSettings.bbrConfig.probeRttDisabledIfAppLimited = true;
+  conn.transportSettings.mutate().bbrConfig.probeRttDisabledIfAppLimited = true;
   BbrCongestionController bbr(conn);
   auto mockRttSampler = std::make_unique<MockMinRttSampler>();
   auto mockBandwidthSampler = std::make_unique<MockBandwidthSampler>();
@@ -22,17 +22,17 @@ class CongestionControlFunctionsTest : public Test {};
 TEST_F(CongestionControlFunctionsTest, CalculatePacingRate) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
   conn.udpSendPacketLen = 1;
-  conn.transportSettings.minBurstPackets = 1;
-  conn.transportSettings.pacingTimerTickInterval = 10ms;
+  conn.transportSettings.mutate().minBurstPackets = 1;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 10ms;
   std::chrono::microseconds rtt(1000 * 100);
   auto result =
-      calculatePacingRate(conn, 50, conn.transportSettings.minCwndInMss, rtt);
+      calculatePacingRate(conn, 50, conn.transportSettings->minCwndInMss, rtt);
   EXPECT_EQ(10ms, result.interval);
   EXPECT_EQ(5, result.burstSize);
 
-  conn.transportSettings.pacingTimerTickInterval = 1ms;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 1ms;
   auto result2 =
-      calculatePacingRate(conn, 300, conn.transportSettings.minCwndInMss, rtt);
+      calculatePacingRate(conn, 300, conn.transportSettings->minCwndInMss, rtt);
   EXPECT_EQ(1ms, result2.interval);
   EXPECT_EQ(3, result2.burstSize);
 }
@@ -40,22 +40,22 @@ TEST_F(CongestionControlFunctionsTest, CalculatePacingRate) {
 TEST_F(CongestionControlFunctionsTest, MinPacingRate) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
   conn.udpSendPacketLen = 1;
-  conn.transportSettings.pacingTimerTickInterval = 1ms;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 1ms;
   auto result = calculatePacingRate(
-      conn, 100, conn.transportSettings.minCwndInMss, 100ms);
+      conn, 100, conn.transportSettings->minCwndInMss, 100ms);
   // 100 ms rtt, 1ms tick interval, 100 mss cwnd, 5 mss min burst -> 5 mss every
   // 5ms
   EXPECT_EQ(5ms, result.interval);
-  EXPECT_EQ(conn.transportSettings.minBurstPackets, result.burstSize);
+  EXPECT_EQ(conn.transportSettings->minBurstPackets, result.burstSize);
 }
 
 TEST_F(CongestionControlFunctionsTest, SmallCwnd) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
   conn.udpSendPacketLen = 1;
-  conn.transportSettings.minBurstPackets = 1;
-  conn.transportSettings.pacingTimerTickInterval = 1ms;
+  conn.transportSettings.mutate().minBurstPackets = 1;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 1ms;
   auto result = calculatePacingRate(
-      conn, 10, conn.transportSettings.minCwndInMss, 100000us);
+      conn, 10, conn.transportSettings->minCwndInMss, 100000us);
   EXPECT_EQ(10ms, result.interval);
   EXPECT_EQ(1, result.burstSize);
 }
@@ -63,13 +63,14 @@ TEST_F(CongestionControlFunctionsTest, SmallCwnd) {
 TEST_F(CongestionControlFunctionsTest, RttSmallerThanInterval) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
   conn.udpSendPacketLen = 1;
-  conn.transportSettings.minBurstPackets = 1;
-  conn.transportSettings.pacingTimerTickInterval = 10ms;
+  conn.transportSettings.mutate().minBurstPackets = 1;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 10ms;
   auto result =
-      calculatePacingRate(conn, 10, conn.transportSettings.minCwndInMss, 1ms);
+      calculatePacingRate(conn, 10, conn.transportSettings->minCwndInMss, 1ms);
   EXPECT_EQ(std::chrono::milliseconds::zero(), result.interval);
   EXPECT_EQ(
-      conn.transportSettings.writeConnectionDataPacketsLimit, result.burstSize);
+      conn.transportSettings->writeConnectionDataPacketsLimit,
+      result.burstSize);
 }
 
 
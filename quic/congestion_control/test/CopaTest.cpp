@@ -170,7 +170,7 @@ TEST_F(CopaTest, PersistentCongestion) {
   copa.onPacketAckOrLoss(folly::none, loss);
   EXPECT_EQ(
       copa.getWritableBytes(),
-      conn.transportSettings.minCwndInMss * conn.udpSendPacketLen);
+      conn.transportSettings->minCwndInMss * conn.udpSendPacketLen);
   EXPECT_TRUE(copa.inSlowStart());
 }
 
@@ -214,7 +214,7 @@ TEST_F(CopaTest, TestSlowStartAck) {
   // initial cwnd = 10 packets
   EXPECT_EQ(
       copa.getCongestionWindow(),
-      conn.transportSettings.initCwndInMss * conn.udpSendPacketLen);
+      conn.transportSettings->initCwndInMss * conn.udpSendPacketLen);
 
   auto numPacketsInFlight = 0;
   auto packetNumToSend = 1;
@@ -344,11 +344,11 @@ TEST_F(CopaTest, TestSteadyStateChanges) {
 
 TEST_F(CopaTest, TestVelocity) {
   QuicServerConnectionState conn;
-  conn.transportSettings.pacingTimerTickInterval = 10ms;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 10ms;
   Copa copa(conn);
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Client);
   conn.qLogger = qLogger;
-  conn.transportSettings.pacingEnabled = true;
+  conn.transportSettings.mutate().pacingEnabled = true;
 
   // lastCwnd = 9.8 packets
   auto now = Clock::now();
@@ -470,5 +470,97 @@ TEST_F(CopaTest, PacketLossInvokesPacer) {
   copa.onPacketAckOrLoss(folly::none, lossEvent);
 }
 
+TEST_F(CopaTest, AppLimitedFreezesCwnd) {
+  QuicServerConnectionState conn;
+  Copa copa(conn);
+  auto now = Clock::now();
+  exitSlowStart(copa, conn, now);
+  copa.onRemoveBytesFromInflight(copa.getBytesInFlight());
+  auto packetSize = conn.udpSendPacketLen;
+  PacketNum packetNum = 100;
+
+  auto sentBeforeAppLimited = Clock::now();
+  copa.onPacketSent(createPacket(++packetNum, packetSize, packetSize));
+  copa.onPacketSent(createPacket(++packetNum, packetSize, 2 * packetSize));
+  EXPECT_FALSE(copa.isAppLimited());
+  copa.setAppLimited();
+  EXPECT_TRUE(copa.isAppLimited());
+
+  // No queuing delay, so this ack would normally grow the cwnd.
+  auto cwnd = copa.getCongestionWindow();
+  conn.lossState.lrtt = 50ms;
+  now += 10ms;
+  auto ack = createAckEvent(packetNum - 1, packetSize, now);
+  ack.largestAckedPacketSentTime = sentBeforeAppLimited;
+  copa.onPacketAckOrLoss(ack, folly::none);
+  EXPECT_EQ(copa.getCongestionWindow(), cwnd);
+  EXPECT_TRUE(copa.isAppLimited());
+
+  // A packet sent after the app-limited period ends it.
+  now += 10ms;
+  ack = createAckEvent(packetNum, packetSize, now);
+  ack.largestAckedPacketSentTime = Clock::now() + 1ms;
+  copa.onPacketAckOrLoss(ack, folly::none);
+  EXPECT_FALSE(copa.isAppLimited());
+  EXPECT_GT(copa.getCongestionWindow(), cwnd);
+}
+
+TEST_F(CopaTest, BurstyRpcTrafficDoesNotInflateCwnd) {
+  QuicServerConnectionState conn;
+  Copa copa(conn);
+  auto now = Clock::now();
+  exitSlowStart(copa, conn, now);
+  copa.onRemoveBytesFromInflight(copa.getBytesInFlight());
+  auto packetSize = conn.udpSendPacketLen;
+  auto cwnd = copa.getCongestionWindow();
+  conn.lossState.lrtt = 50ms;
+
+  // Small request / response exchanges that never come close to using the
+  // cwnd, separated by quiet periods. Every ack sees an empty queue, which
+  // without app-limited tracking would keep pushing the cwnd up.
+  PacketNum packetNum = 100;
+  uint64_t totalSent = 0;
+  for (int rpc = 0; rpc < 50; ++rpc) {
+    auto sentTime = Clock::now();
+    for (int i = 0; i < 2; ++i) {
+      totalSent += packetSize;
+      copa.onPacketSent(createPacket(++packetNum, packetSize, totalSent));
+    }
+    copa.setAppLimited();
+    now += 50ms;
+    for (PacketNum acked = packetNum - 1; acked <= packetNum; ++acked) {
+      auto ack = createAckEvent(acked, packetSize, now);
+      ack.largestAckedPacketSentTime = sentTime;
+      copa.onPacketAckOrLoss(ack, folly::none);
+    }
+    copa.setAppIdle(true, now);
+    now += 200ms;
+    copa.setAppIdle(false, now);
+  }
+  EXPECT_EQ(copa.getCongestionWindow(), cwnd);
+  EXPECT_EQ(copa.getBytesInFlight(), 0);
+}
+
+TEST_F(CopaTest, AppLimitedAndIdleInvokePacer) {
+  QuicServerConnectionState conn;
+  Copa copa(conn);
+  auto mockPacer = std::make_unique<MockPacer>();
+  auto rawPacer = mockPacer.get();
+  conn.pacer = std::move(mockPacer);
+  copa.onPacketSent(createPacket(0 /* packetNum */, 1000, 1000));
+
+  InSequence s;
+  // Idle ending does not clear the pacer's app-limited state while the app
+  // is still app-limited.
+  EXPECT_CALL(*rawPacer, setAppLimited(true)).Times(3);
+  EXPECT_CALL(*rawPacer, setAppLimited(false)).Times(1);
+  copa.setAppLimited();
+  copa.setAppIdle(true, Clock::now());
+  copa.setAppIdle(false, Clock::now());
+  auto ack = createAckEvent(0, 1000, Clock::now());
+  ack.largestAckedPacketSentTime = Clock::now() + 1ms;
+  copa.onPacketAckOrLoss(ack, folly::none);
+}
+
 } // namespace test
 } // namespace quic
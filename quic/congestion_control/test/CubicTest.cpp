@@ -56,7 +56,7 @@ TEST_F(CubicTest, PersistentCongestion) {
   EXPECT_EQ(CubicStates::Hystart, cubic.state());
   // Cwnd should be dropped to minCwnd:
   EXPECT_EQ(
-      conn.transportSettings.minCwndInMss * conn.udpSendPacketLen,
+      conn.transportSettings->minCwndInMss * conn.udpSendPacketLen,
       cubic.getWritableBytes());
 
   // Verify ssthresh is at initCwnd / 2
@@ -238,7 +238,7 @@ TEST_F(CubicTest, AppIdle) {
 
 TEST_F(CubicTest, PacingGain) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
-  conn.transportSettings.pacingTimerTickInterval = 1ms;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 1ms;
   auto mockPacer = std::make_unique<MockPacer>();
   auto rawPacer = mockPacer.get();
   conn.pacer = std::move(mockPacer);
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/congestion_control/Ledbat.h>
+
+#include <folly/portability/GTest.h>
+#include <quic/common/test/TestUtils.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class LedbatTest : public Test {
+ public:
+  OutstandingPacket
+  createPacket(PacketNum packetNum, uint32_t size, uint64_t totalSent) {
+    auto connId = getTestConnectionId();
+    RegularQuicWritePacket packet(
+        ShortHeader(ProtectionType::KeyPhaseZero, connId, packetNum));
+    return OutstandingPacket(
+        std::move(packet), Clock::now(), size, false, totalSent);
+  }
+
+  CongestionController::AckEvent createAckEvent(
+      PacketNum largestAcked,
+      uint64_t ackedSize,
+      TimePoint ackTime) {
+    CongestionController::AckEvent ack;
+    ack.largestAckedPacket = largestAcked;
+    ack.largestAckedPacketSentTime = ackTime;
+    ack.ackTime = ackTime;
+    ack.ackedBytes = ackedSize;
+    ack.ackedPackets.push_back(makeAckPacketFromOutstandingPacket(
+        createPacket(largestAcked, ackedSize, ackedSize)));
+    return ack;
+  }
+
+  // Acks a packet sent just before, as if measured with the given RTT.
+  void ack(std::chrono::microseconds rtt) {
+    conn.lossState.lrtt = rtt;
+    now += 1ms;
+    ledbat.onPacketSent(createPacket(++packetNum, kPacketSize, 0));
+    ledbat.onPacketAckOrLoss(
+        createAckEvent(packetNum, kPacketSize, now), folly::none);
+  }
+
+  // Builds up queuing delay until the initial slow start ends.
+  void exitSlowStart() {
+    ack(60ms);
+    for (int i = 0; i < 4 && ledbat.inSlowStart(); ++i) {
+      ack(110ms);
+    }
+    ASSERT_FALSE(ledbat.inSlowStart());
+    EXPECT_EQ(ledbat.getQueuingDelay(), 50ms);
+  }
+
+  static constexpr uint32_t kPacketSize = 1000;
+  QuicServerConnectionState conn;
+  Ledbat ledbat{conn};
+  TimePoint now{Clock::now()};
+  PacketNum packetNum{0};
+
+ protected:
+  void SetUp() override {
+    conn.lossState.srtt = 60ms;
+  }
+};
+
+TEST_F(LedbatTest, SlowStartGrowsByGain) {
+  EXPECT_TRUE(ledbat.inSlowStart());
+  auto cwnd = ledbat.getCongestionWindow();
+  // A 60ms base delay gives a gain of 1 / ceil(2 * 60ms / 60ms).
+  ack(60ms);
+  EXPECT_EQ(ledbat.getCongestionWindow(), cwnd + kPacketSize / 2);
+  EXPECT_EQ(ledbat.getQueuingDelay(), 0us);
+  EXPECT_EQ(ledbat.getBytesInFlight(), 0);
+}
+
+TEST_F(LedbatTest, BacksOffOverTargetDelay) {
+  exitSlowStart();
+  // Under target the cwnd keeps growing.
+  auto cwnd = ledbat.getCongestionWindow();
+  ack(110ms);
+  EXPECT_GT(ledbat.getCongestionWindow(), cwnd);
+
+  // Twice the target delay shrinks it.
+  for (int i = 0; i < 4; ++i) {
+    ack(180ms);
+  }
+  EXPECT_EQ(ledbat.getQueuingDelay(), 120ms);
+  cwnd = ledbat.getCongestionWindow();
+  ack(180ms);
+  // The decrease is capped at half the cwnd per RTT, of which the ack covers
+  // kPacketSize / cwnd.
+  EXPECT_NEAR(ledbat.getCongestionWindow(), cwnd - kPacketSize / 2, 1);
+  EXPECT_FALSE(ledbat.inSlowStart());
+}
+
+TEST_F(LedbatTest, BackoffScalesWithCwnd) {
+  exitSlowStart();
+  // A quarter over target takes a quarter of the cwnd per RTT, less the gain.
+  for (int i = 0; i < 4; ++i) {
+    ack(135ms);
+  }
+  EXPECT_EQ(ledbat.getQueuingDelay(), 75ms);
+  auto cwnd = ledbat.getCongestionWindow();
+  double cwndPackets = static_cast<double>(cwnd) / conn.udpSendPacketLen;
+  double packetsPerRtt = 0.5 - cwndPackets / 4;
+  ASSERT_LT(packetsPerRtt, 0);
+  double decrease =
+      -packetsPerRtt * conn.udpSendPacketLen * kPacketSize / cwnd;
+  ack(135ms);
+  EXPECT_NEAR(ledbat.getCongestionWindow(), cwnd - decrease, 1);
+  EXPECT_GT(cwnd - ledbat.getCongestionWindow(), kPacketSize / 10);
+}
+
+TEST_F(LedbatTest, PeriodicSlowdown) {
+  exitSlowStart();
+  EXPECT_FALSE(ledbat.inSlowdown());
+  auto minCwnd = conn.transportSettings->minCwndInMss * conn.udpSendPacketLen;
+
+  // The first slowdown starts two RTTs after the initial slow start.
+  now += 2 * conn.lossState.srtt;
+  ack(60ms);
+  EXPECT_TRUE(ledbat.inSlowdown());
+  EXPECT_EQ(ledbat.getCongestionWindow(), minCwnd);
+
+  // The cwnd is frozen for two RTTs, then slow starts back up.
+  now += conn.lossState.srtt;
+  ack(60ms);
+  EXPECT_EQ(ledbat.getCongestionWindow(), minCwnd);
+  now += conn.lossState.srtt;
+  ack(60ms);
+  EXPECT_GT(ledbat.getCongestionWindow(), minCwnd);
+  EXPECT_TRUE(ledbat.inSlowStart());
+  EXPECT_TRUE(ledbat.inSlowdown());
+}
+
+TEST_F(LedbatTest, LossHalvesCwnd) {
+  auto cwnd = ledbat.getCongestionWindow();
+  auto packet = createPacket(++packetNum, kPacketSize, kPacketSize);
+  ledbat.onPacketSent(packet);
+  CongestionController::LossEvent loss;
+  loss.addLostPacket(packet);
+  ledbat.onPacketAckOrLoss(folly::none, loss);
+  EXPECT_EQ(ledbat.getCongestionWindow(), cwnd / 2);
+  EXPECT_EQ(ledbat.getBytesInFlight(), 0);
+  EXPECT_FALSE(ledbat.inSlowStart());
+}
+
+TEST_F(LedbatTest, PersistentCongestion) {
+  auto packet = createPacket(++packetNum, kPacketSize, kPacketSize);
+  ledbat.onPacketSent(packet);
+  CongestionController::LossEvent loss;
+  loss.persistentCongestion = true;
+  loss.addLostPacket(packet);
+  ledbat.onPacketAckOrLoss(folly::none, loss);
+  EXPECT_EQ(
+      ledbat.getCongestionWindow(),
+      conn.transportSettings->minCwndInMss * conn.udpSendPacketLen);
+}
+
+} // namespace test
+} // namespace quic
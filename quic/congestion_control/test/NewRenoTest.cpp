@@ -205,7 +205,7 @@ TEST_F(NewRenoTest, PersistentCongestion) {
   reno.onPacketAckOrLoss(folly::none, loss);
   EXPECT_EQ(
       reno.getWritableBytes(),
-      conn.transportSettings.minCwndInMss * conn.udpSendPacketLen);
+      conn.transportSettings->minCwndInMss * conn.udpSendPacketLen);
   EXPECT_TRUE(reno.inSlowStart());
 }
 
@@ -25,17 +25,17 @@ void consumeTokensHelper(Pacer& pacer, size_t tokensToConsume) {
 class PacerTest : public Test {
  public:
   void SetUp() override {
-    conn.transportSettings.pacingTimerTickInterval = 1us;
+    conn.transportSettings.mutate().pacingTimerTickInterval = 1us;
   }
 
  protected:
   QuicConnectionStateBase conn{QuicNodeType::Client};
-  DefaultPacer pacer{conn, conn.transportSettings.minCwndInMss};
+  DefaultPacer pacer{conn, conn.transportSettings->minCwndInMss};
 };
 
 TEST_F(PacerTest, WriteBeforeScheduled) {
   EXPECT_EQ(
-      conn.transportSettings.writeConnectionDataPacketsLimit,
+      conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.updateAndGetWriteBatchSize(Clock::now()));
   EXPECT_EQ(0us, pacer.getTimeUntilNextWrite());
 }
@@ -50,10 +50,10 @@ TEST_F(PacerTest, RateCalculator) {
   pacer.refreshPacingRate(200000, 200us);
   EXPECT_EQ(0us, pacer.getTimeUntilNextWrite());
   EXPECT_EQ(
-      4321 + conn.transportSettings.writeConnectionDataPacketsLimit,
+      4321 + conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.updateAndGetWriteBatchSize(Clock::now()));
   consumeTokensHelper(
-      pacer, 4321 + conn.transportSettings.writeConnectionDataPacketsLimit);
+      pacer, 4321 + conn.transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1234us, pacer.getTimeUntilNextWrite());
 }
 
@@ -68,20 +68,20 @@ TEST_F(PacerTest, CompensateTimerDrift) {
   pacer.refreshPacingRate(20, 100us); // These two values do not matter here
   pacer.onPacedWriteScheduled(currentTime);
   EXPECT_EQ(
-      20 + conn.transportSettings.writeConnectionDataPacketsLimit,
+      20 + conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.updateAndGetWriteBatchSize(currentTime + 1000us));
 
   // Query batch size again without calling onPacedWriteScheduled won't do timer
   // drift compensation. But token_ keeps the last compenstation.
   EXPECT_EQ(
-      20 + conn.transportSettings.writeConnectionDataPacketsLimit,
+      20 + conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.updateAndGetWriteBatchSize(currentTime + 2000us));
 
   // Consume a few:
   consumeTokensHelper(pacer, 3);
 
   EXPECT_EQ(
-      20 + conn.transportSettings.writeConnectionDataPacketsLimit - 3,
+      20 + conn.transportSettings->writeConnectionDataPacketsLimit - 3,
       pacer.updateAndGetWriteBatchSize(currentTime + 2000us));
 }
 
@@ -101,14 +101,14 @@ TEST_F(PacerTest, NextWriteTime) {
 
   // Consume all the tokens:
   consumeTokensHelper(
-      pacer, 10 + conn.transportSettings.writeConnectionDataPacketsLimit);
+      pacer, 10 + conn.transportSettings->writeConnectionDataPacketsLimit);
 
   // Then we use real delay:
   EXPECT_EQ(1000us, pacer.getTimeUntilNextWrite());
 }
 
 TEST_F(PacerTest, ImpossibleToPace) {
-  conn.transportSettings.pacingTimerTickInterval = 1ms;
+  conn.transportSettings.mutate().pacingTimerTickInterval = 1ms;
   pacer.setPacingRateCalculator([](const QuicConnectionStateBase& conn,
                                    uint64_t cwndBytes,
                                    uint64_t,
@@ -121,13 +121,13 @@ TEST_F(PacerTest, ImpossibleToPace) {
   pacer.refreshPacingRate(200 * conn.udpSendPacketLen, 100us);
   EXPECT_EQ(0us, pacer.getTimeUntilNextWrite());
   EXPECT_EQ(
-      conn.transportSettings.writeConnectionDataPacketsLimit,
+      conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.updateAndGetWriteBatchSize(Clock::now()));
 }
 
 TEST_F(PacerTest, CachedBatchSize) {
   EXPECT_EQ(
-      conn.transportSettings.writeConnectionDataPacketsLimit,
+      conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.getCachedWriteBatchSize());
   pacer.setPacingRateCalculator([](const QuicConnectionStateBase& conn,
                                    uint64_t cwndBytes,
@@ -152,7 +152,7 @@ TEST_F(PacerTest, CachedBatchSize) {
 }
 
 TEST_F(PacerTest, AppLimited) {
-  conn.transportSettings.writeConnectionDataPacketsLimit = 12;
+  conn.transportSettings.mutate().writeConnectionDataPacketsLimit = 12;
   pacer.setAppLimited(true);
   EXPECT_EQ(0us, pacer.getTimeUntilNextWrite());
   EXPECT_EQ(12, pacer.updateAndGetWriteBatchSize(Clock::now()));
@@ -162,12 +162,12 @@ TEST_F(PacerTest, Tokens) {
   // Pacer has tokens right after init:
   EXPECT_EQ(0us, pacer.getTimeUntilNextWrite());
   EXPECT_EQ(
-      conn.transportSettings.writeConnectionDataPacketsLimit,
+      conn.transportSettings->writeConnectionDataPacketsLimit,
       pacer.updateAndGetWriteBatchSize(Clock::now()));
 
   // Consume all initial tokens:
   consumeTokensHelper(
-      pacer, conn.transportSettings.writeConnectionDataPacketsLimit);
+      pacer, conn.transportSettings->writeConnectionDataPacketsLimit);
 
   // Pacing rate: 10 mss per 10 ms
   pacer.setPacingRateCalculator([](const QuicConnectionStateBase&,
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/fizz/handshake/FizzCertCompression.h>
+
+#include <fizz/compression/ZlibCertificateCompressor.h>
+#include <fizz/compression/ZlibCertificateDecompressor.h>
+#include <fizz/compression/ZstdCertificateCompressor.h>
+#include <fizz/compression/ZstdCertificateDecompressor.h>
+#include <folly/Conv.h>
+
+namespace {
+// Certificates are compressed once when the SelfCert is built, so favour
+// ratio over speed.
+constexpr int kZlibCompressionLevel = 9;
+constexpr int kZstdCompressionLevel = 19;
+
+[[noreturn]] void throwUnsupported(fizz::CertificateCompressionAlgorithm algo) {
+  throw std::invalid_argument(folly::to<std::string>(
+      "Unsupported certificate compression algorithm ",
+      static_cast<uint16_t>(algo)));
+}
+} // namespace
+
+namespace quic {
+
+std::vector<std::shared_ptr<fizz::CertificateCompressor>>
+createCertCompressors(
+    const std::vector<fizz::CertificateCompressionAlgorithm>& algos) {
+  std::vector<std::shared_ptr<fizz::CertificateCompressor>> compressors;
+  for (auto algo : algos) {
+    switch (algo) {
+      case fizz::CertificateCompressionAlgorithm::zlib:
+        compressors.push_back(std::make_shared<fizz::ZlibCertificateCompressor>(
+            kZlibCompressionLevel));
+        break;
+      case fizz::CertificateCompressionAlgorithm::zstd:
+        compressors.push_back(std::make_shared<fizz::ZstdCertificateCompressor>(
+            kZstdCompressionLevel));
+        break;
+      default:
+        throwUnsupported(algo);
+    }
+  }
+  return compressors;
+}
+
+std::shared_ptr<fizz::CertDecompressionManager> createCertDecompressionManager(
+    const std::vector<fizz::CertificateCompressionAlgorithm>& algos) {
+  if (algos.empty()) {
+    return nullptr;
+  }
+  std::vector<std::shared_ptr<fizz::CertificateDecompressor>> decompressors;
+  for (auto algo : algos) {
+    switch (algo) {
+      case fizz::CertificateCompressionAlgorithm::zlib:
+        decompressors.push_back(
+            std::make_shared<fizz::ZlibCertificateDecompressor>());
+        break;
+      case fizz::CertificateCompressionAlgorithm::zstd:
+        decompressors.push_back(
+            std::make_shared<fizz::ZstdCertificateDecompressor>());
+        break;
+      default:
+        throwUnsupported(algo);
+    }
+  }
+  auto manager = std::make_shared<fizz::CertDecompressionManager>();
+  manager->setDecompressors(std::move(decompressors));
+  return manager;
+}
+
+std::shared_ptr<fizz::SelfCert> createCompressibleSelfCert(
+    folly::ssl::EvpPkeyUniquePtr privKey,
+    std::vector<folly::ssl::X509UniquePtr> certs,
+    const std::vector<fizz::CertificateCompressionAlgorithm>& algos) {
+  return fizz::CertUtils::makeSelfCert(
+      std::move(privKey), std::move(certs), createCertCompressors(algos));
+}
+
+} // namespace quic
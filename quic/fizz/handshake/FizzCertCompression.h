@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <fizz/compression/CertDecompressionManager.h>
+#include <fizz/compression/CertificateCompressor.h>
+#include <fizz/protocol/Certificate.h>
+#include <fizz/record/Types.h>
+
+#include <memory>
+#include <vector>
+
+namespace quic {
+
+/**
+ * Helpers to enable RFC 8879 certificate compression on the fizz contexts
+ * used by the QUIC handshake. A compressed certificate keeps the server's
+ * first flight within the 3x anti-amplification budget more often, which
+ * saves a round trip for large chains. zlib and zstd are supported; other
+ * algorithms are rejected with std::invalid_argument.
+ */
+
+/**
+ * Creates one compressor per algorithm, in the order given.
+ */
+std::vector<std::shared_ptr<fizz::CertificateCompressor>>
+createCertCompressors(
+    const std::vector<fizz::CertificateCompressionAlgorithm>& algos);
+
+/**
+ * Creates a decompression manager that can inflate every algorithm in
+ * algos. Set it on the FizzClientContext so the client advertises the
+ * compress_certificate extension. Returns nullptr when algos is empty, so
+ * that no extension is sent at all.
+ */
+std::shared_ptr<fizz::CertDecompressionManager> createCertDecompressionManager(
+    const std::vector<fizz::CertificateCompressionAlgorithm>& algos);
+
+/**
+ * Wraps the key and chain in a SelfCert that carries compressors for algos.
+ * The same algos should be passed to
+ * FizzServerContext::setSupportedCompressionAlgorithms, since the server
+ * can only answer with algorithms its certificate has a compressor for.
+ */
+std::shared_ptr<fizz::SelfCert> createCompressibleSelfCert(
+    folly::ssl::EvpPkeyUniquePtr privKey,
+    std::vector<folly::ssl::X509UniquePtr> certs,
+    const std::vector<fizz::CertificateCompressionAlgorithm>& algos);
+
+} // namespace quic
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/test/TestUtil.h>
+#include <quic/fizz/handshake/FizzCertCompression.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class FizzCertCompressionTest
+    : public TestWithParam<fizz::CertificateCompressionAlgorithm> {
+ protected:
+  std::shared_ptr<fizz::SelfCert> makeCert(
+      const std::vector<fizz::CertificateCompressionAlgorithm>& algos) {
+    std::vector<folly::ssl::X509UniquePtr> certs;
+    certs.emplace_back(fizz::test::getCert(fizz::test::kP256Certificate));
+    return createCompressibleSelfCert(
+        fizz::test::getPrivateKey(fizz::test::kP256Key),
+        std::move(certs),
+        algos);
+  }
+};
+
+TEST_P(FizzCertCompressionTest, CompressorsMatchAlgorithms) {
+  auto compressors = createCertCompressors({GetParam()});
+  ASSERT_EQ(compressors.size(), 1);
+  EXPECT_EQ(compressors.front()->getAlgorithm(), GetParam());
+}
+
+TEST_P(FizzCertCompressionTest, RoundTrip) {
+  auto cert = makeCert({GetParam()});
+  auto compressed = cert->getCompressedCert(GetParam());
+  EXPECT_EQ(compressed.algorithm, GetParam());
+
+  auto manager = createCertDecompressionManager({GetParam()});
+  auto decompressor = manager->getDecompressor(GetParam());
+  ASSERT_NE(decompressor, nullptr);
+  auto decompressed = decompressor->decompress(compressed);
+  auto original = cert->getCertMessage();
+  ASSERT_EQ(decompressed.certificate_list.size(), 1);
+  EXPECT_TRUE(folly::IOBufEqualTo()(
+      decompressed.certificate_list.front().cert_data,
+      original.certificate_list.front().cert_data));
+  EXPECT_LT(
+      compressed.compressed_certificate_message->computeChainDataLength(),
+      compressed.uncompressed_length);
+}
+
+TEST_F(FizzCertCompressionTest, UnsupportedAlgorithm) {
+  EXPECT_THROW(
+      createCertCompressors({fizz::CertificateCompressionAlgorithm::brotli}),
+      std::invalid_argument);
+  EXPECT_THROW(
+      createCertDecompressionManager(
+          {fizz::CertificateCompressionAlgorithm::brotli}),
+      std::invalid_argument);
+}
+
+TEST_F(FizzCertCompressionTest, NoAlgorithms) {
+  EXPECT_TRUE(createCertCompressors({}).empty());
+  // Without algorithms the client must not send the extension, so there is
+  // no manager to install.
+  EXPECT_EQ(createCertDecompressionManager({}), nullptr);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    FizzCertCompressionTests,
+    FizzCertCompressionTest,
+    Values(
+        fizz::CertificateCompressionAlgorithm::zlib,
+        fizz::CertificateCompressionAlgorithm::zstd));
+
+} // namespace test
+} // namespace quic
@@ -98,5 +98,52 @@ TEST_F(ExtensionsTest, TestD18TicketParams) {
           TransportParameterId::initial_max_data, ext->parameters),
       494878333ULL);
 }
+TEST(PreferredAddressTest, EncodeDecode) {
+  StatelessResetToken token;
+  token.fill(0xab);
+  PreferredAddress preferredAddress(ConnectionId({1, 2, 3, 4, 5}), token);
+  preferredAddress.ipv4Address = folly::SocketAddress("10.1.2.3", 4433);
+  preferredAddress.ipv6Address = folly::SocketAddress("2001:db8::1", 4434);
+  std::vector<TransportParameter> parameters;
+  parameters.push_back(encodePreferredAddress(preferredAddress));
+  // 4 + 2 + 16 + 2 bytes of addresses, the length prefixed id and the token.
+  EXPECT_EQ(
+      parameters.front().value->computeChainDataLength(), 24 + 1 + 5 + 16);
+
+  auto decoded = getPreferredAddressParameter(parameters);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_EQ(*decoded, preferredAddress);
+}
+
+TEST(PreferredAddressTest, SingleFamily) {
+  StatelessResetToken token;
+  token.fill(0x01);
+  PreferredAddress preferredAddress(ConnectionId({1, 2, 3, 4}), token);
+  preferredAddress.ipv6Address = folly::SocketAddress("2001:db8::2", 443);
+  std::vector<TransportParameter> parameters;
+  parameters.push_back(encodePreferredAddress(preferredAddress));
+
+  auto decoded = getPreferredAddressParameter(parameters);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_FALSE(decoded->ipv4Address.hasValue());
+  EXPECT_EQ(*decoded->ipv6Address, *preferredAddress.ipv6Address);
+}
+
+TEST(PreferredAddressTest, Missing) {
+  std::vector<TransportParameter> parameters;
+  EXPECT_FALSE(getPreferredAddressParameter(parameters).hasValue());
+}
+
+TEST(PreferredAddressTest, Truncated) {
+  StatelessResetToken token;
+  token.fill(0x01);
+  PreferredAddress preferredAddress(ConnectionId({1, 2, 3, 4}), token);
+  std::vector<TransportParameter> parameters;
+  parameters.push_back(encodePreferredAddress(preferredAddress));
+  parameters.front().value->coalesce();
+  parameters.front().value->trimEnd(1);
+  EXPECT_THROW(
+      getPreferredAddressParameter(parameters), QuicTransportException);
+}
 } // namespace test
 } // namespace quic
@@ -55,7 +55,7 @@ inline void incrementWithOverFlowCheck(T& num, T diff) {
 
 inline uint64_t calculateMaximumData(const QuicStreamState& stream) {
   return std::max(
-      stream.currentReadOffset + stream.flowControlState.windowSize,
+      stream.flowControlReadOffset() + stream.flowControlState.windowSize,
       stream.flowControlState.advertisedMaxOffset);
 }
 } // namespace
@@ -74,7 +74,7 @@ bool maybeSendConnWindowUpdate(
       flowControlState.advertisedMaxOffset,
       flowControlState.windowSize,
       conn.lossState.srtt,
-      conn.transportSettings,
+      *conn.transportSettings,
       flowControlState.timeOfLastFlowControlUpdate,
       updateTime);
   if (newAdvertisedOffset) {
@@ -101,11 +101,11 @@ bool maybeSendStreamWindowUpdate(
     return false;
   }
   auto newAdvertisedOffset = calculateNewWindowUpdate(
-      stream.currentReadOffset,
+      stream.flowControlReadOffset(),
       flowControlState.advertisedMaxOffset,
       flowControlState.windowSize,
       stream.conn.lossState.srtt,
-      stream.conn.transportSettings,
+      *stream.conn.transportSettings,
       flowControlState.timeOfLastFlowControlUpdate,
       updateTime);
   if (newAdvertisedOffset) {
@@ -148,8 +148,8 @@ void updateFlowControlOnRead(
     QuicStreamState& stream,
     uint64_t lastReadOffset,
     TimePoint readTime) {
-  DCHECK_GE(stream.currentReadOffset, lastReadOffset);
-  auto diff = stream.currentReadOffset - lastReadOffset;
+  DCHECK_GE(stream.flowControlReadOffset(), lastReadOffset);
+  auto diff = stream.flowControlReadOffset() - lastReadOffset;
   incrementWithOverFlowCheck(
       stream.conn.flowControlState.sumCurReadOffset, diff);
   if (maybeSendConnWindowUpdate(stream.conn, readTime)) {
@@ -169,10 +169,21 @@ void updateFlowControlOnRead(
 void updateFlowControlOnWriteToSocket(
     QuicStreamState& stream,
     uint64_t length) {
+  auto connWritableBefore = getSendConnFlowControlBytesWire(stream.conn);
   incrementWithOverFlowCheck(
       stream.conn.flowControlState.sumCurWriteOffset, length);
   DCHECK_GE(stream.conn.flowControlState.sumCurStreamBufferLen, length);
   stream.conn.flowControlState.sumCurStreamBufferLen -= length;
+  auto reservedBytes = getReservedConnFlowControlBytes(stream.conn);
+  if (reservedBytes > 0 && connWritableBefore > reservedBytes &&
+      getSendConnFlowControlBytesWire(stream.conn) <= reservedBytes) {
+    // Only the reservation for control streams is left. Ask the peer for more
+    // credit before the control streams run out of it.
+    stream.conn.pendingEvents.dataBlocked = DataBlockedFrame(
+        stream.conn.flowControlState.peerAdvertisedMaxOffset);
+    VLOG(4) << "Conn flow control reached reservation, queue data blocked "
+            << stream.conn;
+  }
   if (stream.conn.flowControlState.sumCurWriteOffset ==
       stream.conn.flowControlState.peerAdvertisedMaxOffset) {
     if (stream.conn.qLogger) {
@@ -281,6 +292,12 @@ void handleConnWindowUpdate(
     QUIC_TRACE(
         flow_control_event, conn, "rx_conn", frame.maximumData, packetNum);
   }
+  if (conn.pendingEvents.dataBlocked &&
+      conn.pendingEvents.dataBlocked->dataLimit <
+          conn.flowControlState.peerAdvertisedMaxOffset) {
+    // The peer raised the limit before the frame went out.
+    conn.pendingEvents.dataBlocked.clear();
+  }
   // Peer sending a smaller max offset than previously advertised is legal but
   // ignored.
 }
@@ -330,6 +347,13 @@ uint64_t getSendConnFlowControlBytesWire(const QuicConnectionStateBase& conn) {
       conn.flowControlState.sumCurWriteOffset;
 }
 
+uint64_t getReservedConnFlowControlBytes(const QuicConnectionStateBase& conn) {
+  if (!conn.streamManager || conn.streamManager->numControlStreams() == 0) {
+    return 0;
+  }
+  return conn.transportSettings->controlStreamFlowControlReserve;
+}
+
 uint64_t getSendConnFlowControlBytesAPI(const QuicConnectionStateBase& conn) {
   auto connFlowControlBytes = getSendConnFlowControlBytesWire(conn);
   if (conn.flowControlState.sumCurStreamBufferLen > connFlowControlBytes) {
@@ -405,6 +429,16 @@ void onBlockedLost(QuicStreamState& stream) {
   maybeWriteBlockAfterSocketWrite(stream);
 }
 
+void onConnBlockedLost(
+    QuicConnectionStateBase& conn,
+    const DataBlockedFrame& frame) {
+  // Only resend if the peer has not given us more credit in the meantime.
+  if (frame.dataLimit == conn.flowControlState.peerAdvertisedMaxOffset &&
+      !conn.pendingEvents.dataBlocked) {
+    conn.pendingEvents.dataBlocked = frame;
+  }
+}
+
 void updateFlowControlList(QuicStreamState& stream) {
   stream.conn.streamManager->queueFlowControlUpdated(stream.id);
 }
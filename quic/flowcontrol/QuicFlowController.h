@@ -74,6 +74,10 @@ void onConnWindowUpdateLost(QuicConnectionStateBase& conn);
 
 void onBlockedLost(QuicStreamState& stream);
 
+void onConnBlockedLost(
+    QuicConnectionStateBase& conn,
+    const DataBlockedFrame& frame);
+
 /*
  *  Check whether crypto has pending data.
  */
@@ -97,6 +101,12 @@ uint64_t getSendStreamFlowControlBytesAPI(const QuicStreamState& stream);
  */
 uint64_t getSendConnFlowControlBytesWire(const QuicConnectionStateBase& conn);
 
+/**
+ * Returns the number of connection flow control bytes that are reserved for
+ * control streams and may not be used by other streams.
+ */
+uint64_t getReservedConnFlowControlBytes(const QuicConnectionStateBase& conn);
+
 /**
  * Returns the number of bytes that we are allowed to send on the connection
  * accounting for the bytes that are already in the send buffers of all the
@@ -25,7 +25,7 @@ class QuicFlowControlTest : public Test {
   void SetUp() override {
     transportInfoCb_ = std::make_unique<MockQuicStats>();
     conn_.streamManager = std::make_unique<QuicStreamManager>(
-        conn_, conn_.nodeType, conn_.transportSettings);
+        conn_, conn_.nodeType, *conn_.transportSettings);
     conn_.infoCallback = transportInfoCb_.get();
   }
   std::unique_ptr<MockQuicStats> transportInfoCb_;
@@ -655,6 +655,60 @@ TEST_F(QuicFlowControlTest, UpdateFlowControlOnWrite) {
   updateFlowControlOnWriteToSocket(stream, 100);
 }
 
+TEST_F(QuicFlowControlTest, UpdateFlowControlOnWriteReachesReservation) {
+  StreamId id = 3;
+  QuicStreamState stream(id, conn_);
+  stream.flowControlState.peerAdvertisedMaxOffset = 1000;
+  conn_.flowControlState.peerAdvertisedMaxOffset = 500;
+  conn_.transportSettings.mutate().controlStreamFlowControlReserve = 100;
+
+  // No reservation without control streams.
+  EXPECT_EQ(getReservedConnFlowControlBytes(conn_), 0);
+  updateFlowControlOnWriteToStream(stream, 300);
+  updateFlowControlOnWriteToSocket(stream, 300);
+  EXPECT_FALSE(conn_.pendingEvents.dataBlocked);
+
+  conn_.streamManager->setStreamAsControl(stream);
+  EXPECT_EQ(getReservedConnFlowControlBytes(conn_), 100);
+  updateFlowControlOnWriteToStream(stream, 50);
+  updateFlowControlOnWriteToSocket(stream, 50);
+  EXPECT_FALSE(conn_.pendingEvents.dataBlocked);
+
+  updateFlowControlOnWriteToStream(stream, 50);
+  updateFlowControlOnWriteToSocket(stream, 50);
+  ASSERT_TRUE(conn_.pendingEvents.dataBlocked);
+  EXPECT_EQ(conn_.pendingEvents.dataBlocked->dataLimit, 500);
+
+  // Writing into the reservation does not queue another frame.
+  conn_.pendingEvents.dataBlocked = folly::none;
+  updateFlowControlOnWriteToStream(stream, 50);
+  updateFlowControlOnWriteToSocket(stream, 50);
+  EXPECT_FALSE(conn_.pendingEvents.dataBlocked);
+}
+
+TEST_F(QuicFlowControlTest, LostConnDataBlocked) {
+  conn_.flowControlState.peerAdvertisedMaxOffset = 500;
+  onConnBlockedLost(conn_, DataBlockedFrame(500));
+  ASSERT_TRUE(conn_.pendingEvents.dataBlocked);
+  EXPECT_EQ(conn_.pendingEvents.dataBlocked->dataLimit, 500);
+
+  // Stale once the peer has raised the limit.
+  conn_.pendingEvents.dataBlocked = folly::none;
+  conn_.flowControlState.peerAdvertisedMaxOffset = 800;
+  onConnBlockedLost(conn_, DataBlockedFrame(500));
+  EXPECT_FALSE(conn_.pendingEvents.dataBlocked);
+}
+
+TEST_F(QuicFlowControlTest, ConnWindowUpdateClearsStaleDataBlocked) {
+  conn_.flowControlState.peerAdvertisedMaxOffset = 500;
+  conn_.pendingEvents.dataBlocked = DataBlockedFrame(500);
+  handleConnWindowUpdate(conn_, MaxDataFrame(500), 1);
+  EXPECT_TRUE(conn_.pendingEvents.dataBlocked);
+
+  handleConnWindowUpdate(conn_, MaxDataFrame(800), 2);
+  EXPECT_FALSE(conn_.pendingEvents.dataBlocked);
+}
+
 TEST_F(QuicFlowControlTest, UpdateFlowControlOnWriteToStream) {
   StreamId id = 3;
   QuicStreamState stream(id, conn_);
@@ -48,6 +48,90 @@ folly::Optional<StatelessResetToken> getStatelessResetTokenParameter(
   return token;
 }
 
+folly::Optional<PreferredAddress> getPreferredAddressParameter(
+    const std::vector<TransportParameter>& parameters) {
+  auto it = findParameter(parameters, TransportParameterId::preferred_address);
+  if (it == parameters.end()) {
+    return folly::none;
+  }
+  folly::io::Cursor cursor(it->value.get());
+  if (!cursor.canAdvance(
+          folly::IPAddressV4::byteCount() + folly::IPAddressV6::byteCount() +
+          2 * sizeof(uint16_t) + sizeof(uint8_t))) {
+    throw QuicTransportException(
+        "Preferred address too short",
+        TransportErrorCode::TRANSPORT_PARAMETER_ERROR);
+  }
+  std::array<uint8_t, folly::IPAddressV4::byteCount()> v4Bytes;
+  cursor.pull(v4Bytes.data(), v4Bytes.size());
+  auto v4Port = cursor.readBE<uint16_t>();
+  std::array<uint8_t, folly::IPAddressV6::byteCount()> v6Bytes;
+  cursor.pull(v6Bytes.data(), v6Bytes.size());
+  auto v6Port = cursor.readBE<uint16_t>();
+  auto connIdLen = cursor.readBE<uint8_t>();
+  if (connIdLen == 0 || connIdLen > kMaxConnectionIdSize ||
+      !cursor.canAdvance(connIdLen + sizeof(StatelessResetToken))) {
+    throw QuicTransportException(
+        "Invalid preferred address connection id",
+        TransportErrorCode::TRANSPORT_PARAMETER_ERROR);
+  }
+  ConnectionId connId(cursor, connIdLen);
+  StatelessResetToken token;
+  cursor.pull(token.data(), token.size());
+  if (!cursor.isAtEnd()) {
+    throw QuicTransportException(
+        "Trailing bytes in preferred address",
+        TransportErrorCode::TRANSPORT_PARAMETER_ERROR);
+  }
+
+  PreferredAddress preferredAddress(std::move(connId), token);
+  folly::IPAddressV4 v4(v4Bytes);
+  if (!v4.isZero() || v4Port != 0) {
+    preferredAddress.ipv4Address = folly::SocketAddress(v4, v4Port);
+  }
+  folly::IPAddressV6 v6(v6Bytes);
+  if (!v6.isZero() || v6Port != 0) {
+    preferredAddress.ipv6Address = folly::SocketAddress(v6, v6Port);
+  }
+  return preferredAddress;
+}
+
+TransportParameter encodePreferredAddress(
+    const PreferredAddress& preferredAddress) {
+  size_t encodedSize = folly::IPAddressV4::byteCount() +
+      folly::IPAddressV6::byteCount() + 2 * sizeof(uint16_t) +
+      sizeof(uint8_t) + preferredAddress.connectionId.size() +
+      preferredAddress.token.size();
+  auto data = folly::IOBuf::create(encodedSize);
+  BufAppender appender(data.get(), encodedSize);
+  if (preferredAddress.ipv4Address) {
+    appender.push(
+        preferredAddress.ipv4Address->getIPAddress().asV4().bytes(),
+        folly::IPAddressV4::byteCount());
+    appender.writeBE<uint16_t>(preferredAddress.ipv4Address->getPort());
+  } else {
+    std::array<uint8_t, folly::IPAddressV4::byteCount() + sizeof(uint16_t)>
+        zeros{};
+    appender.push(zeros.data(), zeros.size());
+  }
+  if (preferredAddress.ipv6Address) {
+    appender.push(
+        preferredAddress.ipv6Address->getIPAddress().asV6().bytes(),
+        folly::IPAddressV6::byteCount());
+    appender.writeBE<uint16_t>(preferredAddress.ipv6Address->getPort());
+  } else {
+    std::array<uint8_t, folly::IPAddressV6::byteCount() + sizeof(uint16_t)>
+        zeros{};
+    appender.push(zeros.data(), zeros.size());
+  }
+  appender.writeBE<uint8_t>(preferredAddress.connectionId.size());
+  appender.push(
+      preferredAddress.connectionId.data(),
+      preferredAddress.connectionId.size());
+  appender.push(preferredAddress.token.data(), preferredAddress.token.size());
+  return {TransportParameterId::preferred_address, std::move(data)};
+}
+
 TransportParameter encodeIntegerParameter(
     TransportParameterId id,
     uint64_t value) {
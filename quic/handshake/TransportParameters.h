@@ -44,6 +44,16 @@ struct TransportParameter {
   TransportParameter(const TransportParameter& other)
       : parameter(other.parameter),
         value(other.value ? other.value->clone() : nullptr) {}
+
+  TransportParameter(TransportParameter&&) = default;
+
+  TransportParameter& operator=(const TransportParameter& other) {
+    parameter = other.parameter;
+    value = other.value ? other.value->clone() : nullptr;
+    return *this;
+  }
+
+  TransportParameter& operator=(TransportParameter&&) = default;
 };
 
 class CustomTransportParameter {
@@ -127,6 +137,31 @@ TransportParameter encodeIntegerParameter(
     TransportParameterId id,
     uint64_t value);
 
+/**
+ * Contents of the preferred_address transport parameter. Unset addresses are
+ * encoded as all zeros, which peers read as "not offered".
+ */
+struct PreferredAddress {
+  folly::Optional<folly::SocketAddress> ipv4Address;
+  folly::Optional<folly::SocketAddress> ipv6Address;
+  ConnectionId connectionId;
+  StatelessResetToken token;
+
+  PreferredAddress(ConnectionId connIdIn, StatelessResetToken tokenIn)
+      : connectionId(std::move(connIdIn)), token(std::move(tokenIn)) {}
+
+  bool operator==(const PreferredAddress& rhs) const {
+    return ipv4Address == rhs.ipv4Address && ipv6Address == rhs.ipv6Address &&
+        connectionId == rhs.connectionId && token == rhs.token;
+  }
+};
+
+folly::Optional<PreferredAddress> getPreferredAddressParameter(
+    const std::vector<TransportParameter>& parameters);
+
+TransportParameter encodePreferredAddress(
+    const PreferredAddress& preferredAddress);
+
 inline TransportParameter encodeEmptyParameter(TransportParameterId id) {
   TransportParameter param;
   param.parameter = id;
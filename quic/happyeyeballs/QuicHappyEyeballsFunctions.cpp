@@ -8,6 +8,7 @@
 
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
 
+#include <quic/common/SocketTuning.h>
 #include <quic/logging/QuicLogger.h>
 #include <quic/state/StateData.h>
 
@@ -96,7 +97,7 @@ void startHappyEyeballs(
           *connection.happyEyeballsState.secondSocket,
           connection.localAddress,
           connection.happyEyeballsState.secondPeerAddress,
-          connection.transportSettings,
+          *connection.transportSettings,
           errMsgCallback,
           readCallback);
     } catch (const std::exception&) {
@@ -143,6 +144,10 @@ void happyEyeballsSetUpSocket(
   if (transportSettings.enableSocketErrMsgCallback) {
     socket.setErrMessageCallback(errMsgCallback);
   }
+  if (transportSettings.trackKernelReceiveDrops ||
+      transportSettings.maxSocketReceiveBuffer > 0) {
+    enableReceiveDropReporting(socket.getNetworkSocket().toFd());
+  }
   socket.resumeRead(readCallback);
 }
 
@@ -65,6 +65,17 @@ void addQuicSimpleFrameToEvent(
               frame.sequenceNumber));
       break;
     }
+    case quic::QuicSimpleFrame::Type::NewTokenFrame_E: {
+      event->frames.push_back(std::make_unique<quic::ReadNewTokenFrameLog>());
+      break;
+    }
+    case quic::QuicSimpleFrame::Type::StreamRepairFrame_E: {
+      const quic::StreamRepairFrame& frame =
+          *simpleFrame.asStreamRepairFrame();
+      event->frames.push_back(std::make_unique<quic::StreamRepairFrameLog>(
+          frame.streamId, frame.offset, frame.length, frame.symbolSize));
+      break;
+    }
   }
 }
 } // namespace
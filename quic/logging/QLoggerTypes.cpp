@@ -151,6 +151,16 @@ folly::dynamic ExpiredStreamDataFrameLog::toDynamic() const {
   return d;
 }
 
+folly::dynamic StreamRepairFrameLog::toDynamic() const {
+  folly::dynamic d = folly::dynamic::object();
+  d["frame_type"] = toString(FrameType::STREAM_REPAIR);
+  d["stream_id"] = streamId;
+  d["offset"] = offset;
+  d["length"] = length;
+  d["symbol_size"] = symbolSize;
+  return d;
+}
+
 folly::dynamic PathChallengeFrameLog::toDynamic() const {
   folly::dynamic d = folly::dynamic::object();
   d["frame_type"] = toString(FrameType::PATH_CHALLENGE);
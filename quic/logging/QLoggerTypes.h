@@ -234,6 +234,26 @@ class ExpiredStreamDataFrameLog : public QLogFrame {
   folly::dynamic toDynamic() const override;
 };
 
+class StreamRepairFrameLog : public QLogFrame {
+ public:
+  StreamId streamId;
+  uint64_t offset;
+  uint64_t length;
+  uint64_t symbolSize;
+
+  StreamRepairFrameLog(
+      StreamId streamIdIn,
+      uint64_t offsetIn,
+      uint64_t lengthIn,
+      uint64_t symbolSizeIn)
+      : streamId{streamIdIn},
+        offset{offsetIn},
+        length{lengthIn},
+        symbolSize{symbolSizeIn} {}
+  ~StreamRepairFrameLog() override = default;
+  folly::dynamic toDynamic() const override;
+};
+
 class PathChallengeFrameLog : public QLogFrame {
  public:
   uint64_t pathData;
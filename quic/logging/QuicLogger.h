@@ -10,21 +10,11 @@
 
 #include <folly/tracing/StaticTracepoint.h>
 #include <quic/codec/QuicConnectionId.h>
+#include <quic/logging/QuicTrace.h>
 #include <quic/state/StateData.h>
 
 namespace quic {
 
-class Logger {
- public:
-  virtual ~Logger() = default;
-
-  virtual void logTrace(
-      const std::string& name,
-      const QuicConnectionStateBase& conn,
-      std::chrono::steady_clock::time_point time,
-      const std::string& value) = 0;
-};
-
 template <class T>
 void quicTraceStream(std::string& value, T&& t) {
   value += folly::to<std::string>(t);
@@ -36,24 +26,47 @@ void quicTraceStream(std::string& value, T&& t, Args&&... args) {
   quicTraceStream(value, std::forward<Args>(args)...);
 }
 
+inline uint64_t quicTraceConnId(const folly::Optional<ConnectionId>& connId) {
+  uint64_t value = 0;
+  if (connId) {
+    for (size_t i = 0; i < std::min<size_t>(connId->size(), 8); ++i) {
+      value |= uint64_t(connId->data()[i]) << (56 - 8 * i);
+    }
+  }
+  return value;
+}
+
 template <class T, class... Args>
-void quicTraceLogger(std::string name, const T& conn, Args&&... args) {
+void quicTraceRecord(QuicTraceEvent event, const T& conn, Args&&... args) {
+  QuicTraceRecord record;
+  record.timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                          conn.clock.packetNow().time_since_epoch())
+                          .count();
+  record.clientConnId = quicTraceConnId(conn.clientConnectionId);
+  record.serverConnId = quicTraceConnId(conn.serverConnectionId);
+  record.event = event;
+  detail::appendQuicTraceArgs(record, std::forward<Args>(args)...);
+  QuicTracer::record(record);
+}
+
+template <class T, class... Args>
+void quicTraceVlog(folly::StringPiece name, const T& conn, Args&&... args) {
   std::string value;
   quicTraceStream(value, std::forward<Args>(args)...);
-
   VLOG(20) << name << " [" << conn << "] " << value;
-
-  if (conn.logger) {
-    conn.logger->logTrace(name, conn, std::chrono::steady_clock::now(), value);
-  }
 }
 
+// The event name must be one of QUIC_TRACE_EVENTS. Values are recorded as
+// they are, without being formatted, while the QuicTracer is enabled.
 #if FOLLY_MOBILE
 #define QUIC_LOGGER(name, conn, ...) (void)conn;
 #else
-#define QUIC_LOGGER(name, connmacro, ...)           \
-  if ((connmacro).logger || VLOG_IS_ON(20)) {       \
-    quicTraceLogger(#name, connmacro, __VA_ARGS__); \
+#define QUIC_LOGGER(name, connmacro, ...)                          \
+  if (QuicTracer::isEnabled()) {                                   \
+    quicTraceRecord(QuicTraceEvent::name, connmacro, __VA_ARGS__); \
+  }                                                                \
+  if (VLOG_IS_ON(20)) {                                            \
+    quicTraceVlog(#name, connmacro, __VA_ARGS__);                  \
   }
 #endif
 
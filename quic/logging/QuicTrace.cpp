@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/logging/QuicTrace.h>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/Format.h>
+#include <folly/Synchronized.h>
+#include <folly/lang/Bits.h>
+
+#include <algorithm>
+#include <memory>
+
+namespace quic {
+
+namespace {
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(size_t capacity) : buffer(capacity) {}
+
+  QuicTraceRingBuffer buffer;
+  // Set once the owning thread has exited, after which the buffer is
+  // dropped as soon as it has been drained.
+  std::atomic<bool> orphaned{false};
+};
+
+struct Registry {
+  size_t recordsPerThread{kDefaultQuicTraceBufferRecords};
+  // Bumped by enable(), so that threads pick up a new buffer size.
+  uint64_t generation{0};
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  uint64_t droppedFromRemoved{0};
+};
+
+folly::Synchronized<Registry>& getRegistry() {
+  static auto registry = new folly::Synchronized<Registry>();
+  return *registry;
+}
+
+struct ThreadBufferHolder {
+  ~ThreadBufferHolder() {
+    if (buffer) {
+      buffer->orphaned = true;
+    }
+  }
+
+  std::shared_ptr<ThreadBuffer> buffer;
+  uint64_t generation{0};
+};
+
+std::atomic<uint64_t> currentGeneration{0};
+
+ThreadBuffer& getThreadBuffer() {
+  static thread_local ThreadBufferHolder holder;
+  auto generation = currentGeneration.load(std::memory_order_acquire);
+  if (!holder.buffer || holder.generation != generation) {
+    if (holder.buffer) {
+      holder.buffer->orphaned = true;
+    }
+    auto registry = getRegistry().wlock();
+    holder.buffer = std::make_shared<ThreadBuffer>(registry->recordsPerThread);
+    holder.generation = registry->generation;
+    registry->buffers.push_back(holder.buffer);
+  }
+  return *holder.buffer;
+}
+
+template <class T>
+bool readFixed(const QuicTraceRecord& record, size_t& offset, T& value) {
+  if (offset + sizeof(value) > record.payloadSize) {
+    return false;
+  }
+  memcpy(&value, record.payload.data() + offset, sizeof(value));
+  offset += sizeof(value);
+  return true;
+}
+
+// Records may come from a file, so nothing about them is trusted.
+bool appendValues(std::string& out, const QuicTraceRecord& record) {
+  if (record.numArgs > kMaxQuicTraceArgs ||
+      record.payloadSize > record.payload.size()) {
+    return false;
+  }
+  size_t offset = 0;
+  for (size_t i = 0; i < record.numArgs; ++i) {
+    if (i > 0) {
+      out += ", ";
+    }
+    switch (record.argTypes[i]) {
+      case QuicTraceArgType::Unsigned: {
+        uint64_t value;
+        if (!readFixed(record, offset, value)) {
+          return false;
+        }
+        out += folly::to<std::string>(value);
+        break;
+      }
+      case QuicTraceArgType::Signed: {
+        int64_t value;
+        if (!readFixed(record, offset, value)) {
+          return false;
+        }
+        out += folly::to<std::string>(value);
+        break;
+      }
+      case QuicTraceArgType::Double: {
+        double value;
+        if (!readFixed(record, offset, value)) {
+          return false;
+        }
+        out += folly::to<std::string>(value);
+        break;
+      }
+      case QuicTraceArgType::String: {
+        uint8_t length;
+        if (!readFixed(record, offset, length) ||
+            offset + length > record.payloadSize) {
+          return false;
+        }
+        out.append(
+            reinterpret_cast<const char*>(record.payload.data() + offset),
+            length);
+        offset += length;
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+std::atomic<bool> QuicTracer::enabled_{false};
+
+folly::StringPiece quicTraceEventToString(QuicTraceEvent event) {
+  switch (event) {
+#define QUIC_TRACE_EVENT_STRING(name) \
+  case QuicTraceEvent::name:          \
+    return #name;
+    QUIC_TRACE_EVENTS(QUIC_TRACE_EVENT_STRING)
+#undef QUIC_TRACE_EVENT_STRING
+    case QuicTraceEvent::NumEvents:
+      break;
+  }
+  return "unknown";
+}
+
+void QuicTraceRecord::appendString(folly::StringPiece value) {
+  if (numArgs == kMaxQuicTraceArgs || payloadSize >= payload.size()) {
+    return;
+  }
+  size_t length = std::min<size_t>(
+      {value.size(), payload.size() - payloadSize - 1, UINT8_MAX});
+  argTypes[numArgs++] = QuicTraceArgType::String;
+  payload[payloadSize] = static_cast<uint8_t>(length);
+  memcpy(payload.data() + payloadSize + 1, value.data(), length);
+  payloadSize = static_cast<uint8_t>(payloadSize + 1 + length);
+}
+
+QuicTraceRingBuffer::QuicTraceRingBuffer(size_t capacity)
+    : records_(folly::nextPowTwo(std::max<size_t>(capacity, 1))),
+      mask_(records_.size() - 1) {}
+
+bool QuicTraceRingBuffer::write(const QuicTraceRecord& record) {
+  auto head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) == records_.size()) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  records_[head & mask_] = record;
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+size_t QuicTraceRingBuffer::read(
+    folly::FunctionRef<void(const QuicTraceRecord&)> fn) {
+  auto tail = tail_.load(std::memory_order_relaxed);
+  auto head = head_.load(std::memory_order_acquire);
+  for (auto i = tail; i != head; ++i) {
+    fn(records_[i & mask_]);
+  }
+  tail_.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+void QuicTracer::enable(size_t recordsPerThread) {
+  {
+    auto registry = getRegistry().wlock();
+    if (registry->recordsPerThread != recordsPerThread) {
+      registry->recordsPerThread = recordsPerThread;
+      currentGeneration.store(
+          ++registry->generation, std::memory_order_release);
+    }
+  }
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void QuicTracer::disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void QuicTracer::record(const QuicTraceRecord& record) {
+  getThreadBuffer().buffer.write(record);
+}
+
+size_t QuicTracer::drain(folly::FunctionRef<void(const QuicTraceRecord&)> fn) {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    // Records are read outside of the lock, so that threads creating their
+    // buffers are not held up by the reader.
+    buffers = getRegistry().rlock()->buffers;
+  }
+  size_t count = 0;
+  for (auto& buffer : buffers) {
+    count += buffer->buffer.read(fn);
+  }
+  auto registry = getRegistry().wlock();
+  auto& registered = registry->buffers;
+  for (auto it = registered.begin(); it != registered.end();) {
+    auto& buffer = **it;
+    // Orphaned buffers get no more writes. Anything still in one was written
+    // after the read above, and is read on the next drain.
+    if (buffer.orphaned && buffer.buffer.empty()) {
+      registry->droppedFromRemoved += buffer.buffer.dropped();
+      it = registered.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return count;
+}
+
+ssize_t QuicTracer::drainToFile(int fd) {
+  std::vector<QuicTraceRecord> records;
+  drain([&](const QuicTraceRecord& record) { records.push_back(record); });
+  auto size = records.size() * sizeof(QuicTraceRecord);
+  if (size > 0 && folly::writeFull(fd, records.data(), size) < 0) {
+    return -1;
+  }
+  return records.size();
+}
+
+uint64_t QuicTracer::dropped() {
+  auto registry = getRegistry().rlock();
+  auto dropped = registry->droppedFromRemoved;
+  for (const auto& buffer : registry->buffers) {
+    dropped += buffer->buffer.dropped();
+  }
+  return dropped;
+}
+
+folly::Expected<size_t, std::string> readQuicTraceFile(
+    int fd,
+    folly::FunctionRef<void(const QuicTraceRecord&)> fn) {
+  QuicTraceFileHeader expected;
+  QuicTraceFileHeader header;
+  auto bytesRead = folly::readFull(fd, &header, sizeof(header));
+  if (bytesRead < 0) {
+    return folly::makeUnexpected(
+        folly::to<std::string>(folly::errnoStr(errno)));
+  }
+  if (size_t(bytesRead) != sizeof(header) || header.magic != expected.magic) {
+    return folly::makeUnexpected(std::string("not a trace file"));
+  }
+  if (header.version != expected.version ||
+      header.recordSize != expected.recordSize) {
+    return folly::makeUnexpected(folly::to<std::string>(
+        "unsupported trace version ",
+        header.version,
+        " with records of ",
+        header.recordSize,
+        " bytes"));
+  }
+  size_t count = 0;
+  QuicTraceRecord record;
+  while ((bytesRead = folly::readFull(fd, &record, sizeof(record))) > 0) {
+    if (size_t(bytesRead) != sizeof(record)) {
+      return folly::makeUnexpected(std::string("truncated record"));
+    }
+    fn(record);
+    ++count;
+  }
+  if (bytesRead < 0) {
+    return folly::makeUnexpected(
+        folly::to<std::string>(folly::errnoStr(errno)));
+  }
+  return count;
+}
+
+folly::Optional<std::string> formatQuicTraceRecord(
+    const QuicTraceRecord& record) {
+  auto line = folly::sformat(
+      "{:<14}{:016x}      {:016x}      {:<22}",
+      record.timeMicros,
+      record.clientConnId,
+      record.serverConnId,
+      quicTraceEventToString(record.event));
+  if (!appendValues(line, record)) {
+    return folly::none;
+  }
+  return line;
+}
+
+} // namespace quic
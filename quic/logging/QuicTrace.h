@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Expected.h>
+#include <folly/Function.h>
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/portability/SysTypes.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace quic {
+
+// Every event that QUIC_TRACE can record. The values of each event are
+// described in QUIC_TRACE_FORMAT.md.
+#define QUIC_TRACE_EVENTS(x)     \
+  x(bbr_ack)                     \
+  x(bbr_appidle)                 \
+  x(bbr_applimited)              \
+  x(bbr_appunlimited)            \
+  x(bbr_persistent_congestion)   \
+  x(conn_close)                  \
+  x(copa_ack)                    \
+  x(copa_loss)                   \
+  x(cubic_ack)                   \
+  x(cubic_appidle)               \
+  x(cubic_loss)                  \
+  x(cubic_persistent_congestion) \
+  x(cubic_remove_inflight)       \
+  x(cubic_steady_cwnd)           \
+  x(cwnd_may_block)              \
+  x(flow_control_event)          \
+  x(fst_trace)                   \
+  x(handshake_alarm)             \
+  x(happy_eyeballs)              \
+  x(holb_time)                   \
+  x(initcwnd)                    \
+  x(pacing_update)               \
+  x(packet_acked)                \
+  x(packet_buffered)             \
+  x(packet_drop)                 \
+  x(packet_recvd)                \
+  x(packet_sent)                 \
+  x(packets_lost)                \
+  x(pto_alarm)                   \
+  x(recvd_close)                 \
+  x(transport_data)              \
+  x(udp_recvd)                   \
+  x(update_rtt)                  \
+  x(zero_rtt)
+
+enum class QuicTraceEvent : uint16_t {
+#define QUIC_TRACE_EVENT_ENUM(name) name,
+  QUIC_TRACE_EVENTS(QUIC_TRACE_EVENT_ENUM)
+#undef QUIC_TRACE_EVENT_ENUM
+  NumEvents,
+};
+
+folly::StringPiece quicTraceEventToString(QuicTraceEvent event);
+
+enum class QuicTraceArgType : uint8_t {
+  Unsigned,
+  Signed,
+  Double,
+  // One byte of length followed by the bytes of the string.
+  String,
+};
+
+constexpr size_t kQuicTraceRecordSize = 192;
+constexpr size_t kMaxQuicTraceArgs = 12;
+constexpr size_t kQuicTracePayloadSize = 152;
+// Records each thread can buffer before new ones are dropped.
+constexpr size_t kDefaultQuicTraceBufferRecords = 16 * 1024;
+
+/**
+ * A trace event as written to the ring buffers and to trace files. Values
+ * are packed one after the other into the payload, in native byte order.
+ * Strings that do not fit in the rest of the payload are truncated, and
+ * values past kMaxQuicTraceArgs are dropped.
+ */
+struct QuicTraceRecord {
+  // Steady clock time, in microseconds since the clock's epoch.
+  uint64_t timeMicros{0};
+  // The first 8 bytes of the connection ids, zero when not known.
+  uint64_t clientConnId{0};
+  uint64_t serverConnId{0};
+  QuicTraceEvent event{QuicTraceEvent::NumEvents};
+  uint8_t numArgs{0};
+  uint8_t payloadSize{0};
+  std::array<QuicTraceArgType, kMaxQuicTraceArgs> argTypes{};
+  std::array<uint8_t, kQuicTracePayloadSize> payload{};
+
+  void appendUnsigned(uint64_t value) {
+    appendFixed(QuicTraceArgType::Unsigned, &value, sizeof(value));
+  }
+
+  void appendSigned(int64_t value) {
+    appendFixed(QuicTraceArgType::Signed, &value, sizeof(value));
+  }
+
+  void appendDouble(double value) {
+    appendFixed(QuicTraceArgType::Double, &value, sizeof(value));
+  }
+
+  void appendString(folly::StringPiece value);
+
+ private:
+  void appendFixed(QuicTraceArgType type, const void* value, size_t size) {
+    if (numArgs == kMaxQuicTraceArgs || payloadSize + size > payload.size()) {
+      return;
+    }
+    argTypes[numArgs++] = type;
+    memcpy(payload.data() + payloadSize, value, size);
+    payloadSize = static_cast<uint8_t>(payloadSize + size);
+  }
+};
+
+static_assert(
+    sizeof(QuicTraceRecord) == kQuicTraceRecordSize,
+    "Trace records must keep their size");
+static_assert(
+    std::is_trivially_copyable<QuicTraceRecord>::value,
+    "Trace records are copied as bytes");
+
+/**
+ * Ring buffer of trace records with one producer and one consumer, which
+ * do not need to lock. Records written while the buffer is full are dropped
+ * and counted.
+ */
+class QuicTraceRingBuffer {
+ public:
+  // The capacity is rounded up to a power of 2.
+  explicit QuicTraceRingBuffer(size_t capacity);
+
+  // Producer side.
+  bool write(const QuicTraceRecord& record);
+
+  // Consumer side. Returns the number of records read.
+  size_t read(folly::FunctionRef<void(const QuicTraceRecord&)> fn);
+
+  size_t capacity() const {
+    return records_.size();
+  }
+
+  uint64_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+        tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<QuicTraceRecord> records_;
+  uint64_t mask_;
+  // Written by the producer only.
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> dropped_{0};
+  // Keep the consumer's index off the producer's cache line.
+  char padding_[64];
+  // Written by the consumer only.
+  std::atomic<uint64_t> tail_{0};
+};
+
+/**
+ * Process wide switch and collection point for QUIC_TRACE. While enabled,
+ * each thread writes its records into its own QuicTraceRingBuffer, created
+ * on the thread's first record, and a reader drains all of them.
+ */
+class QuicTracer {
+ public:
+  static void enable(size_t recordsPerThread = kDefaultQuicTraceBufferRecords);
+
+  /**
+   * Stops recording. Records already buffered can still be drained.
+   */
+  static void disable();
+
+  static bool isEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  static void record(const QuicTraceRecord& record);
+
+  /**
+   * Reads the buffered records of every thread, each thread's in the order
+   * they were written. Must not be called by more than one thread at a time.
+   */
+  static size_t drain(folly::FunctionRef<void(const QuicTraceRecord&)> fn);
+
+  /**
+   * Drains the buffered records into a trace file, which the caller starts
+   * with a QuicTraceFileHeader. Returns the number of records written, or -1
+   * with errno set if writing failed.
+   */
+  static ssize_t drainToFile(int fd);
+
+  /**
+   * Records dropped because a thread's buffer was full.
+   */
+  static uint64_t dropped();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+/**
+ * Start of a trace file, which is followed by records of recordSize bytes
+ * until the end of the file.
+ */
+struct QuicTraceFileHeader {
+  std::array<char, 4> magic{{'Q', 'T', 'R', 'C'}};
+  uint32_t version{1};
+  uint32_t recordSize{kQuicTraceRecordSize};
+  uint32_t reserved{0};
+};
+
+/**
+ * Reads a trace file, calling fn for each of its records. Fails if the file
+ * was not written with this record format.
+ */
+folly::Expected<size_t, std::string> readQuicTraceFile(
+    int fd,
+    folly::FunctionRef<void(const QuicTraceRecord&)> fn);
+
+/**
+ * Formats a record as a line of the text format in QUIC_TRACE_FORMAT.md, or
+ * returns none if the record is malformed.
+ */
+folly::Optional<std::string> formatQuicTraceRecord(
+    const QuicTraceRecord& record);
+
+namespace detail {
+
+inline void appendQuicTraceArg(QuicTraceRecord& record, bool value) {
+  record.appendUnsigned(value);
+}
+
+template <class T>
+std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value>
+appendQuicTraceArg(QuicTraceRecord& record, T value) {
+  record.appendUnsigned(value);
+}
+
+template <class T>
+std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>
+appendQuicTraceArg(QuicTraceRecord& record, T value) {
+  record.appendSigned(value);
+}
+
+template <class T>
+std::enable_if_t<std::is_enum<T>::value> appendQuicTraceArg(
+    QuicTraceRecord& record,
+    T value) {
+  appendQuicTraceArg(
+      record, static_cast<std::underlying_type_t<T>>(value));
+}
+
+template <class T>
+std::enable_if_t<std::is_floating_point<T>::value> appendQuicTraceArg(
+    QuicTraceRecord& record,
+    T value) {
+  record.appendDouble(value);
+}
+
+inline void appendQuicTraceArg(QuicTraceRecord& record, const char* value) {
+  record.appendString(value);
+}
+
+inline void appendQuicTraceArg(
+    QuicTraceRecord& record,
+    folly::StringPiece value) {
+  record.appendString(value);
+}
+
+inline void appendQuicTraceArgs(QuicTraceRecord&) {}
+
+template <class T, class... Args>
+void appendQuicTraceArgs(QuicTraceRecord& record, T&& t, Args&&... args) {
+  appendQuicTraceArg(record, std::forward<T>(t));
+  appendQuicTraceArgs(record, std::forward<Args>(args)...);
+}
+
+} // namespace detail
+
+} // namespace quic
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/logging/QuicTrace.h>
+
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/Unistd.h>
+
+#include <thread>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+enum class TestState : uint8_t { Start, Steady };
+
+QuicTraceRecord makeRecord(QuicTraceEvent event, uint64_t time) {
+  QuicTraceRecord record;
+  record.timeMicros = time;
+  record.clientConnId = 0x681b2cedd6da02d7;
+  record.serverConnId = 0x42bb929f9a80dbd2;
+  record.event = event;
+  return record;
+}
+
+TEST(QuicTraceTest, TypedValues) {
+  auto record = makeRecord(QuicTraceEvent::packet_sent, 148401640306);
+  std::string space = "InitialSpace";
+  detail::appendQuicTraceArgs(
+      record, space, uint64_t(1), 142, true, TestState::Steady, -3, 0.5);
+  EXPECT_EQ(record.numArgs, 7);
+  EXPECT_EQ(
+      formatQuicTraceRecord(record).value(),
+      "148401640306  681b2cedd6da02d7      42bb929f9a80dbd2      "
+      "packet_sent           InitialSpace, 1, 142, 1, 1, -3, 0.5");
+}
+
+TEST(QuicTraceTest, StringLiteralsAreStrings) {
+  auto record = makeRecord(QuicTraceEvent::fst_trace, 1);
+  detail::appendQuicTraceArgs(record, "transport ready");
+  ASSERT_EQ(record.numArgs, 1);
+  EXPECT_EQ(record.argTypes[0], QuicTraceArgType::String);
+}
+
+TEST(QuicTraceTest, PayloadLimits) {
+  auto record = makeRecord(QuicTraceEvent::fst_trace, 1);
+  std::string longString(300, 'a');
+  record.appendString(longString);
+  EXPECT_EQ(record.payloadSize, kQuicTracePayloadSize);
+  // Nothing more fits.
+  record.appendUnsigned(1);
+  record.appendString("b");
+  EXPECT_EQ(record.numArgs, 1);
+  EXPECT_EQ(
+      formatQuicTraceRecord(record).value().size(),
+      14 + 22 + 22 + 22 + kQuicTracePayloadSize - 1);
+
+  record = makeRecord(QuicTraceEvent::transport_data, 1);
+  for (size_t i = 0; i < kMaxQuicTraceArgs + 2; ++i) {
+    record.appendUnsigned(i);
+  }
+  EXPECT_EQ(record.numArgs, kMaxQuicTraceArgs);
+}
+
+TEST(QuicTraceTest, MalformedRecord) {
+  auto record = makeRecord(QuicTraceEvent::update_rtt, 1);
+  record.appendUnsigned(1);
+  record.payloadSize = 4;
+  EXPECT_FALSE(formatQuicTraceRecord(record).hasValue());
+}
+
+TEST(QuicTraceTest, RingBufferDropsWhenFull) {
+  QuicTraceRingBuffer buffer(3);
+  EXPECT_EQ(buffer.capacity(), 4);
+  for (uint64_t i = 0; i < 5; ++i) {
+    buffer.write(makeRecord(QuicTraceEvent::udp_recvd, i));
+  }
+  EXPECT_EQ(buffer.dropped(), 1);
+
+  std::vector<uint64_t> times;
+  auto read = [&](const QuicTraceRecord& record) {
+    times.push_back(record.timeMicros);
+  };
+  EXPECT_EQ(buffer.read(read), 4);
+  EXPECT_THAT(times, ElementsAre(0, 1, 2, 3));
+  EXPECT_TRUE(buffer.empty());
+
+  buffer.write(makeRecord(QuicTraceEvent::udp_recvd, 5));
+  EXPECT_EQ(buffer.read(read), 1);
+  EXPECT_EQ(times.back(), 5);
+}
+
+TEST(QuicTraceTest, DrainToFile) {
+  QuicTracer::enable();
+  // Records of exited threads are still drained.
+  std::thread([] {
+    QuicTracer::record(makeRecord(QuicTraceEvent::pto_alarm, 1));
+  }).join();
+  QuicTracer::record(makeRecord(QuicTraceEvent::zero_rtt, 2));
+  QuicTracer::disable();
+
+  folly::test::TemporaryFile file;
+  QuicTraceFileHeader header;
+  ASSERT_EQ(
+      folly::writeFull(file.fd(), &header, sizeof(header)),
+      ssize_t(sizeof(header)));
+  EXPECT_EQ(QuicTracer::drainToFile(file.fd()), 2);
+  EXPECT_EQ(QuicTracer::drainToFile(file.fd()), 0);
+
+  ASSERT_EQ(lseek(file.fd(), 0, SEEK_SET), 0);
+  std::vector<QuicTraceEvent> events;
+  auto result = readQuicTraceFile(file.fd(), [&](const auto& record) {
+    events.push_back(record.event);
+  });
+  ASSERT_TRUE(result.hasValue());
+  EXPECT_EQ(*result, 2);
+  EXPECT_THAT(
+      events,
+      UnorderedElementsAre(
+          QuicTraceEvent::pto_alarm, QuicTraceEvent::zero_rtt));
+}
+
+TEST(QuicTraceTest, RejectsOtherFiles) {
+  folly::test::TemporaryFile file;
+  std::string data = "not a trace file at all";
+  folly::writeFull(file.fd(), data.data(), data.size());
+  ASSERT_EQ(lseek(file.fd(), 0, SEEK_SET), 0);
+  auto result = readQuicTraceFile(file.fd(), [](const auto&) {});
+  EXPECT_TRUE(result.hasError());
+}
+
+} // namespace test
+} // namespace quic
@@ -46,7 +46,7 @@ void onPTOAlarm(QuicConnectionStateBase& conn) {
         (uint64_t)conn.outstandingPackets.size(),
         kPtoAlarm);
   }
-  if (conn.lossState.ptoCount == conn.transportSettings.maxNumPTOs) {
+  if (conn.lossState.ptoCount == conn.transportSettings->maxNumPTOs) {
     throw QuicInternalException("Exceeded max PTO", LocalErrorCode::NO_ERROR);
   }
   conn.pendingEvents.numProbePackets = kPacketToSendForPTO;
@@ -162,6 +162,13 @@ void markPacketLoss(
         onBlockedLost(*stream);
         break;
       }
+      case QuicWriteFrame::Type::DataBlockedFrame_E: {
+        if (processed) {
+          break;
+        }
+        onConnBlockedLost(conn, *packetFrame.asDataBlockedFrame());
+        break;
+      }
       case QuicWriteFrame::Type::QuicSimpleFrame_E: {
         QuicSimpleFrame& frame = *packetFrame.asQuicSimpleFrame();
         if (processed) {
@@ -79,7 +79,7 @@ calculateAlarmDuration(const QuicConnectionStateBase& conn) {
     alarmMethod = LossState::AlarmMethod::EarlyRetransmitOrReordering;
   } else if (conn.outstandingHandshakePacketsCount > 0) {
     if (conn.lossState.srtt == 0us) {
-      alarmDuration = conn.transportSettings.initialRtt * 2;
+      alarmDuration = conn.transportSettings->initialRtt * 2;
     } else {
       alarmDuration = conn.lossState.srtt * 2;
     }
@@ -196,8 +196,8 @@ folly::Optional<CongestionController::LossEvent> detectLossPackets(
   getLossTime(conn, pnSpace).clear();
   std::chrono::microseconds delayUntilLost =
       std::max(conn.lossState.srtt, conn.lossState.lrtt) *
-      conn.transportSettings.timeReorderingThreshDividend /
-      conn.transportSettings.timeReorderingThreshDivisor;
+      conn.transportSettings->timeReorderingThreshDividend /
+      conn.transportSettings->timeReorderingThreshDivisor;
   VLOG(10) << __func__ << " outstanding=" << conn.outstandingPackets.size()
            << " largestAcked=" << largestAcked
            << " delayUntilLost=" << delayUntilLost.count() << "us"
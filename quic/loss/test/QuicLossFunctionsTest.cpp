@@ -330,7 +330,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLoss) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
 
   EXPECT_EQ(1, conn->outstandingPackets.size());
   auto& packet =
@@ -367,7 +367,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLossMerge) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, conn->outstandingPackets.size());
 
   auto buf2 = buildRandomInputData(20);
@@ -380,7 +380,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLossMerge) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(2, conn->outstandingPackets.size());
 
   auto& packet1 =
@@ -423,7 +423,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLossNoMerge) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(1, conn->outstandingPackets.size());
 
   auto buf2 = buildRandomInputData(20);
@@ -436,7 +436,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLossNoMerge) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(2, conn->outstandingPackets.size());
 
   auto buf3 = buildRandomInputData(20);
@@ -449,7 +449,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLossNoMerge) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_EQ(3, conn->outstandingPackets.size());
 
   auto& packet1 =
@@ -535,7 +535,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkCryptoLostAfterCancelRetransmission) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   ASSERT_EQ(conn->outstandingPackets.size(), 1);
   EXPECT_GT(conn->cryptoState->handshakeStream.retransmissionBuffer.size(), 0);
   auto& packet = conn->outstandingPackets.front().packet;
@@ -569,7 +569,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkCryptoLostCancel) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   ASSERT_EQ(conn->outstandingPackets.size(), 1);
   EXPECT_GT(conn->cryptoState->handshakeStream.retransmissionBuffer.size(), 0);
   auto& packet = conn->outstandingPackets.front().packet;
@@ -759,7 +759,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkRstLoss) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
 
   EXPECT_EQ(conn->outstandingPackets.size(), 1);
   EXPECT_TRUE(conn->pendingEvents.resets.empty());
@@ -783,7 +783,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkRstLoss) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_TRUE(conn->pendingEvents.resets.empty());
   auto& packet2 =
       getLastOutstandingPacket(*conn, PacketNumberSpace::AppData)->packet;
@@ -850,7 +850,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkWindowUpdateLoss) {
       *aead,
       *headerCipher,
       *conn->version,
-      conn->transportSettings.writeConnectionDataPacketsLimit);
+      conn->transportSettings->writeConnectionDataPacketsLimit);
   EXPECT_FALSE(conn->streamManager->hasWindowUpdates());
 
   EXPECT_EQ(1, conn->outstandingPackets.size());
@@ -909,7 +909,7 @@ TEST_F(QuicLossFunctionsTest, LossTimePreemptsCryptoTimer) {
   conn->lossState.srtt = 100ms;
   conn->lossState.lrtt = 100ms;
   auto expectedDelayUntilLost =
-      500ms / conn->transportSettings.timeReorderingThreshDivisor;
+      500ms / conn->transportSettings->timeReorderingThreshDivisor;
   auto sendTime = Clock::now();
   // Send two:
   sendPacket(*conn, sendTime, folly::none, PacketType::Handshake);
@@ -1056,7 +1056,7 @@ TEST_F(QuicLossFunctionsTest, AlarmDurationHandshakeOutstanding) {
   MockClock::mockNow = [=]() { return thisMoment; };
   auto duration = calculateAlarmDuration<MockClock>(*conn);
   EXPECT_EQ(
-      conn->transportSettings.initialRtt * 2 - packetSentDelay + 25ms,
+      conn->transportSettings->initialRtt * 2 - packetSentDelay + 25ms,
       duration.first);
   EXPECT_EQ(duration.second, LossState::AlarmMethod::Handshake);
 
@@ -1318,7 +1318,7 @@ TEST_F(QuicLossFunctionsTest, TestExceedsMaxPTOThrows) {
   auto conn = createConn();
   auto mockQLogger = std::make_shared<MockQLogger>(VantagePoint::Server);
   conn->qLogger = mockQLogger;
-  conn->transportSettings.maxNumPTOs = 3;
+  conn->transportSettings.mutate().maxNumPTOs = 3;
   for (int i = 1; i <= 3; i++) {
     EXPECT_CALL(*mockQLogger, addLossAlarm(0, i, 0, kPtoAlarm));
   }
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/ConnectionTombstoneTable.h>
+
+#include <folly/Chrono.h>
+
+namespace quic {
+
+ConnectionTombstoneTable::ConnectionTombstoneTable(folly::EventBase* evb)
+    : evb_(evb) {}
+
+void ConnectionTombstoneTable::add(
+    std::vector<ConnectionId> connectionIds,
+    Buf closePacket,
+    std::chrono::milliseconds drainPeriod) {
+  auto now = Clock::now();
+  auto tombstone = std::make_shared<Tombstone>();
+  tombstone->closePacket = std::move(closePacket);
+  tombstone->expiry = now + drainPeriod;
+  for (const auto& connId : connectionIds) {
+    tombstones_[connId] = tombstone;
+  }
+  expiryQueue_.push_back(
+      ExpiryEntry{tombstone->expiry, std::move(connectionIds)});
+  if (!isScheduled()) {
+    scheduleSweep(now);
+  }
+}
+
+folly::Optional<Buf> ConnectionTombstoneTable::onPacketReceived(
+    const ConnectionId& connId,
+    TimePoint now) {
+  auto it = tombstones_.find(connId);
+  if (it == tombstones_.end() || it->second->expiry <= now) {
+    return folly::none;
+  }
+  auto& tombstone = *it->second;
+  tombstone.packetsReceived++;
+  if (!tombstone.closePacket ||
+      tombstone.packetsReceived < tombstone.nextReplyAt) {
+    return Buf(nullptr);
+  }
+  tombstone.nextReplyAt *= 2;
+  return tombstone.closePacket->clone();
+}
+
+void ConnectionTombstoneTable::sweep(TimePoint now) {
+  while (!expiryQueue_.empty() && expiryQueue_.front().expiry <= now) {
+    for (const auto& connId : expiryQueue_.front().connectionIds) {
+      auto it = tombstones_.find(connId);
+      // The connection id may have been reused by a newer tombstone.
+      if (it != tombstones_.end() && it->second->expiry <= now) {
+        tombstones_.erase(it);
+      }
+    }
+    expiryQueue_.pop_front();
+  }
+}
+
+void ConnectionTombstoneTable::timeoutExpired() noexcept {
+  auto now = Clock::now();
+  sweep(now);
+  scheduleSweep(now);
+}
+
+void ConnectionTombstoneTable::scheduleSweep(TimePoint now) {
+  if (expiryQueue_.empty()) {
+    return;
+  }
+  auto delay = folly::chrono::ceil<std::chrono::milliseconds>(
+      std::max(expiryQueue_.front().expiry - now, Clock::duration::zero()));
+  evb_->timer().scheduleTimeout(this, delay);
+}
+
+} // namespace quic
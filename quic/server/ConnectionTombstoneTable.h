@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/container/F14Map.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/HHWheelTimer.h>
+
+#include <quic/QuicConstants.h>
+#include <quic/codec/QuicConnectionId.h>
+#include <quic/common/BufUtil.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace quic {
+
+/**
+ * Per worker table of connections that are closed but still within their
+ * drain period. Each tombstone only keeps the final close packet, so the
+ * transport itself can be freed as soon as it closes.
+ *
+ * Replies are rate limited: the close packet is sent for the 1st, 2nd, 4th,
+ * 8th, ... packet received for a connection. Expired tombstones are swept by
+ * a single timeout on the event base's wheel timer.
+ */
+class ConnectionTombstoneTable : private folly::HHWheelTimer::Callback {
+ public:
+  explicit ConnectionTombstoneTable(folly::EventBase* evb);
+  ~ConnectionTombstoneTable() override = default;
+
+  /**
+   * Adds a tombstone shared by all the given connection ids, that expires
+   * after drainPeriod. closePacket may be null, in which case packets for
+   * the connection are dropped without a reply.
+   */
+  void add(
+      std::vector<ConnectionId> connectionIds,
+      Buf closePacket,
+      std::chrono::milliseconds drainPeriod);
+
+  /**
+   * Looks up the tombstone for a received packet. Returns folly::none if the
+   * connection id has no live tombstone. Otherwise the packet belongs to a
+   * closed connection and the result is the packet to send back, or nullptr
+   * if nothing should be sent.
+   */
+  folly::Optional<Buf> onPacketReceived(
+      const ConnectionId& connId,
+      TimePoint now = Clock::now());
+
+  size_t size() const {
+    return tombstones_.size();
+  }
+
+  /**
+   * Removes tombstones that expired by 'now'.
+   */
+  void sweep(TimePoint now);
+
+ private:
+  struct Tombstone {
+    Buf closePacket;
+    TimePoint expiry;
+    uint64_t packetsReceived{0};
+    uint64_t nextReplyAt{1};
+  };
+
+  struct ExpiryEntry {
+    TimePoint expiry;
+    std::vector<ConnectionId> connectionIds;
+  };
+
+  void timeoutExpired() noexcept override;
+  void scheduleSweep(TimePoint now);
+
+  folly::EventBase* evb_;
+  folly::F14FastMap<ConnectionId, std::shared_ptr<Tombstone>, ConnectionIdHash>
+      tombstones_;
+  // In insertion order. Drain periods differ between connections, so an
+  // entry may outlive its expiry until the ones ahead of it are swept, but
+  // lookups never return an expired tombstone.
+  std::deque<ExpiryEntry> expiryQueue_;
+};
+
+} // namespace quic
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/IngressPolicer.h>
+
+#include <folly/Random.h>
+#include <folly/hash/Hash.h>
+
+namespace quic {
+
+IngressPolicer::IngressPolicer(const IngressPolicerConfig& config)
+    : config_(config),
+      initials_(folly::Random::rand64()),
+      unroutable_(folly::Random::rand64()) {
+  setConfig(config);
+}
+
+void IngressPolicer::setConfig(const IngressPolicerConfig& config) {
+  config_ = config;
+  initials_.setLimits(config.initialsPerSecond, config.initialBurst);
+  unroutable_.setLimits(config.unroutablePerSecond, config.unroutableBurst);
+}
+
+bool IngressPolicer::admit(
+    const folly::IPAddress& address,
+    PacketType type,
+    TimePoint now) {
+  auto& sketch = type == PacketType::Initial ? initials_ : unroutable_;
+  return sketch.admit(prefixKey(address), now);
+}
+
+uint64_t IngressPolicer::prefixKey(const folly::IPAddress& address) const {
+  if (address.isIPv4Mapped()) {
+    return prefixKey(address.createIPv4());
+  }
+  auto prefixLength =
+      address.isV4() ? config_.ipv4PrefixLength : config_.ipv6PrefixLength;
+  return address.mask(std::min<size_t>(prefixLength, address.bitCount()))
+      .hash();
+}
+
+IngressPolicer::Sketch::Sketch(uint64_t seed) : seed_(seed) {}
+
+void IngressPolicer::Sketch::setLimits(uint64_t perSecond, uint64_t burst) {
+  perSecond_ = perSecond;
+  burst_ = std::max<uint64_t>(burst, 1);
+}
+
+void IngressPolicer::Sketch::drain(TimePoint now) {
+  if (!lastDrain_) {
+    lastDrain_ = now;
+    return;
+  }
+  if (now < *lastDrain_ + kIngressPolicerDrainInterval) {
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      now - *lastDrain_);
+  auto drained = static_cast<float>(perSecond_ * elapsed.count() / 1000000.0);
+  lastDrain_ = now;
+  for (auto& row : levels_) {
+    for (auto& level : row) {
+      level = level > drained ? level - drained : 0;
+    }
+  }
+}
+
+bool IngressPolicer::Sketch::admit(uint64_t key, TimePoint now) {
+  if (perSecond_ == 0) {
+    return true;
+  }
+  drain(now);
+  std::array<size_t, kIngressPolicerSketchDepth> cells;
+  float estimate = std::numeric_limits<float>::max();
+  for (size_t row = 0; row < kIngressPolicerSketchDepth; ++row) {
+    cells[row] = folly::hash::hash_128_to_64(key, seed_ + row) %
+        kIngressPolicerSketchWidth;
+    estimate = std::min(estimate, levels_[row][cells[row]]);
+  }
+  if (estimate + 1 > burst_) {
+    return false;
+  }
+  // Conservative update: only the buckets at the estimate are raised, which
+  // keeps the error from sources sharing buckets low.
+  for (size_t row = 0; row < kIngressPolicerSketchDepth; ++row) {
+    auto& level = levels_[row][cells[row]];
+    level = std::max(level, estimate + 1);
+  }
+  return true;
+}
+
+} // namespace quic
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/Optional.h>
+
+#include <quic/QuicConstants.h>
+
+#include <array>
+
+namespace quic {
+
+struct IngressPolicerConfig {
+  // Sources are policed by address prefix, so that a single network can not
+  // get around the limits by spreading over many of its addresses.
+  uint8_t ipv4PrefixLength{kDefaultIngressPolicerIPv4PrefixLength};
+  uint8_t ipv6PrefixLength{kDefaultIngressPolicerIPv6PrefixLength};
+
+  // Initial packets that would create a new connection. A rate of 0 turns
+  // the limit off.
+  uint64_t initialsPerSecond{kDefaultIngressPolicerInitialsPerSecond};
+  uint64_t initialBurst{kDefaultIngressPolicerInitialBurst};
+
+  // Packets that match no connection. A rate of 0 turns the limit off.
+  uint64_t unroutablePerSecond{kDefaultIngressPolicerUnroutablePerSecond};
+  uint64_t unroutableBurst{kDefaultIngressPolicerUnroutableBurst};
+};
+
+/**
+ * Per worker policer for the packets that cost the server the most work
+ * without belonging to an established connection: Initials that create
+ * connections, and packets that can not be routed.
+ *
+ * Each source prefix gets a token bucket, but buckets are not kept per
+ * prefix. They are cells of a count-min sketch, so memory is fixed no
+ * matter how many sources there are. A prefix sharing every one of its cells
+ * with heavier sources may be limited early; it is never limited late.
+ */
+class IngressPolicer {
+ public:
+  enum class PacketType : uint8_t {
+    Initial,
+    Unroutable,
+  };
+
+  explicit IngressPolicer(const IngressPolicerConfig& config);
+
+  /**
+   * Changes the limits. Buckets keep their current level.
+   */
+  void setConfig(const IngressPolicerConfig& config);
+
+  const IngressPolicerConfig& getConfig() const {
+    return config_;
+  }
+
+  /**
+   * Returns whether a packet of the given type from address is within the
+   * limits, and if so takes a token for it.
+   */
+  bool admit(
+      const folly::IPAddress& address,
+      PacketType type,
+      TimePoint now = Clock::now());
+
+ private:
+  class Sketch {
+   public:
+    explicit Sketch(uint64_t seed);
+
+    void setLimits(uint64_t perSecond, uint64_t burst);
+
+    bool admit(uint64_t key, TimePoint now);
+
+   private:
+    void drain(TimePoint now);
+
+    uint64_t seed_;
+    double perSecond_{0};
+    double burst_{0};
+    folly::Optional<TimePoint> lastDrain_;
+    // Level of each bucket, in packets. A packet is admitted while the
+    // smallest of its buckets is below the burst.
+    std::array<
+        std::array<float, kIngressPolicerSketchWidth>,
+        kIngressPolicerSketchDepth>
+        levels_{};
+  };
+
+  uint64_t prefixKey(const folly::IPAddress& address) const;
+
+  IngressPolicerConfig config_;
+  Sketch initials_;
+  Sketch unroutable_;
+};
+
+} // namespace quic
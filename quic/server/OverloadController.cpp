@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/OverloadController.h>
+
+#include <folly/lang/Assume.h>
+#include <glog/logging.h>
+
+namespace quic {
+
+folly::StringPiece overloadLevelToString(OverloadLevel level) {
+  switch (level) {
+    case OverloadLevel::None:
+      return "None";
+    case OverloadLevel::ShrinkWindows:
+      return "ShrinkWindows";
+    case OverloadLevel::ThrottleInitials:
+      return "ThrottleInitials";
+    case OverloadLevel::RejectNewConnections:
+      return "RejectNewConnections";
+  }
+  folly::assume_unreachable();
+}
+
+OverloadController::OverloadController(
+    folly::EventBase* evb,
+    const OverloadControllerConfig& config,
+    LevelCallback levelCallback)
+    : folly::AsyncTimeout(evb),
+      evb_(evb),
+      config_(config),
+      levelCallback_(std::move(levelCallback)) {}
+
+void OverloadController::start() {
+  DCHECK(evb_->isInEventBaseThread());
+  if (!isScheduled()) {
+    scheduleInterval();
+  }
+}
+
+void OverloadController::setConfig(const OverloadControllerConfig& config) {
+  config_ = config;
+}
+
+void OverloadController::setNextObserver(
+    std::shared_ptr<folly::EventBaseObserver> observer) {
+  nextObserver_ = std::move(observer);
+  nextObserverLoops_ = 0;
+}
+
+void OverloadController::onKernelDrops(uint64_t drops) {
+  kernelDrops_ += drops;
+}
+
+void OverloadController::loopSample(int64_t busyTime, int64_t idleTime) {
+  busyTime_ += busyTime;
+  idleTime_ += idleTime;
+  if (nextObserver_ &&
+      ++nextObserverLoops_ >= nextObserver_->getSampleRate()) {
+    nextObserverLoops_ = 0;
+    nextObserver_->loopSample(busyTime, idleTime);
+  }
+}
+
+void OverloadController::onIntervalEnd(std::chrono::microseconds loopLag) {
+  double sample = 0;
+  if (busyTime_ + idleTime_ > 0) {
+    sample = static_cast<double>(busyTime_) / (busyTime_ + idleTime_);
+  }
+  auto maxLoopLag =
+      std::chrono::duration_cast<std::chrono::microseconds>(config_.maxLoopLag);
+  if (maxLoopLag.count() > 0) {
+    sample = std::max(
+        sample, static_cast<double>(loopLag.count()) / maxLoopLag.count());
+  }
+  if (config_.maxKernelDrops > 0) {
+    sample = std::max(
+        sample, static_cast<double>(kernelDrops_) / config_.maxKernelDrops);
+  }
+  busyTime_ = 0;
+  idleTime_ = 0;
+  kernelDrops_ = 0;
+  load_ = kOverloadLoadEwmaWeight * std::min(sample, 1.0) +
+      (1 - kOverloadLoadEwmaWeight) * load_;
+
+  auto level = static_cast<size_t>(level_);
+  auto raised = level;
+  while (raised < config_.levelThresholds.size() &&
+         load_ >= config_.levelThresholds[raised]) {
+    ++raised;
+  }
+  if (raised > level) {
+    level = raised;
+  } else {
+    while (level > 0 &&
+           load_ < config_.levelThresholds[level - 1] - config_.hysteresis) {
+      --level;
+    }
+  }
+  if (level != static_cast<size_t>(level_)) {
+    VLOG(2) << "Overload level " << overloadLevelToString(level_) << " -> "
+            << overloadLevelToString(static_cast<OverloadLevel>(level))
+            << " at load=" << load_;
+    level_ = static_cast<OverloadLevel>(level);
+    if (levelCallback_) {
+      levelCallback_(level_);
+    }
+  }
+}
+
+void OverloadController::timeoutExpired() noexcept {
+  auto now = Clock::now();
+  auto lag = now > intervalDeadline_
+      ? std::chrono::duration_cast<std::chrono::microseconds>(
+            now - intervalDeadline_)
+      : std::chrono::microseconds::zero();
+  onIntervalEnd(lag);
+  scheduleInterval();
+}
+
+void OverloadController::scheduleInterval() {
+  intervalDeadline_ = Clock::now() + config_.sampleInterval;
+  scheduleTimeout(config_.sampleInterval);
+}
+
+} // namespace quic
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+#include <quic/QuicConstants.h>
+
+#include <array>
+
+namespace quic {
+
+/**
+ * Steps a worker takes as it gets more loaded. Each level includes the
+ * steps of the levels below it.
+ */
+enum class OverloadLevel : uint8_t {
+  None,
+  // New connections get smaller flow control windows, so each of them
+  // brings less data to process.
+  ShrinkWindows,
+  // Initials that would create a connection are rate limited.
+  ThrottleInitials,
+  // New connections are turned away.
+  RejectNewConnections,
+};
+
+folly::StringPiece overloadLevelToString(OverloadLevel level);
+
+struct OverloadControllerConfig {
+  std::chrono::milliseconds sampleInterval{kDefaultOverloadSampleInterval};
+
+  // Loop lag, and kernel receive queue drops per interval, at which the
+  // worker counts as fully loaded.
+  std::chrono::milliseconds maxLoopLag{kDefaultOverloadMaxLoopLag};
+  uint64_t maxKernelDrops{kDefaultOverloadMaxKernelDrops};
+
+  // Load, between 0 and 1, at which each level above None is entered. A
+  // level is left once the load falls hysteresis below its threshold.
+  std::array<double, 3> levelThresholds{{0.7, 0.85, 0.95}};
+  double hysteresis{0.15};
+
+  // Fraction of the configured windows given to new connections from
+  // ShrinkWindows up.
+  double windowScale{0.5};
+
+  // New connections per second allowed from ThrottleInitials up. Must be
+  // positive.
+  uint64_t throttledInitialsPerSecond{100};
+};
+
+/**
+ * Tracks how loaded a worker's event loop is and picks an OverloadLevel.
+ *
+ * The load of each interval is the largest of: the fraction of time the
+ * loop was busy, as reported to the EventBaseObserver; how late a timeout
+ * fired, relative to maxLoopLag; and the receive queue drops reported by the
+ * worker, relative to maxKernelDrops. Levels follow a moving average of the
+ * load, going up as soon as a threshold is crossed and down with
+ * hysteresis.
+ *
+ * Only one observer can be set on an event base, so any other observer is
+ * given to setNextObserver and keeps getting samples at its own rate.
+ */
+class OverloadController : public folly::EventBaseObserver,
+                           private folly::AsyncTimeout {
+ public:
+  using LevelCallback = folly::Function<void(OverloadLevel)>;
+
+  OverloadController(
+      folly::EventBase* evb,
+      const OverloadControllerConfig& config,
+      LevelCallback levelCallback);
+
+  /**
+   * Starts measuring the loop lag. Must be called on the event base's
+   * thread; the owner is responsible for installing the controller as the
+   * event base's observer.
+   */
+  void start();
+
+  void setConfig(const OverloadControllerConfig& config);
+
+  void setNextObserver(std::shared_ptr<folly::EventBaseObserver> observer);
+
+  const std::shared_ptr<folly::EventBaseObserver>& getNextObserver() const {
+    return nextObserver_;
+  }
+
+  const OverloadControllerConfig& getConfig() const {
+    return config_;
+  }
+
+  OverloadLevel getLevel() const {
+    return level_;
+  }
+
+  double getLoad() const {
+    return load_;
+  }
+
+  void onKernelDrops(uint64_t drops);
+
+  /**
+   * Closes the current interval. Called by the controller's own timeout;
+   * exposed for tests.
+   */
+  void onIntervalEnd(std::chrono::microseconds loopLag);
+
+  // folly::EventBaseObserver
+  uint32_t getSampleRate() const override {
+    return 1;
+  }
+
+  void loopSample(int64_t busyTime, int64_t idleTime) override;
+
+ private:
+  void timeoutExpired() noexcept override;
+
+  void scheduleInterval();
+
+  folly::EventBase* evb_;
+  OverloadControllerConfig config_;
+  LevelCallback levelCallback_;
+  std::shared_ptr<folly::EventBaseObserver> nextObserver_;
+  uint32_t nextObserverLoops_{0};
+
+  TimePoint intervalDeadline_;
+  int64_t busyTime_{0};
+  int64_t idleTime_{0};
+  uint64_t kernelDrops_{0};
+  double load_{0};
+  OverloadLevel level_{OverloadLevel::None};
+};
+
+} // namespace quic
@@ -136,13 +136,22 @@ void QuicServer::initializeWorkers(
     const std::vector<folly::EventBase*>& evbs,
     bool useDefaultTransport) {
   CHECK(workers_.empty());
+  // All workers share a single immutable copy of the settings.
+  auto transportSettings =
+      std::make_shared<const TransportSettings>(transportSettings_);
   for (auto& workerEvb : evbs) {
-    auto worker = newWorkerWithoutSocket();
+    auto worker = newWorkerWithoutSocket(transportSettings);
     if (useDefaultTransport) {
       CHECK(transportFactory_) << "Transport factory is not set";
       worker->setTransportFactory(transportFactory_.get());
       worker->setFizzContext(ctx_);
     }
+    if (ingressPolicerConfig_) {
+      worker->setIngressPolicerConfig(ingressPolicerConfig_);
+    }
+    if (overloadControllerConfig_) {
+      worker->setOverloadControllerConfig(overloadControllerConfig_);
+    }
     if (healthCheckToken_) {
       worker->setHealthCheckToken(*healthCheckToken_);
     }
@@ -164,16 +173,18 @@ void QuicServer::initializeWorkers(
     worker->setCongestionControllerFactory(ccFactory_);
     worker->setWorkerId(workers_.size());
     worker->setTransportSettingsOverrideFn(transportSettingsOverrideFn_);
+    worker->setTransportSettingsProfileFn(transportSettingsProfileFn_);
     workers_.push_back(std::move(worker));
     evbToWorkers_.emplace(workerEvb, workers_.back().get());
   }
 }
 
-std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket() {
+std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket(
+    std::shared_ptr<const TransportSettings> transportSettings) {
   auto worker = std::make_unique<QuicServerWorker>(this->shared_from_this());
   worker->setNewConnectionSocketFactory(socketFactory_.get());
   worker->setSupportedVersions(supportedVersions_);
-  worker->setTransportSettings(transportSettings_);
+  worker->setTransportSettings(std::move(transportSettings));
   worker->rejectNewConnections(rejectNewConnections_);
   worker->setProcessId(processId_);
   worker->setHostId(hostId_);
@@ -484,6 +495,12 @@ void QuicServer::setTransportSettingsOverrideFn(
   transportSettingsOverrideFn_ = std::move(fn);
 }
 
+void QuicServer::setTransportSettingsProfileFn(TransportSettingsProfileFn fn) {
+  CHECK(!initialized_) << "Transport settings profile function must be"
+                       << "set before initializing Quic server";
+  transportSettingsProfileFn_ = std::move(fn);
+}
+
 void QuicServer::setHealthCheckToken(const std::string& healthCheckToken) {
   // Make sure the token satisfies the required properties, i.e. it is not a
   // valid quic header.
@@ -523,9 +540,11 @@ const TransportSettings& QuicServer::getTransportSettings() const noexcept {
 }
 
 void QuicServer::setTransportSettings(TransportSettings transportSettings) {
-  transportSettings_ = transportSettings;
-  runOnAllWorkers([transportSettings](auto worker) mutable {
-    worker->setTransportSettings(transportSettings);
+  transportSettings_ = std::move(transportSettings);
+  auto sharedSettings =
+      std::make_shared<const TransportSettings>(transportSettings_);
+  runOnAllWorkers([sharedSettings](auto worker) mutable {
+    worker->setTransportSettings(sharedSettings);
   });
 }
 
@@ -542,6 +561,22 @@ void QuicServer::enablePartialReliability(bool enabled) {
   });
 }
 
+void QuicServer::setIngressPolicerConfig(
+    folly::Optional<IngressPolicerConfig> config) {
+  ingressPolicerConfig_ = config;
+  runOnAllWorkers([config](auto worker) mutable {
+    worker->setIngressPolicerConfig(config);
+  });
+}
+
+void QuicServer::setOverloadControllerConfig(
+    folly::Optional<OverloadControllerConfig> config) {
+  overloadControllerConfig_ = config;
+  runOnAllWorkers([config](auto worker) mutable {
+    worker->setOverloadControllerConfig(config);
+  });
+}
+
 void QuicServer::setEventBaseObserver(
     std::shared_ptr<folly::EventBaseObserver> observer) {
   if (shutdown_ || workerEvbs_.empty()) {
@@ -549,9 +584,8 @@ void QuicServer::setEventBaseObserver(
   }
   workerEvbs_.front()->getEventBase()->runInEventBaseThreadAndWait(
       [&] { evbObserver_ = observer; });
-  runOnAllWorkers([observer](auto worker) {
-    worker->getEventBase()->setObserver(observer);
-  });
+  runOnAllWorkers(
+      [observer](auto worker) { worker->setEventBaseObserver(observer); });
 };
 
 void QuicServer::startPacketForwarding(const folly::SocketAddress& destAddr) {
@@ -34,6 +34,9 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
           const quic::TransportSettings&,
           const folly::IPAddress&)>;
 
+  using TransportSettingsProfileFn =
+      QuicServerWorker::TransportSettingsProfileFn;
+
   static std::shared_ptr<QuicServer> createQuicServer() {
     return std::shared_ptr<QuicServer>(new QuicServer());
   }
@@ -67,6 +70,15 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
    */
   void setTransportSettingsOverrideFn(TransportSettingsOverrideFn fn);
 
+  /*
+   * Take in a function to select a shared, immutable transport settings
+   * profile for a new connection, given the client address as input. The
+   * function is invoked with the server's default profile and may return
+   * nullptr to keep it. Profiles are shared by all workers, so they must not
+   * be modified once handed out.
+   */
+  void setTransportSettingsProfileFn(TransportSettingsProfileFn fn);
+
   /*
    * Transport factory to create server-transport.
    * QuicServer calls 'make()' on the supplied transport factory for *each* new
@@ -160,6 +172,20 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
    */
   void enablePartialReliability(bool enabled);
 
+  /**
+   * Limits the Initials and unroutable packets each worker accepts from any
+   * one source prefix. Takes effect immediately; folly::none turns policing
+   * off.
+   */
+  void setIngressPolicerConfig(folly::Optional<IngressPolicerConfig> config);
+
+  /**
+   * Turns on overload protection in each worker, driven by the worker's own
+   * event loop. Takes effect immediately; folly::none turns it off.
+   */
+  void setOverloadControllerConfig(
+      folly::Optional<OverloadControllerConfig> config);
+
   /**
    * Returns listening address of this server
    */
@@ -312,7 +338,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
       const std::vector<folly::EventBase*>& evbs,
       bool useDefaultTransport);
 
-  std::unique_ptr<QuicServerWorker> newWorkerWithoutSocket();
+  std::unique_ptr<QuicServerWorker> newWorkerWithoutSocket(
+      std::shared_ptr<const TransportSettings> transportSettings);
 
   // helper method to run the given function in all worker asynchronously
   void runOnAllWorkers(const std::function<void(QuicServerWorker*)>& func);
@@ -359,6 +386,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   ProcessId processId_{ProcessId::ZERO};
   uint16_t hostId_{0};
   bool rejectNewConnections_{false};
+  folly::Optional<IngressPolicerConfig> ingressPolicerConfig_;
+  folly::Optional<OverloadControllerConfig> overloadControllerConfig_;
   // factory to create per worker QuicTransportStatsCallback
   std::unique_ptr<QuicTransportStatsCallbackFactory> transportStatsFactory_;
   // factory to create per worker ConnectionIdAlgo
@@ -367,6 +396,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   std::unique_ptr<ConnectionIdAlgo> connIdAlgo_;
   // Used to override certain transport parameters, given the client address
   TransportSettingsOverrideFn transportSettingsOverrideFn_;
+  // Used to select a shared settings profile, given the client address
+  TransportSettingsProfileFn transportSettingsProfileFn_;
   // address that the server is bound to
   folly::SocketAddress boundAddress_;
 };
@@ -23,11 +23,9 @@ constexpr uint16_t kMaxBufSizeForTakeoverEncapsulation = 64;
 TakeoverHandlerCallback::TakeoverHandlerCallback(
     QuicServerWorker* worker,
     TakeoverPacketHandler& takeoverPktHandler,
-    const TransportSettings& transportSettings,
     std::unique_ptr<folly::AsyncUDPSocket> socket)
     : worker_(worker),
       takeoverPktHandler_(takeoverPktHandler),
-      transportSettings_(transportSettings),
       socket_(std::move(socket)) {}
 
 TakeoverHandlerCallback::~TakeoverHandlerCallback() {
@@ -74,12 +72,13 @@ int TakeoverHandlerCallback::getSocketFD() {
 }
 
 void TakeoverHandlerCallback::getReadBuffer(void** buf, size_t* len) noexcept {
-  readBuffer_ = folly::IOBuf::create(
-      transportSettings_.maxRecvPacketSize +
-      kMaxBufSizeForTakeoverEncapsulation);
-  *buf = readBuffer_->writableData();
-  *len = transportSettings_.maxRecvPacketSize +
+  // Settings are owned by the worker and may be swapped at runtime, so look
+  // them up on every read instead of holding on to a reference.
+  const auto bufSize = worker_->getTransportSettings().maxRecvPacketSize +
       kMaxBufSizeForTakeoverEncapsulation;
+  readBuffer_ = folly::IOBuf::create(bufSize);
+  *buf = readBuffer_->writableData();
+  *len = bufSize;
 }
 
 void TakeoverHandlerCallback::onDataAvailable(
@@ -112,7 +112,6 @@ class TakeoverHandlerCallback : public folly::AsyncUDPSocket::ReadCallback,
   explicit TakeoverHandlerCallback(
       QuicServerWorker* worker,
       TakeoverPacketHandler& takeoverPktHandler,
-      const TransportSettings& transportSettings,
       std::unique_ptr<folly::AsyncUDPSocket> socket);
 
   // prevent copying
@@ -153,8 +152,6 @@ class TakeoverHandlerCallback : public folly::AsyncUDPSocket::ReadCallback,
   QuicServerWorker* worker_;
   // QuicServerWorker owns Packethandler
   TakeoverPacketHandler& takeoverPktHandler_;
-  // QuicServerWorker owns the transport settings
-  const TransportSettings& transportSettings_;
   folly::SocketAddress address_;
   std::unique_ptr<folly::AsyncUDPSocket> socket_;
   Buf readBuffer_;
@@ -11,6 +11,7 @@
 #include <quic/server/handshake/AppToken.h>
 #include <quic/server/handshake/DefaultAppTokenValidator.h>
 #include <quic/server/handshake/StatelessResetGenerator.h>
+#include <quic/server/handshake/TokenGenerator.h>
 #include <algorithm>
 
 namespace quic {
@@ -25,6 +26,7 @@ QuicServerTransport::QuicServerTransport(
   tempConn->serverAddr = socket_->address();
   serverConn_ = tempConn.get();
   conn_.reset(tempConn.release());
+  conn_->clock.attachEventBase(evb);
   // TODO: generate this when we can encode the packet sequence number
   // correctly.
   // conn_->nextSequenceNum = folly::Random::secureRandom<PacketNum>();
@@ -121,13 +123,14 @@ void QuicServerTransport::onReadData(
   maybeWriteNewSessionTicket();
   maybeNotifyConnectionIdBound();
   maybeIssueConnectionIds();
+  maybeIssueNewToken();
   maybeNotifyTransportReady();
 }
 
 void QuicServerTransport::accept() {
   setIdleTimer();
   updateFlowControlStateWithSettings(
-      conn_->flowControlState, conn_->transportSettings);
+      conn_->flowControlState, *conn_->transportSettings);
   serverConn_->serverHandshakeLayer->initialize(
       evb_,
       ctx_,
@@ -164,7 +167,7 @@ void QuicServerTransport::writeData() {
       // pending in which case we would not derive the 1-RTT keys. We
       // shouldn't send a long header at this point, because the client may
       // have already dropped its handshake keys.
-      writeShortClose(
+      closePacket_ = writeShortClose(
           *socket_,
           *conn_,
           destConnId /* dst */,
@@ -173,7 +176,7 @@ void QuicServerTransport::writeData() {
           *conn_->oneRttWriteHeaderCipher);
     } else if (conn_->initialWriteCipher) {
       CHECK(conn_->initialHeaderCipher);
-      writeLongClose(
+      closePacket_ = writeLongClose(
           *socket_,
           *conn_,
           srcConnId /* src */,
@@ -192,11 +195,13 @@ void QuicServerTransport::writeData() {
     // could not be parsed later.
     return;
   }
+  maybeUpdateConnectedSocket();
 
   uint64_t packetLimit =
       (isConnectionPaced(*conn_)
-           ? conn_->pacer->updateAndGetWriteBatchSize(Clock::now())
-           : conn_->transportSettings.writeConnectionDataPacketsLimit);
+           ? conn_->pacer->updateAndGetWriteBatchSize(
+                 conn_->clock.coarseNow())
+           : conn_->transportSettings->writeConnectionDataPacketsLimit);
   CryptoStreamScheduler initialScheduler(
       *conn_, *getCryptoStream(*conn_->cryptoState, EncryptionLevel::Initial));
   CryptoStreamScheduler handshakeScheduler(
@@ -263,6 +268,9 @@ void QuicServerTransport::closeTransport() {
 }
 
 void QuicServerTransport::unbindConnection() {
+  if (connectedSocketPeer_) {
+    releaseConnectedSocket();
+  }
   if (routingCb_) {
     auto routingCb = routingCb_;
     routingCb_ = nullptr;
@@ -277,6 +285,75 @@ void QuicServerTransport::unbindConnection() {
   }
 }
 
+void QuicServerTransport::maybeUpdateConnectedSocket() {
+  if (connectedSocketPeer_) {
+    if (!routingCb_ || *connectedSocketPeer_ != conn_->peerAddress) {
+      releaseConnectedSocket();
+    }
+    return;
+  }
+  auto minBytesSent = conn_->transportSettings->connectedSocketMinBytesSent;
+  if (minBytesSent == 0 || connectedSocketRequested_ || !routingCb_ ||
+      !conn_->readCodec->getOneRttReadCipher() ||
+      conn_->lossState.totalBytesSent < minBytesSent) {
+    return;
+  }
+  // Only asked once; a connection that migrated away keeps the shared one.
+  connectedSocketRequested_ = true;
+  auto connectedSocket = routingCb_->onConnectedSocketRequested(
+      conn_->peerAddress);
+  if (!connectedSocket) {
+    return;
+  }
+  VLOG(4) << "Using a connected socket for peer=" << conn_->peerAddress << " "
+          << *this;
+  sharedSocket_ = std::move(socket_);
+  socket_ = std::move(connectedSocket);
+  connectedSocketPeer_ = conn_->peerAddress;
+}
+
+void QuicServerTransport::releaseConnectedSocket() {
+  VLOG(4) << "Releasing the connected socket for peer="
+          << *connectedSocketPeer_ << " " << *this;
+  // Drop our handle on the connected socket before its owner closes it. A
+  // transport that already tore down its socket must not get the shared one
+  // back, so close our handle on that one too.
+  if (socket_) {
+    socket_ = std::move(sharedSocket_);
+  } else {
+    auto sharedSocket = std::move(sharedSocket_);
+    sharedSocket->pauseRead();
+    sharedSocket->close();
+  }
+  auto peer = std::move(*connectedSocketPeer_);
+  connectedSocketPeer_.clear();
+  if (routingCb_) {
+    routingCb_->onConnectedSocketReleased(peer);
+  }
+}
+
+bool QuicServerTransport::handOffDrain(std::chrono::milliseconds drainPeriod) {
+  if (!conn_->transportSettings->drainWithTombstones || !routingCb_ ||
+      !conn_->serverConnectionId) {
+    return false;
+  }
+  std::vector<ConnectionId> connectionIds;
+  connectionIds.reserve(conn_->selfConnectionIds.size() + 1);
+  for (const auto& connIdData : conn_->selfConnectionIds) {
+    connectionIds.push_back(connIdData.connId);
+  }
+  // Retransmitted client initials still carry the client chosen id.
+  if (conn_->clientChosenDestConnectionId) {
+    connectionIds.push_back(*conn_->clientChosenDestConnectionId);
+  }
+  // Once the peer closed we are draining and must not send anything else.
+  Buf closePacket =
+      conn_->peerConnectionError ? nullptr : std::move(closePacket_);
+  routingCb_->onConnectionTombstoned(
+      std::move(connectionIds), std::move(closePacket), drainPeriod);
+  return true;
+}
+
 bool QuicServerTransport::hasWriteCipher() const {
   return conn_->oneRttWriteCipher != nullptr;
 }
@@ -313,6 +390,7 @@ void QuicServerTransport::onCryptoEventAvailable() noexcept {
     maybeWriteNewSessionTicket();
     maybeNotifyConnectionIdBound();
     maybeIssueConnectionIds();
+    maybeIssueNewToken();
     writeSocketData();
     maybeNotifyTransportReady();
   } catch (const QuicTransportException& ex) {
@@ -387,14 +465,14 @@ void QuicServerTransport::maybeWriteNewSessionTicket() {
     newSessionTicketWritten_ = true;
     AppToken appToken;
     appToken.transportParams = createTicketTransportParameters(
-        conn_->transportSettings.idleTimeout.count(),
-        conn_->transportSettings.maxRecvPacketSize,
-        conn_->transportSettings.advertisedInitialConnectionWindowSize,
-        conn_->transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-        conn_->transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-        conn_->transportSettings.advertisedInitialUniStreamWindowSize,
-        conn_->transportSettings.advertisedInitialMaxStreamsBidi,
-        conn_->transportSettings.advertisedInitialMaxStreamsUni);
+        conn_->transportSettings->idleTimeout.count(),
+        conn_->transportSettings->maxRecvPacketSize,
+        conn_->transportSettings->advertisedInitialConnectionWindowSize,
+        conn_->transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+        conn_->transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+        conn_->transportSettings->advertisedInitialUniStreamWindowSize,
+        conn_->transportSettings->advertisedInitialMaxStreamsBidi,
+        conn_->transportSettings->advertisedInitialMaxStreamsUni);
     appToken.sourceAddresses = serverConn_->tokenSourceAddresses;
     appToken.version = conn_->version;
     // If a client connects to server for the first time and doesn't attempt
@@ -419,14 +497,18 @@ void QuicServerTransport::maybeNotifyConnectionIdBound() {
       serverConn_->serverHandshakeLayer->isHandshakeDone()) {
     notifiedConnIdBound_ = true;
     routingCb_->onConnectionIdBound(shared_from_this());
+    if (serverConn_->preferredAddressConnectionId) {
+      routingCb_->onConnectionIdAvailable(
+          shared_from_this(), *serverConn_->preferredAddressConnectionId);
+    }
   }
 }
 
 void QuicServerTransport::maybeIssueConnectionIds() {
-  if (!conn_->transportSettings.disableMigration && !connectionIdsIssued_ &&
+  if (!conn_->transportSettings->disableMigration && !connectionIdsIssued_ &&
       serverConn_->serverHandshakeLayer->isHandshakeDone()) {
     connectionIdsIssued_ = true;
-    CHECK(conn_->transportSettings.statelessResetTokenSecret.hasValue());
+    CHECK(conn_->transportSettings->statelessResetTokenSecret.hasValue());
 
     // If the peer specifies that they have a limit of 1,000,000 connection ids
     // then only issue a small number at first, since the server still
@@ -453,6 +535,23 @@ void QuicServerTransport::maybeIssueConnectionIds() {
   }
 }
 
+void QuicServerTransport::maybeIssueNewToken() {
+  if (newTokenIssued_ || !conn_->transportSettings->newTokenSecret ||
+      !serverConn_->serverHandshakeLayer->isHandshakeDone()) {
+    return;
+  }
+  newTokenIssued_ = true;
+  const auto& generator =
+      getThreadTokenGenerator(*conn_->transportSettings->newTokenSecret);
+  auto token = generator.encryptToken(
+      conn_->peerAddress.getIPAddress(), std::chrono::system_clock::now());
+  if (!token) {
+    VLOG(4) << "Failed to generate new token " << *this;
+    return;
+  }
+  sendSimpleFrame(*conn_, NewTokenFrame(std::move(token)));
+}
+
 void QuicServerTransport::maybeNotifyTransportReady() {
   if (!transportReadyNotified_ && connCallback_ && hasWriteCipher()) {
     if (conn_->qLogger) {
@@ -44,6 +44,24 @@ class QuicServerTransport
         QuicServerTransport* transport,
         const SourceIdentity& address,
         const std::vector<ConnectionIdData>& connectionIdData) noexcept = 0;
+
+    // Called when a closed connection hands off answering the peer for the
+    // rest of its drain period. A null closePacket means packets for the
+    // connection ids should be dropped silently.
+    virtual void onConnectionTombstoned(
+        std::vector<ConnectionId> connectionIds,
+        Buf closePacket,
+        std::chrono::milliseconds drainPeriod) noexcept = 0;
+
+    // Called when the connection wants a socket of its own, connected to
+    // peer. Datagrams arriving on it must still be routed by the callback.
+    // Returns null if no socket could be made.
+    virtual std::unique_ptr<folly::AsyncUDPSocket> onConnectedSocketRequested(
+        const folly::SocketAddress& peer) noexcept = 0;
+
+    // Called once the connection stopped using its connected socket.
+    virtual void onConnectedSocketReleased(
+        const folly::SocketAddress& peer) noexcept = 0;
   };
 
   static QuicServerTransport::Ptr make(
@@ -99,6 +117,7 @@ class QuicServerTransport
   void writeData() override;
   void closeTransport() override;
   void unbindConnection() override;
+  bool handOffDrain(std::chrono::milliseconds drainPeriod) override;
   bool hasWriteCipher() const override;
   std::shared_ptr<QuicTransportBase> sharedGuard() override;
 
@@ -124,15 +143,28 @@ class QuicServerTransport
   void maybeNotifyConnectionIdBound();
   void maybeWriteNewSessionTicket();
   void maybeIssueConnectionIds();
+  void maybeIssueNewToken();
+  // Moves writes to a connected socket once the connection has proven
+  // itself a bulk flow, and back to the shared socket when the peer
+  // migrates or the connection is unbound.
+  void maybeUpdateConnectedSocket();
+  void releaseConnectedSocket();
 
  private:
   RoutingCallback* routingCb_{nullptr};
+  // The worker's shared socket, kept while writing to a connected one.
+  std::unique_ptr<folly::AsyncUDPSocket> sharedSocket_;
+  folly::Optional<folly::SocketAddress> connectedSocketPeer_;
+  bool connectedSocketRequested_{false};
   std::shared_ptr<const fizz::server::FizzServerContext> ctx_;
   bool notifiedRouting_{false};
   bool notifiedConnIdBound_{false};
   bool newSessionTicketWritten_{false};
   bool shedConnection_{false};
   bool connectionIdsIssued_{false};
+  bool newTokenIssued_{false};
+  // Last close packet sent, handed to the worker's tombstone table on drain.
+  Buf closePacket_;
   QuicServerConnectionState* serverConn_;
 };
 } // namespace quic
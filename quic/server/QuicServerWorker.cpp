@@ -9,6 +9,7 @@
 #include <folly/io/Cursor.h>
 #include <folly/system/ThreadId.h>
 #include <quic/QuicConstants.h>
+#include <quic/common/QuicClock.h>
 #include <quic/common/Timers.h>
 
 #include <quic/server/QuicServerWorker.h>
@@ -16,6 +17,18 @@
 
 namespace quic {
 
+namespace {
+void shrinkAdvertisedWindows(TransportSettings& settings, double scale) {
+  auto shrink = [scale](uint64_t& window) {
+    window = std::max<uint64_t>(window * scale, kDefaultUDPSendPacketLen);
+  };
+  shrink(settings.advertisedInitialConnectionWindowSize);
+  shrink(settings.advertisedInitialBidiLocalStreamWindowSize);
+  shrink(settings.advertisedInitialBidiRemoteStreamWindowSize);
+  shrink(settings.advertisedInitialUniStreamWindowSize);
+}
+} // namespace
+
 QuicServerWorker::QuicServerWorker(
     std::shared_ptr<QuicServerWorker::WorkerCallback> callback)
     : callback_(callback), takeoverPktHandler_(this) {}
@@ -42,6 +55,11 @@ void QuicServerWorker::setTransportSettingsOverrideFn(
   transportSettingsOverrideFn_ = std::move(fn);
 }
 
+void QuicServerWorker::setTransportSettingsProfileFn(
+    TransportSettingsProfileFn fn) {
+  transportSettingsProfileFn_ = std::move(fn);
+}
+
 void QuicServerWorker::setTransportInfoCallback(
     std::unique_ptr<QuicTransportStatsCallback> infoCallback) noexcept {
   CHECK(infoCallback);
@@ -69,8 +87,10 @@ void QuicServerWorker::start() {
   CHECK(socket_);
   if (!pacingTimer_) {
     pacingTimer_ = TimerHighRes::newTimer(
-        evb_, transportSettings_.pacingTimerTickInterval);
+        evb_, transportSettings_->pacingTimerTickInterval);
   }
+  maybeStartOverloadController();
+  scheduleHibernationTimeout();
   socket_->resumeRead(this);
   VLOG(10) << "Registered read on worker=" << this
            << " thread=" << folly::getCurrentThreadID()
@@ -93,9 +113,9 @@ const folly::SocketAddress& QuicServerWorker::getAddress() const {
 }
 
 void QuicServerWorker::getReadBuffer(void** buf, size_t* len) noexcept {
-  readBuffer_ = folly::IOBuf::create(transportSettings_.maxRecvPacketSize);
+  readBuffer_ = folly::IOBuf::create(transportSettings_->maxRecvPacketSize);
   *buf = readBuffer_->writableData();
-  *len = transportSettings_.maxRecvPacketSize;
+  *len = transportSettings_->maxRecvPacketSize;
 }
 
 // Returns true if we either drop the packet or send a version
@@ -107,7 +127,9 @@ bool QuicServerWorker::maybeSendVersionNegotiationPacketOrDrop(
     LongHeaderInvariant& invariant) {
   folly::Optional<std::pair<VersionNegotiationPacket, Buf>>
       versionNegotiationPacket;
-  if (rejectNewConnections_ && isInitial) {
+  bool reject = rejectNewConnections_ ||
+      getOverloadLevel() >= OverloadLevel::RejectNewConnections;
+  if (reject && isInitial) {
     VersionNegotiationPacketBuilder builder(
         invariant.dstConnId,
         invariant.srcConnId,
@@ -151,7 +173,10 @@ void QuicServerWorker::onDataAvailable(
     bool truncated) noexcept {
   // TODO: we can get better receive time accuracy than this, with
   // SO_TIMESTAMP or SIOCGSTAMP.
-  auto packetReceiveTime = Clock::now();
+  auto packetReceiveTime = transportSettings_->packetTimestampClock ==
+          PacketTimestampClock::Tsc
+      ? TscClock::now()
+      : Clock::now();
   VLOG(10) << "Worker=" << this
            << " Received data on thread=" << folly::getCurrentThreadID()
            << " processId=" << (int)processId_;
@@ -166,6 +191,12 @@ void QuicServerWorker::onDataAvailable(
   data->append(len);
   QUIC_STATS(infoCallback_, onPacketReceived);
   QUIC_STATS(infoCallback_, onRead, len);
+  if (shouldTrackKernelReceiveDrops()) {
+    if (receiveBurstBytes_ == 0) {
+      evb_->runInLoop(&receiveBurstCallback_);
+    }
+    receiveBurstBytes_ += len;
+  }
   handleNetworkData(client, std::move(data), packetReceiveTime);
 }
 
@@ -202,7 +233,8 @@ void QuicServerWorker::handleNetworkData(
 
     if (headerForm == HeaderForm::Short) {
       folly::Expected<ShortHeaderInvariant, TransportErrorCode>
-          parsedShortHeader = parseShortHeaderInvariants(initialByte, cursor);
+          parsedShortHeader = parseShortHeaderInvariants(
+              initialByte, cursor, connIdAlgo_->getConnectionIdSize());
       if (!parsedShortHeader) {
         return tryHandlingAsHealthCheck(client, *data);
       }
@@ -337,7 +369,26 @@ void QuicServerWorker::dispatchPacketData(
     transport = cit->second;
     VLOG(10) << "Found existing connection for CID="
              << routingData.destinationConnId.hex() << " " << *transport;
-  } else if (routingData.headerForm != HeaderForm::Long) {
+  } else if (tombstones_ && tombstones_->size() > 0) {
+    auto closePacket =
+        tombstones_->onPacketReceived(routingData.destinationConnId);
+    if (closePacket) {
+      VLOG(10) << "Packet for closed connection CID="
+               << routingData.destinationConnId.hex();
+      if (*closePacket) {
+        auto packetSize = (*closePacket)->computeChainDataLength();
+        socket_->write(client, *closePacket);
+        QUIC_STATS(infoCallback_, onWrite, packetSize);
+        QUIC_STATS(infoCallback_, onPacketSent);
+      }
+      QUIC_STATS(
+          infoCallback_,
+          onPacketDropped,
+          PacketDropReason::SERVER_STATE_CLOSED);
+      return;
+    }
+  }
+  if (!transport && routingData.headerForm != HeaderForm::Long) {
     // Drop the packet if the header form is not long
     VLOG(3) << "Dropping non-long header packet with no connid match CID="
             << routingData.destinationConnId << " headerForm="
@@ -380,6 +431,27 @@ void QuicServerWorker::dispatchPacketData(
               infoCallback_, onPacketDropped, PacketDropReason::INVALID_PACKET);
           return;
         }
+        if (ingressPolicer_ &&
+            !ingressPolicer_->admit(
+                client.getIPAddress(),
+                IngressPolicer::PacketType::Initial,
+                networkData.receiveTimePoint)) {
+          VLOG(3) << "Dropping policed initial packet from client=" << client;
+          QUIC_STATS(
+              infoCallback_,
+              onPacketDropped,
+              PacketDropReason::INGRESS_POLICED);
+          return;
+        }
+        if (!admitInitialWhenOverloaded(networkData.receiveTimePoint)) {
+          VLOG(3) << "Dropping initial packet from client=" << client
+                  << " while overloaded";
+          QUIC_STATS(
+              infoCallback_,
+              onPacketDropped,
+              PacketDropReason::WORKER_OVERLOADED);
+          return;
+        }
         // create 'accepting' transport
         auto sock = makeSocket(getEventBase());
         auto trans = transportFactory_->make(
@@ -389,17 +461,33 @@ void QuicServerWorker::dispatchPacketData(
         trans->setSupportedVersions(supportedVersions_);
         trans->setOriginalPeerAddress(client);
         trans->setCongestionControllerFactory(ccFactory_);
+        std::shared_ptr<const TransportSettings> settingsProfile;
+        if (transportSettingsProfileFn_) {
+          settingsProfile = transportSettingsProfileFn_(
+              transportSettings_, client.getIPAddress());
+        }
+        if (!settingsProfile) {
+          settingsProfile = transportSettings_;
+        }
+        const TransportSettings& baseSettings = *settingsProfile;
+        folly::Optional<TransportSettings> overridenTransportSettings;
         if (transportSettingsOverrideFn_) {
-          folly::Optional<TransportSettings> overridenTransportSettings =
-              transportSettingsOverrideFn_(
-                  transportSettings_, client.getIPAddress());
+          overridenTransportSettings = transportSettingsOverrideFn_(
+              baseSettings, client.getIPAddress());
+        }
+        if (getOverloadLevel() >= OverloadLevel::ShrinkWindows) {
           if (overridenTransportSettings) {
-            trans->setTransportSettings(*overridenTransportSettings);
+            shrinkAdvertisedWindows(
+                *overridenTransportSettings, overloadConfig_->windowScale);
           } else {
-            trans->setTransportSettings(transportSettings_);
+            settingsProfile = getShrunkSettingsProfile(settingsProfile);
           }
+        }
+        if (overridenTransportSettings) {
+          trans->setTransportSettings(std::move(*overridenTransportSettings));
         } else {
-          trans->setTransportSettings(transportSettings_);
+          // Connections share the profile until they change a setting.
+          trans->setSharedTransportSettings(std::move(settingsProfile));
         }
         trans->setConnectionIdAlgo(connIdAlgo_.get());
         if (routingData.sourceConnId) {
@@ -437,6 +525,9 @@ void QuicServerWorker::dispatchPacketData(
   ServerConnectionIdParams connIdParam =
       connIdAlgo_->parseConnectionId(routingData.destinationConnId);
   if (connIdParam.hostId != hostId_) {
+    if (!admitUnroutable(client, networkData)) {
+      return;
+    }
     VLOG(3) << "Dropping packet routed to wrong host, CID="
             << routingData.destinationConnId.hex()
             << ", workerId=" << (uint32_t)workerId_
@@ -454,6 +545,9 @@ void QuicServerWorker::dispatchPacketData(
   }
 
   if (!packetForwardingEnabled_ || isForwardedData) {
+    if (!admitUnroutable(client, networkData)) {
+      return;
+    }
     QUIC_STATS(
         infoCallback_, onPacketDropped, PacketDropReason::CONNECTION_NOT_FOUND);
     return sendResetPacket(
@@ -466,6 +560,9 @@ void QuicServerWorker::dispatchPacketData(
   // There's no existing connection for the packet's CID or the client's
   // addr, and doesn't belong to the old server. Send a Reset.
   if (connIdParam.processId == static_cast<uint8_t>(processId_)) {
+    if (!admitUnroutable(client, networkData)) {
+      return;
+    }
     QUIC_STATS(
         infoCallback_, onPacketDropped, PacketDropReason::CONNECTION_NOT_FOUND);
     return sendResetPacket(
@@ -487,6 +584,25 @@ void QuicServerWorker::dispatchPacketData(
   QUIC_STATS(infoCallback_, onPacketForwarded);
 }
 
+bool QuicServerWorker::admitUnroutable(
+    const folly::SocketAddress& client,
+    const NetworkData& networkData) {
+  // Answering an unroutable packet costs work and may amplify an attack, so
+  // sources sending many of them are cut off. Packets that are forwarded to
+  // the process owning their connection are not policed.
+  if (ingressPolicer_ &&
+      !ingressPolicer_->admit(
+          client.getIPAddress(),
+          IngressPolicer::PacketType::Unroutable,
+          networkData.receiveTimePoint)) {
+    VLOG(4) << "Dropping policed unroutable packet from client=" << client;
+    QUIC_STATS(
+        infoCallback_, onPacketDropped, PacketDropReason::INGRESS_POLICED);
+    return false;
+  }
+  return true;
+}
+
 void QuicServerWorker::sendResetPacket(
     const HeaderForm& headerForm,
     const folly::SocketAddress& client,
@@ -500,9 +616,9 @@ void QuicServerWorker::sendResetPacket(
   uint16_t maxResetPacketSize = std::min<uint16_t>(
       std::max<uint16_t>(kMinStatelessPacketSize, packetSize),
       kDefaultUDPSendPacketLen);
-  CHECK(transportSettings_.statelessResetTokenSecret.hasValue());
+  CHECK(transportSettings_->statelessResetTokenSecret.hasValue());
   StatelessResetGenerator generator(
-      *transportSettings_.statelessResetTokenSecret,
+      *transportSettings_->statelessResetTokenSecret,
       getAddress().getFullyQualified());
   StatelessResetToken token = generator.generateToken(connId);
   StatelessResetPacketBuilder builder(maxResetPacketSize, token);
@@ -520,7 +636,7 @@ void QuicServerWorker::allowBeingTakenOver(
   // We instantiate and bind the TakeoverHandlerCallback to the given address.
   // It is reset at shutdownAllConnections (i.e. only when the process dies).
   takeoverCB_ = std::make_unique<TakeoverHandlerCallback>(
-      this, takeoverPktHandler_, transportSettings_, std::move(socket));
+      this, takeoverPktHandler_, std::move(socket));
   takeoverCB_->bind(address);
 }
 
@@ -610,15 +726,199 @@ void QuicServerWorker::setFizzContext(
 
 void QuicServerWorker::setTransportSettings(
     TransportSettings transportSettings) {
-  transportSettings_ = transportSettings;
+  transportSettings_ =
+      std::make_shared<const TransportSettings>(std::move(transportSettings));
+}
+
+void QuicServerWorker::setTransportSettings(
+    std::shared_ptr<const TransportSettings> transportSettings) {
+  CHECK(transportSettings);
+  transportSettings_ = std::move(transportSettings);
+}
+
+const TransportSettings& QuicServerWorker::getTransportSettings() const
+    noexcept {
+  return *transportSettings_;
 }
 
 void QuicServerWorker::rejectNewConnections(bool rejectNewConnections) {
   rejectNewConnections_ = rejectNewConnections;
 }
 
+void QuicServerWorker::setIngressPolicerConfig(
+    folly::Optional<IngressPolicerConfig> config) {
+  if (!config) {
+    ingressPolicer_.reset();
+  } else if (ingressPolicer_) {
+    ingressPolicer_->setConfig(*config);
+  } else {
+    ingressPolicer_ = std::make_unique<IngressPolicer>(*config);
+  }
+}
+
+void QuicServerWorker::setOverloadControllerConfig(
+    folly::Optional<OverloadControllerConfig> config) {
+  overloadConfig_ = config;
+  overloadInitialsLimiter_.reset();
+  shrunkSettingsProfiles_.clear();
+  if (!config) {
+    stopOverloadController();
+  } else if (overloadController_) {
+    overloadController_->setConfig(*config);
+  } else if (evb_ && evb_->isInEventBaseThread() && !shutdown_) {
+    maybeStartOverloadController();
+  }
+}
+
+OverloadLevel QuicServerWorker::getOverloadLevel() const {
+  return overloadController_ ? overloadController_->getLevel()
+                             : OverloadLevel::None;
+}
+
+void QuicServerWorker::setEventBaseObserver(
+    std::shared_ptr<folly::EventBaseObserver> observer) {
+  if (overloadController_) {
+    overloadController_->setNextObserver(std::move(observer));
+  } else {
+    evb_->setObserver(std::move(observer));
+  }
+}
+
+void QuicServerWorker::maybeStartOverloadController() {
+  if (!overloadConfig_ || overloadController_) {
+    return;
+  }
+  overloadController_ = std::make_shared<OverloadController>(
+      evb_, *overloadConfig_, [this](OverloadLevel level) {
+        LOG(INFO) << "Worker=" << (uint32_t)workerId_
+                  << " overload level=" << overloadLevelToString(level);
+        if (level < OverloadLevel::ThrottleInitials) {
+          overloadInitialsLimiter_.reset();
+        }
+        shrunkSettingsProfiles_.clear();
+      });
+  overloadController_->setNextObserver(evb_->getObserver());
+  evb_->setObserver(overloadController_);
+  overloadController_->start();
+}
+
+void QuicServerWorker::stopOverloadController() {
+  if (!overloadController_) {
+    return;
+  }
+  if (evb_->getObserver() == overloadController_) {
+    evb_->setObserver(overloadController_->getNextObserver());
+  }
+  overloadController_.reset();
+  overloadInitialsLimiter_.reset();
+  shrunkSettingsProfiles_.clear();
+}
+
+std::shared_ptr<const TransportSettings>
+QuicServerWorker::getShrunkSettingsProfile(
+    const std::shared_ptr<const TransportSettings>& profile) {
+  auto& shrunk = shrunkSettingsProfiles_[profile.get()];
+  if (!shrunk.second) {
+    auto settings = *profile;
+    shrinkAdvertisedWindows(settings, overloadConfig_->windowScale);
+    shrunk.first = profile;
+    shrunk.second = std::make_shared<const TransportSettings>(settings);
+  }
+  return shrunk.second;
+}
+
+bool QuicServerWorker::admitInitialWhenOverloaded(TimePoint now) {
+  if (getOverloadLevel() < OverloadLevel::ThrottleInitials) {
+    return true;
+  }
+  if (!overloadInitialsLimiter_) {
+    // The limiter starts with a full burst each time the level is entered.
+    overloadInitialsLimiter_ = std::make_unique<SendRateLimiter>(
+        std::max<uint64_t>(overloadConfig_->throttledInitialsPerSecond, 1), 1);
+  }
+  overloadInitialsLimiter_->refill(now);
+  if (!overloadInitialsLimiter_->hasCredit()) {
+    return false;
+  }
+  overloadInitialsLimiter_->onBytesSent(1, now);
+  return true;
+}
+
+bool QuicServerWorker::shouldTrackKernelReceiveDrops() const {
+  return transportSettings_->trackKernelReceiveDrops ||
+      transportSettings_->maxSocketReceiveBuffer > 0 || overloadController_;
+}
+
+void QuicServerWorker::onReceiveBurstEnd() {
+  auto burstBytes = receiveBurstBytes_;
+  receiveBurstBytes_ = 0;
+  if (!socket_) {
+    return;
+  }
+  // The listening socket is read by folly, without control messages, so the
+  // kernel's drop count is polled instead.
+  auto fd = socket_->getNetworkSocket().toFd();
+  if (transportSettings_->maxSocketReceiveBuffer > 0 && !receiveBufferSizer_) {
+    receiveBufferSizer_.emplace(
+        transportSettings_->minSocketReceiveBuffer,
+        transportSettings_->maxSocketReceiveBuffer,
+        getSocketReceiveBuffer(fd).value_or(
+            transportSettings_->minSocketReceiveBuffer));
+  }
+  if (receiveBufferSizer_) {
+    receiveBufferSizer_->onReadBurst(burstBytes);
+  }
+  auto now = Clock::now();
+  if (now < nextReceiveStatsTime_) {
+    return;
+  }
+  nextReceiveStatsTime_ = now + kSocketReceiveStatsInterval;
+  auto total = readSocketDropCount(fd);
+  auto drops = total ? kernelDropCounter_.update(*total) : 0;
+  if (drops > 0) {
+    VLOG(3) << "Kernel dropped " << drops << " datagrams on worker="
+            << (uint32_t)workerId_;
+    QUIC_STATS(infoCallback_, onKernelReceiveDrops, drops);
+    if (overloadController_) {
+      overloadController_->onKernelDrops(drops);
+    }
+    if (receiveBufferSizer_) {
+      receiveBufferSizer_->onDrops(drops);
+    }
+  }
+  if (receiveBufferSizer_) {
+    auto size = receiveBufferSizer_->nextSize();
+    if (size && !setSocketReceiveBuffer(fd, *size)) {
+      LOG(WARNING) << "Failed to resize receive buffer to " << *size
+                   << " on worker=" << (uint32_t)workerId_;
+    }
+  }
+}
+
+void QuicServerWorker::scheduleHibernationTimeout() {
+  auto interval = transportSettings_->hibernationIdleTimeout;
+  if (shutdown_ || interval == std::chrono::milliseconds::zero() ||
+      hibernationTimeout_.isScheduled()) {
+    return;
+  }
+  evb_->timer().scheduleTimeout(&hibernationTimeout_, interval);
+}
+
+void QuicServerWorker::hibernationTimeoutExpired() noexcept {
+  for (auto transport : boundServerTransports_) {
+    transport->maybeHibernate();
+  }
+  scheduleHibernationTimeout();
+}
+
 void QuicServerWorker::enablePartialReliability(bool enabled) {
-  transportSettings_.partialReliabilityEnabled = enabled;
+  if (transportSettings_->partialReliabilityEnabled == enabled) {
+    return;
+  }
+  auto transportSettings =
+      std::make_shared<TransportSettings>(*transportSettings_);
+  transportSettings->partialReliabilityEnabled = enabled;
+  transportSettings_ = std::move(transportSettings);
 }
 
 void QuicServerWorker::setHealthCheckToken(
@@ -706,6 +1006,66 @@ void QuicServerWorker::onConnectionUnbound(
   sourceAddressMap_.erase(source);
 }
 
+void QuicServerWorker::onConnectionTombstoned(
+    std::vector<ConnectionId> connectionIds,
+    Buf closePacket,
+    std::chrono::milliseconds drainPeriod) noexcept {
+  if (shutdown_) {
+    return;
+  }
+  if (!tombstones_) {
+    tombstones_ = std::make_unique<ConnectionTombstoneTable>(evb_);
+  }
+  VLOG(4) << "Adding tombstone for " << connectionIds.size()
+          << " connection ids, drainPeriod=" << drainPeriod.count()
+          << "ms, workerId=" << (uint32_t)workerId_;
+  tombstones_->add(
+      std::move(connectionIds), std::move(closePacket), drainPeriod);
+}
+
+std::unique_ptr<folly::AsyncUDPSocket>
+QuicServerWorker::onConnectedSocketRequested(
+    const folly::SocketAddress& peer) noexcept {
+  if (shutdown_ || !socket_ || connectedSockets_.count(peer)) {
+    return nullptr;
+  }
+  auto reader = std::make_unique<ConnectedSocketReader>(this);
+  std::unique_ptr<folly::AsyncUDPSocket> transportSocket;
+  try {
+    reader->socket = std::make_unique<folly::AsyncUDPSocket>(evb_);
+    reader->socket->setReusePort(true);
+    reader->socket->setReuseAddr(false);
+    reader->socket->bind(socket_->address());
+    reader->socket->setDFAndTurnOffPMTU();
+    reader->socket->connect(peer);
+    // The transport's handle must be connected too, or it would keep
+    // passing the destination on every send.
+    transportSocket =
+        makeSocket(evb_, reader->socket->getNetworkSocket().toFd());
+    transportSocket->connect(peer);
+  } catch (const std::exception& ex) {
+    LOG(WARNING) << "Failed to make a connected socket for peer=" << peer
+                 << ": " << ex.what();
+    return nullptr;
+  }
+  reader->socket->resumeRead(reader.get());
+  connectedSockets_.emplace(peer, std::move(reader));
+  return transportSocket;
+}
+
+void QuicServerWorker::onConnectedSocketReleased(
+    const folly::SocketAddress& peer) noexcept {
+  connectedSockets_.erase(peer);
+}
+
+void QuicServerWorker::ConnectedSocketReader::onReadError(
+    const folly::AsyncSocketException& ex) noexcept {
+  // The connection keeps its socket until it is done with it, so only stop
+  // reading here.
+  LOG(ERROR) << "QuicServer connected socket read error: " << ex.what();
+  socket->pauseRead();
+}
+
 void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
   VLOG(4) << "QuicServer shutdown all connections."
           << " addressMap=" << sourceAddressMap_.size()
@@ -714,6 +1074,10 @@ void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
     return;
   }
   shutdown_ = true;
+  tombstones_.reset();
+  stopOverloadController();
+  receiveBurstCallback_.cancelLoopCallback();
+  hibernationTimeout_.cancelTimeout();
   if (socket_) {
     socket_->pauseRead();
   }
@@ -741,6 +1105,7 @@ void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
   }
   sourceAddressMap_.clear();
   connectionIdMap_.clear();
+  connectedSockets_.clear();
   takeoverPktHandler_.stop();
   if (infoCallback_) {
     infoCallback_.reset();
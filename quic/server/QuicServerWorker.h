@@ -11,14 +11,20 @@
 #include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 #include <folly/io/async/AsyncUDPSocket.h>
+#include <folly/io/async/HHWheelTimer.h>
 
 #include <quic/codec/ConnectionIdAlgo.h>
+#include <quic/common/SocketTuning.h>
 #include <quic/common/Timers.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
+#include <quic/server/ConnectionTombstoneTable.h>
+#include <quic/server/IngressPolicer.h>
+#include <quic/server/OverloadController.h>
 #include <quic/server/QuicServerPacketRouter.h>
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicUDPSocketFactory.h>
 #include <quic/state/QuicTransportStatsCallback.h>
+#include <quic/state/SendRateLimiter.h>
 
 namespace quic {
 
@@ -30,6 +36,11 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
           const quic::TransportSettings&,
           const folly::IPAddress&)>;
 
+  using TransportSettingsProfileFn =
+      std::function<std::shared_ptr<const quic::TransportSettings>(
+          const std::shared_ptr<const quic::TransportSettings>&,
+          const folly::IPAddress&)>;
+
   class WorkerCallback {
    public:
     virtual ~WorkerCallback() = default;
@@ -58,6 +69,15 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
    */
   void setTransportSettingsOverrideFn(TransportSettingsOverrideFn fn);
 
+  /*
+   * Take in a function that picks one of a small set of immutable transport
+   * settings profiles for a new connection, given the client address as input.
+   * Returning nullptr selects the worker's default profile. Unlike the
+   * override function, no per-connection TransportSettings is materialized
+   * until the profile is handed to the transport.
+   */
+  void setTransportSettingsProfileFn(TransportSettingsProfileFn fn);
+
   /**
    * Sets the listening socket
    */
@@ -165,6 +185,15 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
 
   void setTransportSettings(TransportSettings transportSettings);
 
+  /**
+   * Shares an immutable settings profile with this worker. The same profile
+   * may be handed to any number of workers.
+   */
+  void setTransportSettings(
+      std::shared_ptr<const TransportSettings> transportSettings);
+
+  const TransportSettings& getTransportSettings() const noexcept;
+
   /**
    * If true, start to reject any new connection during handshake
    */
@@ -175,6 +204,28 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
    */
   void enablePartialReliability(bool enabled);
 
+  /**
+   * Limits the Initials and unroutable packets accepted from each source.
+   * Can be changed at any time; folly::none turns policing off.
+   */
+  void setIngressPolicerConfig(folly::Optional<IngressPolicerConfig> config);
+
+  /**
+   * Protects the worker from overload by shrinking the windows of, then
+   * throttling, then rejecting new connections as its event loop gets
+   * busier. Can be changed at any time; folly::none turns it off.
+   */
+  void setOverloadControllerConfig(
+      folly::Optional<OverloadControllerConfig> config);
+
+  OverloadLevel getOverloadLevel() const;
+
+  /**
+   * Sets the observer of the worker's event base. Must be used instead of
+   * EventBase::setObserver while the overload controller is on.
+   */
+  void setEventBaseObserver(std::shared_ptr<folly::EventBaseObserver> observer);
+
   /**
    * Set a health-check token that can be used to ping if the server is alive
    */
@@ -242,6 +293,22 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       const QuicServerTransport::SourceIdentity& source,
       const std::vector<ConnectionIdData>& connectionIdData) noexcept override;
 
+  void onConnectionTombstoned(
+      std::vector<ConnectionId> connectionIds,
+      Buf closePacket,
+      std::chrono::milliseconds drainPeriod) noexcept override;
+
+  /**
+   * Makes a socket connected to peer that shares the worker's address
+   * through SO_REUSEPORT. The worker keeps the socket, keyed by peer, and
+   * reads from it; the transport is given a handle to write with.
+   */
+  std::unique_ptr<folly::AsyncUDPSocket> onConnectedSocketRequested(
+      const folly::SocketAddress& peer) noexcept override;
+
+  void onConnectedSocketReleased(
+      const folly::SocketAddress& peer) noexcept override;
+
   void onReadError(const folly::AsyncSocketException& ex) noexcept override;
 
   void onReadClosed() noexcept override;
@@ -271,6 +338,10 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
 
   const SrcToTransportMap& getSrcToTransportMap() const;
 
+  const ConnectionTombstoneTable* getTombstoneTable() const {
+    return tombstones_.get();
+  }
+
   void shutdownAllConnections(LocalErrorCode error);
 
   // for unit test
@@ -329,6 +400,14 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       folly::EventBase* evb,
       int fd) const;
 
+  /**
+   * Returns whether a packet that matches no connection here and is not
+   * forwarded is within the ingress policer's limits.
+   */
+  bool admitUnroutable(
+      const folly::SocketAddress& client,
+      const NetworkData& networkData);
+
   void sendResetPacket(
       const HeaderForm& headerForm,
       const folly::SocketAddress& client,
@@ -340,6 +419,89 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       bool isInitial,
       LongHeaderInvariant& invariant);
 
+  /**
+   * Creates the overload controller and makes it the event base's observer,
+   * if it is configured and not running yet.
+   */
+  void maybeStartOverloadController();
+
+  void stopOverloadController();
+
+  /**
+   * Returns the profile with its advertised windows shrunk by the overload
+   * window scale. Connections accepted at the same overload level share one
+   * copy per profile.
+   */
+  std::shared_ptr<const TransportSettings> getShrunkSettingsProfile(
+      const std::shared_ptr<const TransportSettings>& profile);
+
+  bool admitInitialWhenOverloaded(TimePoint now);
+
+  bool shouldTrackKernelReceiveDrops() const;
+
+  // Called at the end of each loop iteration in which datagrams were read.
+  void onReceiveBurstEnd();
+
+  // Lets the connections that stayed quiescent since the previous check
+  // hibernate, then schedules the next check.
+  void hibernationTimeoutExpired() noexcept;
+  void scheduleHibernationTimeout();
+
+  // Reads a connected socket into the worker, like the listening socket,
+  // but leaves errors to the connection using it.
+  class ConnectedSocketReader : public folly::AsyncUDPSocket::ReadCallback {
+   public:
+    explicit ConnectedSocketReader(QuicServerWorker* worker)
+        : worker_(worker) {}
+
+    void getReadBuffer(void** buf, size_t* len) noexcept override {
+      worker_->getReadBuffer(buf, len);
+    }
+
+    void onDataAvailable(
+        const folly::SocketAddress& client,
+        size_t len,
+        bool truncated) noexcept override {
+      worker_->onDataAvailable(client, len, truncated);
+    }
+
+    void onReadError(const folly::AsyncSocketException& ex) noexcept override;
+
+    void onReadClosed() noexcept override {}
+
+    std::unique_ptr<folly::AsyncUDPSocket> socket;
+
+   private:
+    QuicServerWorker* worker_;
+  };
+
+  class ReceiveBurstCallback : public folly::EventBase::LoopCallback {
+   public:
+    explicit ReceiveBurstCallback(QuicServerWorker* worker)
+        : worker_(worker) {}
+
+    void runLoopCallback() noexcept override {
+      worker_->onReceiveBurstEnd();
+    }
+
+   private:
+    QuicServerWorker* worker_;
+  };
+
+  class HibernationTimeout : public folly::HHWheelTimer::Callback {
+   public:
+    explicit HibernationTimeout(QuicServerWorker* worker) : worker_(worker) {}
+
+    void timeoutExpired() noexcept override {
+      worker_->hibernationTimeoutExpired();
+    }
+
+    void callbackCanceled() noexcept override {}
+
+   private:
+    QuicServerWorker* worker_;
+  };
+
   std::unique_ptr<folly::AsyncUDPSocket> socket_;
   std::shared_ptr<WorkerCallback> callback_;
   folly::EventBase* evb_{nullptr};
@@ -356,13 +518,48 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
   // Contains every unique transport that is mapped in connectionIdMap_.
   folly::F14FastSet<QuicServerTransport*> boundServerTransports_;
 
+  // Closed connections within their drain period, created on first use.
+  std::unique_ptr<ConnectionTombstoneTable> tombstones_;
+
+  // Sockets connected to a single peer. They all share the worker's local
+  // address, so the peer completes the 4-tuple.
+  folly::F14FastMap<
+      folly::SocketAddress,
+      std::unique_ptr<ConnectedSocketReader>>
+      connectedSockets_;
+
   Buf readBuffer_;
   bool shutdown_{false};
   std::vector<QuicVersion> supportedVersions_;
   std::shared_ptr<const fizz::server::FizzServerContext> ctx_;
-  TransportSettings transportSettings_;
+  // Default settings profile, shared with the server and other workers.
+  // Modified only by copy-on-write.
+  std::shared_ptr<const TransportSettings> transportSettings_{
+      std::make_shared<const TransportSettings>()};
   folly::Optional<Buf> healthCheckToken_;
   bool rejectNewConnections_{false};
+  std::unique_ptr<IngressPolicer> ingressPolicer_;
+  folly::Optional<OverloadControllerConfig> overloadConfig_;
+  std::shared_ptr<OverloadController> overloadController_;
+  // Limits new connections from OverloadLevel::ThrottleInitials up.
+  std::unique_ptr<SendRateLimiter> overloadInitialsLimiter_;
+  // Copies of the settings profiles with shrunk windows, handed out from
+  // OverloadLevel::ShrinkWindows up and keyed by the profile they were made
+  // from, which they keep alive. Dropped whenever the overload level changes.
+  folly::F14FastMap<
+      const TransportSettings*,
+      std::pair<
+          std::shared_ptr<const TransportSettings>,
+          std::shared_ptr<const TransportSettings>>>
+      shrunkSettingsProfiles_;
+  // Bytes read from the socket in the current loop iteration.
+  uint64_t receiveBurstBytes_{0};
+  ReceiveBurstCallback receiveBurstCallback_{this};
+  // One timer for all connections, which would otherwise each keep their own.
+  HibernationTimeout hibernationTimeout_{this};
+  TimePoint nextReceiveStatsTime_;
+  KernelDropCounter kernelDropCounter_{KernelDropCounter::Source::SocketPoll};
+  folly::Optional<ReceiveBufferSizer> receiveBufferSizer_;
   uint8_t workerId_{0};
   std::unique_ptr<ConnectionIdAlgo> connIdAlgo_;
   uint16_t hostId_{0};
@@ -379,6 +576,9 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
 
   // Used to override certain transport parameters, given the client address
   TransportSettingsOverrideFn transportSettingsOverrideFn_;
+
+  // Used to select a shared settings profile, given the client address
+  TransportSettingsProfileFn transportSettingsProfileFn_;
 };
 
 } // namespace quic
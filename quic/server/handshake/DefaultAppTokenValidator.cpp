@@ -73,7 +73,7 @@ bool DefaultAppTokenValidator::validate(
   auto ticketIdleTimeout =
       getIntegerParameter(TransportParameterId::idle_timeout, params);
   if (!ticketIdleTimeout ||
-      conn_->transportSettings.idleTimeout !=
+      conn_->transportSettings->idleTimeout !=
           std::chrono::milliseconds(*ticketIdleTimeout)) {
     VLOG(10) << "Changed idle timeout";
     return false;
@@ -82,7 +82,7 @@ bool DefaultAppTokenValidator::validate(
   auto ticketPacketSize =
       getIntegerParameter(TransportParameterId::max_packet_size, params);
   if (!ticketPacketSize ||
-      conn_->transportSettings.maxRecvPacketSize < *ticketPacketSize) {
+      conn_->transportSettings->maxRecvPacketSize < *ticketPacketSize) {
     VLOG(10) << "Decreased max receive packet size";
     return false;
   }
@@ -92,7 +92,7 @@ bool DefaultAppTokenValidator::validate(
   auto ticketMaxData =
       getIntegerParameter(TransportParameterId::initial_max_data, params);
   if (!ticketMaxData ||
-      conn_->transportSettings.advertisedInitialConnectionWindowSize <
+      conn_->transportSettings->advertisedInitialConnectionWindowSize <
           *ticketMaxData) {
     VLOG(10) << "Decreased max data";
     return false;
@@ -105,13 +105,13 @@ bool DefaultAppTokenValidator::validate(
   auto ticketMaxStreamDataUni = getIntegerParameter(
       TransportParameterId::initial_max_stream_data_uni, params);
   if (!ticketMaxStreamDataBidiLocal ||
-      conn_->transportSettings.advertisedInitialBidiLocalStreamWindowSize <
+      conn_->transportSettings->advertisedInitialBidiLocalStreamWindowSize <
           *ticketMaxStreamDataBidiLocal ||
       !ticketMaxStreamDataBidiRemote ||
-      conn_->transportSettings.advertisedInitialBidiRemoteStreamWindowSize <
+      conn_->transportSettings->advertisedInitialBidiRemoteStreamWindowSize <
           *ticketMaxStreamDataBidiRemote ||
       !ticketMaxStreamDataUni ||
-      conn_->transportSettings.advertisedInitialUniStreamWindowSize <
+      conn_->transportSettings->advertisedInitialUniStreamWindowSize <
           *ticketMaxStreamDataUni) {
     VLOG(10) << "Decreased max stream data";
     return false;
@@ -122,10 +122,10 @@ bool DefaultAppTokenValidator::validate(
   auto ticketMaxStreamsUni = getIntegerParameter(
       TransportParameterId::initial_max_streams_uni, params);
   if (!ticketMaxStreamsBidi ||
-      conn_->transportSettings.advertisedInitialMaxStreamsBidi <
+      conn_->transportSettings->advertisedInitialMaxStreamsBidi <
           *ticketMaxStreamsBidi ||
       !ticketMaxStreamsUni ||
-      conn_->transportSettings.advertisedInitialMaxStreamsUni <
+      conn_->transportSettings->advertisedInitialMaxStreamsUni <
           *ticketMaxStreamsUni) {
     VLOG(10) << "Decreased max streams";
     return false;
@@ -14,6 +14,66 @@
 
 #include <fizz/protocol/Protocol.h>
 
+namespace {
+// Enough for a default context plus a few per-connection override contexts
+// without thrashing.
+constexpr size_t kMaxSharedServerContexts = 8;
+
+struct SharedServerContext {
+  std::weak_ptr<const fizz::server::FizzServerContext> source;
+  std::shared_ptr<const fizz::server::FizzServerContext> context;
+  std::shared_ptr<quic::FizzCryptoFactory> cryptoFactory;
+};
+
+SharedServerContext makeSharedServerContext(
+    const std::shared_ptr<const fizz::server::FizzServerContext>& source) {
+  SharedServerContext shared;
+  shared.source = source;
+  auto ctx = std::make_shared<fizz::server::FizzServerContext>(*source);
+  shared.cryptoFactory = std::make_shared<quic::FizzCryptoFactory>();
+  ctx->setFactory(shared.cryptoFactory->getFizzFactory());
+  ctx->setSupportedCiphers({{fizz::CipherSuite::TLS_AES_128_GCM_SHA256}});
+  ctx->setVersionFallbackEnabled(false);
+  // Since Draft-17, client won't sent EOED
+  ctx->setOmitEarlyRecordLayer(true);
+  shared.context = std::move(ctx);
+  return shared;
+}
+
+/**
+ * Returns the QUIC flavoured copy of source, building it only the first time
+ * source is seen on this thread. Workers hand every connection the same
+ * context, so the copy and crypto factory are shared instead of being
+ * rebuilt on each accept.
+ */
+const SharedServerContext& getSharedServerContext(
+    const std::shared_ptr<const fizz::server::FizzServerContext>& source) {
+  static thread_local std::vector<SharedServerContext> sharedContexts;
+  auto isSource = [&source](const SharedServerContext& shared) {
+    return !shared.source.owner_before(source) &&
+        !source.owner_before(shared.source) && !shared.source.expired();
+  };
+  auto it =
+      std::find_if(sharedContexts.begin(), sharedContexts.end(), isSource);
+  if (it != sharedContexts.end()) {
+    return *it;
+  }
+  sharedContexts.erase(
+      std::remove_if(
+          sharedContexts.begin(),
+          sharedContexts.end(),
+          [](const SharedServerContext& shared) {
+            return shared.source.expired();
+          }),
+      sharedContexts.end());
+  if (sharedContexts.size() >= kMaxSharedServerContexts) {
+    sharedContexts.erase(sharedContexts.begin());
+  }
+  sharedContexts.push_back(makeSharedServerContext(source));
+  return sharedContexts.back();
+}
+} // namespace
+
 namespace quic {
 ServerHandshake::ServerHandshake(
     QuicConnectionStateBase* conn,
@@ -40,15 +100,9 @@ void ServerHandshake::initialize(
     HandshakeCallback* callback,
     std::unique_ptr<fizz::server::AppTokenValidator> validator) {
   executor_ = executor;
-  auto ctx = std::make_shared<fizz::server::FizzServerContext>(*context);
-  auto cryptoFactory = std::make_shared<FizzCryptoFactory>();
-  ctx->setFactory(cryptoFactory->getFizzFactory());
-  cryptoFactory_ = std::move(cryptoFactory);
-  ctx->setSupportedCiphers({{fizz::CipherSuite::TLS_AES_128_GCM_SHA256}});
-  ctx->setVersionFallbackEnabled(false);
-  // Since Draft-17, client won't sent EOED
-  ctx->setOmitEarlyRecordLayer(true);
-  context_ = std::move(ctx);
+  const auto& shared = getSharedServerContext(context);
+  cryptoFactory_ = shared.cryptoFactory;
+  context_ = shared.context;
   callback_ = callback;
 
   if (validator) {
@@ -83,9 +83,12 @@ class ServerHandshake : public Handshake {
 
   /**
    * Initialize the handshake with the executor and the callback.
-   * The class will clone the context, so the same context will not be used
-   * directly. To get the real context used, call getContext() after invoking
-   * initialize.
+   * The context is adapted for QUIC on a copy, so the same context will not
+   * be used directly. The copy is made once per context and thread and is
+   * shared by every handshake initialized with that context, so the context
+   * must not be modified after it is handed out; install a new context to
+   * change certificates or ticket ciphers. To get the real context used, call
+   * getContext() after invoking initialize.
    */
   virtual void initialize(
       folly::Executor* executor,
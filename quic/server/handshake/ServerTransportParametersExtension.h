@@ -14,6 +14,63 @@
 
 namespace quic {
 
+/**
+ * Encodes the server transport parameters that only depend on transport
+ * settings. Connections accepted with the same settings can share the
+ * result; the per-connection stateless reset token is appended by
+ * ServerTransportParametersExtension.
+ */
+inline std::shared_ptr<const std::vector<TransportParameter>>
+encodeServerTransportParameters(
+    uint64_t initialMaxData,
+    uint64_t initialMaxStreamDataBidiLocal,
+    uint64_t initialMaxStreamDataBidiRemote,
+    uint64_t initialMaxStreamDataUni,
+    uint64_t initialMaxStreamsBidi,
+    uint64_t initialMaxStreamsUni,
+    std::chrono::milliseconds idleTimeout,
+    uint64_t ackDelayExponent,
+    uint64_t maxRecvPacketSize,
+    TransportPartialReliabilitySetting partialReliability,
+    uint64_t fecRetentionBytes = 0) {
+  auto parameters = std::make_shared<std::vector<TransportParameter>>();
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::initial_max_stream_data_bidi_local,
+      initialMaxStreamDataBidiLocal));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::initial_max_stream_data_bidi_remote,
+      initialMaxStreamDataBidiRemote));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::initial_max_stream_data_uni,
+      initialMaxStreamDataUni));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::initial_max_data, initialMaxData));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::initial_max_streams_bidi, initialMaxStreamsBidi));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::initial_max_streams_uni, initialMaxStreamsUni));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::idle_timeout, idleTimeout.count()));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::ack_delay_exponent, ackDelayExponent));
+  parameters->push_back(encodeIntegerParameter(
+      TransportParameterId::max_packet_size, maxRecvPacketSize));
+
+  uint64_t partialReliabilitySetting = 0;
+  if (partialReliability) {
+    partialReliabilitySetting = 1;
+  }
+  parameters->push_back(encodeIntegerParameter(
+      static_cast<TransportParameterId>(kPartialReliabilityParameterId),
+      partialReliabilitySetting));
+  if (fecRetentionBytes > 0) {
+    parameters->push_back(encodeIntegerParameter(
+        static_cast<TransportParameterId>(kFecParameterId),
+        fecRetentionBytes));
+  }
+  return parameters;
+}
+
 class ServerTransportParametersExtension : public fizz::ServerExtensions {
  public:
   ServerTransportParametersExtension(
@@ -30,22 +87,45 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
       uint64_t maxRecvPacketSize,
       TransportPartialReliabilitySetting partialReliability,
       const StatelessResetToken& token)
+      : ServerTransportParametersExtension(
+            negotiatedVersion,
+            supportedVersions,
+            encodeServerTransportParameters(
+                initialMaxData,
+                initialMaxStreamDataBidiLocal,
+                initialMaxStreamDataBidiRemote,
+                initialMaxStreamDataUni,
+                initialMaxStreamsBidi,
+                initialMaxStreamsUni,
+                idleTimeout,
+                ackDelayExponent,
+                maxRecvPacketSize,
+                partialReliability),
+            token) {}
+
+  /**
+   * Uses parameters previously built by encodeServerTransportParameters.
+   */
+  ServerTransportParametersExtension(
+      folly::Optional<QuicVersion> negotiatedVersion,
+      const std::vector<QuicVersion>& supportedVersions,
+      std::shared_ptr<const std::vector<TransportParameter>> encodedParameters,
+      const StatelessResetToken& token)
       : negotiatedVersion_(negotiatedVersion),
         supportedVersions_(supportedVersions),
-        initialMaxData_(initialMaxData),
-        initialMaxStreamDataBidiLocal_(initialMaxStreamDataBidiLocal),
-        initialMaxStreamDataBidiRemote_(initialMaxStreamDataBidiRemote),
-        initialMaxStreamDataUni_(initialMaxStreamDataUni),
-        initialMaxStreamsBidi_(initialMaxStreamsBidi),
-        initialMaxStreamsUni_(initialMaxStreamsUni),
-        idleTimeout_(idleTimeout),
-        ackDelayExponent_(ackDelayExponent),
-        maxRecvPacketSize_(maxRecvPacketSize),
-        partialReliability_(partialReliability),
+        encodedParameters_(std::move(encodedParameters)),
         token_(token) {}
 
   ~ServerTransportParametersExtension() override = default;
 
+  /**
+   * Advertises a unicast address the client should move the connection to
+   * once the handshake is done.
+   */
+  void setPreferredAddress(PreferredAddress preferredAddress) {
+    preferredAddress_ = std::move(preferredAddress);
+  }
+
   std::vector<fizz::Extension> getExtensions(
       const fizz::ClientHello& chlo) override {
     auto clientParams =
@@ -66,40 +146,21 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
     ServerTransportParameters params;
     params.negotiated_version = negotiatedVersion_;
     params.supported_versions = supportedVersions_;
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::initial_max_stream_data_bidi_local,
-        initialMaxStreamDataBidiLocal_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::initial_max_stream_data_bidi_remote,
-        initialMaxStreamDataBidiRemote_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::initial_max_stream_data_uni,
-        initialMaxStreamDataUni_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::initial_max_data, initialMaxData_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::initial_max_streams_bidi,
-        initialMaxStreamsBidi_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::initial_max_streams_uni, initialMaxStreamsUni_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::idle_timeout, idleTimeout_.count()));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::ack_delay_exponent, ackDelayExponent_));
-    params.parameters.push_back(encodeIntegerParameter(
-        TransportParameterId::max_packet_size, maxRecvPacketSize_));
+    // Copies clone the shared encoded values rather than re-encoding them.
+    params.parameters = *encodedParameters_;
     TransportParameter statelessReset;
     statelessReset.parameter = TransportParameterId::stateless_reset_token;
     statelessReset.value = folly::IOBuf::copyBuffer(token_);
     params.parameters.push_back(std::move(statelessReset));
-
-    uint64_t partialReliabilitySetting = 0;
-    if (partialReliability_) {
-      partialReliabilitySetting = 1;
+    // The preferred address comes with a connection id, which a client that
+    // takes no ids besides the one in use has no room for.
+    auto activeConnectionIdLimit = getIntegerParameter(
+        TransportParameterId::active_connection_id_limit,
+        clientTransportParameters_->parameters);
+    if (preferredAddress_ &&
+        activeConnectionIdLimit.value_or(kDefaultConnectionIdLimit) > 0) {
+      params.parameters.push_back(encodePreferredAddress(*preferredAddress_));
     }
-    params.parameters.push_back(encodeIntegerParameter(
-        static_cast<TransportParameterId>(kPartialReliabilityParameterId),
-        partialReliabilitySetting));
 
     exts.push_back(encodeExtension(params));
     return exts;
@@ -112,17 +173,9 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
  private:
   folly::Optional<QuicVersion> negotiatedVersion_;
   std::vector<QuicVersion> supportedVersions_;
-  uint64_t initialMaxData_;
-  uint64_t initialMaxStreamDataBidiLocal_;
-  uint64_t initialMaxStreamDataBidiRemote_;
-  uint64_t initialMaxStreamDataUni_;
-  uint64_t initialMaxStreamsBidi_;
-  uint64_t initialMaxStreamsUni_;
-  std::chrono::milliseconds idleTimeout_;
-  uint64_t ackDelayExponent_;
-  uint64_t maxRecvPacketSize_;
-  TransportPartialReliabilitySetting partialReliability_;
+  std::shared_ptr<const std::vector<TransportParameter>> encodedParameters_;
   folly::Optional<ClientTransportParameters> clientTransportParameters_;
   StatelessResetToken token_;
+  folly::Optional<PreferredAddress> preferredAddress_;
 };
 } // namespace quic
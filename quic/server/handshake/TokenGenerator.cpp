@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/handshake/TokenGenerator.h>
+
+#include <folly/io/Cursor.h>
+
+namespace {
+constexpr folly::StringPiece kNewTokenContext{"QUIC new token"};
+constexpr size_t kMaxIpAddressLength = 16;
+} // namespace
+
+namespace quic {
+
+TokenGenerator::TokenGenerator(const NewTokenSecret& secret)
+    : cipher_(std::vector<std::string>{kNewTokenContext.str()}) {
+  std::vector<folly::ByteRange> secrets{folly::range(secret)};
+  CHECK(cipher_.setSecrets(secrets)) << "Failed to set new token secret";
+}
+
+Buf TokenGenerator::encryptToken(
+    const folly::IPAddress& clientIp,
+    std::chrono::system_clock::time_point issueTime) const {
+  auto plaintext =
+      folly::IOBuf::create(sizeof(uint64_t) + clientIp.byteCount());
+  folly::io::Appender appender(plaintext.get(), 0);
+  appender.writeBE<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          issueTime.time_since_epoch())
+          .count());
+  appender.push(clientIp.bytes(), clientIp.byteCount());
+  auto sealed = cipher_.encrypt(std::move(plaintext));
+  if (!sealed) {
+    return nullptr;
+  }
+  auto token = folly::IOBuf::create(sizeof(TokenType));
+  folly::io::Appender(token.get(), 0)
+      .writeBE<uint8_t>(static_cast<uint8_t>(TokenType::NewToken));
+  token->prependChain(std::move(*sealed));
+  return token;
+}
+
+bool TokenGenerator::validateToken(
+    const folly::IOBuf& token,
+    const folly::IPAddress& clientIp,
+    std::chrono::seconds validity,
+    std::chrono::system_clock::time_point now) const {
+  folly::io::Cursor tokenCursor(&token);
+  uint8_t tokenType;
+  if (!tokenCursor.tryReadBE(tokenType) ||
+      tokenType != static_cast<uint8_t>(TokenType::NewToken)) {
+    return false;
+  }
+  Buf sealed;
+  tokenCursor.clone(sealed, tokenCursor.totalLength());
+  auto plaintext = cipher_.decrypt(std::move(sealed));
+  if (!plaintext || !*plaintext) {
+    return false;
+  }
+  folly::io::Cursor cursor(plaintext->get());
+  uint64_t issueTimeMs;
+  if (!cursor.tryReadBE(issueTimeMs)) {
+    return false;
+  }
+  auto ipLength = cursor.totalLength();
+  if (ipLength == 0 || ipLength > kMaxIpAddressLength) {
+    return false;
+  }
+  std::array<uint8_t, kMaxIpAddressLength> ipBytes;
+  cursor.pull(ipBytes.data(), ipLength);
+  auto tokenIp = folly::IPAddress::tryFromBinary(
+      folly::ByteRange(ipBytes.data(), ipLength));
+  if (tokenIp.hasError() || tokenIp.value() != clientIp) {
+    return false;
+  }
+  std::chrono::system_clock::time_point issueTime{
+      std::chrono::milliseconds(issueTimeMs)};
+  return now - issueTime <= validity;
+}
+
+const TokenGenerator& getThreadTokenGenerator(const NewTokenSecret& secret) {
+  static thread_local std::unique_ptr<TokenGenerator> generator;
+  static thread_local NewTokenSecret generatorSecret;
+  if (!generator || generatorSecret != secret) {
+    generator = std::make_unique<TokenGenerator>(secret);
+    generatorSecret = secret;
+  }
+  return *generator;
+}
+
+} // namespace quic
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <fizz/server/AeadTokenCipher.h>
+#include <folly/IPAddress.h>
+#include <quic/codec/Types.h>
+
+namespace quic {
+
+using NewTokenSecret = std::array<uint8_t, kNewTokenSecretLength>;
+
+/**
+ * First byte of the tokens the server hands out, so that a token echoed in an
+ * Initial can be told apart before it is opened.
+ */
+enum class TokenType : uint8_t {
+  RetryToken = 0x00,
+  NewToken = 0x01,
+};
+
+/**
+ * Seals and opens the address validation tokens sent in NEW_TOKEN frames.
+ *
+ * A token carries the client IP address and the time it was issued, sealed
+ * with an AEAD key derived from the NewTokenSecret. A client that echoes the
+ * token in the Initial of a later connection from the same address has shown
+ * that it can receive packets sent to that address.
+ *
+ * Plaintext = Concat(issueTimeMs, clientIpBytes)
+ * Token = Concat(TokenType::NewToken, AEAD-Seal(HKDF(secret, salt), Plaintext))
+ *
+ * Deriving the key is expensive, so servers use getThreadTokenGenerator
+ * rather than building a generator for each token.
+ */
+class TokenGenerator {
+ public:
+  explicit TokenGenerator(const NewTokenSecret& secret);
+
+  /**
+   * Returns nullptr if the token could not be sealed.
+   */
+  Buf encryptToken(
+      const folly::IPAddress& clientIp,
+      std::chrono::system_clock::time_point issueTime) const;
+
+  /**
+   * Returns true if the token was issued by a server sharing the secret, for
+   * the given client address, and no longer than validity before now.
+   */
+  bool validateToken(
+      const folly::IOBuf& token,
+      const folly::IPAddress& clientIp,
+      std::chrono::seconds validity,
+      std::chrono::system_clock::time_point now) const;
+
+ private:
+  fizz::server::Aead128GCMTokenCipher cipher_;
+};
+
+/**
+ * Returns a generator for the secret that is kept by the calling thread and
+ * rebuilt only when the secret changes.
+ */
+const TokenGenerator& getThreadTokenGenerator(const NewTokenSecret& secret);
+
+} // namespace quic
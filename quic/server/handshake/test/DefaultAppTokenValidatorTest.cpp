@@ -32,14 +32,14 @@ TEST(DefaultAppTokenValidatorTest, TestValidParams) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   appToken.version = conn.version;
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
@@ -58,17 +58,17 @@ TEST(
   conn.version = QuicVersion::MVFST;
 
   auto initialMaxData =
-      conn.transportSettings.advertisedInitialConnectionWindowSize;
+      conn.transportSettings->advertisedInitialConnectionWindowSize;
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
       initialMaxData - 1,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   appToken.version = conn.version;
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
@@ -79,7 +79,7 @@ TEST(
   EXPECT_TRUE(validator.validate(resState));
 
   EXPECT_EQ(
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
       initialMaxData - 1);
   EXPECT_EQ(conn.flowControlState.windowSize, initialMaxData - 1);
   EXPECT_EQ(conn.flowControlState.advertisedMaxOffset, initialMaxData - 1);
@@ -107,14 +107,14 @@ TEST(DefaultAppTokenValidatorTest, TestNoVersionMismatch) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   appToken.version = conn.version;
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
@@ -132,14 +132,14 @@ TEST(DefaultAppTokenValidatorTest, TestVersionMismatch) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   appToken.version = QuicVersion::MVFST;
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
@@ -182,19 +182,19 @@ TEST(DefaultAppTokenValidatorTest, TestInvalidMissingParams) {
   auto& params = appToken.transportParams;
   params.parameters.push_back(encodeIntegerParameter(
       TransportParameterId::initial_max_stream_data_bidi_local,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize));
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize));
   params.parameters.push_back(encodeIntegerParameter(
       TransportParameterId::initial_max_stream_data_bidi_remote,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize));
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize));
   params.parameters.push_back(encodeIntegerParameter(
       TransportParameterId::initial_max_stream_data_uni,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize));
+      conn.transportSettings->advertisedInitialUniStreamWindowSize));
   params.parameters.push_back(encodeIntegerParameter(
       TransportParameterId::ack_delay_exponent,
-      conn.transportSettings.ackDelayExponent));
+      conn.transportSettings->ackDelayExponent));
   params.parameters.push_back(encodeIntegerParameter(
       TransportParameterId::max_packet_size,
-      conn.transportSettings.maxRecvPacketSize));
+      conn.transportSettings->maxRecvPacketSize));
 
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
@@ -215,14 +215,14 @@ TEST(DefaultAppTokenValidatorTest, TestInvalidRedundantParameter) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   appToken.transportParams.parameters.push_back(
       encodeIntegerParameter(TransportParameterId::idle_timeout, 100));
   ResumptionState resState;
@@ -244,14 +244,14 @@ TEST(DefaultAppTokenValidatorTest, TestInvalidDecreasedInitialMaxStreamData) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize + 1,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize + 1,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize + 1,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize + 1,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize + 1,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize + 1,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
 
@@ -271,14 +271,14 @@ TEST(DefaultAppTokenValidatorTest, TestChangedIdleTimeout) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count() + 100,
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count() + 100,
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
 
@@ -298,14 +298,14 @@ TEST(DefaultAppTokenValidatorTest, TestDecreasedInitialMaxStreams) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi + 1,
-      conn.transportSettings.advertisedInitialMaxStreamsUni + 1);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi + 1,
+      conn.transportSettings->advertisedInitialMaxStreamsUni + 1);
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
 
@@ -327,14 +327,14 @@ TEST(DefaultAppTokenValidatorTest, TestInvalidAppParams) {
 
   AppToken appToken;
   appToken.transportParams = createTicketTransportParameters(
-      conn.transportSettings.idleTimeout.count(),
-      conn.transportSettings.maxRecvPacketSize,
-      conn.transportSettings.advertisedInitialConnectionWindowSize,
-      conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-      conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-      conn.transportSettings.advertisedInitialUniStreamWindowSize,
-      conn.transportSettings.advertisedInitialMaxStreamsBidi,
-      conn.transportSettings.advertisedInitialMaxStreamsUni);
+      conn.transportSettings->idleTimeout.count(),
+      conn.transportSettings->maxRecvPacketSize,
+      conn.transportSettings->advertisedInitialConnectionWindowSize,
+      conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+      conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+      conn.transportSettings->advertisedInitialUniStreamWindowSize,
+      conn.transportSettings->advertisedInitialMaxStreamsBidi,
+      conn.transportSettings->advertisedInitialMaxStreamsUni);
   ResumptionState resState;
   resState.appToken = encodeAppToken(appToken);
 
@@ -351,14 +351,14 @@ class SourceAddressTokenTest : public Test {
     conn_.version = QuicVersion::MVFST;
 
     appToken_.transportParams = createTicketTransportParameters(
-        conn_.transportSettings.idleTimeout.count(),
-        conn_.transportSettings.maxRecvPacketSize,
-        conn_.transportSettings.advertisedInitialConnectionWindowSize,
-        conn_.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-        conn_.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-        conn_.transportSettings.advertisedInitialUniStreamWindowSize,
-        conn_.transportSettings.advertisedInitialMaxStreamsBidi,
-        conn_.transportSettings.advertisedInitialMaxStreamsUni);
+        conn_.transportSettings->idleTimeout.count(),
+        conn_.transportSettings->maxRecvPacketSize,
+        conn_.transportSettings->advertisedInitialConnectionWindowSize,
+        conn_.transportSettings->advertisedInitialBidiLocalStreamWindowSize,
+        conn_.transportSettings->advertisedInitialBidiRemoteStreamWindowSize,
+        conn_.transportSettings->advertisedInitialUniStreamWindowSize,
+        conn_.transportSettings->advertisedInitialMaxStreamsBidi,
+        conn_.transportSettings->advertisedInitialMaxStreamsUni);
     appToken_.version = QuicVersion::MVFST;
   }
 
@@ -382,7 +382,7 @@ TEST_F(SourceAddressTokenTest, EmptySourceToken) {
 
   EXPECT_EQ(
       conn_.writableBytesLimit.value(),
-      conn_.transportSettings.limitedCwndInMss * conn_.udpSendPacketLen);
+      conn_.transportSettings->limitedCwndInMss * conn_.udpSendPacketLen);
   ASSERT_THAT(
       conn_.tokenSourceAddresses,
       ElementsAre(conn_.peerAddress.getIPAddress()));
@@ -394,7 +394,7 @@ TEST_F(SourceAddressTokenTest, OneSourceTokensNoMatch) {
 
   EXPECT_EQ(
       conn_.writableBytesLimit.value(),
-      conn_.transportSettings.limitedCwndInMss * conn_.udpSendPacketLen);
+      conn_.transportSettings->limitedCwndInMss * conn_.udpSendPacketLen);
   ASSERT_THAT(
       conn_.tokenSourceAddresses,
       ElementsAre(
@@ -409,7 +409,7 @@ TEST_F(SourceAddressTokenTest, MaxNumSourceTokensNoMatch) {
 
   EXPECT_EQ(
       conn_.writableBytesLimit.value(),
-      conn_.transportSettings.limitedCwndInMss * conn_.udpSendPacketLen);
+      conn_.transportSettings->limitedCwndInMss * conn_.udpSendPacketLen);
   ASSERT_THAT(
       conn_.tokenSourceAddresses,
       ElementsAre(
@@ -448,7 +448,7 @@ class SourceAddressTokenRejectNoMatchPolicyTest
  public:
   void SetUp() override {
     SourceAddressTokenTest::SetUp();
-    conn_.transportSettings.zeroRttSourceTokenMatchingPolicy =
+    conn_.transportSettings.mutate().zeroRttSourceTokenMatchingPolicy =
         ZeroRttSourceTokenMatchingPolicy::REJECT_IF_NO_EXACT_MATCH;
   }
 };
@@ -16,8 +16,10 @@
 #include <fizz/crypto/test/TestUtil.h>
 #include <fizz/protocol/clock/test/Mocks.h>
 #include <fizz/protocol/test/Mocks.h>
+#include <fizz/server/CertManager.h>
 #include <fizz/server/test/Mocks.h>
 
+#include <folly/io/Cursor.h>
 #include <folly/io/async/SSLContext.h>
 #include <folly/io/async/ScopedEventBaseThread.h>
 #include <folly/io/async/test/MockAsyncTransport.h>
@@ -27,6 +29,7 @@
 #include <quic/client/handshake/FizzClientExtensions.h>
 #include <quic/common/test/TestUtils.h>
 #include <quic/fizz/handshake/FizzBridge.h>
+#include <quic/fizz/handshake/FizzCertCompression.h>
 #include <quic/fizz/handshake/QuicFizzFactory.h>
 #include <quic/handshake/HandshakeLayer.h>
 #include <quic/server/handshake/AppToken.h>
@@ -267,12 +270,16 @@ class ServerHandshakeTest : public Test {
     switch (clientState.readRecordLayer()->getEncryptionLevel()) {
       case fizz::EncryptionLevel::Plaintext:
         if (!cryptoState->initialStream.writeBuffer.empty()) {
+          serverInitialBytes +=
+              cryptoState->initialStream.writeBuffer.chainLength();
           buf->prependChain(cryptoState->initialStream.writeBuffer.move());
         }
         break;
       case fizz::EncryptionLevel::Handshake:
       case fizz::EncryptionLevel::EarlyData:
         if (!cryptoState->handshakeStream.writeBuffer.empty()) {
+          serverHandshakeFlight.append(
+              cryptoState->handshakeStream.writeBuffer.front()->clone());
           buf->prependChain(cryptoState->handshakeStream.writeBuffer.move());
         }
         break;
@@ -332,6 +339,11 @@ class ServerHandshakeTest : public Test {
       fizz::client::ClientStateMachine>>
       fizzClient;
   folly::IOBufQueue clientReadBuffer{folly::IOBufQueue::cacheChainLength()};
+  // Every handshake message the server sent at the handshake level.
+  folly::IOBufQueue serverHandshakeFlight{
+      folly::IOBufQueue::cacheChainLength()};
+  // Bytes of every handshake message the server sent at the initial level.
+  size_t serverInitialBytes{0};
   bool earlyHandshakeSuccess{false};
   bool handshakeSuccess{false};
   bool earlyWriteFailed{false};
@@ -370,6 +382,193 @@ TEST_F(ServerHandshakeTest, TestHandshakeSuccess) {
   EXPECT_TRUE(handshakeSuccess);
 }
 
+TEST_F(ServerHandshakeTest, TestContextSharedAcrossHandshakes) {
+  using ConnPtr = std::unique_ptr<
+      TestingServerConnectionState,
+      folly::DelayedDestruction::Destructor>;
+  ConnPtr otherConn(new TestingServerConnectionState());
+  otherConn->serverHandshakeLayer->initialize(&evb, serverCtx, &serverCallback);
+  EXPECT_EQ(
+      handshake->getContext(), otherConn->serverHandshakeLayer->getContext());
+  EXPECT_NE(handshake->getContext(), serverCtx);
+
+  auto overrideCtx = quic::test::createServerCtx();
+  ConnPtr overrideConn(new TestingServerConnectionState());
+  overrideConn->serverHandshakeLayer->initialize(
+      &evb, overrideCtx, &serverCallback);
+  EXPECT_NE(
+      handshake->getContext(),
+      overrideConn->serverHandshakeLayer->getContext());
+}
+
+/**
+ * Measures the certificate bytes in the server's handshake flight when the
+ * server can compress its certificate with zlib and zstd and the client
+ * accepts the algorithms in the parameter, or none of them.
+ */
+class ServerHandshakeCertCompressionTest
+    : public ServerHandshakeTest,
+      public WithParamInterface<
+          std::vector<fizz::CertificateCompressionAlgorithm>> {
+ public:
+  void setupClientAndServerContext() override {
+    serverCtx = quic::test::createServerCtx(
+        {fizz::CertificateCompressionAlgorithm::zlib,
+         fizz::CertificateCompressionAlgorithm::zstd});
+    if (!GetParam().empty()) {
+      clientCtx->setCertDecompressionManager(
+          createCertDecompressionManager(GetParam()));
+    }
+  }
+
+  struct CertificateBytes {
+    folly::Optional<fizz::HandshakeType> type;
+    // Length of the Certificate or CompressedCertificate message.
+    uint32_t sent{0};
+    // Length of the Certificate message before compression.
+    uint32_t uncompressed{0};
+  };
+
+  CertificateBytes getCertificateBytes() {
+    CertificateBytes bytes;
+    if (serverHandshakeFlight.empty()) {
+      return bytes;
+    }
+    auto flight = serverHandshakeFlight.front()->clone();
+    folly::io::Cursor cursor(flight.get());
+    auto readUint24 = [&cursor]() -> uint32_t {
+      uint32_t high = cursor.readBE<uint8_t>();
+      return (high << 16) | cursor.readBE<uint16_t>();
+    };
+    while (!cursor.isAtEnd()) {
+      auto type = static_cast<fizz::HandshakeType>(cursor.readBE<uint8_t>());
+      auto length = readUint24();
+      if (type == fizz::HandshakeType::certificate) {
+        bytes = {type, length, length};
+      } else if (type == fizz::HandshakeType::compressed_certificate) {
+        // Starts with the algorithm and the uncompressed length.
+        cursor.skip(sizeof(uint16_t));
+        bytes = {type, length, readUint24()};
+        length -= sizeof(uint16_t) + 3;
+      }
+      cursor.skip(length);
+    }
+    return bytes;
+  }
+};
+
+TEST_P(ServerHandshakeCertCompressionTest, ServerFlightCertificateBytes) {
+  clientServerRound();
+  serverClientRound();
+  clientServerRound();
+  if (ex) {
+    std::rethrow_exception(ex);
+  }
+  EXPECT_EQ(handshake->getPhase(), ServerHandshake::Phase::Established);
+  EXPECT_TRUE(handshakeSuccess);
+
+  auto bytes = getCertificateBytes();
+  ASSERT_TRUE(bytes.type.hasValue());
+  if (GetParam().empty()) {
+    EXPECT_EQ(*bytes.type, fizz::HandshakeType::certificate);
+  } else {
+    EXPECT_EQ(*bytes.type, fizz::HandshakeType::compressed_certificate);
+    EXPECT_LT(bytes.sent, bytes.uncompressed);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ServerHandshakeCertCompressionTests,
+    ServerHandshakeCertCompressionTest,
+    Values(
+        std::vector<fizz::CertificateCompressionAlgorithm>{},
+        std::vector<fizz::CertificateCompressionAlgorithm>{
+            fizz::CertificateCompressionAlgorithm::zlib},
+        std::vector<fizz::CertificateCompressionAlgorithm>{
+            fizz::CertificateCompressionAlgorithm::zstd}));
+
+// Bytes the server may send in reply to a single padded client Initial,
+// before the client address is validated.
+constexpr size_t kAmplificationBudget =
+    kLimitedCwndInMss * kMinInitialPacketSize;
+// A long header with the longest connection ids, token, length and packet
+// number fields, plus the AEAD tag.
+constexpr size_t kLongHeaderPacketOverhead =
+    1 + sizeof(QuicVersionType) + 2 * (1 + kMaxConnectionIdSize) + 1 + 2 +
+    4 + 16;
+
+/**
+ * Serves a certificate chain that alone is larger than the anti-amplification
+ * budget, and checks whether the server's whole first flight fits in it. If
+ * it does not the server has to wait for another client packet, costing a
+ * round trip.
+ */
+class ServerHandshakeLargeCertChainTest
+    : public ServerHandshakeCertCompressionTest {
+ public:
+  void setupClientAndServerContext() override {
+    ServerHandshakeCertCompressionTest::setupClientAndServerContext();
+    // Repeat the test certificate until the chain exceeds the budget. Copies
+    // compress better than a real chain, so this shows that a flight can fit
+    // rather than how much a given chain shrinks.
+    auto certificate = fizz::test::getCert(fizz::test::kP256Certificate);
+    size_t certLength = i2d_X509(certificate.get(), nullptr);
+    std::vector<folly::ssl::X509UniquePtr> chain;
+    for (size_t chainLength = 0; chainLength <= kAmplificationBudget;
+         chainLength += certLength) {
+      chain.push_back(fizz::test::getCert(fizz::test::kP256Certificate));
+    }
+    auto certManager = std::make_unique<fizz::server::CertManager>();
+    certManager->addCert(
+        createCompressibleSelfCert(
+            fizz::test::getPrivateKey(fizz::test::kP256Key),
+            std::move(chain),
+            {fizz::CertificateCompressionAlgorithm::zlib,
+             fizz::CertificateCompressionAlgorithm::zstd}),
+        true);
+    serverCtx->setCertManager(std::move(certManager));
+  }
+
+  size_t getServerFlightBytes() {
+    // Charge the overhead of every packet the budget allows, so that a
+    // flight is never estimated to fit when it would not.
+    return serverInitialBytes + serverHandshakeFlight.chainLength() +
+        kLimitedCwndInMss * kLongHeaderPacketOverhead;
+  }
+};
+
+TEST_P(ServerHandshakeLargeCertChainTest, FirstFlightAmplificationBudget) {
+  clientServerRound();
+  serverClientRound();
+  clientServerRound();
+  if (ex) {
+    std::rethrow_exception(ex);
+  }
+  EXPECT_EQ(handshake->getPhase(), ServerHandshake::Phase::Established);
+  EXPECT_TRUE(handshakeSuccess);
+
+  auto bytes = getCertificateBytes();
+  ASSERT_TRUE(bytes.type.hasValue());
+  EXPECT_GT(bytes.uncompressed, kAmplificationBudget);
+  if (GetParam().empty()) {
+    EXPECT_EQ(*bytes.type, fizz::HandshakeType::certificate);
+    EXPECT_GT(getServerFlightBytes(), kAmplificationBudget);
+  } else {
+    EXPECT_EQ(*bytes.type, fizz::HandshakeType::compressed_certificate);
+    EXPECT_LE(getServerFlightBytes(), kAmplificationBudget);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ServerHandshakeLargeCertChainTests,
+    ServerHandshakeLargeCertChainTest,
+    Values(
+        std::vector<fizz::CertificateCompressionAlgorithm>{},
+        std::vector<fizz::CertificateCompressionAlgorithm>{
+            fizz::CertificateCompressionAlgorithm::zlib},
+        std::vector<fizz::CertificateCompressionAlgorithm>{
+            fizz::CertificateCompressionAlgorithm::zstd}));
+
 TEST_F(ServerHandshakeTest, TestHandshakeSuccessIgnoreNonHandshake) {
   fizz::WriteToSocket write;
   fizz::TLSContent content;
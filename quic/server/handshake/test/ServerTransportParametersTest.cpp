@@ -88,6 +88,74 @@ TEST(ServerTransportParametersTest, TestGetExtensionsD18) {
   EXPECT_EQ(token, expectedToken);
 }
 
+TEST(ServerTransportParametersTest, TestGetExtensionsSharedEncoding) {
+  auto encoded = encodeServerTransportParameters(
+      kDefaultConnectionWindowSize,
+      kDefaultStreamWindowSize,
+      kDefaultStreamWindowSize,
+      kDefaultStreamWindowSize,
+      std::numeric_limits<uint32_t>::max(),
+      std::numeric_limits<uint32_t>::max(),
+      kDefaultIdleTimeout,
+      kDefaultAckDelayExponent,
+      kDefaultUDPSendPacketLen,
+      kDefaultPartialReliability);
+  StatelessResetToken token1 = generateStatelessResetToken();
+  StatelessResetToken token2 = generateStatelessResetToken();
+  ServerTransportParametersExtension ext1(
+      QuicVersion::MVFST, {MVFST1, QuicVersion::MVFST}, encoded, token1);
+  ServerTransportParametersExtension ext2(
+      QuicVersion::MVFST, {MVFST1, QuicVersion::MVFST}, encoded, token2);
+
+  auto serverParams1 = getExtension<ServerTransportParameters>(
+      ext1.getExtensions(getClientHello(folly::none)));
+  auto serverParams2 = getExtension<ServerTransportParameters>(
+      ext2.getExtensions(getClientHello(folly::none)));
+  ASSERT_TRUE(serverParams1.hasValue());
+  ASSERT_TRUE(serverParams2.hasValue());
+  EXPECT_EQ(
+      *getStatelessResetTokenParameter(serverParams1->parameters), token1);
+  EXPECT_EQ(
+      *getStatelessResetTokenParameter(serverParams2->parameters), token2);
+  EXPECT_EQ(
+      *getIntegerParameter(
+          TransportParameterId::initial_max_data, serverParams2->parameters),
+      kDefaultConnectionWindowSize);
+  // The shared encoding is left untouched by each connection's extension.
+  EXPECT_EQ(encoded->size(), serverParams1->parameters.size() - 1);
+}
+
+TEST(ServerTransportParametersTest, TestGetExtensionsPreferredAddress) {
+  auto encoded = encodeServerTransportParameters(
+      kDefaultConnectionWindowSize,
+      kDefaultStreamWindowSize,
+      kDefaultStreamWindowSize,
+      kDefaultStreamWindowSize,
+      std::numeric_limits<uint32_t>::max(),
+      std::numeric_limits<uint32_t>::max(),
+      kDefaultIdleTimeout,
+      kDefaultAckDelayExponent,
+      kDefaultUDPSendPacketLen,
+      kDefaultPartialReliability);
+  ServerTransportParametersExtension ext(
+      QuicVersion::MVFST,
+      {MVFST1, QuicVersion::MVFST},
+      encoded,
+      generateStatelessResetToken());
+  PreferredAddress preferredAddress(
+      ConnectionId(std::vector<uint8_t>{1, 2, 3, 4}),
+      generateStatelessResetToken());
+  preferredAddress.ipv4Address = folly::SocketAddress("10.0.0.1", 443);
+  ext.setPreferredAddress(preferredAddress);
+
+  auto serverParams = getExtension<ServerTransportParameters>(
+      ext.getExtensions(getClientHello(folly::none)));
+  ASSERT_TRUE(serverParams.hasValue());
+  auto decoded = getPreferredAddressParameter(serverParams->parameters);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_EQ(*decoded, preferredAddress);
+}
+
 TEST(ServerTransportParametersTest, TestGetExtensionsMissingClientParams) {
   ServerTransportParametersExtension ext(
       QuicVersion::MVFST,
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/handshake/TokenGenerator.h>
+#include <folly/Random.h>
+#include <folly/portability/GTest.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class TokenGeneratorTest : public Test {
+ public:
+  void SetUp() override {
+    folly::Random::secureRandom(secret_.data(), secret_.size());
+  }
+
+ protected:
+  NewTokenSecret secret_;
+  std::chrono::system_clock::time_point now_{std::chrono::system_clock::now()};
+  std::chrono::seconds validity_{kDefaultNewTokenValidity};
+};
+
+TEST_F(TokenGeneratorTest, ValidToken) {
+  TokenGenerator generator1(secret_), generator2(secret_);
+  folly::IPAddress clientIp("1.2.3.4");
+  auto token = generator1.encryptToken(clientIp, now_);
+  ASSERT_TRUE(token);
+  EXPECT_TRUE(generator2.validateToken(*token, clientIp, validity_, now_));
+  EXPECT_TRUE(generator2.validateToken(
+      *token, clientIp, validity_, now_ + validity_));
+
+  folly::IPAddress clientIpV6("2401:db00::1");
+  auto tokenV6 = generator1.encryptToken(clientIpV6, now_);
+  ASSERT_TRUE(tokenV6);
+  EXPECT_TRUE(generator2.validateToken(*tokenV6, clientIpV6, validity_, now_));
+}
+
+TEST_F(TokenGeneratorTest, DifferentAddress) {
+  TokenGenerator generator(secret_);
+  auto token = generator.encryptToken(folly::IPAddress("1.2.3.4"), now_);
+  ASSERT_TRUE(token);
+  EXPECT_FALSE(generator.validateToken(
+      *token, folly::IPAddress("1.2.3.5"), validity_, now_));
+}
+
+TEST_F(TokenGeneratorTest, Expired) {
+  TokenGenerator generator(secret_);
+  folly::IPAddress clientIp("1.2.3.4");
+  auto token = generator.encryptToken(clientIp, now_);
+  ASSERT_TRUE(token);
+  EXPECT_FALSE(generator.validateToken(
+      *token, clientIp, validity_, now_ + validity_ + std::chrono::seconds(1)));
+}
+
+TEST_F(TokenGeneratorTest, DifferentSecret) {
+  NewTokenSecret otherSecret;
+  folly::Random::secureRandom(otherSecret.data(), otherSecret.size());
+  TokenGenerator generator1(secret_), generator2(otherSecret);
+  folly::IPAddress clientIp("1.2.3.4");
+  auto token = generator1.encryptToken(clientIp, now_);
+  ASSERT_TRUE(token);
+  EXPECT_FALSE(generator2.validateToken(*token, clientIp, validity_, now_));
+}
+
+TEST_F(TokenGeneratorTest, TokenType) {
+  TokenGenerator generator(secret_);
+  folly::IPAddress clientIp("1.2.3.4");
+  auto token = generator.encryptToken(clientIp, now_);
+  ASSERT_TRUE(token);
+  token->coalesce();
+  EXPECT_EQ(static_cast<uint8_t>(TokenType::NewToken), token->data()[0]);
+
+  // The same sealed bytes are not accepted as any other kind of token.
+  token->writableData()[0] = static_cast<uint8_t>(TokenType::RetryToken);
+  EXPECT_FALSE(generator.validateToken(*token, clientIp, validity_, now_));
+}
+
+TEST_F(TokenGeneratorTest, ThreadTokenGenerator) {
+  const auto& generator = getThreadTokenGenerator(secret_);
+  EXPECT_EQ(&generator, &getThreadTokenGenerator(secret_));
+  folly::IPAddress clientIp("1.2.3.4");
+  auto token = generator.encryptToken(clientIp, now_);
+  ASSERT_TRUE(token);
+
+  NewTokenSecret otherSecret;
+  folly::Random::secureRandom(otherSecret.data(), otherSecret.size());
+  EXPECT_FALSE(getThreadTokenGenerator(otherSecret).validateToken(
+      *token, clientIp, validity_, now_));
+  EXPECT_TRUE(getThreadTokenGenerator(secret_).validateToken(
+      *token, clientIp, validity_, now_));
+}
+
+TEST_F(TokenGeneratorTest, Garbage) {
+  TokenGenerator generator(secret_);
+  auto token = folly::IOBuf::copyBuffer("this is not a token");
+  EXPECT_FALSE(generator.validateToken(
+      *token, folly::IPAddress("1.2.3.4"), validity_, now_));
+}
+
+} // namespace test
+} // namespace quic
@@ -14,6 +14,7 @@
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/TransportParameters.h>
 #include <quic/logging/QLoggerConstants.h>
+#include <quic/server/handshake/TokenGenerator.h>
 #include <quic/state/QuicPacingFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <quic/state/QuicTransportStatsCallback.h>
@@ -56,12 +57,82 @@ CongestionAndRttState moveCurrentCongestionAndRttState(
   return state;
 }
 
+using ServerTransportParametersKey = std::tuple<
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    std::chrono::milliseconds,
+    uint64_t,
+    uint64_t,
+    TransportPartialReliabilitySetting,
+    uint64_t>;
+
+/**
+ * Connections accepted by a worker nearly always share one settings profile,
+ * so remembering the last encoding per thread is enough to take transport
+ * parameter encoding off the accept path.
+ */
+std::shared_ptr<const std::vector<TransportParameter>>
+getEncodedServerTransportParameters(const TransportSettings& settings) {
+  struct CachedParameters {
+    ServerTransportParametersKey key;
+    std::shared_ptr<const std::vector<TransportParameter>> parameters;
+  };
+  static thread_local CachedParameters cached;
+  ServerTransportParametersKey key(
+      settings.advertisedInitialConnectionWindowSize,
+      settings.advertisedInitialBidiLocalStreamWindowSize,
+      settings.advertisedInitialBidiRemoteStreamWindowSize,
+      settings.advertisedInitialUniStreamWindowSize,
+      settings.advertisedInitialMaxStreamsBidi,
+      settings.advertisedInitialMaxStreamsUni,
+      settings.idleTimeout,
+      settings.ackDelayExponent,
+      settings.maxRecvPacketSize,
+      settings.partialReliabilityEnabled,
+      settings.fecRetentionBytes);
+  if (!cached.parameters || cached.key != key) {
+    cached.parameters = encodeServerTransportParameters(
+        settings.advertisedInitialConnectionWindowSize,
+        settings.advertisedInitialBidiLocalStreamWindowSize,
+        settings.advertisedInitialBidiRemoteStreamWindowSize,
+        settings.advertisedInitialUniStreamWindowSize,
+        settings.advertisedInitialMaxStreamsBidi,
+        settings.advertisedInitialMaxStreamsUni,
+        settings.idleTimeout,
+        settings.ackDelayExponent,
+        settings.maxRecvPacketSize,
+        settings.partialReliabilityEnabled,
+        settings.fecRetentionBytes);
+    cached.key = std::move(key);
+  }
+  return cached.parameters;
+}
+
+folly::Optional<PreferredAddress> maybeCreatePreferredAddress(
+    QuicServerConnectionState& conn) {
+  const auto& settings = *conn.transportSettings;
+  if (!settings.preferredAddressV4 && !settings.preferredAddressV6) {
+    return folly::none;
+  }
+  // The preferred address connection id has sequence number 1, right after
+  // the one chosen for the handshake.
+  auto connIdData = conn.createPreferredAddressConnId();
+  PreferredAddress preferredAddress(connIdData.connId, *connIdData.token);
+  preferredAddress.ipv4Address = settings.preferredAddressV4;
+  preferredAddress.ipv6Address = settings.preferredAddressV6;
+  return preferredAddress;
+}
+
 void resetCongestionAndRttState(QuicServerConnectionState& conn) {
   CHECK(conn.congestionControllerFactory)
       << "CongestionControllerFactory is not set.";
   conn.congestionController =
       conn.congestionControllerFactory->makeCongestionController(
-          conn, conn.transportSettings.defaultCongestionController);
+          conn, conn.transportSettings->defaultCongestionController);
   conn.lossState.srtt = 0us;
   conn.lossState.lrtt = 0us;
   conn.lossState.rttvar = 0us;
@@ -86,6 +157,39 @@ void recoverOrResetCongestionAndRttState(
     resetCongestionAndRttState(conn);
   }
 }
+
+/**
+ * A client validating our preferred address sends its PATH_CHALLENGE from
+ * its current address to the connection id issued with the preferred
+ * address. The client has not moved, so the challenge is answered without
+ * switching to a spare peer connection id. Returns whether the frame was
+ * such a challenge.
+ */
+bool maybeAnswerPreferredAddressChallenge(
+    QuicServerConnectionState& conn,
+    const PacketHeader& header,
+    const QuicSimpleFrame& frame,
+    const folly::SocketAddress& peer) {
+  const auto pathChallenge = frame.asPathChallengeFrame();
+  const auto shortHeader = header.asShort();
+  if (!pathChallenge || !shortHeader || !conn.preferredAddressConnectionId ||
+      peer != conn.peerAddress ||
+      shortHeader->getConnectionId() != *conn.preferredAddressConnectionId) {
+    return false;
+  }
+  conn.pendingEvents.frames.emplace_back(
+      PathResponseFrame(pathChallenge->pathData));
+  return true;
+}
+
+/**
+ * Short header packets carry one of our own connection ids, whose length
+ * depends on the ConnectionIdAlgo in use.
+ */
+size_t getSelfConnectionIdSize(const QuicServerConnectionState& conn) {
+  return conn.serverConnectionId ? conn.serverConnectionId->size()
+                                 : kDefaultConnectionIdSize;
+}
 } // namespace
 
 void processClientInitialParams(
@@ -117,6 +221,9 @@ void processClientInitialParams(
   auto partialReliability = getIntegerParameter(
       static_cast<TransportParameterId>(kPartialReliabilityParameterId),
       clientParams.parameters);
+  auto fecRetentionBytes = getIntegerParameter(
+      static_cast<TransportParameterId>(kFecParameterId),
+      clientParams.parameters);
   auto activeConnectionIdLimit = getIntegerParameter(
       TransportParameterId::active_connection_id_limit,
       clientParams.parameters);
@@ -161,20 +268,36 @@ void processClientInitialParams(
   conn.peerAckDelayExponent =
       ackDelayExponent.value_or(kDefaultAckDelayExponent);
   // TODO: udpSendPacketLen should also be limited by PMTU
-  if (conn.transportSettings.canIgnorePathMTU) {
+  if (conn.transportSettings->canIgnorePathMTU) {
     conn.udpSendPacketLen =
         std::min<uint64_t>(*packetSize, kDefaultMaxUDPPayload);
   }
 
   conn.peerActiveConnectionIdLimit =
       activeConnectionIdLimit.value_or(kDefaultConnectionIdLimit);
+  if (conn.preferredAddressConnectionId &&
+      conn.peerActiveConnectionIdLimit == 0) {
+    // The client takes no connection id besides the one in use, so the
+    // preferred address was left out of our transport parameters.
+    auto& selfIds = conn.selfConnectionIds;
+    selfIds.erase(
+        std::remove_if(
+            selfIds.begin(),
+            selfIds.end(),
+            [&conn](const ConnectionIdData& data) {
+              return data.connId == *conn.preferredAddressConnectionId;
+            }),
+        selfIds.end());
+    conn.preferredAddressConnectionId = folly::none;
+  }
 
   if (partialReliability && *partialReliability != 0 &&
-      conn.transportSettings.partialReliabilityEnabled) {
+      conn.transportSettings->partialReliabilityEnabled) {
     conn.partialReliabilityEnabled = true;
   }
   VLOG(10) << "conn.partialReliabilityEnabled="
            << conn.partialReliabilityEnabled;
+  conn.peerFecRetentionBytes = fecRetentionBytes.value_or(0);
 }
 
 void updateHandshakeState(QuicServerConnectionState& conn) {
@@ -288,14 +411,18 @@ bool validateAndUpdateSourceToken(
     }
     sourceAddresses.push_back(conn.peerAddress.getIPAddress());
 
-    switch (conn.transportSettings.zeroRttSourceTokenMatchingPolicy) {
+    switch (conn.transportSettings->zeroRttSourceTokenMatchingPolicy) {
       case ZeroRttSourceTokenMatchingPolicy::REJECT_IF_NO_EXACT_MATCH:
         acceptZeroRtt = false;
         break;
       case ZeroRttSourceTokenMatchingPolicy::LIMIT_IF_NO_EXACT_MATCH:
         acceptZeroRtt = true;
-        conn.writableBytesLimit =
-            conn.transportSettings.limitedCwndInMss * conn.udpSendPacketLen;
+        // A valid NEW_TOKEN token already proved that the client owns its
+        // address, so there is nothing to limit.
+        if (!conn.newTokenValidated) {
+          conn.writableBytesLimit =
+              conn.transportSettings->limitedCwndInMss * conn.udpSendPacketLen;
+        }
         break;
     }
   }
@@ -310,8 +437,33 @@ void updateWritableByteLimitOnRecvPacket(QuicServerConnectionState& conn) {
   // that a peer can do the same by opening a new connection.
   if (conn.writableBytesLimit) {
     conn.writableBytesLimit = *conn.writableBytesLimit +
-        conn.transportSettings.limitedCwndInMss * conn.udpSendPacketLen;
+        conn.transportSettings->limitedCwndInMss * conn.udpSendPacketLen;
+  }
+}
+
+void maybeValidateNewToken(
+    QuicServerConnectionState& conn,
+    const LongHeader& longHeader) {
+  const auto& token = longHeader.getToken();
+  if (longHeader.getHeaderType() != LongHeader::Types::Initial ||
+      token.empty() || !conn.transportSettings->newTokenSecret) {
+    return;
+  }
+  const auto& generator =
+      getThreadTokenGenerator(*conn.transportSettings->newTokenSecret);
+  auto tokenBuf = folly::IOBuf::wrapBuffer(token.data(), token.size());
+  conn.newTokenValidated = generator.validateToken(
+      *tokenBuf,
+      conn.peerAddress.getIPAddress(),
+      conn.transportSettings->newTokenValidity,
+      std::chrono::system_clock::now());
+  if (conn.newTokenValidated) {
+    // The client has already proven its address, lift any limit on what we
+    // may send before the handshake completes.
+    conn.writableBytesLimit = folly::none;
   }
+  VLOG(4) << "Initial token validated=" << conn.newTokenValidated << " "
+          << conn;
 }
 
 void updateTransportParamsFromTicket(
@@ -324,22 +476,35 @@ void updateTransportParamsFromTicket(
     uint64_t initialMaxStreamDataUni,
     uint64_t initialMaxStreamsBidi,
     uint64_t initialMaxStreamsUni) {
-  conn.transportSettings.idleTimeout = std::chrono::milliseconds(idleTimeout);
-  conn.transportSettings.maxRecvPacketSize = maxRecvPacketSize;
-
-  conn.transportSettings.advertisedInitialConnectionWindowSize = initialMaxData;
-  conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize =
-      initialMaxStreamDataBidiLocal;
-  conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize =
-      initialMaxStreamDataBidiRemote;
-  conn.transportSettings.advertisedInitialUniStreamWindowSize =
-      initialMaxStreamDataUni;
+  const auto& settings = *conn.transportSettings;
+  // Tickets normally carry the parameters the connection was set up with, in
+  // which case it keeps sharing its worker's settings.
+  if (settings.idleTimeout != std::chrono::milliseconds(idleTimeout) ||
+      settings.maxRecvPacketSize != maxRecvPacketSize ||
+      settings.advertisedInitialConnectionWindowSize != initialMaxData ||
+      settings.advertisedInitialBidiLocalStreamWindowSize !=
+          initialMaxStreamDataBidiLocal ||
+      settings.advertisedInitialBidiRemoteStreamWindowSize !=
+          initialMaxStreamDataBidiRemote ||
+      settings.advertisedInitialUniStreamWindowSize !=
+          initialMaxStreamDataUni ||
+      settings.advertisedInitialMaxStreamsBidi != initialMaxStreamsBidi ||
+      settings.advertisedInitialMaxStreamsUni != initialMaxStreamsUni) {
+    auto& ticketSettings = conn.transportSettings.mutate();
+    ticketSettings.idleTimeout = std::chrono::milliseconds(idleTimeout);
+    ticketSettings.maxRecvPacketSize = maxRecvPacketSize;
+    ticketSettings.advertisedInitialConnectionWindowSize = initialMaxData;
+    ticketSettings.advertisedInitialBidiLocalStreamWindowSize =
+        initialMaxStreamDataBidiLocal;
+    ticketSettings.advertisedInitialBidiRemoteStreamWindowSize =
+        initialMaxStreamDataBidiRemote;
+    ticketSettings.advertisedInitialUniStreamWindowSize =
+        initialMaxStreamDataUni;
+    ticketSettings.advertisedInitialMaxStreamsBidi = initialMaxStreamsBidi;
+    ticketSettings.advertisedInitialMaxStreamsUni = initialMaxStreamsUni;
+  }
   updateFlowControlStateWithSettings(
-      conn.flowControlState, conn.transportSettings);
-
-  conn.transportSettings.advertisedInitialMaxStreamsBidi =
-      initialMaxStreamsBidi;
-  conn.transportSettings.advertisedInitialMaxStreamsUni = initialMaxStreamsUni;
+      conn.flowControlState, *conn.transportSettings);
 }
 
 void onConnectionMigration(
@@ -458,7 +623,7 @@ void handleCipherUnavailable(
   size_t combinedSize =
       (conn.pendingZeroRttData ? conn.pendingZeroRttData->size() : 0) +
       (conn.pendingOneRttData ? conn.pendingOneRttData->size() : 0);
-  if (combinedSize >= conn.transportSettings.maxPacketsToBuffer) {
+  if (combinedSize >= conn.transportSettings->maxPacketsToBuffer) {
     VLOG(10) << "drop because max buffered " << conn;
     if (conn.qLogger) {
       conn.qLogger->addPacketDrop(packetSize, kMaxBuffered);
@@ -568,21 +733,16 @@ void onServerReadDataFromOpen(
     conn.serverConnectionId = newServerConnIdData->connId;
 
     QUIC_STATS(conn.infoCallback, onStatelessReset);
-    conn.serverHandshakeLayer->accept(
-        std::make_shared<ServerTransportParametersExtension>(
-            version,
-            conn.supportedVersions,
-            conn.transportSettings.advertisedInitialConnectionWindowSize,
-            conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize,
-            conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize,
-            conn.transportSettings.advertisedInitialUniStreamWindowSize,
-            conn.transportSettings.advertisedInitialMaxStreamsBidi,
-            conn.transportSettings.advertisedInitialMaxStreamsUni,
-            conn.transportSettings.idleTimeout,
-            conn.transportSettings.ackDelayExponent,
-            conn.transportSettings.maxRecvPacketSize,
-            conn.transportSettings.partialReliabilityEnabled,
-            *newServerConnIdData->token));
+    auto serverParams = std::make_shared<ServerTransportParametersExtension>(
+        version,
+        conn.supportedVersions,
+        getEncodedServerTransportParameters(*conn.transportSettings),
+        *newServerConnIdData->token);
+    auto preferredAddress = maybeCreatePreferredAddress(conn);
+    if (preferredAddress) {
+      serverParams->setPreferredAddress(std::move(*preferredAddress));
+    }
+    conn.serverHandshakeLayer->accept(std::move(serverParams));
     conn.transportParametersEncoded = true;
     CryptoFactory& cryptoFactory = *conn.serverHandshakeLayer->cryptoFactory_;
     conn.readCodec = std::make_unique<QuicReadCodec>(QuicNodeType::Server);
@@ -612,7 +772,8 @@ void onServerReadDataFromOpen(
        !udpData.empty() && processedPackets < kMaxNumCoalescedPackets;
        processedPackets++) {
     size_t dataSize = udpData.chainLength();
-    auto parsedPacket = conn.readCodec->parsePacket(udpData, conn.ackStates);
+    auto parsedPacket = conn.readCodec->parsePacket(
+        udpData, conn.ackStates, getSelfConnectionIdSize(conn));
     size_t packetSize = dataSize - udpData.chainLength();
 
     switch (parsedPacket.type()) {
@@ -710,6 +871,7 @@ void onServerReadDataFromOpen(
             "Invalid packet type", TransportErrorCode::PROTOCOL_VIOLATION);
       }
       conn.version = longHeader->getVersion();
+      maybeValidateNewToken(conn, *longHeader);
     }
 
     if (conn.peerAddress != readData.peer) {
@@ -729,7 +891,7 @@ void onServerReadDataFromOpen(
             TransportErrorCode::INVALID_MIGRATION);
       }
 
-      if (conn.transportSettings.disableMigration) {
+      if (conn.transportSettings->disableMigration) {
         if (conn.qLogger) {
           conn.qLogger->addPacketDrop(
               packetSize,
@@ -957,9 +1119,18 @@ void onServerReadDataFromOpen(
         case QuicFrame::Type::PaddingFrame_E: {
           break;
         }
+        case QuicFrame::Type::ReadNewTokenFrame_E: {
+          throw QuicTransportException(
+              "Received NEW_TOKEN from client",
+              TransportErrorCode::PROTOCOL_VIOLATION);
+        }
         case QuicFrame::Type::QuicSimpleFrame_E: {
           pktHasRetransmittableData = true;
           QuicSimpleFrame& simpleFrame = *quicFrame.asQuicSimpleFrame();
+          if (maybeAnswerPreferredAddressChallenge(
+                  conn, regularPacket.header, simpleFrame, readData.peer)) {
+            break;
+          }
           isNonProbingPacket |= updateSimpleFrameOnPacketReceived(
               conn, simpleFrame, packetNum, readData.peer != conn.peerAddress);
           break;
@@ -1080,7 +1251,8 @@ void onServerReadDataFromClosed(
         PacketDropReason::SERVER_STATE_CLOSED);
     return;
   }
-  auto parsedPacket = conn.readCodec->parsePacket(udpData, conn.ackStates);
+  auto parsedPacket = conn.readCodec->parsePacket(
+      udpData, conn.ackStates, getSelfConnectionIdSize(conn));
   switch (parsedPacket.type()) {
     case CodecResult::Type::CIPHER_UNAVAILABLE: {
       VLOG(10) << "drop cipher unavailable " << conn;
@@ -1181,14 +1353,26 @@ QuicServerConnectionState::createAndAddNewSelfConnId() {
   CHECK(connIdAlgo);
   CHECK(serverConnIdParams);
 
-  if (selfConnectionIds.size() == peerActiveConnectionIdLimit + 1) {
+  if (selfConnectionIds.size() >= peerActiveConnectionIdLimit + 1) {
     return folly::none;
   };
+  return addSelfConnId();
+}
+
+ConnectionIdData QuicServerConnectionState::createPreferredAddressConnId() {
+  CHECK(connIdAlgo);
+  CHECK(serverConnIdParams);
+  CHECK(!preferredAddressConnectionId);
+  auto connIdData = addSelfConnId();
+  preferredAddressConnectionId = connIdData.connId;
+  return connIdData;
+}
 
-  CHECK(transportSettings.statelessResetTokenSecret);
+ConnectionIdData QuicServerConnectionState::addSelfConnId() {
+  CHECK(transportSettings->statelessResetTokenSecret);
 
   StatelessResetGenerator generator(
-      transportSettings.statelessResetTokenSecret.value(),
+      transportSettings->statelessResetTokenSecret.value(),
       serverAddr.getFullyQualified());
 
   // TODO Possibly change this mechanism later
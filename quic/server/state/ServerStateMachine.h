@@ -115,11 +115,27 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
   // limited until CFIN depending on matching policy.
   folly::Optional<bool> sourceTokenMatching;
 
+  // Whether the client echoed a valid NEW_TOKEN token from a previous
+  // connection in its Initial, proving it owns its address.
+  bool newTokenValidated{false};
+
   // Server address of VIP. Currently used as input for stateless reset token.
   folly::SocketAddress serverAddr;
 
+  // Connection id advertised with the preferred address. It has to be
+  // routable before the client migrates, i.e. once the handshake is done.
+  folly::Optional<ConnectionId> preferredAddressConnectionId;
+
   folly::Optional<ConnectionIdData> createAndAddNewSelfConnId() override;
 
+  /**
+   * Creates the connection id advertised with the preferred address. It is
+   * created before the client's active_connection_id_limit is known, and
+   * withdrawn by processClientInitialParams if the limit leaves no room for
+   * it.
+   */
+  ConnectionIdData createPreferredAddressConnId();
+
   QuicServerConnectionState() : QuicConnectionStateBase(QuicNodeType::Server) {
     state = ServerState::Open;
     // Create the crypto stream.
@@ -137,13 +153,16 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
     handshakeLayer.reset(serverHandshakeLayer);
     // We shouldn't normally need to set this until we're starting the
     // transport, however writing unit tests is much easier if we set this here.
-    updateFlowControlStateWithSettings(flowControlState, transportSettings);
+    updateFlowControlStateWithSettings(flowControlState, *transportSettings);
     pendingZeroRttData =
         std::make_unique<std::vector<ServerEvents::ReadData>>();
     pendingOneRttData = std::make_unique<std::vector<ServerEvents::ReadData>>();
     streamManager = std::make_unique<QuicStreamManager>(
-        *this, this->nodeType, transportSettings);
+        *this, this->nodeType, *transportSettings);
   }
+
+ private:
+  ConnectionIdData addSelfConnId();
 };
 
 // Transition to error state on invalid state transition.
@@ -177,6 +196,15 @@ bool validateAndUpdateSourceToken(
 
 void updateWritableByteLimitOnRecvPacket(QuicServerConnectionState& conn);
 
+/**
+ * Checks the token the client sent in its Initial against the tokens this
+ * server hands out in NEW_TOKEN frames, and marks the client address as
+ * validated if it matches.
+ */
+void maybeValidateNewToken(
+    QuicServerConnectionState& conn,
+    const LongHeader& longHeader);
+
 void updateTransportParamsFromTicket(
     QuicServerConnectionState& conn,
     uint64_t idleTimeout,
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/ConnectionTombstoneTable.h>
+
+#include <folly/portability/GTest.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class ConnectionTombstoneTableTest : public Test {
+ protected:
+  ConnectionId connId1{std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 8}};
+  ConnectionId connId2{std::vector<uint8_t>{8, 7, 6, 5, 4, 3, 2, 1}};
+  ConnectionId otherConnId{std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 1}};
+  folly::EventBase evb;
+  ConnectionTombstoneTable table{&evb};
+};
+
+TEST_F(ConnectionTombstoneTableTest, ReplyRateLimited) {
+  table.add(
+      {connId1, connId2},
+      folly::IOBuf::copyBuffer("close"),
+      std::chrono::seconds(10));
+  EXPECT_EQ(table.size(), 2);
+  EXPECT_FALSE(table.onPacketReceived(otherConnId).hasValue());
+
+  // Both connection ids share the same tombstone: replies go out for the
+  // 1st, 2nd, 4th and 8th packet.
+  std::vector<bool> replied;
+  for (int i = 0; i < 8; ++i) {
+    auto result = table.onPacketReceived(i % 2 ? connId1 : connId2);
+    ASSERT_TRUE(result.hasValue());
+    replied.push_back(*result != nullptr);
+    if (*result) {
+      EXPECT_EQ((*result)->moveToFbString(), "close");
+    }
+  }
+  EXPECT_EQ(
+      replied,
+      std::vector<bool>({true, true, false, true, false, false, false, true}));
+}
+
+TEST_F(ConnectionTombstoneTableTest, SilentTombstone) {
+  table.add({connId1}, nullptr, std::chrono::seconds(10));
+  auto result = table.onPacketReceived(connId1);
+  ASSERT_TRUE(result.hasValue());
+  EXPECT_EQ(*result, nullptr);
+}
+
+TEST_F(ConnectionTombstoneTableTest, Expiry) {
+  auto now = Clock::now();
+  table.add(
+      {connId1}, folly::IOBuf::copyBuffer("close"), std::chrono::seconds(1));
+  table.add(
+      {connId2}, folly::IOBuf::copyBuffer("close"), std::chrono::seconds(10));
+  EXPECT_FALSE(table.onPacketReceived(connId1, now + std::chrono::seconds(2))
+                   .hasValue());
+  EXPECT_TRUE(table.onPacketReceived(connId2, now + std::chrono::seconds(2))
+                  .hasValue());
+
+  table.sweep(now + std::chrono::seconds(2));
+  EXPECT_EQ(table.size(), 1);
+  table.sweep(now + std::chrono::seconds(11));
+  EXPECT_EQ(table.size(), 0);
+}
+
+TEST_F(ConnectionTombstoneTableTest, SweptByTimer) {
+  table.add(
+      {connId1},
+      folly::IOBuf::copyBuffer("close"),
+      std::chrono::milliseconds(1));
+  EXPECT_EQ(table.size(), 1);
+  evb.runAfterDelay([&] { evb.terminateLoopSoon(); }, 50);
+  evb.loopForever();
+  EXPECT_EQ(table.size(), 0);
+}
+
+} // namespace test
+} // namespace quic
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/IngressPolicer.h>
+
+#include <folly/portability/GTest.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+using PacketType = IngressPolicer::PacketType;
+
+class IngressPolicerTest : public Test {
+ public:
+  void SetUp() override {
+    config.initialsPerSecond = 10;
+    config.initialBurst = 3;
+    config.unroutablePerSecond = 10;
+    config.unroutableBurst = 1;
+  }
+
+  IngressPolicerConfig config;
+  folly::IPAddress client{"10.0.0.1"};
+  TimePoint now{Clock::now()};
+};
+
+TEST_F(IngressPolicerTest, BurstThenRate) {
+  IngressPolicer policer(config);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(policer.admit(client, PacketType::Initial, now));
+  }
+  EXPECT_FALSE(policer.admit(client, PacketType::Initial, now));
+
+  // Each packet type has its own buckets.
+  EXPECT_TRUE(policer.admit(client, PacketType::Unroutable, now));
+  EXPECT_FALSE(policer.admit(client, PacketType::Unroutable, now));
+
+  // One more Initial is allowed every 100ms.
+  now += 50ms;
+  EXPECT_FALSE(policer.admit(client, PacketType::Initial, now));
+  now += 50ms;
+  EXPECT_TRUE(policer.admit(client, PacketType::Initial, now));
+  EXPECT_FALSE(policer.admit(client, PacketType::Initial, now));
+}
+
+TEST_F(IngressPolicerTest, PolicedByPrefix) {
+  IngressPolicer policer(config);
+  EXPECT_TRUE(policer.admit(client, PacketType::Unroutable, now));
+  EXPECT_FALSE(policer.admit(
+      folly::IPAddress("10.0.0.200"), PacketType::Unroutable, now));
+  EXPECT_FALSE(policer.admit(
+      folly::IPAddress("::ffff:10.0.0.2"), PacketType::Unroutable, now));
+  EXPECT_TRUE(policer.admit(
+      folly::IPAddress("10.0.1.1"), PacketType::Unroutable, now));
+
+  EXPECT_TRUE(policer.admit(
+      folly::IPAddress("2001:db8:1::1"), PacketType::Unroutable, now));
+  EXPECT_FALSE(policer.admit(
+      folly::IPAddress("2001:db8:1:ffff::1"), PacketType::Unroutable, now));
+  EXPECT_TRUE(policer.admit(
+      folly::IPAddress("2001:db8:2::1"), PacketType::Unroutable, now));
+}
+
+TEST_F(IngressPolicerTest, ChangeLimits) {
+  IngressPolicer policer(config);
+  EXPECT_TRUE(policer.admit(client, PacketType::Unroutable, now));
+  EXPECT_FALSE(policer.admit(client, PacketType::Unroutable, now));
+
+  // Buckets keep their level when the limits change.
+  config.unroutableBurst = 2;
+  policer.setConfig(config);
+  EXPECT_TRUE(policer.admit(client, PacketType::Unroutable, now));
+  EXPECT_FALSE(policer.admit(client, PacketType::Unroutable, now));
+
+  config.unroutablePerSecond = 0;
+  policer.setConfig(config);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(policer.admit(client, PacketType::Unroutable, now));
+  }
+}
+
+} // namespace test
+} // namespace quic
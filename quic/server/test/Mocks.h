@@ -112,5 +112,34 @@ class MockRoutingCallback : public QuicServerTransport::RoutingCallback {
           QuicServerTransport*,
           const QuicServerTransport::SourceIdentity&,
           const std::vector<ConnectionIdData>& connIdData));
+
+  void onConnectionTombstoned(
+      std::vector<ConnectionId> connectionIds,
+      Buf closePacket,
+      std::chrono::milliseconds drainPeriod) noexcept override {
+    _onConnectionTombstoned(connectionIds, closePacket.get(), drainPeriod);
+  }
+  MOCK_METHOD3(
+      _onConnectionTombstoned,
+      void(
+          const std::vector<ConnectionId>&,
+          folly::IOBuf*,
+          std::chrono::milliseconds));
+
+  std::unique_ptr<folly::AsyncUDPSocket> onConnectedSocketRequested(
+      const folly::SocketAddress& peer) noexcept override {
+    return std::unique_ptr<folly::AsyncUDPSocket>(
+        _onConnectedSocketRequested(peer));
+  }
+  MOCK_METHOD1(
+      _onConnectedSocketRequested,
+      folly::AsyncUDPSocket*(const folly::SocketAddress&));
+
+  GMOCK_METHOD1_(
+      ,
+      noexcept,
+      ,
+      onConnectedSocketReleased,
+      void(const folly::SocketAddress&));
 };
 } // namespace quic
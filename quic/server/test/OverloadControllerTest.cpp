@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/OverloadController.h>
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <thread>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class MockEventBaseObserver : public folly::EventBaseObserver {
+ public:
+  MOCK_CONST_METHOD0(getSampleRate, uint32_t());
+  MOCK_METHOD2(loopSample, void(int64_t, int64_t));
+};
+
+class OverloadControllerTest : public Test {
+ public:
+  void SetUp() override {
+    controller = std::make_shared<OverloadController>(
+        &evb, config, [this](OverloadLevel level) { levels.push_back(level); });
+  }
+
+  void busyInterval(int64_t busyPercent) {
+    controller->loopSample(busyPercent, 100 - busyPercent);
+    controller->onIntervalEnd(std::chrono::microseconds::zero());
+  }
+
+  folly::EventBase evb;
+  OverloadControllerConfig config;
+  std::vector<OverloadLevel> levels;
+  std::shared_ptr<OverloadController> controller;
+};
+
+TEST_F(OverloadControllerTest, LevelsFollowBusyTime) {
+  busyInterval(90);
+  busyInterval(90);
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::None);
+  busyInterval(90);
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::ShrinkWindows);
+
+  // Just under the threshold is not enough to leave the level.
+  busyInterval(60);
+  EXPECT_LT(controller->getLoad(), config.levelThresholds[0]);
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::ShrinkWindows);
+
+  busyInterval(30);
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::None);
+  EXPECT_THAT(
+      levels, ElementsAre(OverloadLevel::ShrinkWindows, OverloadLevel::None));
+}
+
+TEST_F(OverloadControllerTest, LoopLag) {
+  for (int i = 0; i < 3; ++i) {
+    controller->onIntervalEnd(config.maxLoopLag);
+  }
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::ThrottleInitials);
+  controller->onIntervalEnd(config.maxLoopLag * 2);
+  controller->onIntervalEnd(config.maxLoopLag * 2);
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::RejectNewConnections);
+  EXPECT_THAT(
+      levels,
+      ElementsAre(
+          OverloadLevel::ShrinkWindows,
+          OverloadLevel::ThrottleInitials,
+          OverloadLevel::RejectNewConnections));
+}
+
+TEST_F(OverloadControllerTest, KernelDrops) {
+  config.maxKernelDrops = 10;
+  config.levelThresholds = {{0.1, 0.2, 0.3}};
+  config.hysteresis = 0.05;
+  controller->setConfig(config);
+  controller->onKernelDrops(3);
+  controller->onIntervalEnd(std::chrono::microseconds::zero());
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::ShrinkWindows);
+
+  // Levels can be skipped on the way up and on the way down.
+  controller->onKernelDrops(20);
+  controller->onIntervalEnd(std::chrono::microseconds::zero());
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::RejectNewConnections);
+  controller->onIntervalEnd(std::chrono::microseconds::zero());
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::RejectNewConnections);
+  controller->onIntervalEnd(std::chrono::microseconds::zero());
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::ShrinkWindows);
+  controller->onIntervalEnd(std::chrono::microseconds::zero());
+  controller->onIntervalEnd(std::chrono::microseconds::zero());
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::None);
+  EXPECT_THAT(
+      levels,
+      ElementsAre(
+          OverloadLevel::ShrinkWindows,
+          OverloadLevel::RejectNewConnections,
+          OverloadLevel::ShrinkWindows,
+          OverloadLevel::None));
+}
+
+TEST_F(OverloadControllerTest, KernelDropsDefaultConfig) {
+  // Occasional bursts of drops leave the level alone.
+  for (int i = 0; i < 10; ++i) {
+    controller->onKernelDrops(i % 2 == 0 ? 50 : 0);
+    controller->onIntervalEnd(std::chrono::microseconds::zero());
+  }
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::None);
+
+  // Dropping at the limit for a few intervals in a row raises it.
+  for (int i = 0; i < 3; ++i) {
+    controller->onKernelDrops(config.maxKernelDrops);
+    controller->onIntervalEnd(std::chrono::microseconds::zero());
+  }
+  EXPECT_EQ(controller->getLevel(), OverloadLevel::ThrottleInitials);
+}
+
+TEST_F(OverloadControllerTest, ChainsNextObserver) {
+  auto next = std::make_shared<StrictMock<MockEventBaseObserver>>();
+  EXPECT_CALL(*next, getSampleRate()).WillRepeatedly(Return(2));
+  controller->setNextObserver(next);
+  EXPECT_CALL(*next, loopSample(20, 80)).Times(1);
+  EXPECT_CALL(*next, loopSample(40, 60)).Times(1);
+  controller->loopSample(10, 90);
+  controller->loopSample(20, 80);
+  controller->loopSample(30, 70);
+  controller->loopSample(40, 60);
+}
+
+TEST_F(OverloadControllerTest, MeasuresLagOnEventBase) {
+  config.sampleInterval = std::chrono::milliseconds(1);
+  config.maxLoopLag = std::chrono::milliseconds(1);
+  controller->setConfig(config);
+  evb.setObserver(controller);
+  controller->start();
+  // Block the loop for much longer than the allowed lag.
+  evb.runInLoop(
+      [] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+  evb.loopOnce();
+  evb.loopOnce();
+  EXPECT_GT(controller->getLoad(), 0);
+  evb.setObserver(nullptr);
+}
+
+} // namespace test
+} // namespace quic
@@ -201,7 +201,7 @@ void QuicServerWorkerTest::expectConnectionCreation(
         EXPECT_EQ(params.processId, 1);
         EXPECT_EQ(params.workerId, 42);
       }));
-  EXPECT_CALL(*transport, setTransportSettings(_));
+  EXPECT_CALL(*transport, setSharedTransportSettings(_));
   EXPECT_CALL(*transport, accept());
   EXPECT_CALL(*transport, setTransportInfoCallback(transportInfoCb_));
 }
@@ -289,6 +289,46 @@ TEST_F(QuicServerWorkerTest, HostIdMismatchTestReset) {
       QuicTransportStatsCallback::PacketDropReason::ROUTING_ERROR_WRONG_HOST);
 }
 
+TEST_F(QuicServerWorkerTest, UnroutableResetPoliced) {
+  IngressPolicerConfig config;
+  config.unroutablePerSecond = 1;
+  config.unroutableBurst = 1;
+  worker_->setIngressPolicerConfig(config);
+  EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
+  EXPECT_CALL(
+      *transportInfoCb_,
+      onPacketDropped(QuicTransportStatsCallback::PacketDropReason::
+                          ROUTING_ERROR_WRONG_HOST))
+      .Times(1);
+  EXPECT_CALL(
+      *transportInfoCb_,
+      onPacketDropped(
+          QuicTransportStatsCallback::PacketDropReason::INGRESS_POLICED))
+      .Times(1);
+  // Only the first packet is answered with a reset.
+  EXPECT_CALL(*transportInfoCb_, onWrite(_)).Times(1);
+  EXPECT_CALL(*transportInfoCb_, onPacketSent()).Times(1);
+  EXPECT_CALL(*transportInfoCb_, onStatelessReset()).Times(1);
+  EXPECT_CALL(*socketPtr_, write(_, _))
+      .WillOnce(Invoke([](const folly::SocketAddress&,
+                          const std::unique_ptr<folly::IOBuf>& buf) {
+        return buf->computeChainDataLength();
+      }));
+  for (int i = 0; i < 2; ++i) {
+    RoutingData routingData(
+        HeaderForm::Short,
+        false,
+        false,
+        getTestConnectionId(hostId_ + 1),
+        folly::none);
+    worker_->dispatchPacketData(
+        kClientAddr,
+        std::move(routingData),
+        NetworkData(folly::IOBuf::copyBuffer("data"), Clock::now()));
+  }
+  eventbase_.loop();
+}
+
 TEST_F(QuicServerWorkerTest, NoConnFoundTestReset) {
   EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
   auto data = folly::IOBuf::copyBuffer("data");
@@ -604,6 +644,59 @@ TEST_F(QuicServerWorkerTest, ConnectionIdTooShort) {
   eventbase_.loop();
 }
 
+TEST_F(QuicServerWorkerTest, TransportSettingsProfile) {
+  auto profile = std::make_shared<const TransportSettings>([] {
+    TransportSettings settings;
+    settings.idleTimeout = std::chrono::milliseconds(1234);
+    return settings;
+  }());
+  worker_->setTransportSettingsProfileFn(
+      [&](const std::shared_ptr<const TransportSettings>& defaultProfile,
+          const folly::IPAddress& addr) {
+        EXPECT_EQ(&worker_->getTransportSettings(), defaultProfile.get());
+        EXPECT_EQ(addr, kClientAddr.getIPAddress());
+        return profile;
+      });
+  // The legacy override still sees the selected profile as its base.
+  worker_->setTransportSettingsOverrideFn(
+      [](const TransportSettings& settings, const folly::IPAddress&)
+          -> folly::Optional<TransportSettings> {
+        EXPECT_EQ(settings.idleTimeout, std::chrono::milliseconds(1234));
+        return folly::none;
+      });
+
+  auto connId = getTestConnectionId(hostId_);
+  RoutingData routingData(HeaderForm::Long, true, true, connId, connId);
+  auto data = createData(kMinInitialPacketSize + 10);
+  EXPECT_CALL(*factory_, _make(_, _, _, _)).WillOnce(Return(transport_));
+  EXPECT_CALL(*transport_, setSupportedVersions(_));
+  EXPECT_CALL(*transport_, setOriginalPeerAddress(kClientAddr));
+  EXPECT_CALL(*transport_, setRoutingCallback(worker_.get()));
+  EXPECT_CALL(*transport_, setConnectionIdAlgo(_));
+  EXPECT_CALL(*transport_, setServerConnectionIdParams(_));
+  // The connection shares the profile rather than copying it.
+  EXPECT_CALL(*transport_, setSharedTransportSettings(_))
+      .WillOnce(Invoke([&](std::shared_ptr<const TransportSettings> settings) {
+        EXPECT_EQ(settings.get(), profile.get());
+      }));
+  EXPECT_CALL(*transport_, accept());
+  EXPECT_CALL(*transport_, setTransportInfoCallback(transportInfoCb_));
+  EXPECT_CALL(*transport_, onNetworkData(kClientAddr, _));
+  worker_->dispatchPacketData(
+      kClientAddr,
+      std::move(routingData),
+      NetworkData(data->clone(), Clock::now()));
+  eventbase_.loop();
+
+  // Copy-on-write leaves profiles handed out earlier untouched.
+  worker_->setTransportSettings(profile);
+  worker_->enablePartialReliability(!profile->partialReliabilityEnabled);
+  EXPECT_NE(&worker_->getTransportSettings(), profile.get());
+  EXPECT_NE(
+      worker_->getTransportSettings().partialReliabilityEnabled,
+      profile->partialReliabilityEnabled);
+}
+
 TEST_F(QuicServerWorkerTest, ShutdownQuicServer) {
   auto connId = getTestConnectionId(hostId_);
   createQuicConnection(kClientAddr, connId);
@@ -918,6 +1011,27 @@ TEST_F(QuicServerWorkerTakeoverTest, QuicServerTakeoverForwarding) {
   testNoPacketForwarding(std::move(pkt), len, connId);
 }
 
+TEST_F(QuicServerWorkerTakeoverTest, ForwardingNotPoliced) {
+  IngressPolicerConfig config;
+  config.unroutablePerSecond = 1;
+  config.unroutableBurst = 1;
+  takeoverWorker_->setIngressPolicerConfig(config);
+  ConnectionId connId = createConnIdForServer(ProcessId::ZERO),
+               clientConnId = getTestConnectionId(clientHostId_);
+  takeoverWorker_->setProcessId(ProcessId::ONE);
+  size_t len{0};
+  // More packets than the unroutable burst, all for the other process.
+  for (int i = 0; i < 3; ++i) {
+    auto pkt = writeTestDataOnWorkersBuf(
+        clientConnId,
+        connId,
+        len,
+        takeoverWorker_.get(),
+        LongHeader::Types::Handshake);
+    testPacketForwarding(std::move(pkt), len, connId);
+  }
+}
+
 void QuicServerWorkerTakeoverTest::testPacketForwarding(
     Buf data,
     size_t len,
@@ -1194,20 +1308,20 @@ class QuicServerTest : public Test {
           .WillOnce(Invoke([&](QuicTransportStatsCallback* infoCallback) {
             CHECK(infoCallback);
           }));
-      EXPECT_CALL(*transport, setTransportSettings(_))
+      EXPECT_CALL(*transport, setSharedTransportSettings(_))
           .WillRepeatedly(Invoke([&](auto transportSettings) {
             EXPECT_EQ(
                 transportSettings_.advertisedInitialBidiLocalStreamWindowSize,
-                transportSettings.advertisedInitialBidiLocalStreamWindowSize);
+                transportSettings->advertisedInitialBidiLocalStreamWindowSize);
             EXPECT_EQ(
                 transportSettings_.advertisedInitialBidiRemoteStreamWindowSize,
-                transportSettings.advertisedInitialBidiRemoteStreamWindowSize);
+                transportSettings->advertisedInitialBidiRemoteStreamWindowSize);
             EXPECT_EQ(
                 transportSettings_.advertisedInitialUniStreamWindowSize,
-                transportSettings.advertisedInitialUniStreamWindowSize);
+                transportSettings->advertisedInitialUniStreamWindowSize);
             EXPECT_EQ(
                 transportSettings_.advertisedInitialConnectionWindowSize,
-                transportSettings.advertisedInitialConnectionWindowSize);
+                transportSettings->advertisedInitialConnectionWindowSize);
           }));
       ON_CALL(*transport, onNetworkData(_, _))
           .WillByDefault(Invoke(
@@ -1451,7 +1565,7 @@ class QuicServerTakeoverTest : public Test {
       transport->setClientConnectionId(clientConnId);
       // setup expectations
       EXPECT_CALL(*transport, getEventBase()).WillRepeatedly(Return(eventBase));
-      EXPECT_CALL(*transport, setTransportSettings(_));
+      EXPECT_CALL(*transport, setSharedTransportSettings(_));
       EXPECT_CALL(*transport, accept());
       EXPECT_CALL(*transport, setSupportedVersions(_));
       EXPECT_CALL(*transport, setRoutingCallback(_));
@@ -1969,7 +2083,7 @@ TEST_F(QuicServerTest, ZeroRttPacketRoute) {
     EXPECT_CALL(*transport, getEventBase()).WillRepeatedly(Return(eventBase));
     EXPECT_CALL(*transport, setSupportedVersions(_));
     EXPECT_CALL(*transport, setOriginalPeerAddress(_));
-    EXPECT_CALL(*transport, setTransportSettings(_));
+    EXPECT_CALL(*transport, setSharedTransportSettings(_));
     EXPECT_CALL(*transport, setServerConnectionIdParams(_));
     EXPECT_CALL(*transport, accept());
     // post baton upon receiving the data
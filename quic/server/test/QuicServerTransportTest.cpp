@@ -22,6 +22,7 @@
 #include <quic/fizz/handshake/FizzCryptoFactory.h>
 #include <quic/logging/FileQLogger.h>
 #include <quic/server/handshake/ServerHandshake.h>
+#include <quic/server/handshake/TokenGenerator.h>
 #include <quic/server/test/Mocks.h>
 #include <quic/state/QuicStreamFunctions.h>
 
@@ -236,6 +237,10 @@ class TestingQuicServerTransport : public QuicServerTransport {
     return *socket_;
   }
 
+  bool hasSocket() const {
+    return socket_ != nullptr;
+  }
+
   auto& idleTimeout() {
     return idleTimeout_;
   }
@@ -309,16 +314,18 @@ class QuicServerTransportTest : public Test {
     server->setSupportedVersions(supportedVersions);
     server->setOriginalPeerAddress(clientAddr);
     server->setServerConnectionIdParams(params);
-    server->getNonConstConn().transportSettings.statelessResetTokenSecret =
-        getRandSecret();
+    server->getNonConstConn()
+        .transportSettings.mutate()
+        .statelessResetTokenSecret = getRandSecret();
     transportInfoCb_ = std::make_unique<MockQuicStats>();
     server->setTransportInfoCallback(transportInfoCb_.get());
     initializeServerHandshake();
     server->getNonConstConn().handshakeLayer.reset(fakeHandshake);
     server->getNonConstConn().serverHandshakeLayer = fakeHandshake;
     // Allow ignoring path mtu for testing negotiation.
-    server->getNonConstConn().transportSettings.canIgnorePathMTU = true;
-    server->getNonConstConn().transportSettings.disableMigration =
+    server->getNonConstConn().transportSettings.mutate().canIgnorePathMTU =
+        true;
+    server->getNonConstConn().transportSettings.mutate().disableMigration =
         getDisableMigration();
     server->setConnectionIdAlgo(connIdAlgo_.get());
     server->setClientConnectionId(*clientConnectionId);
@@ -379,7 +386,9 @@ class QuicServerTransportTest : public Test {
     return packetData;
   }
 
-  void recvClientHello(bool writes = true) {
+  void recvClientHello(
+      bool writes = true,
+      const std::string& token = std::string()) {
     auto chlo = IOBuf::copyBuffer("CHLO");
     auto nextPacketNum = clientNextInitialPacketNum++;
     auto aead = getInitialCipher();
@@ -392,7 +401,9 @@ class QuicServerTransportTest : public Test {
             QuicVersion::MVFST,
             *chlo,
             *aead,
-            0 /* largestAcked */),
+            0 /* largestAcked */,
+            0 /* offset */,
+            token),
         *aead,
         *headerCipher,
         nextPacketNum);
@@ -522,7 +533,7 @@ class QuicServerTransportTest : public Test {
         server->getConn().peerActiveConnectionIdLimit,
         kDefaultActiveConnectionIdLimit);
 
-    if (server->getConn().transportSettings.disableMigration ||
+    if (server->getConn().transportSettings->disableMigration ||
         (connIdsToIssue == 0)) {
       EXPECT_EQ(numNewConnIdFrames, 0);
       EXPECT_EQ(server->getConn().nextSelfConnectionIdSequence, 1);
@@ -878,6 +889,59 @@ TEST_F(QuicServerTransportTest, TimeoutsNotSetAfterClose) {
   ASSERT_TRUE(server->drainTimeout().isScheduled());
 }
 
+TEST_F(QuicServerTransportTest, ConnectedSocketForBulkFlow) {
+  server->getNonConstConn()
+      .transportSettings.mutate()
+      .connectedSocketMinBytesSent = 1;
+  auto connectedSocket = new folly::test::MockAsyncUDPSocket(&evb);
+  std::vector<Buf> connectedWrites;
+  EXPECT_CALL(*connectedSocket, write(_, _))
+      .WillRepeatedly(Invoke([&](const SocketAddress&,
+                                 const std::unique_ptr<folly::IOBuf>& buf) {
+        connectedWrites.push_back(buf->clone());
+        return buf->computeChainDataLength();
+      }));
+  EXPECT_CALL(routingCallback, _onConnectedSocketRequested(clientAddr))
+      .WillOnce(Return(connectedSocket));
+
+  serverWrites.clear();
+  StreamId streamId = server->createBidirectionalStream().value();
+  server->writeChain(streamId, IOBuf::copyBuffer("bulk"), false, false);
+  loopForWrites();
+  EXPECT_TRUE(serverWrites.empty());
+  EXPECT_FALSE(connectedWrites.empty());
+
+  EXPECT_CALL(routingCallback, onConnectedSocketReleased(clientAddr));
+  EXPECT_CALL(routingCallback, onConnectionUnbound(_, _, _));
+  server->close(folly::none);
+}
+
+TEST_F(QuicServerTransportTest, ConnectedSocketReleasedAfterDrain) {
+  server->getNonConstConn()
+      .transportSettings.mutate()
+      .connectedSocketMinBytesSent = 1;
+  auto connectedSocket = new folly::test::MockAsyncUDPSocket(&evb);
+  EXPECT_CALL(*connectedSocket, write(_, _))
+      .WillRepeatedly(Invoke(
+          [](const SocketAddress&, const std::unique_ptr<folly::IOBuf>& buf) {
+            return buf->computeChainDataLength();
+          }));
+  EXPECT_CALL(routingCallback, _onConnectedSocketRequested(clientAddr))
+      .WillOnce(Return(connectedSocket));
+
+  StreamId streamId = server->createBidirectionalStream().value();
+  server->writeChain(streamId, IOBuf::copyBuffer("bulk"), false, false);
+  loopForWrites();
+
+  // The connected socket is torn down when the drain ends, and the shared
+  // socket must not be handed back to the closed transport.
+  EXPECT_CALL(routingCallback, onConnectedSocketReleased(clientAddr));
+  EXPECT_CALL(routingCallback, onConnectionUnbound(_, _, _));
+  server->closeNow(folly::none);
+  EXPECT_TRUE(server->isClosed());
+  EXPECT_FALSE(server->hasSocket());
+}
+
 TEST_F(QuicServerTransportTest, IdleTimeoutExpired) {
   server->idleTimeout().timeoutExpired();
 
@@ -928,6 +992,34 @@ TEST_F(QuicServerTransportTest, TestCloseConnectionWithNoError) {
       QuicFrame::Type::ConnectionCloseFrame_E));
 }
 
+TEST_F(QuicServerTransportTest, TestCloseHandsOffDrainToTombstone) {
+  server->getNonConstConn().transportSettings.mutate().drainWithTombstones =
+      true;
+  auto serverConnId = *server->getConn().serverConnectionId;
+  folly::IOBuf* closePacket = nullptr;
+  std::vector<ConnectionId> tombstonedIds;
+  EXPECT_CALL(routingCallback, _onConnectionTombstoned(_, _, _))
+      .WillOnce(Invoke([&](const std::vector<ConnectionId>& connIds,
+                           folly::IOBuf* packet,
+                           std::chrono::milliseconds drainPeriod) {
+        tombstonedIds = connIds;
+        closePacket = packet;
+        EXPECT_GT(drainPeriod.count(), 0);
+      }));
+  EXPECT_CALL(routingCallback, onConnectionUnbound(_, _, _)).Times(1);
+  server->close(std::make_pair(
+      QuicErrorCode(GenericApplicationErrorCode::UNKNOWN),
+      std::string("stopping")));
+  EXPECT_TRUE(verifyFramePresent(
+      serverWrites,
+      *makeClientEncryptedCodec(),
+      QuicFrame::Type::ConnectionCloseFrame_E));
+  EXPECT_NE(closePacket, nullptr);
+  EXPECT_NE(
+      std::find(tombstonedIds.begin(), tombstonedIds.end(), serverConnId),
+      tombstonedIds.end());
+}
+
 TEST_F(QuicServerTransportTest, TestClientAddressChanges) {
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Server);
   server->getNonConstConn().qLogger = qLogger;
@@ -1822,6 +1914,51 @@ TEST_F(QuicServerTransportTest, RecvPathChallenge) {
   EXPECT_EQ(pathResponse.pathData, pathChallenge.pathData);
 }
 
+TEST_F(QuicServerTransportTest, RecvPreferredAddressPathChallenge) {
+  auto& conn = server->getNonConstConn();
+  // No spare peer id, the client probes from the address it is already on.
+  conn.peerConnectionIds.clear();
+  conn.peerConnectionIds.emplace_back(*conn.clientConnectionId, 0);
+  ConnectionId preferredConnId({5, 6, 7, 8, 9, 10, 11, 12});
+  conn.selfConnectionIds.emplace_back(preferredConnId, 1);
+  conn.preferredAddressConnectionId = preferredConnId;
+
+  ShortHeader header(ProtectionType::KeyPhaseZero, preferredConnId, 10);
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen, std::move(header), 0 /* largestAcked */);
+  PathChallengeFrame pathChallenge(123);
+  ASSERT_TRUE(builder.canBuildPacket());
+  writeSimpleFrame(QuicSimpleFrame(pathChallenge), builder);
+  auto packet = std::move(builder).buildPacket();
+
+  EXPECT_TRUE(conn.pendingEvents.frames.empty());
+  deliverData(packetToBuf(packet), false);
+  ASSERT_EQ(conn.pendingEvents.frames.size(), 1);
+  auto pathResponse = conn.pendingEvents.frames[0].asPathResponseFrame();
+  ASSERT_NE(pathResponse, nullptr);
+  EXPECT_EQ(pathResponse->pathData, pathChallenge.pathData);
+  EXPECT_EQ(conn.peerConnectionIds.size(), 1);
+}
+
+TEST_F(QuicServerTransportTest, RecvPathChallengeNoSparePeerConnId) {
+  auto& conn = server->getNonConstConn();
+  conn.peerConnectionIds.clear();
+  conn.peerConnectionIds.emplace_back(*conn.clientConnectionId, 0);
+
+  ShortHeader header(
+      ProtectionType::KeyPhaseZero, *conn.serverConnectionId, 10);
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen, std::move(header), 0 /* largestAcked */);
+  ASSERT_TRUE(builder.canBuildPacket());
+  writeSimpleFrame(QuicSimpleFrame(PathChallengeFrame(123)), builder);
+  auto packet = std::move(builder).buildPacket();
+
+  EXPECT_THROW(deliverData(packetToBuf(packet)), std::runtime_error);
+  EXPECT_EQ(
+      server->getConn().localConnectionError->first,
+      QuicErrorCode(TransportErrorCode::INVALID_MIGRATION));
+}
+
 TEST_F(QuicServerTransportTest, TestAckRstStream) {
   auto streamId = server->createUnidirectionalStream().value();
   auto stream = server->getNonConstConn().streamManager->getStream(streamId);
@@ -2151,7 +2288,7 @@ TEST_P(
     ReceiveProbingPacketFromChangedPeerAddress) {
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Server);
   server->getNonConstConn().qLogger = qLogger;
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
 
   // Add additional peer id so PathResponse completes.
   server->getNonConstConn().peerConnectionIds.emplace_back(
@@ -2228,6 +2365,44 @@ TEST_P(
   EXPECT_EQ(server->getConn().peerAddress, peerAddress);
 }
 
+TEST_P(
+    QuicServerTransportAllowMigrationTest,
+    MigrationReleasesConnectedSocket) {
+  server->getNonConstConn()
+      .transportSettings.mutate()
+      .connectedSocketMinBytesSent = 1;
+  auto connectedSocket = new folly::test::MockAsyncUDPSocket(&evb);
+  size_t connectedWrites = 0;
+  EXPECT_CALL(*connectedSocket, write(_, _))
+      .WillRepeatedly(Invoke([&](const SocketAddress&,
+                                 const std::unique_ptr<folly::IOBuf>& buf) {
+        ++connectedWrites;
+        return buf->computeChainDataLength();
+      }));
+  EXPECT_CALL(routingCallback, _onConnectedSocketRequested(clientAddr))
+      .WillOnce(Return(connectedSocket));
+  StreamId streamId = server->createBidirectionalStream().value();
+  server->writeChain(streamId, IOBuf::copyBuffer("bulk"), false, false);
+  loopForWrites();
+  EXPECT_GT(connectedWrites, 0);
+
+  // Writes to the new peer go out of the shared socket.
+  EXPECT_CALL(routingCallback, onConnectedSocketReleased(clientAddr));
+  serverWrites.clear();
+  auto packetData = packetToBuf(createStreamPacket(
+      *clientConnectionId,
+      *server->getConn().serverConnectionId,
+      clientNextAppDataPacketNum++,
+      2,
+      *IOBuf::copyBuffer("data"),
+      0 /* cipherOverhead */,
+      0 /* largestAcked */));
+  folly::SocketAddress newPeer("100.101.102.103", 23456);
+  deliverData(std::move(packetData), true, &newPeer);
+  EXPECT_EQ(server->getConn().peerAddress, newPeer);
+  EXPECT_FALSE(serverWrites.empty());
+}
+
 TEST_P(QuicServerTransportAllowMigrationTest, MigrateToUnvalidatedPeer) {
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
@@ -2504,7 +2679,7 @@ TEST_P(
 TEST_F(QuicServerTransportTest, TooManyMigrations) {
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Server);
   server->getNonConstConn().qLogger = qLogger;
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
 
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
@@ -2552,7 +2727,7 @@ TEST_P(QuicServerTransportAllowMigrationTest, MigrateToValidatedPeer) {
   state.recordTime = Clock::now();
   state.congestionController = ccFactory_->makeCongestionController(
       server->getNonConstConn(),
-      server->getNonConstConn().transportSettings.defaultCongestionController);
+      server->getNonConstConn().transportSettings->defaultCongestionController);
   state.srtt = 1000us;
   state.lrtt = 2000us;
   state.rttvar = 3000us;
@@ -2626,7 +2801,7 @@ TEST_P(
   state.recordTime = Clock::now();
   state.congestionController = ccFactory_->makeCongestionController(
       server->getNonConstConn(),
-      server->getNonConstConn().transportSettings.defaultCongestionController);
+      server->getNonConstConn().transportSettings->defaultCongestionController);
   state.srtt = 1000us;
   state.lrtt = 2000us;
   state.rttvar = 3000us;
@@ -2694,7 +2869,7 @@ TEST_P(QuicServerTransportAllowMigrationTest, MigrateToStaleValidatedPeer) {
   state.recordTime = Clock::now() - 2 * kTimeToRetainLastCongestionAndRttState;
   state.congestionController = ccFactory_->makeCongestionController(
       server->getNonConstConn(),
-      server->getNonConstConn().transportSettings.defaultCongestionController);
+      server->getNonConstConn().transportSettings->defaultCongestionController);
   state.srtt = 1000us;
   state.lrtt = 2000us;
   state.rttvar = 3000us;
@@ -2752,7 +2927,7 @@ TEST_P(QuicServerTransportAllowMigrationTest, MigrateToStaleValidatedPeer) {
 TEST_F(
     QuicServerTransportTest,
     MigrateToValidatePeerCancelsPendingPathChallenge) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
       *clientConnectionId,
@@ -2827,7 +3002,7 @@ TEST_F(
 TEST_F(
     QuicServerTransportTest,
     MigrateToUnvalidatePeerCancelsOutstandingPathChallenge) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
       *clientConnectionId,
@@ -2916,7 +3091,7 @@ TEST_F(
 TEST_F(
     QuicServerTransportTest,
     MigrateToValidatePeerCancelsOutstandingPathChallenge) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
       *clientConnectionId,
@@ -2987,7 +3162,7 @@ TEST_F(
 }
 
 TEST_F(QuicServerTransportTest, ClientPortChangeNATRebinding) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
 
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
@@ -3019,7 +3194,7 @@ TEST_F(QuicServerTransportTest, ClientPortChangeNATRebinding) {
 }
 
 TEST_F(QuicServerTransportTest, ClientAddressChangeNATRebinding) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
 
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
@@ -3051,7 +3226,7 @@ TEST_F(QuicServerTransportTest, ClientAddressChangeNATRebinding) {
 TEST_F(
     QuicServerTransportTest,
     ClientNATRebindingWhilePathValidationOutstanding) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
 
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
@@ -3131,7 +3306,7 @@ TEST_F(QuicServerTransportTest, PingIsRetransmittable) {
 
 TEST_F(QuicServerTransportTest, RecvNewConnectionIdValid) {
   auto& conn = server->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 2;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 2;
 
   ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
   RegularQuicPacketBuilder builder(
@@ -3153,7 +3328,7 @@ TEST_F(QuicServerTransportTest, RecvNewConnectionIdValid) {
 
 TEST_F(QuicServerTransportTest, RecvNewConnectionIdTooManyReceivedIds) {
   auto& conn = server->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 0;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 0;
 
   ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
   RegularQuicPacketBuilder builder(
@@ -3172,7 +3347,7 @@ TEST_F(QuicServerTransportTest, RecvNewConnectionIdTooManyReceivedIds) {
 
 TEST_F(QuicServerTransportTest, RecvNewConnectionIdInvalidRetire) {
   auto& conn = server->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 1;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 1;
 
   ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
   RegularQuicPacketBuilder builder(
@@ -3190,7 +3365,7 @@ TEST_F(QuicServerTransportTest, RecvNewConnectionIdInvalidRetire) {
 
 TEST_F(QuicServerTransportTest, RecvNewConnectionIdNoopValidDuplicate) {
   auto& conn = server->getNonConstConn();
-  conn.transportSettings.selfActiveConnectionIdLimit = 1;
+  conn.transportSettings.mutate().selfActiveConnectionIdLimit = 1;
 
   ConnectionId connId2({5, 5, 5, 5});
   conn.peerConnectionIds.emplace_back(connId2, 1);
@@ -3365,7 +3540,7 @@ TEST_F(QuicUnencryptedServerTransportTest, TestBadCleartextEncryption) {
 TEST_F(QuicUnencryptedServerTransportTest, TestPendingZeroRttData) {
   auto data = IOBuf::copyBuffer("bad data");
   size_t expectedPendingLen =
-      server->getConn().transportSettings.maxPacketsToBuffer;
+      server->getConn().transportSettings->maxPacketsToBuffer;
   for (size_t i = 0; i < expectedPendingLen + 10; ++i) {
     StreamId streamId = static_cast<StreamId>(i);
     auto packetData = packetToBuf(createStreamPacket(
@@ -3392,7 +3567,7 @@ TEST_F(QuicUnencryptedServerTransportTest, TestPendingOneRttData) {
   recvClientHello();
   auto data = IOBuf::copyBuffer("bad data");
   size_t expectedPendingLen =
-      server->getConn().transportSettings.maxPacketsToBuffer;
+      server->getConn().transportSettings->maxPacketsToBuffer;
   for (size_t i = 0; i < expectedPendingLen + 10; ++i) {
     StreamId streamId = static_cast<StreamId>(i);
     auto packetData = packetToBuf(createStreamPacket(
@@ -3449,7 +3624,7 @@ TEST_F(
 TEST_F(
     QuicUnencryptedServerTransportTest,
     ReceiveHandshakePacketFromChangedPeerAddress) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
 
   recvClientHello();
 
@@ -3470,7 +3645,7 @@ TEST_F(
 TEST_F(
     QuicUnencryptedServerTransportTest,
     ReceiveZeroRttPacketFromChangedPeerAddress) {
-  server->getNonConstConn().transportSettings.disableMigration = false;
+  server->getNonConstConn().transportSettings.mutate().disableMigration = false;
   fakeHandshake->allowZeroRttKeys();
 
   recvClientHello();
@@ -3600,7 +3775,7 @@ TEST_F(
   ASSERT_TRUE(server->getNonConstConn().writableBytesLimit.hasValue());
   EXPECT_EQ(
       *server->getNonConstConn().writableBytesLimit,
-      server->getConn().transportSettings.limitedCwndInMss * originalUdpSize);
+      server->getConn().transportSettings->limitedCwndInMss * originalUdpSize);
 
   recvClientFinished();
   loopForWrites();
@@ -3620,6 +3795,62 @@ TEST_F(
   }
 }
 
+TEST_F(QuicUnencryptedServerTransportTest, NewTokenLiftsWritableBytesLimit) {
+  NewTokenSecret secret;
+  folly::Random::secureRandom(secret.data(), secret.size());
+  server->getNonConstConn().transportSettings.mutate().newTokenSecret = secret;
+  getFakeHandshakeLayer()->allowZeroRttKeys();
+  setupClientReadCodec();
+
+  TokenGenerator generator(secret);
+  auto token = generator.encryptToken(
+      clientAddr.getIPAddress(), std::chrono::system_clock::now());
+  ASSERT_TRUE(token);
+  recvClientHello(true, token->moveToFbString().toStdString());
+  EXPECT_TRUE(server->getConn().newTokenValidated);
+  EXPECT_FALSE(server->getConn().writableBytesLimit);
+}
+
+TEST_F(QuicUnencryptedServerTransportTest, InvalidNewTokenKeepsLimit) {
+  NewTokenSecret secret;
+  folly::Random::secureRandom(secret.data(), secret.size());
+  server->getNonConstConn().transportSettings.mutate().newTokenSecret = secret;
+  getFakeHandshakeLayer()->allowZeroRttKeys();
+  setupClientReadCodec();
+
+  TokenGenerator generator(secret);
+  auto token = generator.encryptToken(
+      folly::IPAddress("1.2.3.4"), std::chrono::system_clock::now());
+  ASSERT_TRUE(token);
+  recvClientHello(true, token->moveToFbString().toStdString());
+  EXPECT_FALSE(server->getConn().newTokenValidated);
+  EXPECT_TRUE(server->getConn().writableBytesLimit);
+}
+
+TEST_F(QuicUnencryptedServerTransportTest, IssueNewTokenAfterHandshake) {
+  NewTokenSecret secret;
+  folly::Random::secureRandom(secret.data(), secret.size());
+  server->getNonConstConn().transportSettings.mutate().newTokenSecret = secret;
+  QuicServerTransportTest::setupConnection();
+
+  const NewTokenFrame* newTokenFrame = nullptr;
+  for (const auto& packet : server->getConn().outstandingPackets) {
+    for (const auto& frame : packet.packet.frames) {
+      auto simpleFrame = frame.asQuicSimpleFrame();
+      if (simpleFrame && simpleFrame->asNewTokenFrame()) {
+        newTokenFrame = simpleFrame->asNewTokenFrame();
+      }
+    }
+  }
+  ASSERT_NE(newTokenFrame, nullptr);
+  TokenGenerator generator(secret);
+  EXPECT_TRUE(generator.validateToken(
+      *newTokenFrame->token,
+      clientAddr.getIPAddress(),
+      kDefaultNewTokenValidity,
+      std::chrono::system_clock::now()));
+}
+
 TEST_F(
     QuicUnencryptedServerTransportTest,
     IncreaseLimitAfterReceivingNewPacket) {
@@ -3633,14 +3864,14 @@ TEST_F(
   recvClientHello();
   EXPECT_EQ(
       *server->getNonConstConn().writableBytesLimit,
-      server->getConn().transportSettings.limitedCwndInMss * originalUdpSize);
+      server->getConn().transportSettings->limitedCwndInMss * originalUdpSize);
 
   recvClientHello();
 
   // in tests the udp packet length changes
   auto expectedLen =
-      server->getConn().transportSettings.limitedCwndInMss * originalUdpSize +
-      server->getConn().transportSettings.limitedCwndInMss *
+      server->getConn().transportSettings->limitedCwndInMss * originalUdpSize +
+      server->getConn().transportSettings->limitedCwndInMss *
           server->getConn().udpSendPacketLen;
   EXPECT_EQ(*server->getNonConstConn().writableBytesLimit, expectedLen);
   std::vector<int> indices =
@@ -3972,7 +4203,7 @@ class QuicServerTransportHandshakeTest
           EXPECT_EQ(
               initialMaxData,
               server->getConn()
-                  .transportSettings.advertisedInitialConnectionWindowSize);
+                  .transportSettings->advertisedInitialConnectionWindowSize);
 
           auto initialMaxStreamDataBidiLocal = *getIntegerParameter(
               TransportParameterId::initial_max_stream_data_bidi_local, params);
@@ -3986,16 +4217,16 @@ class QuicServerTransportHandshakeTest
               initialMaxStreamDataBidiLocal,
               server->getConn()
                   .transportSettings
-                  .advertisedInitialBidiLocalStreamWindowSize);
+                  ->advertisedInitialBidiLocalStreamWindowSize);
           EXPECT_EQ(
               initialMaxStreamDataBidiRemote,
               server->getConn()
                   .transportSettings
-                  .advertisedInitialBidiRemoteStreamWindowSize);
+                  ->advertisedInitialBidiRemoteStreamWindowSize);
           EXPECT_EQ(
               initialMaxStreamDataUni,
               server->getConn()
-                  .transportSettings.advertisedInitialUniStreamWindowSize);
+                  .transportSettings->advertisedInitialUniStreamWindowSize);
 
           auto initialMaxStreamsBidi = *getIntegerParameter(
               TransportParameterId::initial_max_streams_bidi, params);
@@ -4004,17 +4235,17 @@ class QuicServerTransportHandshakeTest
           EXPECT_EQ(
               initialMaxStreamsBidi,
               server->getConn()
-                  .transportSettings.advertisedInitialMaxStreamsBidi);
+                  .transportSettings->advertisedInitialMaxStreamsBidi);
           EXPECT_EQ(
               initialMaxStreamsUni,
               server->getConn()
-                  .transportSettings.advertisedInitialMaxStreamsUni);
+                  .transportSettings->advertisedInitialMaxStreamsUni);
 
           auto maxRecvPacketSize = *getIntegerParameter(
               TransportParameterId::max_packet_size, params);
           EXPECT_EQ(
               maxRecvPacketSize,
-              server->getConn().transportSettings.maxRecvPacketSize);
+              server->getConn().transportSettings->maxRecvPacketSize);
 
           EXPECT_THAT(
               appToken.sourceAddresses, ContainerEq(expectedSourceToken_));
@@ -30,7 +30,7 @@ TEST(ServerStateMachineTest, TestAddConnId) {
   serverState.serverAddr = folly::SocketAddress("0.0.0.0", 42069);
 
   std::array<uint8_t, kStatelessResetTokenSecretLength> secret;
-  serverState.transportSettings.statelessResetTokenSecret = secret;
+  serverState.transportSettings.mutate().statelessResetTokenSecret = secret;
   EXPECT_EQ(serverState.selfConnectionIds.size(), 0);
   serverState.peerActiveConnectionIdLimit = 2;
   auto newConnId1 = serverState.createAndAddNewSelfConnId();
@@ -66,5 +66,93 @@ TEST(ServerStateMachineTest, TestAddConnId) {
   EXPECT_EQ(serverState.selfConnectionIds.size(), 3);
   EXPECT_EQ(serverState.nextSelfConnectionIdSequence, 3);
 }
+
+TEST(ServerStateMachineTest, PreferredAddressConnIdWithdrawnWithoutLimit) {
+  QuicServerConnectionState serverState;
+  auto algo = std::make_unique<DefaultConnectionIdAlgo>();
+  serverState.connIdAlgo = algo.get();
+  serverState.serverConnIdParams = ServerConnectionIdParams(12, 1, 37);
+  serverState.serverAddr = folly::SocketAddress("0.0.0.0", 42069);
+  std::array<uint8_t, kStatelessResetTokenSecretLength> secret;
+  serverState.transportSettings.mutate().statelessResetTokenSecret = secret;
+
+  auto handshakeConnId = serverState.createAndAddNewSelfConnId();
+  ASSERT_TRUE(handshakeConnId.has_value());
+  auto preferredConnId = serverState.createPreferredAddressConnId();
+  EXPECT_EQ(preferredConnId.sequenceNumber, 1);
+  EXPECT_EQ(serverState.preferredAddressConnectionId, preferredConnId.connId);
+  EXPECT_EQ(serverState.selfConnectionIds.size(), 2);
+
+  // No active_connection_id_limit, so the client takes no spare ids.
+  processClientInitialParams(serverState, ClientTransportParameters());
+  EXPECT_EQ(serverState.peerActiveConnectionIdLimit, 0);
+  EXPECT_FALSE(serverState.preferredAddressConnectionId.has_value());
+  ASSERT_EQ(serverState.selfConnectionIds.size(), 1);
+  EXPECT_EQ(serverState.selfConnectionIds[0].connId, handshakeConnId->connId);
+}
+
+TEST(ServerStateMachineTest, PreferredAddressConnIdCountsAgainstLimit) {
+  QuicServerConnectionState serverState;
+  auto algo = std::make_unique<DefaultConnectionIdAlgo>();
+  serverState.connIdAlgo = algo.get();
+  serverState.serverConnIdParams = ServerConnectionIdParams(12, 1, 37);
+  serverState.serverAddr = folly::SocketAddress("0.0.0.0", 42069);
+  std::array<uint8_t, kStatelessResetTokenSecretLength> secret;
+  serverState.transportSettings.mutate().statelessResetTokenSecret = secret;
+
+  serverState.createAndAddNewSelfConnId();
+  auto preferredConnId = serverState.createPreferredAddressConnId();
+
+  ClientTransportParameters clientParams;
+  clientParams.parameters.push_back(encodeIntegerParameter(
+      TransportParameterId::active_connection_id_limit, 1));
+  processClientInitialParams(serverState, clientParams);
+  EXPECT_EQ(serverState.preferredAddressConnectionId, preferredConnId.connId);
+  EXPECT_EQ(serverState.selfConnectionIds.size(), 2);
+  // The preferred address id already takes the one spare slot.
+  EXPECT_EQ(folly::none, serverState.createAndAddNewSelfConnId());
+}
+
+TEST(ServerStateMachineTest, TicketParamsKeepSharedSettings) {
+  auto profile = std::make_shared<const TransportSettings>();
+  QuicServerConnectionState serverState;
+  serverState.transportSettings = profile;
+
+  // The same parameters the connection already has change nothing.
+  updateTransportParamsFromTicket(
+      serverState,
+      profile->idleTimeout.count(),
+      profile->maxRecvPacketSize,
+      profile->advertisedInitialConnectionWindowSize,
+      profile->advertisedInitialBidiLocalStreamWindowSize,
+      profile->advertisedInitialBidiRemoteStreamWindowSize,
+      profile->advertisedInitialUniStreamWindowSize,
+      profile->advertisedInitialMaxStreamsBidi,
+      profile->advertisedInitialMaxStreamsUni);
+  EXPECT_TRUE(serverState.transportSettings.isShared());
+  EXPECT_EQ(&*serverState.transportSettings, profile.get());
+
+  updateTransportParamsFromTicket(
+      serverState,
+      profile->idleTimeout.count(),
+      profile->maxRecvPacketSize,
+      profile->advertisedInitialConnectionWindowSize * 2,
+      profile->advertisedInitialBidiLocalStreamWindowSize,
+      profile->advertisedInitialBidiRemoteStreamWindowSize,
+      profile->advertisedInitialUniStreamWindowSize,
+      profile->advertisedInitialMaxStreamsBidi,
+      profile->advertisedInitialMaxStreamsUni);
+  EXPECT_FALSE(serverState.transportSettings.isShared());
+  EXPECT_EQ(
+      serverState.transportSettings->advertisedInitialConnectionWindowSize,
+      profile->advertisedInitialConnectionWindowSize * 2);
+  EXPECT_EQ(
+      serverState.flowControlState.windowSize,
+      profile->advertisedInitialConnectionWindowSize * 2);
+  // The profile itself is left alone.
+  EXPECT_EQ(
+      profile->advertisedInitialConnectionWindowSize,
+      kDefaultConnectionWindowSize);
+}
 } // namespace test
 } // namespace quic
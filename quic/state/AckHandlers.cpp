@@ -116,7 +116,8 @@ void processAckFrame(
       }
       // Update RTT if current packet is the largestAcked in the frame:
       auto ackReceiveTimeOrNow =
-          ackReceiveTime > rPacketIt->time ? ackReceiveTime : Clock::now();
+          ackReceiveTime > rPacketIt->time ? ackReceiveTime
+                                           : conn.clock.packetNow();
       auto rttSample = std::chrono::duration_cast<std::chrono::microseconds>(
           ackReceiveTimeOrNow - rPacketIt->time);
       if (currentPacketNum == frame.largestAcked) {
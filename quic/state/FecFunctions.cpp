@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/FecFunctions.h>
+#include <quic/codec/QuicPacketBuilder.h>
+#include <quic/state/stream/StreamReceiveHandlers.h>
+
+namespace quic {
+
+uint64_t getFecSymbolSize(const QuicConnectionStateBase& conn) {
+  constexpr uint64_t kMaxShortHeaderSize =
+      sizeof(uint8_t) + kMaxConnectionIdSize + kMaxPacketNumEncodingSize;
+  // Frame type, then stream id, offset, length and symbol size, each taken
+  // at the largest varint.
+  constexpr uint64_t kMaxStreamRepairFrameHeaderSize =
+      sizeof(uint16_t) + 4 * sizeof(uint64_t);
+  constexpr uint64_t kOverhead = kMaxShortHeaderSize +
+      kCipherOverheadHeuristic + kMaxStreamRepairFrameHeaderSize;
+  CHECK_GT(conn.udpSendPacketLen, kOverhead);
+  return conn.udpSendPacketLen - kOverhead;
+}
+
+uint64_t getFecWindowSymbols(
+    const QuicConnectionStateBase& conn,
+    uint64_t symbolSize) {
+  const auto& settings = *conn.transportSettings;
+  if (conn.peerFecRetentionBytes < symbolSize ||
+      conn.lossState.totalBytesSent == 0) {
+    return 0;
+  }
+  const auto& lossState = conn.lossState;
+  double lossRate = static_cast<double>(lossState.totalBytesRetransmitted) /
+      lossState.totalBytesSent;
+  if (lossRate < settings.fecMinLossRate) {
+    return 0;
+  }
+  uint64_t symbols = settings.fecMaxWindowSymbols;
+  if (lossRate > 0) {
+    symbols = std::min(
+        symbols, static_cast<uint64_t>(kFecLossesPerWindow / lossRate));
+  }
+  symbols = std::max(symbols, kMinFecWindowSymbols);
+  return std::min(symbols, conn.peerFecRetentionBytes / symbolSize);
+}
+
+void onFecStreamDataWritten(
+    QuicStreamState& stream,
+    uint64_t offset,
+    const folly::IOBuf& data,
+    bool fin) {
+  DCHECK(stream.fecEncoder);
+  auto& conn = stream.conn;
+  auto windowSymbols =
+      getFecWindowSymbols(conn, stream.fecEncoder->getSymbolSize());
+  if (windowSymbols == 0) {
+    // The encoder starts a new window at the next data written after this
+    // gap.
+    return;
+  }
+  for (auto& repair :
+       stream.fecEncoder->onDataWritten(offset, data, windowSymbols)) {
+    conn.pendingEvents.frames.emplace_back(std::move(repair));
+  }
+  if (fin) {
+    auto repair = stream.fecEncoder->flush();
+    if (repair) {
+      conn.pendingEvents.frames.emplace_back(std::move(*repair));
+    }
+  }
+}
+
+void onRecvStreamRepairFrame(
+    QuicStreamState& stream,
+    const StreamRepairFrame& frame) {
+  auto retentionBytes = stream.conn.transportSettings->fecRetentionBytes;
+  if (retentionBytes == 0 || stream.recvState != StreamRecvState::Open_E) {
+    return;
+  }
+  if (!stream.fecDecoder) {
+    // Nothing has been kept for this stream yet, so only the repair frames
+    // after this one can be used.
+    stream.fecDecoder =
+        std::make_unique<StreamFecDecoder>(stream.id, retentionBytes);
+    return;
+  }
+  auto recovered = stream.fecDecoder->onRepairReceived(frame);
+  for (auto& data : recovered) {
+    VLOG(10) << "Recovered stream=" << stream.id << " offset=" << data.offset
+             << " len=" << data.data->computeChainDataLength() << " "
+             << stream.conn;
+    receiveReadStreamFrameSMHandler(stream, std::move(data));
+  }
+}
+
+} // namespace quic
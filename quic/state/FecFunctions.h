@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/codec/Types.h>
+#include <quic/state/StateData.h>
+
+namespace quic {
+
+/**
+ * Size of the symbols repair windows are made of: the largest repair that
+ * fits in a short header packet along with the STREAM_REPAIR frame carrying
+ * it. Stream frames of streams with forward error correction enabled carry
+ * no more than this, so the loss of any one packet can be repaired.
+ */
+uint64_t getFecSymbolSize(const QuicConnectionStateBase& conn);
+
+/**
+ * Number of symbols of symbolSize bytes the next repair window should hold,
+ * based on the loss rate measured so far. Returns 0 if no repair frames
+ * should be sent.
+ */
+uint64_t getFecWindowSymbols(
+    const QuicConnectionStateBase& conn,
+    uint64_t symbolSize);
+
+/**
+ * Queues the repair frames for new data written on a stream with forward
+ * error correction enabled. Windows are repaired as they fill up, and the
+ * last one as soon as the FIN is written.
+ */
+void onFecStreamDataWritten(
+    QuicStreamState& stream,
+    uint64_t offset,
+    const folly::IOBuf& data,
+    bool fin);
+
+/**
+ * processing upon receipt of StreamRepairFrame
+ */
+void onRecvStreamRepairFrame(
+    QuicStreamState& stream,
+    const StreamRepairFrame& frame);
+} // namespace quic
@@ -14,8 +14,10 @@
 namespace quic {
 namespace {
 
-// shrink the buffers until offset, either by popping up or trimming from start
-void shrinkBuffers(std::deque<StreamBuffer>& buffers, uint64_t offset) {
+// shrink the buffers until offset, either by popping up or trimming from start.
+// Returns the number of bytes removed.
+uint64_t shrinkBuffers(std::deque<StreamBuffer>& buffers, uint64_t offset) {
+  uint64_t removed = 0;
   while (!buffers.empty()) {
     auto curr = buffers.begin();
     if (curr->offset >= offset) {
@@ -24,19 +26,22 @@ void shrinkBuffers(std::deque<StreamBuffer>& buffers, uint64_t offset) {
     }
     size_t currSize = curr->data.chainLength();
     if (curr->offset + currSize <= offset) {
+      removed += currSize;
       buffers.pop_front();
     } else {
       uint64_t amount = offset - curr->offset;
-      curr->data.trimStartAtMost(amount);
+      removed += curr->data.trimStartAtMost(amount);
       curr->offset += amount;
       break;
     }
   }
+  return removed;
 }
 
-void shrinkBuffers(
+uint64_t shrinkBuffers(
     folly::F14FastMap<uint64_t, StreamBuffer>& buffers,
     uint64_t offset) {
+  uint64_t removed = 0;
   // Do a linear search of the entire buffer, there can be exactly one trimmed
   // buffer, since we are changing the offset for that single buffer we need to
   // change the offset in the StreamBuffer, but keep it keyed on the same
@@ -47,14 +52,16 @@ void shrinkBuffers(
       continue;
     }
     if (itr->second.offset + itr->second.data.chainLength() <= offset) {
+      removed += itr->second.data.chainLength();
       itr = buffers.erase(itr);
     } else {
       uint64_t amount = offset - itr->second.offset;
-      itr->second.data.trimStartAtMost(amount);
+      removed += itr->second.data.trimStartAtMost(amount);
       itr->second.offset += amount;
       itr++;
     }
   }
+  return removed;
 }
 
 void shrinkRetransmittableBuffers(
@@ -73,8 +80,10 @@ void shrinkRetransmittableBuffers(
   }
   VLOG(10) << __func__ << ": shrinking retransmissionBuffer to "
            << minimumRetransmittableOffset;
-  shrinkBuffers(stream->retransmissionBuffer, minimumRetransmittableOffset);
-  shrinkBuffers(stream->lossBuffer, minimumRetransmittableOffset);
+  stream->unackedBytes -=
+      shrinkBuffers(stream->retransmissionBuffer, minimumRetransmittableOffset);
+  stream->unackedBytes -=
+      shrinkBuffers(stream->lossBuffer, minimumRetransmittableOffset);
 }
 
 void shrinkReadBuffer(QuicStreamState* stream) {
@@ -84,12 +93,13 @@ void shrinkReadBuffer(QuicStreamState* stream) {
         *stream, stream->maxOffsetObserved, offsetSeen);
     stream->maxOffsetObserved = std::max(stream->maxOffsetObserved, offsetSeen);
   }
-  uint64_t lastReadOffset = stream->currentReadOffset;
-  stream->currentReadOffset = stream->currentReceiveOffset;
+  uint64_t lastReadOffset = stream->flowControlReadOffset();
+  advanceCurrentReadOffset(*stream, stream->currentReceiveOffset);
   shrinkBuffers(stream->readBuffer, stream->currentReadOffset);
 
   // pretends we read stream.currentReadOffset - lastReadOffset bytes
-  updateFlowControlOnRead(*stream, lastReadOffset, Clock::now());
+  updateFlowControlOnRead(
+      *stream, lastReadOffset, stream->conn.clock.coarseNow());
   // may become readable after shrink
   stream->conn.streamManager->updateReadableStreams(*stream);
   stream->conn.streamManager->updatePeekableStreams(*stream);
@@ -8,6 +8,7 @@
 
 #include <quic/state/QuicStateFunctions.h>
 
+#include <quic/common/ContainerUtils.h>
 #include <quic/common/TimeUtil.h>
 #include <quic/logging/QuicLogger.h>
 
@@ -38,6 +39,17 @@ std::pair<folly::Optional<V>, A> minOptional(
   }
   return *p1.first < *p2.first ? p1 : p2;
 }
+
+bool isCryptoStreamQuiescent(const quic::QuicCryptoStream& stream) {
+  return stream.writeBuffer.empty() && stream.lossBuffer.empty() &&
+      stream.retransmissionBuffer.empty();
+}
+
+void compactCryptoStream(quic::QuicCryptoStream& stream) {
+  quic::releaseIfEmpty(stream.retransmissionBuffer);
+  stream.readBuffer.shrink_to_fit();
+  stream.lossBuffer.shrink_to_fit();
+}
 } // namespace
 
 namespace quic {
@@ -94,9 +106,9 @@ void updateAckSendStateOnRecvPacket(
   auto thresh = kNonRtxRxPacketsPendingBeforeAck;
   if (pktHasRetransmittableData || ackState.numRxPacketsRecvd) {
     thresh = ackState.largestReceivedPacketNum.value_or(0) >
-            conn.transportSettings.rxPacketsBeforeAckInitThreshold
-        ? conn.transportSettings.rxPacketsBeforeAckAfterInit
-        : conn.transportSettings.rxPacketsBeforeAckBeforeInit;
+            conn.transportSettings->rxPacketsBeforeAckInitThreshold
+        ? conn.transportSettings->rxPacketsBeforeAckAfterInit
+        : conn.transportSettings->rxPacketsBeforeAckBeforeInit;
   }
   if (pktHasRetransmittableData) {
     if (pktHasCryptoData || pktOutOfOrder ||
@@ -169,7 +181,12 @@ void updateAckSendStateOnSentPacketWithAcks(
 
 bool isConnectionPaced(const QuicConnectionStateBase& conn) noexcept {
   return (
-      conn.transportSettings.pacingEnabled && conn.canBePaced && conn.pacer);
+      conn.transportSettings->pacingEnabled && conn.canBePaced && conn.pacer);
+}
+
+bool isConnectionSendRateLimited(
+    const QuicConnectionStateBase& conn) noexcept {
+  return conn.sendRateLimiter && !conn.sendRateLimiter->hasCredit();
 }
 
 AckState& getAckState(
@@ -316,4 +333,50 @@ std::pair<folly::Optional<TimePoint>, PacketNumberSpace> earliestLossTimer(
       std::make_pair(
           conn.lossState.appDataLossTime, PacketNumberSpace::AppData));
 }
+
+bool isConnectionQuiescent(const QuicConnectionStateBase& conn) noexcept {
+  if (!conn.outstandingPackets.empty() ||
+      !conn.pendingEvents.frames.empty() ||
+      !conn.pendingEvents.resets.empty() ||
+      conn.pendingEvents.numProbePackets > 0 ||
+      conn.pendingEvents.connWindowUpdate ||
+      conn.pendingEvents.dataBlocked) {
+    return false;
+  }
+  if (conn.flowControlState.sumCurStreamBufferLen > 0) {
+    return false;
+  }
+  if (conn.streamManager &&
+      (conn.streamManager->hasWritable() || conn.streamManager->hasLoss() ||
+       conn.streamManager->hasBlocked() ||
+       conn.streamManager->hasWindowUpdates())) {
+    return false;
+  }
+  if (conn.cryptoState &&
+      (!isCryptoStreamQuiescent(conn.cryptoState->initialStream) ||
+       !isCryptoStreamQuiescent(conn.cryptoState->handshakeStream) ||
+       !isCryptoStreamQuiescent(conn.cryptoState->oneRttStream))) {
+    return false;
+  }
+  return true;
+}
+
+void compactConnectionState(QuicConnectionStateBase& conn) {
+  DCHECK(isConnectionQuiescent(conn));
+  conn.outstandingPackets.shrink_to_fit();
+  releaseIfEmpty(conn.outstandingPacketEvents);
+  conn.pendingEvents.frames.shrink_to_fit();
+  releaseIfEmpty(conn.pendingEvents.resets);
+  conn.selfConnectionIds.shrink_to_fit();
+  conn.peerConnectionIds.shrink_to_fit();
+  if (conn.cryptoState) {
+    compactCryptoStream(conn.cryptoState->initialStream);
+    compactCryptoStream(conn.cryptoState->handshakeStream);
+    compactCryptoStream(conn.cryptoState->oneRttStream);
+  }
+  if (conn.streamManager) {
+    conn.streamManager->compact();
+  }
+  conn.hibernated = true;
+}
 } // namespace quic
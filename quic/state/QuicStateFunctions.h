@@ -36,6 +36,13 @@ void updateRtt(
 
 bool isConnectionPaced(const QuicConnectionStateBase& conn) noexcept;
 
+/**
+ * Returns true if the connection's send rate cap currently holds back new data
+ * on its non-control streams.
+ */
+bool isConnectionSendRateLimited(
+    const QuicConnectionStateBase& conn) noexcept;
+
 AckState& getAckState(
     QuicConnectionStateBase& conn,
     PacketNumberSpace pnSpace) noexcept;
@@ -107,4 +114,20 @@ folly::Optional<TimePoint>& getLossTime(
 
 std::pair<folly::Optional<TimePoint>, PacketNumberSpace> earliestLossTimer(
     const QuicConnectionStateBase& conn) noexcept;
+
+/**
+ * Returns true if the connection has nothing outstanding on the wire and
+ * nothing buffered to be sent or retransmitted, i.e. it could release its
+ * spare state without affecting loss recovery or pending writes.
+ */
+bool isConnectionQuiescent(const QuicConnectionStateBase& conn) noexcept;
+
+/**
+ * Release the spare capacity held by a quiescent connection: empty deques and
+ * hash containers sized for the connection's busiest period, and the crypto
+ * stream buffers. Keys, connection ids, flow control, stream offsets and RTT
+ * state are untouched so the connection resumes on the next packet without a
+ * separate rehydration step.
+ */
+void compactConnectionState(QuicConnectionStateBase& conn);
 } // namespace quic
@@ -47,6 +47,29 @@ void writeDataToQuicStream(QuicStreamState& stream, Buf data, bool eof) {
   stream.conn.streamManager->updateWritableStreams(stream);
 }
 
+void pullDataFromStreamDataSource(QuicStreamState& stream, uint64_t maxLength) {
+  if (!stream.dataSource) {
+    return;
+  }
+  auto sourceLength = stream.dataSource->length();
+  auto toPull = std::min(maxLength, sourceLength - stream.dataSourceOffset);
+  bool eof = stream.dataSourceOffset + toPull == sourceLength;
+  if (toPull == 0 && !eof) {
+    return;
+  }
+  Buf data;
+  if (toPull > 0) {
+    data = stream.dataSource->read(stream.dataSourceOffset, toPull);
+    DCHECK_EQ(data->computeChainDataLength(), toPull);
+    stream.dataSourceOffset += toPull;
+  }
+  if (eof) {
+    // Sent data keeps whatever it references alive, so the source can go.
+    stream.dataSource.reset();
+  }
+  writeDataToQuicStream(stream, std::move(data), eof);
+}
+
 void writeDataToQuicStream(QuicCryptoStream& stream, Buf data) {
   stream.writeBuffer.append(std::move(data));
 }
@@ -291,7 +314,8 @@ std::pair<Buf, bool> readDataFromQuicStream(
   std::tie(data, eof) = readDataInOrderFromReadBuffer(stream, amount);
   // Update flow control before handling eof as eof is not subject to flow
   // control
-  updateFlowControlOnRead(stream, lastReadOffset, Clock::now());
+  updateFlowControlOnRead(
+      stream, lastReadOffset, stream.conn.clock.coarseNow());
   eof = stream.finalReadOffset &&
       stream.currentReadOffset == *stream.finalReadOffset;
   if (eof) {
@@ -335,7 +359,8 @@ void consumeDataFromQuicStream(QuicStreamState& stream, uint64_t amount) {
   readDataInOrderFromReadBuffer(stream, amount, true /* sinkData */);
   // Update flow control before handling eof as eof is not subject to flow
   // control
-  updateFlowControlOnRead(stream, lastReadOffset, Clock::now());
+  updateFlowControlOnRead(
+      stream, lastReadOffset, stream.conn.clock.coarseNow());
   eof = stream.finalReadOffset &&
       stream.currentReadOffset == *stream.finalReadOffset;
   if (eof) {
@@ -345,6 +370,112 @@ void consumeDataFromQuicStream(QuicStreamState& stream, uint64_t amount) {
   stream.conn.streamManager->updatePeekableStreams(stream);
 }
 
+namespace {
+/**
+ * Appends the parts of data at offset that have not been read yet to chunks.
+ */
+void appendUnreadChunks(
+    const QuicStreamState& stream,
+    uint64_t offset,
+    BufQueue data,
+    std::vector<StreamBuffer>& chunks) {
+  auto end = offset + data.chainLength();
+  if (offset < stream.currentReadOffset) {
+    data.trimStartAtMost(stream.currentReadOffset - offset);
+    offset = std::min(stream.currentReadOffset, end);
+  }
+  for (auto it = stream.unorderedReadIntervals.cbegin();
+       it != stream.unorderedReadIntervals.cend() && offset < end;
+       ++it) {
+    if (it->end < offset) {
+      continue;
+    }
+    if (it->start >= end) {
+      break;
+    }
+    if (it->start > offset) {
+      auto unreadLen = it->start - offset;
+      chunks.emplace_back(data.splitAtMost(unreadLen), offset);
+      offset += unreadLen;
+    }
+    auto readLen = std::min(it->end + 1, end) - offset;
+    data.trimStartAtMost(readLen);
+    offset += readLen;
+  }
+  if (offset < end) {
+    chunks.emplace_back(data.move(), offset);
+  }
+}
+} // namespace
+
+std::pair<std::vector<StreamBuffer>, bool> readDataUnorderedFromQuicStream(
+    QuicStreamState& stream,
+    uint64_t amount) {
+  std::vector<StreamBuffer> chunks;
+  auto eof = stream.finalReadOffset &&
+      stream.currentReadOffset >= *stream.finalReadOffset;
+  if (eof) {
+    if (stream.currentReadOffset == *stream.finalReadOffset) {
+      stream.currentReadOffset += 1;
+    }
+    stream.conn.streamManager->updateReadableStreams(stream);
+    stream.conn.streamManager->updatePeekableStreams(stream);
+    return std::make_pair(std::move(chunks), true);
+  }
+
+  uint64_t lastReadOffset = stream.flowControlReadOffset();
+  auto remaining = amount;
+  while ((amount == 0 || remaining != 0) && !stream.readBuffer.empty()) {
+    auto& curr = stream.readBuffer.front();
+    uint64_t currSize = curr.data.chainLength();
+    uint64_t toRead =
+        std::min<uint64_t>(currSize, amount == 0 ? currSize : remaining);
+    BufQueue splice(curr.data.splitAtMost(toRead));
+    auto spliceOffset = curr.offset;
+    curr.offset += toRead;
+    if (curr.data.chainLength() == 0) {
+      stream.readBuffer.pop_front();
+    }
+    if (amount != 0) {
+      remaining -= toRead;
+    }
+    auto firstNewChunk = chunks.size();
+    appendUnreadChunks(stream, spliceOffset, std::move(splice), chunks);
+    for (auto i = firstNewChunk; i < chunks.size(); ++i) {
+      auto len = chunks[i].data.chainLength();
+      stream.unorderedReadIntervals.insert(
+          chunks[i].offset, chunks[i].offset + len - 1);
+      stream.unorderedReadBytes += len;
+    }
+  }
+  advanceCurrentReadOffset(stream, stream.currentReadOffset);
+  // Update flow control before handling eof as eof is not subject to flow
+  // control
+  updateFlowControlOnRead(
+      stream, lastReadOffset, stream.conn.clock.coarseNow());
+  eof = stream.finalReadOffset &&
+      stream.currentReadOffset == *stream.finalReadOffset;
+  if (eof) {
+    stream.currentReadOffset += 1;
+  }
+  stream.conn.streamManager->updateReadableStreams(stream);
+  stream.conn.streamManager->updatePeekableStreams(stream);
+  return std::make_pair(std::move(chunks), eof);
+}
+
+void advanceCurrentReadOffset(QuicStreamState& stream, uint64_t offset) {
+  stream.currentReadOffset = std::max(stream.currentReadOffset, offset);
+  auto& intervals = stream.unorderedReadIntervals;
+  while (!intervals.empty() &&
+         intervals.front().start <= stream.currentReadOffset) {
+    auto front = intervals.front();
+    intervals.withdraw(front);
+    stream.unorderedReadBytes -= front.end - front.start + 1;
+    stream.currentReadOffset =
+        std::max(stream.currentReadOffset, front.end + 1);
+  }
+}
+
 bool allBytesTillFinAcked(const QuicStreamState& stream) {
   /**
    * All bytes are acked if the following conditions are met:
@@ -377,6 +508,10 @@ void appendPendingStreamReset(
 }
 
 uint64_t getLargestWriteOffsetSeen(const QuicStreamState& stream) {
+  if (stream.dataSource) {
+    return stream.currentWriteOffset + stream.writeBuffer.chainLength() +
+        stream.dataSource->length() - stream.dataSourceOffset;
+  }
   return stream.finalWriteOffset.value_or(
       stream.currentWriteOffset + stream.writeBuffer.chainLength());
 }
@@ -398,14 +533,49 @@ uint64_t getStreamNextOffsetToDeliver(const QuicStreamState& stream) {
   return minOffsetToDeliver;
 }
 
+uint64_t getStreamUnackedBytes(const QuicStreamState& stream) {
+  return stream.unackedBytes;
+}
+
+uint64_t getSendBufferSpace(const QuicStreamState& stream) {
+  if (!stream.sendBufferLimits) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  const auto& limits = *stream.sendBufferLimits;
+  uint64_t unsentBytes = stream.writeBuffer.chainLength();
+  if (unsentBytes >= limits.maxUnsent) {
+    return 0;
+  }
+  // Unsent bytes may borrow space that unacked bytes do not use, but the sum
+  // of both never exceeds the total buffer size.
+  uint64_t totalLimit = limits.maxUnacked + limits.maxUnsent;
+  uint64_t usedBytes = unsentBytes + getStreamUnackedBytes(stream);
+  if (usedBytes >= totalLimit) {
+    return 0;
+  }
+  return std::min(limits.maxUnsent - unsentBytes, totalLimit - usedBytes);
+}
+
+uint64_t getSendBufferWritable(const QuicStreamState& stream) {
+  uint64_t writable = getSendBufferSpace(stream);
+  if (!stream.sendBufferLimits) {
+    return writable;
+  }
+  uint64_t lowWatermark = std::max<uint64_t>(
+      stream.sendBufferLimits->maxUnsent / kSendBufferLowWatermarkDivisor, 1);
+  return writable < lowWatermark ? 0 : writable;
+}
+
 void cancelHandshakeCryptoStreamRetransmissions(QuicCryptoState& cryptoState) {
   // Cancel any retransmissions we might want to do for the crypto stream.
   // This does not include data that is already deemed as lost, or data that
   // is pending in the write buffer.
   cryptoState.initialStream.retransmissionBuffer.clear();
   cryptoState.initialStream.lossBuffer.clear();
+  cryptoState.initialStream.unackedBytes = 0;
   cryptoState.handshakeStream.retransmissionBuffer.clear();
   cryptoState.handshakeStream.lossBuffer.clear();
+  cryptoState.handshakeStream.unackedBytes = 0;
 }
 
 QuicCryptoStream* getCryptoStream(
@@ -437,6 +607,7 @@ void processCryptoStreamAck(
     // It's possible retransmissions of crypto data were canceled.
     return;
   }
+  cryptoStream.unackedBytes -= len;
   cryptoStream.retransmissionBuffer.erase(ackedBuffer);
 }
 
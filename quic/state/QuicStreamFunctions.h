@@ -43,6 +43,13 @@ void appendDataToReadBuffer(QuicStreamState& stream, StreamBuffer buffer);
  */
 void appendDataToReadBuffer(QuicCryptoStream& stream, StreamBuffer buffer);
 
+/**
+ * Moves up to maxLength bytes from the stream's data source to its write
+ * buffer, and the FIN once the source is used up. The source is released
+ * after its last byte is moved.
+ */
+void pullDataFromStreamDataSource(QuicStreamState& stream, uint64_t maxLength);
+
 /**
  * Reads data from the QUIC stream if data exists.
  * Returns a pair of data and whether or not EOF was reached on the stream.
@@ -76,6 +83,23 @@ void peekDataFromQuicStream(
  */
 void consumeDataFromQuicStream(QuicStreamState& stream, uint64_t amount);
 
+/**
+ * Reads data from anywhere in the stream's read buffer, for streams in
+ * unordered read mode. Returns the chunks read, each with its stream offset,
+ * and whether every byte up to the FIN has now been read. Bytes that were
+ * already read are never returned again. amount == 0 reads all the pending
+ * data in the stream.
+ */
+std::pair<std::vector<StreamBuffer>, bool> readDataUnorderedFromQuicStream(
+    QuicStreamState& stream,
+    uint64_t amount = 0);
+
+/**
+ * Moves the read offset of the stream up to offset, and then past any bytes
+ * right after it that were already read out of order.
+ */
+void advanceCurrentReadOffset(QuicStreamState& stream, uint64_t offset);
+
 bool allBytesTillFinAcked(const QuicStreamState& state);
 
 /**
@@ -97,6 +121,25 @@ uint64_t getLargestWriteOffsetSeen(const QuicStreamState& stream);
  */
 uint64_t getStreamNextOffsetToDeliver(const QuicStreamState& stream);
 
+/**
+ * Get the number of bytes that have been written to the network but not yet
+ * acked, including bytes that are waiting to be retransmitted.
+ */
+uint64_t getStreamUnackedBytes(const QuicStreamState& stream);
+
+/**
+ * Get how many more bytes the stream's send buffer limits leave room for.
+ * writeChain does not accept more than this.
+ */
+uint64_t getSendBufferSpace(const QuicStreamState& stream);
+
+/**
+ * Get how many more bytes the app may write to the stream under its send
+ * buffer limits. Returns 0 while less than the low watermark is available, so
+ * that writers are woken up for a meaningful amount of space only.
+ */
+uint64_t getSendBufferWritable(const QuicStreamState& stream);
+
 /**
  * Common functions for merging data into the read buffer for a Quic stream like
  * object. Callers should provide a connFlowControlVisitor which will be invoked
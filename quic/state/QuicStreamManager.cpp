@@ -8,6 +8,7 @@
 
 #include "quic/state/QuicStreamManager.h"
 
+#include <quic/common/ContainerUtils.h>
 #include <quic/state/QuicStreamUtilities.h>
 
 namespace quic {
@@ -32,7 +33,7 @@ static void updateHolBlockedTime(QuicStreamState& stream) {
   // If there is no more data to read, or if the current read offset
   // matches the read offset in the front queue, a potential HOL block
   // becomes unblocked.
-  if (stream.readBuffer.empty() ||
+  if (stream.readBuffer.empty() || stream.unorderedRead ||
       (stream.currentReadOffset == stream.readBuffer.front().offset)) {
     // If we were previously HOL blocked, we're not any more.
     // Update the total HOLB time and reset the latch.
@@ -213,11 +214,10 @@ void QuicStreamManager::setMaxRemoteUnidirectionalStreamsInternal(
 
 void QuicStreamManager::refreshTransportSettings(
     const TransportSettings& settings) {
-  transportSettings_ = &settings;
   setMaxRemoteBidirectionalStreamsInternal(
-      transportSettings_->advertisedInitialMaxStreamsBidi, true);
+      settings.advertisedInitialMaxStreamsBidi, true);
   setMaxRemoteUnidirectionalStreamsInternal(
-      transportSettings_->advertisedInitialMaxStreamsUni, true);
+      settings.advertisedInitialMaxStreamsUni, true);
 }
 
 // We create local streams lazily. If a local stream was created
@@ -408,6 +408,7 @@ void QuicStreamManager::removeClosedStream(StreamId streamId) {
   peekableStreams_.erase(streamId);
   writableStreams_.erase(streamId);
   writableControlStreams_.erase(streamId);
+  rateLimitedStreams_.erase(streamId);
   blockedStreams_.erase(streamId);
   deliverableStreams_.erase(streamId);
   windowUpdates_.erase(streamId);
@@ -428,8 +429,8 @@ void QuicStreamManager::removeClosedStream(StreamId streamId) {
     // update every time we've closed a number of streams >= the set windowing
     // fraction.
     uint64_t initialStreamLimit = isUnidirectionalStream(streamId)
-        ? transportSettings_->advertisedInitialMaxStreamsUni
-        : transportSettings_->advertisedInitialMaxStreamsBidi;
+        ? conn_.transportSettings->advertisedInitialMaxStreamsUni
+        : conn_.transportSettings->advertisedInitialMaxStreamsBidi;
     uint64_t streamWindow = initialStreamLimit / streamLimitWindowingFraction_;
     uint64_t openableRemoteStreams = isUnidirectionalStream(streamId)
         ? openableRemoteUnidirectionalStreams()
@@ -494,10 +495,15 @@ void QuicStreamManager::updateReadableStreams(QuicStreamState& stream) {
 }
 
 void QuicStreamManager::updateWritableStreams(QuicStreamState& stream) {
-  if (stream.hasWritableData() && !stream.streamWriteError.hasValue()) {
-    stream.conn.streamManager->addWritable(stream);
+  if (!stream.hasWritableData() || stream.streamWriteError.hasValue()) {
+    rateLimitedStreams_.erase(stream.id);
+    removeWritable(stream);
+  } else if (stream.sendRateLimiter && !stream.sendRateLimiter->hasCredit()) {
+    rateLimitedStreams_.insert(stream.id);
+    removeWritable(stream);
   } else {
-    stream.conn.streamManager->removeWritable(stream);
+    rateLimitedStreams_.erase(stream.id);
+    addWritable(stream);
   }
 }
 
@@ -546,4 +552,30 @@ void QuicStreamManager::setStreamAsControl(QuicStreamState& stream) {
 bool QuicStreamManager::isAppIdle() const {
   return isAppIdle_;
 }
+
+void QuicStreamManager::compact() {
+  for (auto& s : streams_) {
+    auto& stream = s.second;
+    releaseIfEmpty(stream.retransmissionBuffer);
+    stream.readBuffer.shrink_to_fit();
+    stream.lossBuffer.shrink_to_fit();
+  }
+  releaseIfEmpty(openBidirectionalPeerStreams_);
+  releaseIfEmpty(openUnidirectionalPeerStreams_);
+  releaseIfEmpty(openBidirectionalLocalStreams_);
+  releaseIfEmpty(openUnidirectionalLocalStreams_);
+  releaseIfEmpty(streams_);
+  newPeerStreams_.shrink_to_fit();
+  releaseIfEmpty(blockedStreams_);
+  releaseIfEmpty(stopSendingStreams_);
+  releaseIfEmpty(dataExpiredStreams_);
+  releaseIfEmpty(dataRejectedStreams_);
+  releaseIfEmpty(windowUpdates_);
+  releaseIfEmpty(flowControlUpdated_);
+  releaseIfEmpty(lossStreams_);
+  releaseIfEmpty(readableStreams_);
+  releaseIfEmpty(peekableStreams_);
+  releaseIfEmpty(deliverableStreams_);
+  releaseIfEmpty(closedStreams_);
+}
 } // namespace quic
@@ -29,9 +29,7 @@ class QuicStreamManager {
       QuicConnectionStateBase& conn,
       QuicNodeType nodeType,
       const TransportSettings& transportSettings)
-      : conn_(conn),
-        nodeType_(nodeType),
-        transportSettings_(&transportSettings) {
+      : conn_(conn), nodeType_(nodeType) {
     if (nodeType == QuicNodeType::Server) {
       nextAcceptablePeerBidirectionalStreamId_ = 0x00;
       nextAcceptablePeerUnidirectionalStreamId_ = 0x02;
@@ -256,6 +254,19 @@ class QuicStreamManager {
   void clearWritable() {
     writableStreams_.clear();
     writableControlStreams_.clear();
+    rateLimitedStreams_.clear();
+  }
+
+  /*
+   * Returns the streams that have writable data but are held back by their
+   * send rate cap.
+   */
+  const auto& rateLimitedStreams() const {
+    return rateLimitedStreams_;
+  }
+
+  bool hasRateLimited() const {
+    return !rateLimitedStreams_.empty();
   }
 
   /*
@@ -638,6 +649,13 @@ class QuicStreamManager {
     return streams_.size() != numControlStreams_;
   }
 
+  /*
+   * Returns the number of open control streams.
+   */
+  uint64_t numControlStreams() const {
+    return numControlStreams_;
+  }
+
   /*
    * Sets the given stream to be tracked as a control stream.
    */
@@ -656,6 +674,14 @@ class QuicStreamManager {
 
   bool isAppIdle() const;
 
+  /*
+   * Release the spare capacity held by the stream manager's bookkeeping
+   * containers and by the buffers of the streams that are currently empty.
+   * This is used when a connection has been quiescent for a while so that
+   * idle connections do not hold on to memory sized for their busiest period.
+   */
+  void compact();
+
  private:
   // Updates the congestion controller app-idle state, after a change in the
   // number of streams.
@@ -784,6 +810,10 @@ class QuicStreamManager {
   // Set of control streams that have writable data
   std::set<StreamId> writableControlStreams_;
 
+  // Set of streams that have writable data but no send rate credit. They
+  // are moved back to the writable sets once their credit refills.
+  folly::F14FastSet<StreamId> rateLimitedStreams_;
+
   // Streams that may be able to callback DeliveryCallback
   folly::F14FastSet<StreamId> deliverableStreams_;
 
@@ -792,8 +822,6 @@ class QuicStreamManager {
 
   // Record whether or not we are app-idle.
   bool isAppIdle_{false};
-
-  const TransportSettings* transportSettings_;
 };
 
 } // namespace quic
@@ -39,6 +39,8 @@ class QuicTransportStatsCallback {
     WORKER_NOT_INITIALIZED,
     SERVER_SHUTDOWN,
     INITIAL_CONNID_SMALL,
+    INGRESS_POLICED,
+    WORKER_OVERLOADED,
     // NOTE: MAX should always be at the end
     MAX
   };
@@ -90,6 +92,12 @@ class QuicTransportStatsCallback {
   virtual void onConnectionClose(
       folly::Optional<ConnectionCloseReason> reason = folly::none) = 0;
 
+  // the connection released its spare state after being quiescent
+  virtual void onConnectionHibernated() = 0;
+
+  // a hibernated connection processed a packet again
+  virtual void onConnectionRehydrated() = 0;
+
   // stream level metrics
   virtual void onNewQuicStream() = 0;
 
@@ -120,6 +128,9 @@ class QuicTransportStatsCallback {
 
   virtual void onUDPSocketWriteError(SocketErrorType errorType) = 0;
 
+  // datagrams the kernel dropped because the socket receive buffer was full
+  virtual void onKernelReceiveDrops(uint64_t drops) = 0;
+
   static const char* toString(ConnectionCloseReason reason) {
     switch (reason) {
       case ConnectionCloseReason::NONE:
@@ -163,6 +174,10 @@ class QuicTransportStatsCallback {
         return "SERVER_SHUTDOWN";
       case PacketDropReason::INITIAL_CONNID_SMALL:
         return "INITIAL_CONNID_SMALL";
+      case PacketDropReason::INGRESS_POLICED:
+        return "INGRESS_POLICED";
+      case PacketDropReason::WORKER_OVERLOADED:
+        return "WORKER_OVERLOADED";
       case PacketDropReason::MAX:
         return "MAX";
       default:
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/SendRateLimiter.h>
+
+#include <glog/logging.h>
+
+namespace quic {
+
+SendRateLimiter::SendRateLimiter(
+    uint64_t bytesPerSecond,
+    uint64_t minBurstBytes)
+    : bytesPerSecond_(bytesPerSecond),
+      burstBytes_(std::max(
+          minBurstBytes,
+          bytesPerSecond *
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                  kSendRateLimiterBurstInterval)
+                  .count() /
+              std::chrono::microseconds::period::den)),
+      tokens_(burstBytes_),
+      lastRefill_(Clock::now()) {
+  CHECK_GT(bytesPerSecond_, 0);
+}
+
+void SendRateLimiter::refill(TimePoint now) noexcept {
+  if (now <= lastRefill_) {
+    return;
+  }
+  uint64_t elapsedUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - lastRefill_)
+          .count();
+  uint64_t missing = burstBytes_ - tokens_;
+  uint64_t fillUs = (missing * std::chrono::microseconds::period::den +
+                     bytesPerSecond_ - 1) /
+      bytesPerSecond_;
+  if (elapsedUs >= fillUs) {
+    tokens_ = burstBytes_;
+    lastRefill_ = now;
+    return;
+  }
+  uint64_t earned =
+      elapsedUs * bytesPerSecond_ / std::chrono::microseconds::period::den;
+  if (earned == 0) {
+    return;
+  }
+  // Only move lastRefill_ forward by the time that earned whole tokens, so
+  // frequent refills do not lose the remainders.
+  tokens_ += earned;
+  lastRefill_ += std::chrono::microseconds(
+      earned * std::chrono::microseconds::period::den / bytesPerSecond_);
+}
+
+void SendRateLimiter::onBytesSent(uint64_t bytes, TimePoint now) noexcept {
+  refill(now);
+  tokens_ -= bytes;
+}
+
+std::chrono::microseconds SendRateLimiter::timeUntilCredit() const noexcept {
+  if (tokens_ > 0) {
+    return std::chrono::microseconds::zero();
+  }
+  uint64_t needed = -tokens_ + 1;
+  // Round up so that the bucket is never checked before it has refilled.
+  return std::chrono::microseconds(
+      (needed * std::chrono::microseconds::period::den + bytesPerSecond_ - 1) /
+      bytesPerSecond_);
+}
+
+} // namespace quic
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/QuicConstants.h>
+
+namespace quic {
+
+/**
+ * Token bucket used to cap the rate at which an application sends, either on
+ * a single stream or on the whole connection.
+ *
+ * The bucket holds at most kSendRateLimiterBurstInterval worth of tokens, so
+ * a sender that was idle cannot burst far above the cap. Sending is allowed
+ * while the bucket holds any tokens, and may overdraw it by a packet; the
+ * debt is paid back before the next send.
+ */
+class SendRateLimiter {
+ public:
+  SendRateLimiter(uint64_t bytesPerSecond, uint64_t minBurstBytes);
+
+  /**
+   * Adds the tokens accumulated since the last refill.
+   */
+  void refill(TimePoint now) noexcept;
+
+  void onBytesSent(uint64_t bytes, TimePoint now) noexcept;
+
+  /**
+   * Whether there were tokens left as of the last refill.
+   */
+  bool hasCredit() const noexcept {
+    return tokens_ > 0;
+  }
+
+  /**
+   * How long from the last refill until the bucket has tokens again.
+   */
+  std::chrono::microseconds timeUntilCredit() const noexcept;
+
+  uint64_t getRate() const noexcept {
+    return bytesPerSecond_;
+  }
+
+  uint64_t getBurst() const noexcept {
+    return burstBytes_;
+  }
+
+ private:
+  uint64_t bytesPerSecond_;
+  uint64_t burstBytes_;
+  int64_t tokens_;
+  TimePoint lastRefill_;
+};
+
+} // namespace quic
@@ -9,8 +9,10 @@
 #include "SimpleFrameFunctions.h"
 
 #include <quic/QuicConstants.h>
+#include <quic/state/FecFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
+#include <quic/state/QuicStreamUtilities.h>
 #include <quic/state/stream/StreamSendHandlers.h>
 
 namespace quic {
@@ -72,6 +74,11 @@ folly::Optional<QuicSimpleFrame> updateSimpleFrameOnPacketClone(
     case QuicSimpleFrame::Type::RetireConnectionIdFrame_E:
       // TODO junqiw
       return QuicSimpleFrame(frame);
+    case QuicSimpleFrame::Type::NewTokenFrame_E:
+      return QuicSimpleFrame(frame);
+    case QuicSimpleFrame::Type::StreamRepairFrame_E:
+      // The data it protects is retransmitted on its own.
+      return folly::none;
   }
   folly::assume_unreachable();
 }
@@ -141,9 +148,14 @@ void updateSimpleFrameOnPacketLoss(
       // Do not retransmit PATH_RESPONSE to avoid buffering
       break;
     }
+    case QuicSimpleFrame::Type::StreamRepairFrame_E: {
+      // By the time a loss is detected the repair is too late to help.
+      break;
+    }
     case QuicSimpleFrame::Type::NewConnectionIdFrame_E:
     case QuicSimpleFrame::Type::MaxStreamsFrame_E:
     case QuicSimpleFrame::Type::RetireConnectionIdFrame_E:
+    case QuicSimpleFrame::Type::NewTokenFrame_E:
       conn.pendingEvents.frames.push_back(frame);
       break;
   }
@@ -263,7 +275,7 @@ bool updateSimpleFrameOnPacketReceived(
       // provided by NEW_CONNECTION_ID frames. We add 1 to represent the initial
       // cid.
       if (conn.peerConnectionIds.size() ==
-          conn.transportSettings.selfActiveConnectionIdLimit + 1) {
+          conn.transportSettings->selfActiveConnectionIdLimit + 1) {
         // Unspec'd as of d-23 if a server doesn't respect the
         // active_connection_id_limit. Ignore frame.
         return false;
@@ -289,6 +301,23 @@ bool updateSimpleFrameOnPacketReceived(
       // TODO junqiw
       return false;
     }
+    case QuicSimpleFrame::Type::NewTokenFrame_E: {
+      // NEW_TOKEN is decoded as a ReadNewTokenFrame, this is only written.
+      return true;
+    }
+    case QuicSimpleFrame::Type::StreamRepairFrame_E: {
+      const StreamRepairFrame& repairFrame = *frame.asStreamRepairFrame();
+      if (isSendingStream(conn.nodeType, repairFrame.streamId)) {
+        throw QuicTransportException(
+            "Received StreamRepairFrame for sending stream.",
+            TransportErrorCode::STREAM_STATE_ERROR);
+      }
+      auto stream = conn.streamManager->getStream(repairFrame.streamId);
+      if (stream) {
+        onRecvStreamRepairFrame(*stream, repairFrame);
+      }
+      return true;
+    }
   }
   folly::assume_unreachable();
 }
@@ -15,15 +15,15 @@ QuicStreamState::QuicStreamState(StreamId idIn, QuicConnectionStateBase& connIn)
   // Note: this will set a windowSize for a locally-initiated unidirectional
   // stream even though that value is meaningless.
   flowControlState.windowSize = isUnidirectionalStream(idIn)
-      ? conn.transportSettings.advertisedInitialUniStreamWindowSize
+      ? conn.transportSettings->advertisedInitialUniStreamWindowSize
       : isLocalStream(connIn.nodeType, idIn)
-          ? conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize
-          : conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize;
+          ? conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize
+          : conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize;
   flowControlState.advertisedMaxOffset = isUnidirectionalStream(idIn)
-      ? conn.transportSettings.advertisedInitialUniStreamWindowSize
+      ? conn.transportSettings->advertisedInitialUniStreamWindowSize
       : isLocalStream(connIn.nodeType, idIn)
-          ? conn.transportSettings.advertisedInitialBidiLocalStreamWindowSize
-          : conn.transportSettings.advertisedInitialBidiRemoteStreamWindowSize;
+          ? conn.transportSettings->advertisedInitialBidiLocalStreamWindowSize
+          : conn.transportSettings->advertisedInitialBidiRemoteStreamWindowSize;
   // Note: this will set a peerAdvertisedMaxOffset for a peer-initiated
   // unidirectional stream even though that value is meaningless.
   flowControlState.peerAdvertisedMaxOffset = isUnidirectionalStream(idIn)
@@ -13,12 +13,15 @@
 #include <quic/codec/QuicReadCodec.h>
 #include <quic/codec/QuicWriteCodec.h>
 #include <quic/codec/Types.h>
+#include <quic/common/QuicClock.h>
+#include <quic/common/SocketTuning.h>
 #include <quic/handshake/HandshakeLayer.h>
 #include <quic/logging/QLogger.h>
 #include <quic/state/AckStates.h>
 #include <quic/state/PendingPathRateLimiter.h>
 #include <quic/state/QuicStreamManager.h>
 #include <quic/state/QuicTransportStatsCallback.h>
+#include <quic/state/SendRateLimiter.h>
 #include <quic/state/StreamData.h>
 #include <quic/state/TransportSettings.h>
 
@@ -40,12 +43,14 @@ struct RecvmmsgStorage {
   std::vector<struct sockaddr_storage> addrs;
   std::vector<Buf> readBuffers;
   std::vector<struct iovec> iovecs;
+  std::vector<ReceiveControlBuffer> controls;
 
   void resize(size_t numPackets) {
     msgs.resize(numPackets);
     addrs.resize(numPackets);
     readBuffers.resize(numPackets);
     iovecs.resize(numPackets);
+    controls.resize(numPackets);
   }
 };
 
@@ -487,7 +492,6 @@ struct LossState {
   TimePoint lastRetransmittablePacketSentTime;
 };
 
-class Logger;
 class CongestionControllerFactory;
 class LoopDetectorCallback;
 class PendingPathRateLimiter;
@@ -523,6 +527,14 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
 
   std::unique_ptr<PendingPathRateLimiter> pathValidationLimiter;
 
+  // Cap on the rate of new stream data sent on the connection, set by the
+  // app via setConnectionMaxSendRate.
+  std::unique_ptr<SendRateLimiter> sendRateLimiter;
+
+  // Where the connection reads the time from, as picked by the transport
+  // settings.
+  TransportClock clock;
+
   // TODO: We really really should wrap outstandingPackets, all its associated
   // counters and the outstandingPacketEvents into one class.
   // Sent packets which have not been acked. These are sorted by PacketNum.
@@ -634,6 +646,11 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // Whether or not we received a new packet before a write.
   bool receivedNewPacketBeforeWrite{false};
 
+  // Whether the connection has released its spare state after being quiescent
+  // for hibernationIdleTimeout. Cleared on the next packet read or
+  // application write.
+  bool hibernated{false};
+
   struct PendingEvents {
     Resets resets;
 
@@ -651,6 +668,9 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
     // Whether a connection level window update is due to send
     bool connWindowUpdate{false};
 
+    // Connection level blocked frame to send, asking the peer for more credit
+    folly::Optional<DataBlockedFrame> dataBlocked;
+
     // If there is a pending loss detection alarm update
     bool setLossDetectionAlarm{false};
 
@@ -710,7 +730,7 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   folly::Optional<PathChallengeFrame> outstandingPathValidation;
 
   // Settings for transports.
-  TransportSettings transportSettings;
+  SharedTransportSettings transportSettings;
 
   // Whether we've set the transporot parameters from transportSettings yet.
   bool transportParametersEncoded{false};
@@ -737,9 +757,6 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // out by us.
   folly::Optional<PacketNum> latestMaxDataPacket;
 
-  // Logger for this connection.
-  std::shared_ptr<Logger> logger;
-
   // QLogger for this connection
   std::shared_ptr<QLogger> qLogger;
 
@@ -783,6 +800,10 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // Whether or not both ends agree to use partial reliability
   bool partialReliabilityEnabled{false};
 
+  // Bytes of stream data the peer keeps to recover from our STREAM_REPAIR
+  // frames. 0 if the peer does not accept them.
+  uint64_t peerFecRetentionBytes{0};
+
   // Debug information. Currently only used to debug busy loop of Transport
   // WriteLooper.
   struct DebugState {
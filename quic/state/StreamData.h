@@ -11,6 +11,9 @@
 #include <folly/container/F14Map.h>
 #include <quic/QuicConstants.h>
 #include <quic/codec/Types.h>
+#include <quic/state/SendRateLimiter.h>
+#include <quic/state/StreamDataSource.h>
+#include <quic/state/StreamFec.h>
 
 namespace quic {
 
@@ -64,6 +67,10 @@ struct QuicStreamLike {
   // Each one represents one StreamFrame that was written.
   std::deque<StreamBuffer> lossBuffer;
 
+  // Bytes in the retransmission and loss buffers, kept up to date as data is
+  // written, acked, skipped and reset so that it never needs to be summed.
+  uint64_t unackedBytes{0};
+
   // Current offset of the start bytes in the write buffer.
   // This changes when we pop stuff off the writeBuffer.
   // When we are finished writing out all the bytes until FIN, this will
@@ -208,6 +215,47 @@ struct QuicStreamState : public QuicStreamLike {
   // lastHolbTime indicates whether the stream is HOL blocked at the moment.
   uint32_t holbCount{0};
 
+  // Send buffer limits set by the app via setSendBuffer. Bytes in the
+  // writeBuffer count against maxUnsent, bytes in the retransmission and loss
+  // buffers against maxUnacked. Unset means the stream is only bounded by
+  // flow control and the connection's buffer space.
+  struct SendBufferLimits {
+    uint64_t maxUnacked;
+    uint64_t maxUnsent;
+  };
+  folly::Optional<SendBufferLimits> sendBufferLimits;
+
+  // Cap on the rate of new data sent on the stream, set by the app via
+  // setStreamMaxSendRate. While it has no credit the stream is kept out of
+  // the writable set.
+  std::unique_ptr<SendRateLimiter> sendRateLimiter;
+
+  // Set by the app via setStreamForwardErrorCorrection. Repair frames are
+  // only built while the peer accepts them and the loss rate calls for it.
+  std::unique_ptr<StreamFecEncoder> fecEncoder;
+
+  // Created when the first repair frame for the stream is received.
+  std::unique_ptr<StreamFecDecoder> fecDecoder;
+
+  // Set by the app via setStreamDataSource. Data is moved from the source
+  // into the writeBuffer as packets are built; the FIN goes with the last
+  // byte of the source.
+  std::unique_ptr<StreamDataSource> dataSource;
+
+  // Number of bytes of the dataSource already moved to the writeBuffer.
+  uint64_t dataSourceOffset{0};
+
+  // Set by the app via setStreamUnorderedRead. Data is then handed to the
+  // app as soon as it arrives, wherever it falls in the stream.
+  bool unorderedRead{false};
+
+  // Ranges past currentReadOffset that were already read out of order.
+  // currentReadOffset moves over them once the gaps before them are read.
+  IntervalSet<uint64_t> unorderedReadIntervals;
+
+  // Number of bytes in unorderedReadIntervals.
+  uint64_t unorderedReadBytes{0};
+
   // Returns true if both send and receive state machines are in a terminal
   // state
   bool inTerminalStates() const {
@@ -220,9 +268,11 @@ struct QuicStreamState : public QuicStreamLike {
     return sendInTerminalState && recvInTerminalState;
   }
 
-  // If the stream is still writable.
+  // If the stream is still writable. Once a data source is set the rest of
+  // the stream comes from it.
   bool writable() const {
-    return sendState == StreamSendState::Open_E && !finalWriteOffset.hasValue();
+    return sendState == StreamSendState::Open_E &&
+        !finalWriteOffset.hasValue() && !dataSource;
   }
 
   bool shouldSendFlowControl() const {
@@ -230,7 +280,7 @@ struct QuicStreamState : public QuicStreamLike {
   }
 
   bool hasWritableData() const {
-    if (!writeBuffer.empty()) {
+    if (!writeBuffer.empty() || hasDataSourceData()) {
       return flowControlState.peerAdvertisedMaxOffset - currentWriteOffset > 0;
     }
     if (finalWriteOffset) {
@@ -241,10 +291,21 @@ struct QuicStreamState : public QuicStreamLike {
 
   bool hasReadableData() const {
     return (readBuffer.size() > 0 &&
-            currentReadOffset == readBuffer.front().offset) ||
+            (unorderedRead ||
+             currentReadOffset == readBuffer.front().offset)) ||
         (finalReadOffset && currentReadOffset == *finalReadOffset);
   }
 
+  bool hasDataSourceData() const {
+    return dataSource && dataSourceOffset < dataSource->length();
+  }
+
+  // The offset the app is credited with having read up to for flow control.
+  // Bytes read out of order count even though there are gaps before them.
+  uint64_t flowControlReadOffset() const {
+    return currentReadOffset + unorderedReadBytes;
+  }
+
   bool hasPeekableData() const {
     return readBuffer.size() > 0;
   }
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/StreamDataSource.h>
+
+#include <glog/logging.h>
+
+namespace quic {
+
+namespace {
+using MappingHolder = std::shared_ptr<folly::MemoryMapping>;
+
+void releaseMapping(void* /* buf */, void* userData) {
+  delete static_cast<MappingHolder*>(userData);
+}
+} // namespace
+
+MmapStreamDataSource::MmapStreamDataSource(const std::string& path)
+    : mapping_(std::make_shared<folly::MemoryMapping>(path.c_str())) {}
+
+uint64_t MmapStreamDataSource::length() const {
+  return mapping_->range().size();
+}
+
+Buf MmapStreamDataSource::read(uint64_t offset, uint64_t len) {
+  auto range = mapping_->range();
+  CHECK_LE(offset + len, range.size());
+  if (len == 0) {
+    return folly::IOBuf::create(0);
+  }
+  // The pages are mapped read-only. Nothing writes to them, since stream
+  // data is cloned into packets before it is encrypted.
+  return folly::IOBuf::takeOwnership(
+      const_cast<uint8_t*>(range.data() + offset),
+      len,
+      releaseMapping,
+      new MappingHolder(mapping_));
+}
+
+} // namespace quic
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/system/MemoryMapping.h>
+#include <quic/common/BufUtil.h>
+
+namespace quic {
+
+/**
+ * Source of the rest of a stream's data, set through setStreamDataSource.
+ * Instead of the whole body being buffered up front, the transport reads
+ * from the source while building packets, only as much as it can send.
+ */
+class StreamDataSource {
+ public:
+  virtual ~StreamDataSource() = default;
+
+  /**
+   * Total number of bytes the source provides. Must not change.
+   */
+  virtual uint64_t length() const = 0;
+
+  /**
+   * Returns the len bytes at offset within the source. The buffers are kept
+   * until the data is acked, so sources should hand out references to data
+   * they already hold rather than copies.
+   */
+  virtual Buf read(uint64_t offset, uint64_t len) = 0;
+};
+
+/**
+ * Serves a file through a read-only memory mapping. Buffers point straight
+ * into the mapped pages and keep the mapping alive, so sending a file never
+ * copies it into the write or retransmission buffers.
+ */
+class MmapStreamDataSource : public StreamDataSource {
+ public:
+  /**
+   * Throws std::system_error if the file can not be opened or mapped.
+   */
+  explicit MmapStreamDataSource(const std::string& path);
+
+  uint64_t length() const override;
+
+  Buf read(uint64_t offset, uint64_t len) override;
+
+ private:
+  std::shared_ptr<folly::MemoryMapping> mapping_;
+};
+
+} // namespace quic
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/StreamFec.h>
+
+#include <folly/io/Cursor.h>
+#include <glog/logging.h>
+
+namespace quic {
+
+StreamFecEncoder::StreamFecEncoder(StreamId streamId, uint64_t symbolSize)
+    : streamId_(streamId), symbolSize_(symbolSize), repair_(symbolSize, 0) {
+  CHECK_GT(symbolSize_, 0);
+}
+
+void StreamFecEncoder::startWindow(uint64_t offset, uint64_t windowSymbols) {
+  CHECK_GT(windowSymbols, 0);
+  windowStart_ = offset;
+  windowLength_ = 0;
+  repairedLength_ = 0;
+  windowCapacity_ = windowSymbols * symbolSize_;
+  std::fill(repair_.begin(), repair_.end(), 0);
+}
+
+StreamRepairFrame StreamFecEncoder::makeRepairFrame() {
+  repairedLength_ = windowLength_;
+  return StreamRepairFrame(
+      streamId_,
+      windowStart_,
+      windowLength_,
+      symbolSize_,
+      folly::IOBuf::copyBuffer(
+          repair_.data(), std::min(symbolSize_, windowLength_)));
+}
+
+std::vector<StreamRepairFrame> StreamFecEncoder::onDataWritten(
+    uint64_t offset,
+    const folly::IOBuf& data,
+    uint64_t windowSymbols) {
+  std::vector<StreamRepairFrame> frames;
+  if (windowCapacity_ == 0 || offset != windowStart_ + windowLength_) {
+    startWindow(offset, windowSymbols);
+  }
+  for (auto range : data) {
+    const uint8_t* bytes = range.data();
+    uint64_t remaining = range.size();
+    while (remaining > 0) {
+      auto toFold = std::min(remaining, windowCapacity_ - windowLength_);
+      auto pos = windowLength_ % symbolSize_;
+      for (uint64_t i = 0; i < toFold; ++i) {
+        repair_[pos] ^= bytes[i];
+        if (++pos == symbolSize_) {
+          pos = 0;
+        }
+      }
+      windowLength_ += toFold;
+      bytes += toFold;
+      remaining -= toFold;
+      if (windowLength_ == windowCapacity_) {
+        frames.push_back(makeRepairFrame());
+        startWindow(windowStart_ + windowLength_, windowSymbols);
+      }
+    }
+  }
+  return frames;
+}
+
+folly::Optional<StreamRepairFrame> StreamFecEncoder::flush() {
+  if (windowLength_ == repairedLength_) {
+    return folly::none;
+  }
+  return makeRepairFrame();
+}
+
+StreamFecDecoder::StreamFecDecoder(StreamId streamId, uint64_t retentionBytes)
+    : streamId_(streamId), retentionBytes_(retentionBytes) {}
+
+void StreamFecDecoder::onDataReceived(
+    uint64_t offset,
+    const folly::IOBuf& data) {
+  auto length = data.computeChainDataLength();
+  if (length == 0) {
+    return;
+  }
+  auto& retained = retained_[offset];
+  if (!retained || retained->computeChainDataLength() < length) {
+    retained = data.clone();
+  }
+  maxOffsetReceived_ = std::max(maxOffsetReceived_, offset + length);
+  // A repair frame never covers more than retentionBytes, so data that far
+  // behind the newest byte can no longer help.
+  while (!retained_.empty()) {
+    auto it = retained_.begin();
+    auto end = it->first + it->second->computeChainDataLength();
+    if (end + retentionBytes_ > maxOffsetReceived_) {
+      break;
+    }
+    retained_.erase(it);
+  }
+}
+
+std::vector<ReadStreamFrame> StreamFecDecoder::onRepairReceived(
+    const StreamRepairFrame& frame) {
+  std::vector<ReadStreamFrame> recovered;
+  auto repairLength = std::min(frame.length, frame.symbolSize);
+  if (frame.length > retentionBytes_ || !frame.repairData ||
+      frame.repairData->computeChainDataLength() != repairLength) {
+    VLOG(4) << "Ignoring malformed repair for stream=" << streamId_;
+    return recovered;
+  }
+  auto rangeEnd = frame.offset + frame.length;
+  std::vector<uint8_t> window(frame.length, 0);
+  std::vector<bool> received(frame.length, false);
+  uint64_t receivedBytes = 0;
+  for (const auto& retained : retained_) {
+    if (retained.first >= rangeEnd) {
+      break;
+    }
+    auto retainedEnd =
+        retained.first + retained.second->computeChainDataLength();
+    auto start = std::max(retained.first, frame.offset);
+    auto end = std::min(retainedEnd, rangeEnd);
+    if (start >= end) {
+      continue;
+    }
+    folly::io::Cursor cursor(retained.second.get());
+    cursor.skip(start - retained.first);
+    cursor.pull(window.data() + (start - frame.offset), end - start);
+    for (auto i = start - frame.offset; i < end - frame.offset; ++i) {
+      if (!received[i]) {
+        received[i] = true;
+        receivedBytes++;
+      }
+    }
+  }
+  auto missingBytes = frame.length - receivedBytes;
+  if (missingBytes == 0 || missingBytes > repairLength) {
+    return recovered;
+  }
+  // Each missing byte is recoverable only if it is the only one missing at
+  // its position within the symbols.
+  std::vector<bool> positionMissing(repairLength, false);
+  for (uint64_t i = 0; i < frame.length; ++i) {
+    if (!received[i]) {
+      auto pos = i % frame.symbolSize;
+      if (positionMissing[pos]) {
+        return recovered;
+      }
+      positionMissing[pos] = true;
+    }
+  }
+
+  std::vector<uint8_t> syndrome(repairLength);
+  folly::io::Cursor repairCursor(frame.repairData.get());
+  repairCursor.pull(syndrome.data(), repairLength);
+  for (uint64_t i = 0; i < frame.length; ++i) {
+    syndrome[i % frame.symbolSize] ^= window[i];
+  }
+  uint64_t i = 0;
+  while (i < frame.length) {
+    if (received[i]) {
+      ++i;
+      continue;
+    }
+    auto start = i;
+    while (i < frame.length && !received[i]) {
+      window[i] = syndrome[i % frame.symbolSize];
+      ++i;
+    }
+    recovered.emplace_back(
+        streamId_,
+        frame.offset + start,
+        folly::IOBuf::copyBuffer(window.data() + start, i - start),
+        false /* fin */);
+  }
+  return recovered;
+}
+
+} // namespace quic
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <map>
+
+#include <quic/codec/Types.h>
+
+namespace quic {
+
+/**
+ * Builds the STREAM_REPAIR frames for one stream. New stream data is folded
+ * into a window of windowSymbols symbols as it is written; the repair frame
+ * for the window goes out once it is full, or earlier through flush() when
+ * the stream ends.
+ */
+class StreamFecEncoder {
+ public:
+  StreamFecEncoder(StreamId streamId, uint64_t symbolSize);
+
+  /**
+   * Folds data written at offset into the current window. Data is expected
+   * in stream order; a gap starts a new window. Returns a repair frame for
+   * every window the data completes. windowSymbols sizes the windows that
+   * are started by this call.
+   */
+  std::vector<StreamRepairFrame> onDataWritten(
+      uint64_t offset,
+      const folly::IOBuf& data,
+      uint64_t windowSymbols);
+
+  /**
+   * Returns a repair frame for the current window if it holds data that no
+   * repair frame has covered yet. The window stays open, so later data is
+   * still protected by the same window.
+   */
+  folly::Optional<StreamRepairFrame> flush();
+
+  uint64_t getSymbolSize() const {
+    return symbolSize_;
+  }
+
+ private:
+  void startWindow(uint64_t offset, uint64_t windowSymbols);
+
+  StreamRepairFrame makeRepairFrame();
+
+  StreamId streamId_;
+  uint64_t symbolSize_;
+  uint64_t windowStart_{0};
+  uint64_t windowLength_{0};
+  uint64_t windowCapacity_{0};
+  // Length of the window when the last repair frame was made.
+  uint64_t repairedLength_{0};
+  std::vector<uint8_t> repair_;
+};
+
+/**
+ * Keeps the most recently received data of a stream so that missing bytes
+ * can be rebuilt from STREAM_REPAIR frames. Buffers are shared with the read
+ * buffer rather than copied.
+ */
+class StreamFecDecoder {
+ public:
+  StreamFecDecoder(StreamId streamId, uint64_t retentionBytes);
+
+  void onDataReceived(uint64_t offset, const folly::IOBuf& data);
+
+  /**
+   * Returns the bytes of the repaired range that were missing, or nothing if
+   * all of it was received or too much of it is missing.
+   */
+  std::vector<ReadStreamFrame> onRepairReceived(const StreamRepairFrame& frame);
+
+  size_t numRetainedBuffers() const {
+    return retained_.size();
+  }
+
+ private:
+  StreamId streamId_;
+  uint64_t retentionBytes_;
+  uint64_t maxOffsetReceived_{0};
+  // Keyed by stream offset. Data is only ever added for an offset if it is
+  // longer than what is already there.
+  std::map<uint64_t, Buf> retained_;
+};
+
+} // namespace quic
@@ -8,8 +8,11 @@
 
 #pragma once
 
+#include <folly/SocketAddress.h>
 #include <quic/QuicConstants.h>
 #include <chrono>
+#include <memory>
+#include <utility>
 
 namespace quic {
 
@@ -137,13 +140,41 @@ struct TransportSettings {
   uint64_t totalBufferSpaceAvailable{kDefaultBufferSpaceAvailable};
   // Whether or not to advertise partial reliability capability
   bool partialReliabilityEnabled{false};
+  // Bytes of received stream data kept per stream to rebuild lost data from
+  // the peer's STREAM_REPAIR frames. Advertised to the peer; 0 means repair
+  // frames are not accepted.
+  uint64_t fecRetentionBytes{0};
+  // Loss rate above which streams with forward error correction enabled send
+  // repair frames.
+  double fecMinLossRate{kDefaultFecMinLossRate};
+  // Upper bound on the number of packet sized symbols one repair frame
+  // protects. Fewer are used as the loss rate goes up.
+  uint64_t fecMaxWindowSymbols{kDefaultFecMaxWindowSymbols};
   // Whether the endpoint allows peer to migrate to new address
   bool disableMigration{true};
+  // Unicast addresses a server advertises in the preferred_address transport
+  // parameter, typically this host's own addresses behind an anycast VIP. The
+  // server must receive packets and reply from the advertised address.
+  folly::Optional<folly::SocketAddress> preferredAddressV4;
+  folly::Optional<folly::SocketAddress> preferredAddressV6;
+  // Whether a client moves to the server's preferred address, if one of the
+  // same address family is offered, once the handshake is done.
+  bool migrateToPreferredAddress{false};
   // Whether or not the socket should gracefully drain on close
   bool shouldDrain{true};
+  // Server only: free the transport as soon as it closes and let the worker
+  // answer stray packets during the drain period from a compact tombstone
+  // holding the final close packet.
+  bool drainWithTombstones{false};
   // default stateless reset secret for stateless reset token
   folly::Optional<std::array<uint8_t, kStatelessResetTokenSecretLength>>
       statelessResetTokenSecret;
+  // Secret used to seal the address validation tokens sent in NEW_TOKEN
+  // frames. Tokens are only issued and accepted when this is set, and it must
+  // be the same on every server a returning client may reach.
+  folly::Optional<std::array<uint8_t, kNewTokenSecretLength>> newTokenSecret;
+  // How long a token from a NEW_TOKEN frame is accepted for.
+  std::chrono::seconds newTokenValidity{kDefaultNewTokenValidity};
   // Default initial RTT
   std::chrono::microseconds initialRtt{kDefaultInitialRtt};
   // The active_connection_id_limit that is sent to the peer.
@@ -155,6 +186,23 @@ struct TransportSettings {
   bool shouldRecvBatch{false};
   // Whether or not use recvmmsg when shouldRecvBatch is true.
   bool shouldUseRecvmmsgForBatchRecv{false};
+  // Whether to count the datagrams the kernel drops because the socket
+  // receive buffer is full, and report them to the stats callback.
+  bool trackKernelReceiveDrops{false};
+  // Bounds for sizing the socket receive buffer from the observed read
+  // bursts and kernel drops, which are then tracked too. Sizing is off while
+  // the maximum is 0, leaving the buffer as the socket factory set it.
+  uint32_t minSocketReceiveBuffer{kDefaultMinSocketReceiveBuffer};
+  uint32_t maxSocketReceiveBuffer{0};
+  // Server connections that have sent at least this many bytes after the
+  // handshake get their own connected UDP socket, which spares the kernel a
+  // route lookup on every send. Zero disables it.
+  uint64_t connectedSocketMinBytesSent{0};
+  // Whether times that only need to be as fine as an event loop iteration,
+  // such as flow control and pacing bookkeeping, are read once per iteration.
+  bool useLoopCachedClock{false};
+  // Clock that packet send and receive times are taken from.
+  PacketTimestampClock packetTimestampClock{PacketTimestampClock::Steady};
   // Config struct for BBR
   BbrConfig bbrConfig;
   // A packet is considered loss when a packet that's sent later by at least
@@ -162,6 +210,93 @@ struct TransportSettings {
   DurationRep timeReorderingThreshDividend{
       kDefaultTimeReorderingThreshDividend};
   DurationRep timeReorderingThreshDivisor{kDefaultTimeReorderingThreshDivisor};
+  // Amount of time a connection has to be quiescent (nothing outstanding and
+  // nothing buffered) before it hibernates and releases the spare capacity of
+  // its containers. The state grows back on demand when the next packet is
+  // processed. A server worker checks its connections at this interval, as
+  // set in its default settings, so a connection hibernates after one to two
+  // intervals. Zero disables hibernation.
+  std::chrono::milliseconds hibernationIdleTimeout{0};
+  // Connection flow control credit, in bytes, that non-control streams may
+  // not use while the connection has control streams. This keeps a bulk
+  // transfer from taking the window a control stream needs next. When the
+  // remaining window drops to the reservation, a DATA_BLOCKED frame asks the
+  // peer for more credit. Zero disables the reservation.
+  uint64_t controlStreamFlowControlReserve{0};
+};
+
+/**
+ * The transport settings of a connection. Connections share an immutable
+ * profile, such as their server worker's settings, and only take a copy of
+ * their own the first time they change one of the settings.
+ */
+class SharedTransportSettings {
+ public:
+  SharedTransportSettings() : settings_(defaultSettings()) {}
+
+  /* implicit */ SharedTransportSettings(
+      std::shared_ptr<const TransportSettings> settings)
+      : settings_(settings ? std::move(settings) : defaultSettings()) {}
+
+  /* implicit */ SharedTransportSettings(TransportSettings settings) {
+    auto owned = std::make_shared<TransportSettings>(std::move(settings));
+    owned_ = owned.get();
+    settings_ = std::move(owned);
+  }
+
+  // Copies share the settings, so neither copy can change them in place.
+  SharedTransportSettings(const SharedTransportSettings& other)
+      : settings_(other.settings_) {}
+
+  SharedTransportSettings& operator=(const SharedTransportSettings& other) {
+    settings_ = other.settings_;
+    owned_ = nullptr;
+    return *this;
+  }
+
+  SharedTransportSettings(SharedTransportSettings&& other) noexcept
+      : settings_(std::move(other.settings_)),
+        owned_(std::exchange(other.owned_, nullptr)) {}
+
+  SharedTransportSettings& operator=(SharedTransportSettings&& other) noexcept {
+    settings_ = std::move(other.settings_);
+    owned_ = std::exchange(other.owned_, nullptr);
+    return *this;
+  }
+
+  const TransportSettings& operator*() const {
+    return *settings_;
+  }
+
+  const TransportSettings* operator->() const {
+    return settings_.get();
+  }
+
+  /**
+   * Settings that can be changed, copied first if they are shared.
+   */
+  TransportSettings& mutate() {
+    if (!owned_) {
+      auto owned = std::make_shared<TransportSettings>(*settings_);
+      owned_ = owned.get();
+      settings_ = std::move(owned);
+    }
+    return *owned_;
+  }
+
+  bool isShared() const {
+    return !owned_;
+  }
+
+ private:
+  static const std::shared_ptr<const TransportSettings>& defaultSettings() {
+    static const auto settings = std::make_shared<const TransportSettings>();
+    return settings;
+  }
+
+  std::shared_ptr<const TransportSettings> settings_;
+  // Set while settings_ is a copy that no one else uses.
+  TransportSettings* owned_{nullptr};
 };
 
 } // namespace quic
@@ -35,6 +35,9 @@ void receiveReadStreamFrameSMHandler(
     case StreamRecvState::Open_E: {
       VLOG_IF(10, frame.fin) << "Open: Received data with fin"
                              << " stream=" << stream.id << " " << stream.conn;
+      if (stream.fecDecoder) {
+        stream.fecDecoder->onDataReceived(frame.offset, *frame.data);
+      }
       appendDataToReadBuffer(
           stream, StreamBuffer(std::move(frame.data), frame.offset, frame.fin));
       if (isAllDataReceived(stream)) {
@@ -103,6 +103,7 @@ void sendAckSMHandler(
               ackedBuffer->second.offset,
               ackedBuffer->second.offset +
                   ackedBuffer->second.data.chainLength());
+          stream.unackedBytes -= ackedBuffer->second.data.chainLength();
           stream.retransmissionBuffer.erase(ackedBuffer);
         } else {
           VLOG(10)
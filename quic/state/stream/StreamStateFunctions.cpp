@@ -8,6 +8,7 @@
 
 #include <quic/state/stream/StreamStateFunctions.h>
 #include <quic/flowcontrol/QuicFlowController.h>
+#include <quic/state/QuicStreamFunctions.h>
 
 namespace quic {
 
@@ -16,8 +17,10 @@ void resetQuicStream(QuicStreamState& stream, ApplicationErrorCode error) {
   updateFlowControlOnWriteToSocket(stream, writeBufferLen);
   stream.retransmissionBuffer.clear();
   stream.writeBuffer.move();
+  stream.dataSource.reset();
   stream.readBuffer.clear();
   stream.lossBuffer.clear();
+  stream.unackedBytes = 0;
   stream.streamWriteError = error;
   stream.conn.streamManager->updateReadableStreams(stream);
   stream.conn.streamManager->updateWritableStreams(stream);
@@ -50,10 +53,11 @@ void onResetQuicStream(QuicStreamState& stream, RstStreamFrame&& frame) {
     // If the currentReadOffset > finalReadOffset we have already processed
     // all the bytes until FIN, so we don't need to do anything for the read
     // side of the flow controller.
-    auto lastReadOffset = stream.currentReadOffset;
-    stream.currentReadOffset = frame.offset;
+    auto lastReadOffset = stream.flowControlReadOffset();
+    advanceCurrentReadOffset(stream, frame.offset);
     stream.maxOffsetObserved = frame.offset;
-    updateFlowControlOnRead(stream, lastReadOffset, Clock::now());
+    updateFlowControlOnRead(
+        stream, lastReadOffset, stream.conn.clock.coarseNow());
   }
   stream.conn.streamManager->updateReadableStreams(stream);
   stream.conn.streamManager->updateWritableStreams(stream);
@@ -212,6 +212,7 @@ TEST_F(QuicOpenStateTest, AckStreamMulti) {
 
   EXPECT_EQ(stream->retransmissionBuffer.size(), 3);
   EXPECT_EQ(3, conn->outstandingPackets.size());
+  EXPECT_EQ(21, stream->unackedBytes);
 
   auto& streamFrame3 =
       *conn->outstandingPackets[2].packet.frames[0].asWriteStreamFrame();
@@ -220,6 +221,7 @@ TEST_F(QuicOpenStateTest, AckStreamMulti) {
   ASSERT_EQ(stream->sendState, StreamSendState::Open_E);
   ASSERT_EQ(stream->ackedIntervals.front().start, 10);
   ASSERT_EQ(stream->ackedIntervals.front().end, 21);
+  EXPECT_EQ(10, stream->unackedBytes);
 
   auto& streamFrame2 =
       *conn->outstandingPackets[1].packet.frames[0].asWriteStreamFrame();
@@ -236,6 +238,7 @@ TEST_F(QuicOpenStateTest, AckStreamMulti) {
   ASSERT_EQ(stream->sendState, StreamSendState::Open_E);
   ASSERT_EQ(stream->ackedIntervals.front().start, 0);
   ASSERT_EQ(stream->ackedIntervals.front().end, 21);
+  EXPECT_EQ(0, stream->unackedBytes);
 }
 
 TEST_F(QuicOpenStateTest, RetxBufferSortedAfterAck) {
@@ -768,8 +768,8 @@ TEST_P(AckHandlersTest, AckNotOutstandingButLoss) {
   WriteStreamFrame frame(0, 0, 0, true);
   regularPacket.frames.emplace_back(std::move(frame));
   auto delayUntilLost = 200ms *
-      conn.transportSettings.timeReorderingThreshDividend /
-      conn.transportSettings.timeReorderingThreshDivisor;
+      conn.transportSettings->timeReorderingThreshDividend /
+      conn.transportSettings->timeReorderingThreshDivisor;
   OutstandingPacket outstandingPacket(
       std::move(regularPacket),
       Clock::now() - delayUntilLost - 20ms,
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <quic/codec/QuicPacketBuilder.h>
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/FecFunctions.h>
+#include <quic/state/QuicStreamFunctions.h>
+#include <quic/state/stream/StreamReceiveHandlers.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+constexpr StreamId kStreamId = 4;
+constexpr uint64_t kSymbolSize = 10;
+
+std::string toString(const Buf& buf) {
+  return buf->clone()->moveToFbString().toStdString();
+}
+
+class FecFunctionsTest : public Test {
+ public:
+  void SetUp() override {
+    conn.transportSettings.mutate().fecRetentionBytes = 1000;
+    conn.peerFecRetentionBytes = 1000;
+    conn.flowControlState.advertisedMaxOffset = kDefaultConnectionWindowSize;
+  }
+
+  QuicServerConnectionState conn;
+  std::string data{"abcdefghijklmnopqrstuvwxyz0123"};
+};
+
+TEST_F(FecFunctionsTest, RecoverLostSymbol) {
+  StreamFecEncoder encoder(kStreamId, kSymbolSize);
+  auto repairs =
+      encoder.onDataWritten(0, *IOBuf::copyBuffer(data), 3 /* symbols */);
+  ASSERT_EQ(repairs.size(), 1);
+  EXPECT_EQ(repairs[0].offset, 0);
+  EXPECT_EQ(repairs[0].length, 30);
+  EXPECT_EQ(repairs[0].repairData->computeChainDataLength(), kSymbolSize);
+  EXPECT_FALSE(encoder.flush().hasValue());
+
+  StreamFecDecoder decoder(kStreamId, 1000);
+  decoder.onDataReceived(0, *IOBuf::copyBuffer(data.substr(0, 10)));
+  decoder.onDataReceived(20, *IOBuf::copyBuffer(data.substr(20, 10)));
+  auto recovered = decoder.onRepairReceived(repairs[0]);
+  ASSERT_EQ(recovered.size(), 1);
+  EXPECT_EQ(recovered[0].offset, 10);
+  EXPECT_FALSE(recovered[0].fin);
+  EXPECT_EQ(toString(recovered[0].data), data.substr(10, 10));
+}
+
+TEST_F(FecFunctionsTest, RecoverRangeAcrossSymbols) {
+  StreamFecEncoder encoder(kStreamId, kSymbolSize);
+  auto repairs = encoder.onDataWritten(0, *IOBuf::copyBuffer(data), 3);
+  ASSERT_EQ(repairs.size(), 1);
+
+  // A lost frame no larger than a symbol is recoverable wherever it starts.
+  StreamFecDecoder decoder(kStreamId, 1000);
+  decoder.onDataReceived(0, *IOBuf::copyBuffer(data.substr(0, 5)));
+  decoder.onDataReceived(15, *IOBuf::copyBuffer(data.substr(15, 15)));
+  auto recovered = decoder.onRepairReceived(repairs[0]);
+  ASSERT_EQ(recovered.size(), 1);
+  EXPECT_EQ(recovered[0].offset, 5);
+  EXPECT_EQ(toString(recovered[0].data), data.substr(5, 10));
+}
+
+TEST_F(FecFunctionsTest, TooMuchLost) {
+  StreamFecEncoder encoder(kStreamId, kSymbolSize);
+  auto repairs = encoder.onDataWritten(0, *IOBuf::copyBuffer(data), 3);
+  ASSERT_EQ(repairs.size(), 1);
+
+  StreamFecDecoder decoder(kStreamId, 1000);
+  decoder.onDataReceived(0, *IOBuf::copyBuffer(data.substr(0, 10)));
+  EXPECT_TRUE(decoder.onRepairReceived(repairs[0]).empty());
+
+  // Nothing missing, nothing to do.
+  decoder.onDataReceived(10, *IOBuf::copyBuffer(data.substr(10, 20)));
+  EXPECT_TRUE(decoder.onRepairReceived(repairs[0]).empty());
+}
+
+TEST_F(FecFunctionsTest, FlushPartialWindow) {
+  StreamFecEncoder encoder(kStreamId, kSymbolSize);
+  EXPECT_FALSE(encoder.flush().hasValue());
+  EXPECT_TRUE(
+      encoder.onDataWritten(0, *IOBuf::copyBuffer(data.substr(0, 15)), 3)
+          .empty());
+  auto repair = encoder.flush();
+  ASSERT_TRUE(repair.hasValue());
+  EXPECT_EQ(repair->offset, 0);
+  EXPECT_EQ(repair->length, 15);
+  EXPECT_FALSE(encoder.flush().hasValue());
+
+  // The window stays open, so the next repair covers both writes.
+  EXPECT_TRUE(
+      encoder.onDataWritten(15, *IOBuf::copyBuffer(data.substr(15, 5)), 3)
+          .empty());
+  repair = encoder.flush();
+  ASSERT_TRUE(repair.hasValue());
+  EXPECT_EQ(repair->offset, 0);
+  EXPECT_EQ(repair->length, 20);
+
+  StreamFecDecoder decoder(kStreamId, 1000);
+  decoder.onDataReceived(0, *IOBuf::copyBuffer(data.substr(0, 15)));
+  auto recovered = decoder.onRepairReceived(*repair);
+  ASSERT_EQ(recovered.size(), 1);
+  EXPECT_EQ(toString(recovered[0].data), data.substr(15, 5));
+
+  // A write past a gap starts a new window.
+  auto repairs =
+      encoder.onDataWritten(100, *IOBuf::copyBuffer(data.substr(0, 20)), 2);
+  ASSERT_EQ(repairs.size(), 1);
+  EXPECT_EQ(repairs[0].offset, 100);
+  EXPECT_EQ(repairs[0].length, 20);
+}
+
+TEST_F(FecFunctionsTest, RetentionIsBounded) {
+  StreamFecDecoder decoder(kStreamId, 20);
+  for (uint64_t offset = 0; offset < 100; offset += 10) {
+    decoder.onDataReceived(offset, *IOBuf::copyBuffer(data.substr(0, 10)));
+  }
+  EXPECT_EQ(decoder.numRetainedBuffers(), 2);
+}
+
+TEST_F(FecFunctionsTest, WindowSymbolsFollowLossRate) {
+  conn.lossState.totalBytesSent = 10000;
+  EXPECT_EQ(getFecWindowSymbols(conn, kSymbolSize), 0);
+
+  conn.lossState.totalBytesRetransmitted = 625;
+  EXPECT_EQ(getFecWindowSymbols(conn, kSymbolSize), 4);
+
+  conn.lossState.totalBytesRetransmitted = 5000;
+  EXPECT_EQ(getFecWindowSymbols(conn, kSymbolSize), kMinFecWindowSymbols);
+
+  conn.lossState.totalBytesRetransmitted = 101;
+  EXPECT_EQ(
+      getFecWindowSymbols(conn, kSymbolSize),
+      conn.transportSettings->fecMaxWindowSymbols);
+
+  conn.peerFecRetentionBytes = 3 * kSymbolSize;
+  EXPECT_EQ(getFecWindowSymbols(conn, kSymbolSize), 3);
+
+  conn.peerFecRetentionBytes = 0;
+  EXPECT_EQ(getFecWindowSymbols(conn, kSymbolSize), 0);
+}
+
+TEST_F(FecFunctionsTest, RepairFramesQueuedOnWrite) {
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  stream->fecEncoder = std::make_unique<StreamFecEncoder>(stream->id, 10);
+  conn.lossState.totalBytesSent = 10000;
+  conn.lossState.totalBytesRetransmitted = 625;
+
+  // Only the full window is repaired.
+  onFecStreamDataWritten(*stream, 0, *IOBuf::copyBuffer(data + data), false);
+  ASSERT_EQ(conn.pendingEvents.frames.size(), 1);
+  auto repair = conn.pendingEvents.frames[0].asStreamRepairFrame();
+  ASSERT_NE(repair, nullptr);
+  EXPECT_EQ(repair->length, 40);
+
+  // Running out of data to send does not end the window.
+  onFecStreamDataWritten(*stream, 60, *IOBuf::copyBuffer("tail"), false);
+  EXPECT_EQ(conn.pendingEvents.frames.size(), 1);
+
+  // The FIN does, even on a frame without data.
+  onFecStreamDataWritten(*stream, 64, IOBuf(), true);
+  ASSERT_EQ(conn.pendingEvents.frames.size(), 2);
+  repair = conn.pendingEvents.frames[1].asStreamRepairFrame();
+  ASSERT_NE(repair, nullptr);
+  EXPECT_EQ(repair->offset, 40);
+  EXPECT_EQ(repair->length, 24);
+}
+
+TEST_F(FecFunctionsTest, RepairFrameFitsInPacket) {
+  auto symbolSize = getFecSymbolSize(conn);
+  StreamFecEncoder encoder(kStreamId, symbolSize);
+  // Large values, so that every varint of the frame takes the most room.
+  std::string windowData(2 * symbolSize, 'a');
+  auto repairs =
+      encoder.onDataWritten(1ULL << 40, *IOBuf::copyBuffer(windowData), 2);
+  ASSERT_EQ(repairs.size(), 1);
+  EXPECT_EQ(repairs[0].repairData->computeChainDataLength(), symbolSize);
+  repairs[0].streamId = 1ULL << 40;
+
+  ShortHeader header(
+      ProtectionType::KeyPhaseZero,
+      ConnectionId(std::vector<uint8_t>(kMaxConnectionIdSize, 1)),
+      1ULL << 30);
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen - kCipherOverheadHeuristic,
+      std::move(header),
+      0 /* largestAcked */);
+  ASSERT_TRUE(builder.canBuildPacket());
+  EXPECT_GT(writeSimpleFrame(QuicSimpleFrame(repairs[0]), builder), 0);
+}
+
+TEST_F(FecFunctionsTest, RecvRepairFrameRecoversStreamData) {
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  StreamFecEncoder encoder(stream->id, kSymbolSize);
+  auto repairs = encoder.onDataWritten(0, *IOBuf::copyBuffer(data), 3);
+  ASSERT_EQ(repairs.size(), 1);
+
+  // The first repair frame only turns on retention for the stream.
+  onRecvStreamRepairFrame(*stream, repairs[0]);
+  ASSERT_NE(stream->fecDecoder, nullptr);
+
+  receiveReadStreamFrameSMHandler(
+      *stream,
+      ReadStreamFrame(
+          stream->id, 0, IOBuf::copyBuffer(data.substr(0, 10)), false));
+  receiveReadStreamFrameSMHandler(
+      *stream,
+      ReadStreamFrame(
+          stream->id, 20, IOBuf::copyBuffer(data.substr(20, 10)), false));
+  EXPECT_EQ(toString(readDataFromQuicStream(*stream).first), "abcdefghij");
+
+  onRecvStreamRepairFrame(*stream, repairs[0]);
+  EXPECT_EQ(
+      toString(readDataFromQuicStream(*stream).first), data.substr(10, 20));
+  EXPECT_EQ(stream->maxOffsetObserved, 30);
+}
+
+TEST_F(FecFunctionsTest, RepairIgnoredWhenNotAdvertised) {
+  conn.transportSettings.mutate().fecRetentionBytes = 0;
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  onRecvStreamRepairFrame(
+      *stream,
+      StreamRepairFrame(stream->id, 0, 1, kSymbolSize, IOBuf::copyBuffer("x")));
+  EXPECT_EQ(stream->fecDecoder, nullptr);
+}
+
+} // namespace test
+} // namespace quic
@@ -93,11 +93,13 @@ TEST_F(QPRFunctionsTest, AdvanceMinimumRetransmittableOffset) {
   // case2. has no unacked data below 139
   stream->currentWriteOffset = 150;
   stream->retransmissionBuffer.emplace(140, StreamBuffer(buf->clone(), 140));
+  stream->unackedBytes = 10;
   result = advanceMinimumRetransmittableOffset(stream, 139);
   EXPECT_TRUE(result.hasValue());
   EXPECT_EQ(*result, 139);
   EXPECT_EQ(stream->minimumRetransmittableOffset, 139);
   EXPECT_EQ(stream->conn.pendingEvents.frames.size(), 1);
+  EXPECT_EQ(stream->unackedBytes, 10);
 
   // case3. ExpiredStreamDataFrame is wired
   stream->minimumRetransmittableOffset = 139;
@@ -114,6 +116,7 @@ TEST_F(QPRFunctionsTest, AdvanceMinimumRetransmittableOffset) {
     }
   }
   EXPECT_TRUE(stream->retransmissionBuffer.empty());
+  EXPECT_EQ(stream->unackedBytes, 0);
 
   // case4. update existing pending event.
   stream->minimumRetransmittableOffset = 150;
@@ -128,7 +128,7 @@ TEST_P(UpdateAckStateTest, TestUpdateAckState) {
 
   // Reaching retx limit
   for (uint8_t i = 0;
-       i < conn.transportSettings.rxPacketsBeforeAckBeforeInit - 1;
+       i < conn.transportSettings->rxPacketsBeforeAckBeforeInit - 1;
        ++i) {
     updateAckState(
         conn, GetParam(), nextPacketNum++, true, false, Clock::now());
@@ -169,14 +169,14 @@ TEST_P(UpdateAckStateTest, TestUpdateAckState) {
 
 TEST_P(UpdateAckStateTest, TestUpdateAckStateFrequency) {
   QuicServerConnectionState conn;
-  conn.transportSettings.rxPacketsBeforeAckInitThreshold = 20;
-  conn.transportSettings.rxPacketsBeforeAckBeforeInit = 2;
-  conn.transportSettings.rxPacketsBeforeAckAfterInit = 10;
+  conn.transportSettings.mutate().rxPacketsBeforeAckInitThreshold = 20;
+  conn.transportSettings.mutate().rxPacketsBeforeAckBeforeInit = 2;
+  conn.transportSettings.mutate().rxPacketsBeforeAckAfterInit = 10;
   PacketNum nextPacketNum = 0;
   auto& ackState = getAckState(conn, GetParam());
 
   for (uint8_t i = 0;
-       i < conn.transportSettings.rxPacketsBeforeAckBeforeInit - 1;
+       i < conn.transportSettings->rxPacketsBeforeAckBeforeInit - 1;
        ++i) {
     updateAckState(
         conn, GetParam(), nextPacketNum++, true, false, Clock::now());
@@ -191,18 +191,18 @@ TEST_P(UpdateAckStateTest, TestUpdateAckStateFrequency) {
   conn.pendingEvents.scheduleAckTimeout = false;
 
   for (;
-       nextPacketNum <= conn.transportSettings.rxPacketsBeforeAckInitThreshold;
+       nextPacketNum <= conn.transportSettings->rxPacketsBeforeAckInitThreshold;
        nextPacketNum++) {
     updateAckState(conn, GetParam(), nextPacketNum, true, false, Clock::now());
   }
   ASSERT_EQ(
       ackState.largestReceivedPacketNum.value(),
-      conn.transportSettings.rxPacketsBeforeAckInitThreshold);
+      conn.transportSettings->rxPacketsBeforeAckInitThreshold);
   ackState.needsToSendAckImmediately = false;
   conn.pendingEvents.scheduleAckTimeout = false;
   ackState.numRxPacketsRecvd = 0;
   for (uint8_t i = 0;
-       i < conn.transportSettings.rxPacketsBeforeAckAfterInit - 1;
+       i < conn.transportSettings->rxPacketsBeforeAckAfterInit - 1;
        ++i) {
     updateAckState(
         conn, GetParam(), nextPacketNum++, true, false, Clock::now());
@@ -258,7 +258,7 @@ TEST_P(UpdateAckStateTest, UpdateAckSendStateOnRecvPacketsRxLimit) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
   auto& ackState = getAckState(conn, GetParam());
   for (size_t i = 0;
-       i < conn.transportSettings.rxPacketsBeforeAckBeforeInit - 1;
+       i < conn.transportSettings->rxPacketsBeforeAckBeforeInit - 1;
        i++) {
     updateAckSendStateOnRecvPacket(conn, ackState, false, true, false);
     EXPECT_FALSE(verifyToAckImmediately(conn, ackState));
@@ -300,7 +300,7 @@ TEST_P(
   // use 1 rx packet
   updateAckSendStateOnRecvPacket(conn, ackState, false, true, false);
   for (size_t i = 0;
-       i < conn.transportSettings.rxPacketsBeforeAckBeforeInit - 2;
+       i < conn.transportSettings->rxPacketsBeforeAckBeforeInit - 2;
        i++) {
     updateAckSendStateOnRecvPacket(conn, ackState, false, false, false);
     EXPECT_FALSE(verifyToAckImmediately(conn, ackState));
@@ -317,11 +317,11 @@ TEST_P(
 
 TEST_P(UpdateAckStateTest, UpdateAckSendStateOnRecvPacketsRxAndNonRxMixed) {
   // Rx and non-rx mixed together. We should still just need
-  // conn.transportSettings.rxPacketsBeforeAckBeforeInit to trigger an ack
+  // conn.transportSettings->rxPacketsBeforeAckBeforeInit to trigger an ack
   QuicConnectionStateBase conn(QuicNodeType::Client);
   auto& ackState = getAckState(conn, GetParam());
   for (size_t i = 0;
-       i < conn.transportSettings.rxPacketsBeforeAckBeforeInit - 1;
+       i < conn.transportSettings->rxPacketsBeforeAckBeforeInit - 1;
        i++) {
     bool isRetransmittable = i % 2;
     updateAckSendStateOnRecvPacket(
@@ -527,7 +527,7 @@ TEST_F(QuicStateFunctionsTest, IsConnectionPaced) {
   state.canBePaced = true;
   EXPECT_FALSE(isConnectionPaced(state));
 
-  state.transportSettings.pacingEnabled = true;
+  state.transportSettings.mutate().pacingEnabled = true;
   EXPECT_FALSE(isConnectionPaced(state));
 }
 
@@ -643,6 +643,59 @@ TEST_P(QuicStateFunctionsTest, CloseTranportStateChange) {
   EXPECT_TRUE(conn.pendingEvents.closeTransport);
 }
 
+TEST_F(QuicStateFunctionsTest, ConnectionQuiescent) {
+  QuicServerConnectionState conn;
+  EXPECT_TRUE(isConnectionQuiescent(conn));
+
+  conn.outstandingPackets.emplace_back(
+      makeTestShortPacket(), Clock::now(), 100, false, 100);
+  EXPECT_FALSE(isConnectionQuiescent(conn));
+  conn.outstandingPackets.clear();
+  EXPECT_TRUE(isConnectionQuiescent(conn));
+
+  conn.pendingEvents.frames.emplace_back(PingFrame());
+  EXPECT_FALSE(isConnectionQuiescent(conn));
+  conn.pendingEvents.frames.clear();
+
+  conn.cryptoState->handshakeStream.writeBuffer.append(
+      folly::IOBuf::copyBuffer("crypto"));
+  EXPECT_FALSE(isConnectionQuiescent(conn));
+  conn.cryptoState->handshakeStream.writeBuffer.move();
+  EXPECT_TRUE(isConnectionQuiescent(conn));
+
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  conn.streamManager->addLoss(stream->id);
+  EXPECT_FALSE(isConnectionQuiescent(conn));
+}
+
+TEST_F(QuicStateFunctionsTest, CompactConnectionState) {
+  QuicServerConnectionState conn;
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  stream->currentReadOffset = 10;
+  stream->currentWriteOffset = 20;
+  conn.flowControlState.sumCurWriteOffset = 20;
+  conn.lossState.srtt = 50ms;
+  for (PacketNum packetNum = 0; packetNum < 100; packetNum++) {
+    conn.outstandingPacketEvents.insert(packetNum);
+  }
+  conn.outstandingPacketEvents.clear();
+  ASSERT_TRUE(isConnectionQuiescent(conn));
+  EXPECT_FALSE(conn.hibernated);
+
+  compactConnectionState(conn);
+  EXPECT_TRUE(conn.hibernated);
+  EXPECT_EQ(0, conn.outstandingPacketEvents.bucket_count());
+
+  // Only spare capacity is released, the connection's state is preserved.
+  auto compactedStream = conn.streamManager->findStream(stream->id);
+  ASSERT_NE(nullptr, compactedStream);
+  EXPECT_EQ(10, compactedStream->currentReadOffset);
+  EXPECT_EQ(20, compactedStream->currentWriteOffset);
+  EXPECT_EQ(20, conn.flowControlState.sumCurWriteOffset);
+  EXPECT_EQ(50ms, conn.lossState.srtt);
+  EXPECT_TRUE(isConnectionQuiescent(conn));
+}
+
 INSTANTIATE_TEST_CASE_P(
     QuicStateFunctionsTests,
     QuicStateFunctionsTest,
@@ -404,6 +404,78 @@ TEST_F(QuicStreamFunctionsTest, TestReadDataOutOfOrder) {
   EXPECT_TRUE(readData4.second);
 }
 
+TEST_F(QuicStreamFunctionsTest, TestReadDataUnordered) {
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  stream->unorderedRead = true;
+  auto connLastReadOffset = conn.flowControlState.sumCurReadOffset;
+
+  appendDataToReadBuffer(
+      *stream, StreamBuffer(IOBuf::copyBuffer("call me maybe"), 10, true));
+  EXPECT_TRUE(stream->hasReadableData());
+
+  auto readData1 = readDataUnorderedFromQuicStream(*stream, 5);
+  ASSERT_EQ(readData1.first.size(), 1);
+  EXPECT_EQ(readData1.first[0].offset, 10);
+  EXPECT_EQ(
+      "call ",
+      readData1.first[0].data.move()->moveToFbString().toStdString());
+  EXPECT_FALSE(readData1.second);
+  EXPECT_EQ(stream->currentReadOffset, 0);
+  EXPECT_EQ(stream->flowControlReadOffset(), 5);
+  EXPECT_EQ(conn.flowControlState.sumCurReadOffset - connLastReadOffset, 5);
+
+  // A retransmission of bytes already read is not handed out again.
+  appendDataToReadBuffer(*stream, StreamBuffer(IOBuf::copyBuffer("ll"), 12));
+  auto readData2 = readDataUnorderedFromQuicStream(*stream);
+  ASSERT_EQ(readData2.first.size(), 1);
+  EXPECT_EQ(readData2.first[0].offset, 15);
+  EXPECT_EQ(
+      "me maybe",
+      readData2.first[0].data.move()->moveToFbString().toStdString());
+  EXPECT_FALSE(readData2.second);
+
+  appendDataToReadBuffer(*stream, StreamBuffer(IOBuf::copyBuffer("so "), 7));
+  appendDataToReadBuffer(
+      *stream, StreamBuffer(IOBuf::copyBuffer("Here's"), 0));
+  auto readData3 = readDataUnorderedFromQuicStream(*stream);
+  ASSERT_EQ(readData3.first.size(), 2);
+  EXPECT_EQ(readData3.first[0].offset, 0);
+  EXPECT_EQ(readData3.first[1].offset, 7);
+  EXPECT_FALSE(readData3.second);
+  EXPECT_EQ(stream->currentReadOffset, 6);
+  EXPECT_EQ(stream->flowControlReadOffset(), 22);
+
+  // Filling the last gap moves the read offset to the end of the stream.
+  appendDataToReadBuffer(*stream, StreamBuffer(IOBuf::copyBuffer(" "), 6));
+  auto readData4 = readDataUnorderedFromQuicStream(*stream);
+  ASSERT_EQ(readData4.first.size(), 1);
+  EXPECT_EQ(readData4.first[0].offset, 6);
+  EXPECT_TRUE(readData4.second);
+  EXPECT_EQ(stream->currentReadOffset, 24);
+  EXPECT_EQ(stream->unorderedReadBytes, 0);
+  EXPECT_TRUE(stream->unorderedReadIntervals.empty());
+  EXPECT_EQ(conn.flowControlState.sumCurReadOffset - connLastReadOffset, 23);
+}
+
+TEST_F(QuicStreamFunctionsTest, TestReadDataUnorderedOpensWindow) {
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  stream->unorderedRead = true;
+  stream->flowControlState.windowSize = 20;
+  stream->flowControlState.advertisedMaxOffset = 20;
+
+  appendDataToReadBuffer(
+      *stream, StreamBuffer(IOBuf::copyBuffer("0123456789abcdef"), 4));
+  EXPECT_TRUE(stream->hasReadableData());
+  readDataUnorderedFromQuicStream(*stream);
+  EXPECT_EQ(stream->currentReadOffset, 0);
+  // The peer is allowed another window beyond what was read, even though
+  // the start of the stream is still missing.
+  EXPECT_TRUE(conn.streamManager->pendingWindowUpdate(stream->id));
+  EXPECT_EQ(
+      generateMaxStreamDataFrame(*stream).maximumData,
+      stream->flowControlReadOffset() + 20);
+}
+
 TEST_F(QuicStreamFunctionsTest, TestReadOverlappingData) {
   auto stream = conn.streamManager->createNextBidirectionalStream().value();
   auto buf1 = IOBuf::copyBuffer("I just met you ");
@@ -1754,7 +1826,7 @@ TEST_F(QuicStreamFunctionsTest, StreamLimitUpdates) {
   StreamId notOpenedPeer = 17;
 
   conn.streamManager->setStreamLimitWindowingFraction(
-      conn.transportSettings.advertisedInitialMaxStreamsBidi);
+      conn.transportSettings->advertisedInitialMaxStreamsBidi);
   conn.streamManager->getStream(peerStream)->sendState =
       StreamSendState::Closed_E;
   conn.streamManager->getStream(peerStream)->recvState =
@@ -1772,7 +1844,7 @@ TEST_F(QuicStreamFunctionsTest, StreamLimitUpdates) {
   ASSERT_TRUE(update);
   EXPECT_EQ(
       update.value(),
-      conn.transportSettings.advertisedInitialMaxStreamsBidi + 1);
+      conn.transportSettings->advertisedInitialMaxStreamsBidi + 1);
 }
 
 TEST_F(QuicStreamFunctionsTest, AllBytesTillFinAcked) {
@@ -1898,6 +1970,38 @@ TEST_F(QuicStreamFunctionsTest, StreamNextOffsetToDeliverRetxAndLossBuffer) {
   EXPECT_EQ(30, getStreamNextOffsetToDeliver(stream));
 }
 
+TEST_F(QuicStreamFunctionsTest, SendBufferWritable) {
+  QuicStreamState stream(3, conn);
+  EXPECT_EQ(
+      std::numeric_limits<uint64_t>::max(), getSendBufferWritable(stream));
+
+  stream.sendBufferLimits = QuicStreamState::SendBufferLimits{100, 100};
+  EXPECT_EQ(100, getSendBufferWritable(stream));
+
+  stream.writeBuffer.append(buildRandomInputData(40));
+  EXPECT_EQ(60, getSendBufferWritable(stream));
+
+  // Unacked bytes may use up to maxUnacked without limiting unsent space.
+  stream.retransmissionBuffer.emplace(
+      0, StreamBuffer(buildRandomInputData(60), 0));
+  stream.lossBuffer.emplace_back(buildRandomInputData(40), 60);
+  stream.unackedBytes = 100;
+  EXPECT_EQ(100, getStreamUnackedBytes(stream));
+  EXPECT_EQ(60, getSendBufferWritable(stream));
+
+  // Beyond that they take space away from unsent bytes, and the stream is not
+  // writable again until the low watermark is available.
+  stream.retransmissionBuffer.emplace(
+      100, StreamBuffer(buildRandomInputData(40), 100));
+  stream.unackedBytes = 140;
+  EXPECT_EQ(0, getSendBufferWritable(stream));
+  EXPECT_EQ(20, getSendBufferSpace(stream));
+
+  stream.retransmissionBuffer.erase(0);
+  stream.unackedBytes = 80;
+  EXPECT_EQ(60, getSendBufferWritable(stream));
+}
+
 TEST_F(QuicStreamFunctionsTest, LossBufferEmpty) {
   StreamId id = 4;
   QuicStreamState stream(id, conn);
@@ -181,9 +181,9 @@ TEST_F(QuicStreamManagerTest, TestAppIdleCloseControlStream) {
 
 TEST_F(QuicStreamManagerTest, StreamLimitWindowedUpdate) {
   auto& manager = *conn.streamManager;
-  conn.transportSettings.advertisedInitialMaxStreamsBidi = 100;
-  conn.transportSettings.advertisedInitialMaxStreamsUni = 100;
-  manager.refreshTransportSettings(conn.transportSettings);
+  conn.transportSettings.mutate().advertisedInitialMaxStreamsBidi = 100;
+  conn.transportSettings.mutate().advertisedInitialMaxStreamsUni = 100;
+  manager.refreshTransportSettings(*conn.transportSettings);
   manager.setStreamLimitWindowingFraction(4);
   for (int i = 0; i < 100; i++) {
     manager.getStream(i * detail::kStreamIncrement);
@@ -212,8 +212,8 @@ TEST_F(QuicStreamManagerTest, StreamLimitWindowedUpdate) {
 
 TEST_F(QuicStreamManagerTest, StreamLimitNoWindowedUpdate) {
   auto& manager = *conn.streamManager;
-  conn.transportSettings.advertisedInitialMaxStreamsBidi = 100;
-  manager.refreshTransportSettings(conn.transportSettings);
+  conn.transportSettings.mutate().advertisedInitialMaxStreamsBidi = 100;
+  manager.refreshTransportSettings(*conn.transportSettings);
   manager.setStreamLimitWindowingFraction(4);
   for (int i = 0; i < 100; i++) {
     manager.getStream(i * detail::kStreamIncrement);
@@ -230,8 +230,8 @@ TEST_F(QuicStreamManagerTest, StreamLimitNoWindowedUpdate) {
 
 TEST_F(QuicStreamManagerTest, StreamLimitManyWindowedUpdate) {
   auto& manager = *conn.streamManager;
-  conn.transportSettings.advertisedInitialMaxStreamsBidi = 100;
-  manager.refreshTransportSettings(conn.transportSettings);
+  conn.transportSettings.mutate().advertisedInitialMaxStreamsBidi = 100;
+  manager.refreshTransportSettings(*conn.transportSettings);
   manager.setStreamLimitWindowingFraction(4);
   for (int i = 0; i < 100; i++) {
     manager.getStream(i * detail::kStreamIncrement);
@@ -252,7 +252,7 @@ TEST_F(QuicStreamManagerTest, StreamLimitManyWindowedUpdate) {
 TEST_F(QuicStreamManagerTest, StreamLimitIncrementBidi) {
   auto& manager = *conn.streamManager;
   manager.setMaxLocalBidirectionalStreams(100, true);
-  manager.refreshTransportSettings(conn.transportSettings);
+  manager.refreshTransportSettings(*conn.transportSettings);
   StreamId max;
   for (int i = 0; i < 100; i++) {
     max = manager.createNextBidirectionalStream().value()->id;
@@ -267,7 +267,7 @@ TEST_F(QuicStreamManagerTest, StreamLimitIncrementBidi) {
 TEST_F(QuicStreamManagerTest, StreamLimitIncrementUni) {
   auto& manager = *conn.streamManager;
   manager.setMaxLocalUnidirectionalStreams(100, true);
-  manager.refreshTransportSettings(conn.transportSettings);
+  manager.refreshTransportSettings(*conn.transportSettings);
   StreamId max;
   for (int i = 0; i < 100; i++) {
     max = manager.createNextUnidirectionalStream().value()->id;
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/SendRateLimiter.h>
+
+#include <folly/portability/GTest.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+TEST(SendRateLimiterTest, BurstSize) {
+  // 1MB/s allows a 10KB burst.
+  SendRateLimiter limiter(1000 * 1000, kDefaultUDPSendPacketLen);
+  EXPECT_EQ(limiter.getBurst(), 10 * 1000);
+  // Slow rates still allow a whole packet at a time.
+  SendRateLimiter slowLimiter(1000, kDefaultUDPSendPacketLen);
+  EXPECT_EQ(slowLimiter.getBurst(), kDefaultUDPSendPacketLen);
+}
+
+TEST(SendRateLimiterTest, OverdrawAndRefill) {
+  SendRateLimiter limiter(1000 * 1000, kDefaultUDPSendPacketLen);
+  auto now = Clock::now();
+  EXPECT_TRUE(limiter.hasCredit());
+  limiter.onBytesSent(9 * 1000, now);
+  EXPECT_TRUE(limiter.hasCredit());
+  // The last send may overdraw the bucket.
+  limiter.onBytesSent(2 * 1000, now);
+  EXPECT_FALSE(limiter.hasCredit());
+  // 1000 bytes of debt plus one byte take 1001us to earn back.
+  EXPECT_EQ(limiter.timeUntilCredit(), std::chrono::microseconds(1001));
+
+  limiter.refill(now + std::chrono::microseconds(1000));
+  EXPECT_FALSE(limiter.hasCredit());
+  limiter.refill(now + std::chrono::microseconds(1001));
+  EXPECT_TRUE(limiter.hasCredit());
+  EXPECT_EQ(limiter.timeUntilCredit(), std::chrono::microseconds::zero());
+}
+
+TEST(SendRateLimiterTest, RefillCappedAtBurst) {
+  SendRateLimiter limiter(1000 * 1000, kDefaultUDPSendPacketLen);
+  auto now = Clock::now();
+  limiter.onBytesSent(limiter.getBurst(), now);
+  EXPECT_FALSE(limiter.hasCredit());
+  // An idle hour only refills a single burst.
+  limiter.refill(now + std::chrono::hours(1));
+  limiter.onBytesSent(limiter.getBurst(), now + std::chrono::hours(1));
+  EXPECT_FALSE(limiter.hasCredit());
+}
+
+TEST(SendRateLimiterTest, FrequentRefillsKeepRemainder) {
+  SendRateLimiter limiter(1000, 10 * 1000);
+  auto now = Clock::now();
+  limiter.onBytesSent(limiter.getBurst(), now);
+  // Each 1500us refill earns 1.5 bytes. Dropping the half byte every time
+  // would only earn 1000 bytes over 1.5s.
+  for (int i = 1; i <= 1000; ++i) {
+    limiter.refill(now + std::chrono::microseconds(1500 * i));
+  }
+  limiter.onBytesSent(1499, now + std::chrono::microseconds(1500 * 1000));
+  EXPECT_TRUE(limiter.hasCredit());
+  limiter.onBytesSent(1, now + std::chrono::microseconds(1500 * 1000));
+  EXPECT_FALSE(limiter.hasCredit());
+}
+
+} // namespace test
+} // namespace quic
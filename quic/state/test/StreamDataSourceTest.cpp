@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/QuicStreamFunctions.h>
+#include <quic/state/StreamDataSource.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class StreamDataSourceTest : public Test {
+ public:
+  void SetUp() override {
+    conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiLocal =
+        kDefaultStreamWindowSize;
+    conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote =
+        kDefaultStreamWindowSize;
+    conn.flowControlState.peerAdvertisedMaxOffset =
+        kDefaultConnectionWindowSize;
+    conn.streamManager->setMaxLocalBidirectionalStreams(
+        kDefaultMaxStreamsBidirectional);
+  }
+
+  std::unique_ptr<MmapStreamDataSource> makeSource(const std::string& data) {
+    CHECK_EQ(
+        writeFull(file.fd(), data.data(), data.size()), ssize_t(data.size()));
+    return std::make_unique<MmapStreamDataSource>(file.path().string());
+  }
+
+  QuicServerConnectionState conn;
+  folly::test::TemporaryFile file;
+};
+
+TEST_F(StreamDataSourceTest, MmapReadSlices) {
+  auto source = makeSource("0123456789");
+  EXPECT_EQ(source->length(), 10);
+  auto slice = source->read(3, 4);
+  EXPECT_EQ(slice->moveToFbString().toStdString(), "3456");
+
+  // Buffers stay valid after the source is gone.
+  auto tail = source->read(7, 3);
+  source.reset();
+  EXPECT_EQ(tail->moveToFbString().toStdString(), "789");
+}
+
+TEST_F(StreamDataSourceTest, PullIntoWriteBuffer) {
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  writeDataToQuicStream(*stream, IOBuf::copyBuffer("header "), false);
+  stream->dataSource = makeSource("body of the file");
+  EXPECT_FALSE(stream->writable());
+  EXPECT_EQ(getLargestWriteOffsetSeen(*stream), 23);
+
+  pullDataFromStreamDataSource(*stream, 4);
+  EXPECT_EQ(stream->writeBuffer.chainLength(), 11);
+  EXPECT_FALSE(stream->finalWriteOffset.hasValue());
+  EXPECT_TRUE(stream->hasDataSourceData());
+
+  pullDataFromStreamDataSource(*stream, 100);
+  EXPECT_EQ(stream->dataSource, nullptr);
+  ASSERT_TRUE(stream->finalWriteOffset.hasValue());
+  EXPECT_EQ(*stream->finalWriteOffset, 23);
+  EXPECT_EQ(
+      stream->writeBuffer.move()->moveToFbString().toStdString(),
+      "header body of the file");
+}
+
+TEST_F(StreamDataSourceTest, EmptySourceOnlyWritesFin) {
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  stream->dataSource = makeSource("");
+  EXPECT_FALSE(stream->hasDataSourceData());
+  pullDataFromStreamDataSource(*stream, 0);
+  ASSERT_TRUE(stream->finalWriteOffset.hasValue());
+  EXPECT_EQ(*stream->finalWriteOffset, 0);
+  EXPECT_TRUE(stream->hasWritableData());
+}
+
+} // namespace test
+} // namespace quic
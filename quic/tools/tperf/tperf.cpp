@@ -18,6 +18,7 @@
 #include <quic/client/handshake/FizzClientQuicHandshakeContext.h>
 #include <quic/common/test/TestUtils.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
+#include <quic/fizz/handshake/FizzCertCompression.h>
 #include <quic/server/QuicServer.h>
 #include <quic/server/QuicServerTransport.h>
 #include <quic/server/QuicSharedUDPSocketFactory.h>
@@ -34,7 +35,7 @@ DEFINE_uint64(
     "Amount of data written to stream each iteration");
 DEFINE_uint64(writes_per_loop, 5, "Amount of socket writes per event loop");
 DEFINE_uint64(window, 64 * 1024, "Flow control window size");
-DEFINE_string(congestion, "newreno", "newreno/cubic/bbr/none");
+DEFINE_string(congestion, "newreno", "newreno/cubic/bbr/ledbat/none");
 DEFINE_bool(pacing, false, "Enable pacing");
 DEFINE_bool(gso, false, "Enable GSO writes to the socket");
 DEFINE_uint32(
@@ -66,6 +67,10 @@ DEFINE_uint32(
         quic::kDefaultV4UDPSendPacketLen,
         quic::kDefaultV6UDPSendPacketLen),
     "Maximum packet size to advertise to the peer.");
+DEFINE_string(
+    cert_compression,
+    "none",
+    "none/zlib/zstd: RFC 8879 certificate compression, set on both ends.");
 
 namespace quic {
 namespace tperf {
@@ -282,13 +287,15 @@ class TPerfServer {
       bool pacing,
       uint32_t numStreams,
       uint64_t maxBytesPerStream,
-      uint32_t maxReceivePacketSize)
+      uint32_t maxReceivePacketSize,
+      const std::vector<fizz::CertificateCompressionAlgorithm>&
+          certCompressionAlgos)
       : host_(host), port_(port), server_(QuicServer::createQuicServer()) {
     eventBase_.setName("tperf_server");
     server_->setQuicServerTransportFactory(
         std::make_unique<TPerfServerTransportFactory>(
             blockSize, numStreams, maxBytesPerStream));
-    auto serverCtx = quic::test::createServerCtx();
+    auto serverCtx = quic::test::createServerCtx(certCompressionAlgos);
     serverCtx->setClock(std::make_shared<fizz::SystemClock>());
     server_->setFizzContext(serverCtx);
     quic::TransportSettings settings;
@@ -337,7 +344,8 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
       uint64_t window,
       bool gso,
       quic::CongestionControlType congestionControlType,
-      uint32_t maxReceivePacketSize)
+      uint32_t maxReceivePacketSize,
+      std::vector<fizz::CertificateCompressionAlgorithm> certCompressionAlgos)
       : host_(host),
         port_(port),
         eventBase_(transportTimerResolution),
@@ -345,7 +353,8 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
         window_(window),
         gso_(gso),
         congestionControlType_(congestionControlType),
-        maxReceivePacketSize_(maxReceivePacketSize) {
+        maxReceivePacketSize_(maxReceivePacketSize),
+        certCompressionAlgos_(std::move(certCompressionAlgos)) {
     eventBase_.setName("tperf_client");
   }
 
@@ -464,6 +473,8 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
     auto fizzClientContext =
         FizzClientQuicHandshakeContext::Builder()
             .setCertificateVerifier(test::createTestCertificateVerifier())
+            .setCertDecompressionManager(
+                createCertDecompressionManager(certCompressionAlgos_))
             .build();
     quicClient_ = std::make_shared<quic::QuicClientTransport>(
         &eventBase_, std::move(sock), std::move(fizzClientContext));
@@ -516,6 +527,7 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
   bool gso_;
   quic::CongestionControlType congestionControlType_;
   uint32_t maxReceivePacketSize_;
+  std::vector<fizz::CertificateCompressionAlgorithm> certCompressionAlgos_;
 };
 
 } // namespace tperf
@@ -533,6 +545,8 @@ quic::CongestionControlType flagsToCongestionControlType(
     return quic::CongestionControlType::BBR;
   } else if (congestionControlType == "copa") {
     return quic::CongestionControlType::Copa;
+  } else if (congestionControlType == "ledbat") {
+    return quic::CongestionControlType::Ledbat;
   } else if (congestionControlType == "none") {
     return quic::CongestionControlType::None;
   }
@@ -540,6 +554,19 @@ quic::CongestionControlType flagsToCongestionControlType(
       "Unknown congestion controller ", congestionControlType));
 }
 
+std::vector<fizz::CertificateCompressionAlgorithm> flagsToCertCompressionAlgos(
+    const std::string& certCompression) {
+  if (certCompression == "zlib") {
+    return {fizz::CertificateCompressionAlgorithm::zlib};
+  } else if (certCompression == "zstd") {
+    return {fizz::CertificateCompressionAlgorithm::zstd};
+  } else if (certCompression == "none") {
+    return {};
+  }
+  throw std::invalid_argument(folly::to<std::string>(
+      "Unknown certificate compression ", certCompression));
+}
+
 int main(int argc, char* argv[]) {
 #if FOLLY_HAVE_LIBGFLAGS
   // Enable glog logging to stderr by default.
@@ -562,7 +589,8 @@ int main(int argc, char* argv[]) {
         FLAGS_pacing,
         FLAGS_num_streams,
         FLAGS_bytes_per_stream,
-        FLAGS_max_receive_packet_size);
+        FLAGS_max_receive_packet_size,
+        flagsToCertCompressionAlgos(FLAGS_cert_compression));
     server.start();
   } else if (FLAGS_mode == "client") {
     if (FLAGS_num_streams != 1) {
@@ -581,7 +609,8 @@ int main(int argc, char* argv[]) {
         FLAGS_window,
         FLAGS_gso,
         flagsToCongestionControlType(FLAGS_congestion),
-        FLAGS_max_receive_packet_size);
+        FLAGS_max_receive_packet_size,
+        flagsToCertCompressionAlgos(FLAGS_cert_compression));
     client.start();
   }
   return 0;
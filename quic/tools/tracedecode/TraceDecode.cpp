@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <glog/logging.h>
+
+#include <folly/File.h>
+#include <folly/init/Init.h>
+#include <folly/portability/GFlags.h>
+
+#include <quic/logging/QuicTrace.h>
+
+#include <iostream>
+
+DEFINE_string(input, "", "Trace file written by QuicTracer::drainToFile");
+
+int main(int argc, char* argv[]) {
+#if FOLLY_HAVE_LIBGFLAGS
+  // Enable glog logging to stderr by default.
+  gflags::SetCommandLineOptionWithMode(
+      "logtostderr", "1", gflags::SET_FLAGS_DEFAULT);
+#endif
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  folly::Init init(&argc, &argv);
+
+  if (FLAGS_input.empty()) {
+    LOG(ERROR) << "--input is required";
+    return 1;
+  }
+  folly::File file(FLAGS_input);
+  std::cout << "reltime ||    client_conn_id ||     server_conn_id ||     "
+               "event ||              value"
+            << std::endl;
+  size_t malformed = 0;
+  auto result = quic::readQuicTraceFile(
+      file.fd(), [&](const quic::QuicTraceRecord& record) {
+        auto line = quic::formatQuicTraceRecord(record);
+        if (!line) {
+          ++malformed;
+          return;
+        }
+        std::cout << *line << "\n";
+      });
+  std::cout.flush();
+  if (result.hasError()) {
+    LOG(ERROR) << "Failed to read " << FLAGS_input << ": " << result.error();
+    return 1;
+  }
+  LOG_IF(WARNING, malformed > 0) << "Skipped " << malformed
+                                 << " malformed records";
+  return 0;
+}